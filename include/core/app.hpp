@@ -6,22 +6,34 @@
 #include <vector>
 #include <atomic>
 #include <mutex>
-#include <future>
 #include <chrono>
+#include <string>
+#include "core/arena.hpp"
+#include "core/thread_pool.hpp"
 #include "rendering/camera.hpp"
 #include "rendering/image.hpp"
-
-struct RenderTile {
-    int start_x, end_x;
-    int start_y, end_y;
-    int tile_id;
-};
+#include "rendering/tile_scheduler.hpp"
+#include "rendering/path_tracer.hpp"
+#include "rendering/integrator.hpp"
+#include "rendering/wavefront.hpp"
+#include "rendering/denoiser.hpp"
+#include "rendering/temporal.hpp"
+#include "rendering/sampling_pattern.hpp"
+#include "rendering/upscaler.hpp"
+#include "geometry/scene.hpp"
 
 class APP{
     public:
 
         APP();
 
+        // Mesh file (.obj, .ply or a .paged cluster file) shown instead of the built-in scene
+        void set_mesh_path(const char* path) { mesh_path = path; }
+        // Radiance .hdr latitude-longitude map used as background and light
+        void set_environment_path(const char* path) { environment_path = path; }
+        // Tiled .rttex texture mapped onto the mesh through its texture coordinates
+        void set_texture_path(const char* path) { texture_path = path; }
+
         int onexecute();
         bool oninit();
         void onevent(SDL_Event *event);
@@ -30,15 +42,48 @@ class APP{
         void onexit();
         
         // Raytracing functions
-        color ray_color(const Ray& r) const;
+        color ray_color(const Ray& r, Rng& rng) const;
         void render_tile(const RenderTile& tile, Image* target_image, Camera* target_camera);
         void render_progressive(int resolution_scale = 1);
         void render_multithreaded();
         void render_quick_preview(int width, int height);
+        void render_upscaled(const Camera& full_camera, const IntegratorKernels& kernels, double scale); // Into image via preview_image
+        void render_navigation_preview(); // Full frame of the preview kernel while the camera moves
+        void render_tile_sampled(const RenderTile& tile, const SamplingPattern& pattern); // Traced pixels only
+        SamplingPattern make_sampling_pattern() const;
+        void render_wavefront(); // Full frame through the staged wavefront integrator
+        void finish_frame(); // Denoises a finished full resolution frame and keeps it as history
+        void reproject_history(); // Shows the last finished frame wherever the moved camera still sees it
+        
+        // Time-sliced rendering - renders until the frame deadline, then presents
+        void begin_time_sliced_render();
+        bool render_time_sliced();
+        void render_row(const RenderTile& tile, int row, int sample);
+        double tile_error(const RenderTile& tile, int samples) const; // RMS relative error of the tile's pixels
+        ResizeContent resize_content() const;
 
     private:
         
+        // Scene setup - quick LBVH first, SAH rebuilt in the background and swapped in
+        void load_scene();
+        // Material for the loaded mesh: textured if a texture opens, else -1
+        int load_texture_material(const TriangleMesh* mesh);
+        // Image-sized tiles in frame memory
+        RenderTile* make_frame_tiles(size_t& tile_count);
+        FrameArena& thread_scratch(); // Row buffers of the pool thread running the caller
+        
         Camera camera;
+        Scene scene;
+        std::string mesh_path;
+        std::string environment_path;
+        std::string texture_path;
+        size_t texture_budget;       // Resident bytes of texture tiles
+        size_t lazy_build_threshold; // Unique triangles above which BLASes start lazy
+        size_t compress_threshold;   // Loaded triangles above which meshes are stored as meshlets
+        PagedMesh paged_mesh;        // Out-of-core mesh from a .paged file, traced by the wavefront integrator
+        size_t paged_budget;         // Resident bytes of its clusters
+        std::shared_ptr<const SceneAccel> frame_scene; // Acceleration snapshot used for the whole frame
+        std::thread bvh_build_thread;
         Image image;
         Image preview_image; // Lower resolution image for fast preview
         bool isrunning;
@@ -60,16 +105,80 @@ class APP{
         static const uint32_t RESIZE_DEBOUNCE_MS = 300;
         
         // Multi-threading variables
+        ThreadPool thread_pool; // Persistent workers, reused every frame
         int num_threads;
         int tile_size;
         std::atomic<bool> render_in_progress;
         std::atomic<int> completed_tiles;
         std::mutex render_mutex;
         
+        // Per-frame scratch memory, reset once per frame in onloop
+        FrameArena frame_arena;
+        ScratchArenas scratch_arenas; // One per pool thread, for row buffers
+        
         // Progressive rendering
         std::vector<int> progressive_scales; // e.g., [8, 4, 2, 1] for 1/8, 1/4, 1/2, full res
         int current_progressive_level;
         bool is_progressive_complete;
+        
+        // Time-sliced rendering
+        TileScheduler scheduler;
+        bool time_sliced_rendering;
+        double frame_budget_ms; // Render budget per presented frame
+        int samples_per_pixel;
+        bool time_sliced_active;
+        
+        // Adaptive sampling - 'V' toggles it; time-sliced passes then run up
+        // to ADAPTIVE_MAX_SAMPLES, but tiles stop once their error estimate
+        // falls to ADAPTIVE_THRESHOLD after ADAPTIVE_MIN_SAMPLES
+        bool use_adaptive;
+        static const int ADAPTIVE_MIN_SAMPLES = 4;
+        static const int ADAPTIVE_MAX_SAMPLES = 64;
+        static constexpr double ADAPTIVE_THRESHOLD = 0.05;
+        
+        // Integrator selection - megakernel (per-pixel trace_path) or wavefront
+        WavefrontIntegrator wavefront;
+        bool use_wavefront;
+        int max_path_depth;
+        std::vector<color> wavefront_output; // Reused between frames
+        
+        // Megakernel specialization - 'R' toggles Russian roulette, 'F' the
+        // indirect clamp; the kernel is looked up once per frame
+        unsigned integrator_features;
+        const IntegratorKernels* integrator;
+        
+        // Navigation - WASD/QE move the camera, 'P' cycles the preview shown
+        // while moving; the full integrator restarts once the camera settles
+        PreviewMode preview_mode;
+        bool navigating;
+        uint32_t last_navigation_time;
+        static constexpr double NAVIGATION_STEP = 0.1;
+        static const uint32_t NAVIGATION_SETTLE_MS = 200;
+        
+        // Denoising - 'N' toggles filtering of each finished full resolution
+        // frame; guides are re-rendered with it, one ray per pixel
+        Denoiser denoiser;
+        GuideBuffers guides;
+        bool use_denoiser;
+        
+        // Temporal reuse - 'T' toggles reprojecting the last finished frame
+        // into navigation frames; the preview only shows where it is rejected
+        TemporalReprojector temporal;
+        bool use_temporal;
+        static constexpr double TEMPORAL_BLEND = 0.2; // Weight of a new path traced frame over history
+        
+        // Sparse navigation frames - 'C' cycles full, checkerboard and
+        // foveated sampling; the fovea follows the cursor, or the centre
+        SamplingMode sampling_mode;
+        int sampling_frame; // Alternates the checkerboard parity
+        int cursor_x, cursor_y; // Window coordinates, -1 until the mouse moves
+        static constexpr double FOVEA_FRACTION = 1.0 / 6.0; // Fovea radius over image height
+        
+        // Reduced resolution rendering - quick previews and, with 'U',
+        // navigation frames render at a fraction of the window and are
+        // upscaled edge-adaptively instead of stretched by SDL
+        Upscaler upscaler;
+        double navigation_scale; // 1 renders navigation frames at full resolution
 
 };
 
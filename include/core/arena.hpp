@@ -0,0 +1,101 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <vector>
+#include <memory>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+
+// Frame-scoped bump allocator. Allocation is a pointer bump, reset() frees
+// everything at once. When a frame overflows the current block, the next
+// reset() coalesces all blocks into one, so a steady-state workload settles
+// into a single block and stops touching the heap.
+class FrameArena {
+
+    public:
+        explicit FrameArena(size_t initial_capacity = 64 * 1024);
+        ~FrameArena();
+
+        FrameArena(const FrameArena&) = delete;
+        FrameArena& operator=(const FrameArena&) = delete;
+
+        void* allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+
+        // Arena memory is never destructed, so only trivially destructible types fit
+        template<class T>
+        T* allocate_array(size_t count) {
+            static_assert(std::is_trivially_destructible<T>::value, "Arena types must be trivially destructible");
+            T* data = static_cast<T*>(allocate(sizeof(T) * count, alignof(T)));
+            for (size_t i = 0; i < count; ++i) {
+                new (data + i) T();
+            }
+            return data;
+        }
+
+        void reset();
+
+        // Position to rewind to, for scratch that only lives within one call
+        struct Marker {
+            size_t block;
+            size_t offset;
+            size_t used_before;
+        };
+        Marker mark() const { return {current_block, offset, used_before_current}; }
+        void rewind(const Marker& marker);
+
+        size_t bytes_used() const { return used_before_current + offset; }
+        size_t capacity() const;
+        size_t block_count() const { return blocks.size(); }
+
+    private:
+        struct Block {
+            char* data;
+            size_t size;
+        };
+
+        void add_block(size_t min_size);
+        void release_blocks();
+
+    private:
+        std::vector<Block> blocks;
+        size_t current_block;
+        size_t offset;              // Bytes used in the current block
+        size_t used_before_current; // Bytes used in earlier blocks this frame
+        size_t initial_capacity;
+};
+
+// Rewinds an arena to where it was when the scope began
+class ArenaScope {
+
+    public:
+        explicit ArenaScope(FrameArena& arena) : arena(arena), marker(arena.mark()) {}
+        ~ArenaScope() { arena.rewind(marker); }
+
+        ArenaScope(const ArenaScope&) = delete;
+        ArenaScope& operator=(const ArenaScope&) = delete;
+
+    private:
+        FrameArena& arena;
+        FrameArena::Marker marker;
+};
+
+// One arena per pool thread, indexed by ThreadPool::current_thread_index().
+// Arenas are separately allocated so threads never share a cache line.
+class ScratchArenas {
+
+    public:
+        explicit ScratchArenas(int num_threads = 1, size_t capacity_per_thread = 64 * 1024);
+
+        void resize(int num_threads);
+        FrameArena& local(int thread_index) { return *arenas[thread_index]; }
+        void reset_all();
+
+        int size() const { return static_cast<int>(arenas.size()); }
+
+    private:
+        std::vector<std::unique_ptr<FrameArena>> arenas;
+        size_t capacity_per_thread;
+};
+
+#endif
@@ -0,0 +1,47 @@
+#ifndef BINARY_FORMAT_H
+#define BINARY_FORMAT_H
+
+#include <algorithm>
+#include <vector>
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+#include <cstddef>
+
+// Layout rules shared by the pointer-free binary files (scene caches, paged
+// meshes, tiled textures). Sections start on SECTION_ALIGNMENT boundaries so
+// a mapped file is read in place, and headers that record BYTE_ORDER_MARK
+// reject files written on a machine of the other endianness.
+const uint32_t BYTE_ORDER_MARK = 0x01020304u;
+const size_t SECTION_ALIGNMENT = 64;
+
+inline size_t align_up(size_t offset) {
+    return (offset + SECTION_ALIGNMENT - 1) & ~(SECTION_ALIGNMENT - 1);
+}
+
+// Writes zeros from written up to offset and advances written to it
+inline bool write_padding(FILE* file, size_t& written, size_t offset) {
+    static const char zeros[SECTION_ALIGNMENT] = {};
+    while (written < offset) {
+        size_t count = std::min(offset - written, SECTION_ALIGNMENT);
+        if (fwrite(zeros, 1, count, file) != count) return false;
+        written += count;
+    }
+    return true;
+}
+
+// True when [offset, offset + bytes) lies inside a file of file_size bytes
+inline bool section_in_file(uint64_t offset, uint64_t bytes, size_t file_size) {
+    return offset <= file_size && bytes <= file_size - offset;
+}
+
+// Copies a section into a vector; false unless it holds whole elements
+template<class T>
+bool copy_section(const char* data, uint64_t bytes, std::vector<T>& out) {
+    if (bytes % sizeof(T) != 0) return false;
+    out.resize(bytes / sizeof(T));
+    if (bytes > 0) std::memcpy(out.data(), data, bytes);
+    return true;
+}
+
+#endif
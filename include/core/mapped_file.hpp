@@ -0,0 +1,31 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstddef>
+
+// Read-only memory-mapped file. Pages are faulted in on first touch, so
+// parallel parsers read straight from the page cache without copies.
+class MappedFile {
+
+    public:
+        MappedFile();
+        ~MappedFile();
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        // Prints the reason and returns false on failure
+        bool open(const char* path);
+        void close();
+
+        bool is_open() const { return opened; }
+        const char* data() const { return bytes; }
+        size_t size() const { return length; }
+
+    private:
+        const char* bytes;
+        size_t length;
+        bool opened;
+};
+
+#endif
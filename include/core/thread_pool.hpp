@@ -0,0 +1,89 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <thread>
+#include <vector>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+
+// Persistent worker pool. Unlike std::async, dispatching a job does not
+// allocate: the callable is passed by pointer and workers are reused.
+// The calling thread participates as thread index 0.
+class ThreadPool {
+
+    public:
+        explicit ThreadPool(int num_threads = 0); // 0 = hardware concurrency
+        ~ThreadPool();
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        // Total threads working on a job, including the caller
+        int size() const { return static_cast<int>(workers.size()) + 1; }
+
+        // Calls fn(index, thread_index) for every index in [0, count).
+        // Indices are claimed dynamically in chunks of `grain`. Calls made
+        // from inside a job run serially on the current thread.
+        template<class Function>
+        void parallel_for(size_t count, const Function& fn, size_t grain = 1) {
+            run(count, grain, &invoke<Function>, &fn);
+        }
+
+        // Index of the calling thread within its pool (0 outside any worker)
+        static int current_thread_index();
+
+    private:
+        using JobFunction = void (*)(const void* context, size_t index, int thread_index);
+
+        template<class Function>
+        static void invoke(const void* context, size_t index, int thread_index) {
+            (*static_cast<const Function*>(context))(index, thread_index);
+        }
+
+        void run(size_t count, size_t grain, JobFunction function, const void* context);
+        void worker_loop(int thread_index);
+        void execute_job(int thread_index);
+
+    private:
+        std::vector<std::thread> workers;
+
+        std::mutex submit_mutex; // Serializes jobs from different external threads
+        std::mutex mutex;
+        std::condition_variable work_available;
+        std::condition_variable work_done;
+
+        // Current job
+        JobFunction job_function;
+        const void* job_context;
+        size_t job_count;
+        size_t job_grain;
+        std::atomic<size_t> next_index;
+
+        int active_workers;
+        uint64_t generation;
+        bool stopping;
+};
+
+// ThreadPool::parallel_for when there is a pool, otherwise the same calls
+// made serially on the caller as thread 0
+template<class Function>
+void parallel_for(ThreadPool* pool, size_t count, const Function& fn, size_t grain = 1) {
+    if (pool != nullptr) {
+        pool->parallel_for(count, fn, grain);
+    } else {
+        for (size_t i = 0; i < count; ++i) fn(i, 0);
+    }
+}
+
+// Image rows claimed ROW_GRAIN at a time; calls fn(row, thread_index)
+const size_t ROW_GRAIN = 4;
+
+template<class Function>
+void for_each_row(ThreadPool* pool, int rows, const Function& fn) {
+    parallel_for(pool, static_cast<size_t>(rows), [&](size_t row, int thread) { fn(static_cast<int>(row), thread); }, ROW_GRAIN);
+}
+
+#endif
@@ -0,0 +1,80 @@
+#ifndef AABB_H
+#define AABB_H
+
+#include <limits>
+#include <algorithm>
+#include "math/ray.hpp"
+
+// Axis-aligned bounding box. A default-constructed box is empty (inverted)
+// so that expanding it by any point or box yields that point or box.
+class AABB{
+    public:
+    point3 min;
+    point3 max;
+
+    AABB()
+        : min(std::numeric_limits<double>::infinity(), std::numeric_limits<double>::infinity(), std::numeric_limits<double>::infinity()),
+          max(-std::numeric_limits<double>::infinity(), -std::numeric_limits<double>::infinity(), -std::numeric_limits<double>::infinity()) {}
+    AABB(const point3& a, const point3& b):min(a),max(b){}
+
+    inline bool empty() const { return min.e[0] > max.e[0] || min.e[1] > max.e[1] || min.e[2] > max.e[2]; }
+
+    inline void expand(const point3& p){
+        for (int a = 0; a < 3; ++a) {
+            min.e[a] = std::min(min.e[a], p.e[a]);
+            max.e[a] = std::max(max.e[a], p.e[a]);
+        }
+    }
+
+    inline void expand(const AABB& b){
+        for (int a = 0; a < 3; ++a) {
+            min.e[a] = std::min(min.e[a], b.min.e[a]);
+            max.e[a] = std::max(max.e[a], b.max.e[a]);
+        }
+    }
+
+    inline point3 centroid() const { return 0.5 * (min + max); }
+    inline vec3 extent() const { return max - min; }
+
+    inline double surface_area() const {
+        if (empty()) return 0.0;
+        vec3 d = extent();
+        return 2.0 * (d.e[0] * d.e[1] + d.e[1] * d.e[2] + d.e[2] * d.e[0]);
+    }
+
+    inline int largest_axis() const {
+        vec3 d = extent();
+        if (d.e[0] > d.e[1] && d.e[0] > d.e[2]) return 0;
+        return d.e[1] > d.e[2] ? 1 : 2;
+    }
+
+    inline bool contains(const AABB& b) const {
+        for (int a = 0; a < 3; ++a) {
+            if (b.min.e[a] < min.e[a] || b.max.e[a] > max.e[a]) return false;
+        }
+        return true;
+    }
+
+    // Slab test. inv_dir is 1/direction per axis, precomputed once per ray.
+    // On a hit, t_entry receives the distance where the ray enters the box.
+    inline bool hit(const point3& origin, const vec3& inv_dir, double t_min, double t_max, double& t_entry) const {
+        for (int a = 0; a < 3; ++a) {
+            double t0 = (min.e[a] - origin.e[a]) * inv_dir.e[a];
+            double t1 = (max.e[a] - origin.e[a]) * inv_dir.e[a];
+            if (inv_dir.e[a] < 0.0) std::swap(t0, t1);
+            t_min = t0 > t_min ? t0 : t_min;
+            t_max = t1 < t_max ? t1 : t_max;
+            if (t_max < t_min) return false;
+        }
+        t_entry = t_min;
+        return true;
+    }
+};
+
+inline AABB surrounding_box(const AABB& a, const AABB& b) {
+    AABB box = a;
+    box.expand(b);
+    return box;
+}
+
+#endif
@@ -0,0 +1,189 @@
+#ifndef BVH_H
+#define BVH_H
+
+#include <vector>
+#include <cstdint>
+#include "geometry/aabb.hpp"
+#include "core/thread_pool.hpp"
+
+// Binary BVH node. Siblings are stored next to each other, so an interior
+// node only records where its left child is; the right child follows it.
+struct BVHNode {
+    AABB bounds;
+    int left_first;  // Left child index for interior nodes, first primitive for leaves
+    int prim_count;  // 0 for interior nodes
+
+    inline bool is_leaf() const { return prim_count > 0; }
+};
+
+// Bounding volume hierarchy over abstract primitives. Builders only see
+// per-primitive bounds, so the same hierarchy serves triangles or instances.
+class BVH {
+
+    public:
+        std::vector<BVHNode> nodes;         // nodes[0] is the root
+        std::vector<uint32_t> prim_indices; // Leaf ranges index into this
+
+        static constexpr int MAX_DEPTH = 64; // Traversal stack size
+
+        bool empty() const { return nodes.empty(); }
+        int depth() const;
+        double sah_cost() const; // Expected traversal cost relative to the root area
+
+        // Closest-hit traversal, nearest child first. For every primitive in a
+        // visited leaf, leaf(prim_index, t_max) is called; it returns true on a
+        // hit and shrinks t_max to the hit distance.
+        template<class LeafFunction>
+        bool traverse(const Ray& r, double t_min, double& t_max, const LeafFunction& leaf) const {
+            if (nodes.empty()) return false;
+
+            const vec3& d = r.direction();
+            vec3 inv_dir(1.0 / d.x(), 1.0 / d.y(), 1.0 / d.z());
+            const point3& origin = r.origin();
+
+            double t_entry;
+            if (!nodes[0].bounds.hit(origin, inv_dir, t_min, t_max, t_entry)) return false;
+
+            int stack[MAX_DEPTH];
+            int stack_size = 0;
+            int node_index = 0;
+            bool hit_anything = false;
+
+            while (true) {
+                const BVHNode& node = nodes[node_index];
+                if (node.is_leaf()) {
+                    for (int i = 0; i < node.prim_count; ++i) {
+                        if (leaf(prim_indices[node.left_first + i], t_max)) hit_anything = true;
+                    }
+                } else {
+                    int left = node.left_first;
+                    double t_left, t_right;
+                    bool hit_left = nodes[left].bounds.hit(origin, inv_dir, t_min, t_max, t_left);
+                    bool hit_right = nodes[left + 1].bounds.hit(origin, inv_dir, t_min, t_max, t_right);
+
+                    if (hit_left && hit_right) {
+                        // Visit the nearer child first, defer the other
+                        int near_child = t_left <= t_right ? left : left + 1;
+                        stack[stack_size++] = t_left <= t_right ? left + 1 : left;
+                        node_index = near_child;
+                        continue;
+                    }
+                    if (hit_left || hit_right) {
+                        node_index = hit_left ? left : left + 1;
+                        continue;
+                    }
+                }
+
+                if (stack_size == 0) break;
+                node_index = stack[--stack_size];
+            }
+            return hit_anything;
+        }
+
+        // Any-hit traversal for shadow rays: stops at the first primitive for
+        // which blocks(prim_index) returns true. When both children are hit the
+        // larger one goes first, being the likelier to hold an occluder.
+        template<class BlockFunction>
+        bool traverse_any(const Ray& r, double t_min, double t_max, const BlockFunction& blocks) const {
+            if (nodes.empty()) return false;
+
+            const vec3& d = r.direction();
+            vec3 inv_dir(1.0 / d.x(), 1.0 / d.y(), 1.0 / d.z());
+            const point3& origin = r.origin();
+
+            double t_entry;
+            if (!nodes[0].bounds.hit(origin, inv_dir, t_min, t_max, t_entry)) return false;
+
+            int stack[MAX_DEPTH];
+            int stack_size = 0;
+            int node_index = 0;
+
+            while (true) {
+                const BVHNode& node = nodes[node_index];
+                if (node.is_leaf()) {
+                    for (int i = 0; i < node.prim_count; ++i) {
+                        if (blocks(prim_indices[node.left_first + i])) return true;
+                    }
+                } else {
+                    int left = node.left_first;
+                    double t_left, t_right;
+                    bool hit_left = nodes[left].bounds.hit(origin, inv_dir, t_min, t_max, t_left);
+                    bool hit_right = nodes[left + 1].bounds.hit(origin, inv_dir, t_min, t_max, t_right);
+
+                    if (hit_left && hit_right) {
+                        bool left_first = nodes[left].bounds.surface_area() >= nodes[left + 1].bounds.surface_area();
+                        stack[stack_size++] = left_first ? left + 1 : left;
+                        node_index = left_first ? left : left + 1;
+                        continue;
+                    }
+                    if (hit_left || hit_right) {
+                        node_index = hit_left ? left : left + 1;
+                        continue;
+                    }
+                }
+
+                if (stack_size == 0) return false;
+                node_index = stack[--stack_size];
+            }
+        }
+
+        // Any-hit traversal for up to 32 rays sharing one stack. Bit i of a
+        // mask stands for rays[i]; blocks(prim_index, mask) returns the rays in
+        // mask that the primitive occludes. Returns the mask of occluded rays.
+        template<class BlockFunction>
+        uint32_t traverse_any_packet(const Ray* rays, int count, double t_min, const double* t_max,
+                                     uint32_t active, const BlockFunction& blocks) const {
+            if (nodes.empty() || active == 0) return 0;
+
+            vec3 inv_dir[32];
+            for (int i = 0; i < count; ++i) {
+                const vec3& d = rays[i].direction();
+                inv_dir[i] = vec3(1.0 / d.x(), 1.0 / d.y(), 1.0 / d.z());
+            }
+            auto box_mask = [&](const AABB& box, uint32_t mask) {
+                uint32_t result = 0;
+                double t_entry;
+                for (; mask != 0; mask &= mask - 1) {
+                    int i = __builtin_ctz(mask);
+                    if (box.hit(rays[i].origin(), inv_dir[i], t_min, t_max[i], t_entry)) result |= 1u << i;
+                }
+                return result;
+            };
+
+            struct Entry { int node; uint32_t mask; };
+            Entry stack[MAX_DEPTH * 2];
+            int stack_size = 0;
+            uint32_t remaining = active;
+            uint32_t root_mask = box_mask(nodes[0].bounds, remaining);
+            if (root_mask != 0) stack[stack_size++] = Entry{0, root_mask};
+
+            while (stack_size > 0 && remaining != 0) {
+                Entry entry = stack[--stack_size];
+                uint32_t mask = entry.mask & remaining;
+                if (mask == 0) continue;
+
+                const BVHNode& node = nodes[entry.node];
+                if (node.is_leaf()) {
+                    for (int i = 0; i < node.prim_count && mask != 0; ++i) {
+                        uint32_t blocked = blocks(prim_indices[node.left_first + i], mask);
+                        mask &= ~blocked;
+                        remaining &= ~blocked;
+                    }
+                    continue;
+                }
+                uint32_t right_mask = box_mask(nodes[node.left_first + 1].bounds, mask);
+                uint32_t left_mask = box_mask(nodes[node.left_first].bounds, mask);
+                if (right_mask != 0) stack[stack_size++] = Entry{node.left_first + 1, right_mask};
+                if (left_mask != 0) stack[stack_size++] = Entry{node.left_first, left_mask};
+            }
+            return active & ~remaining;
+        }
+};
+
+// Parallel builders. Both run on the pool if one is given, serially otherwise.
+// Binned SAH: higher quality, for final rendering.
+BVH build_bvh_binned_sah(const std::vector<AABB>& prim_bounds, ThreadPool* pool, int max_leaf_size = 4);
+// Morton-code LBVH: near-instant build for interactive loads.
+BVH build_bvh_lbvh(const std::vector<AABB>& prim_bounds, ThreadPool* pool, int max_leaf_size = 4);
+
+#endif
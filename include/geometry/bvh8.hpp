@@ -0,0 +1,402 @@
+#ifndef BVH8_H
+#define BVH8_H
+
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include "geometry/bvh.hpp"
+
+#if defined(__AVX2__) && defined(__FMA__)
+#include <immintrin.h>
+#endif
+
+// Compressed 8-wide BVH node, 80 bytes. Child boxes are stored as 8-bit
+// offsets on a per-node grid: child bound = origin + q * 2^exponent per
+// axis, rounded outwards so decoded boxes always contain the child.
+// Interior children of a node are consecutive from child_base; primitives
+// of leaf children are consecutive from prim_base in slot order.
+struct BVH8Node {
+    float origin[3];
+    int8_t exponent[3];
+    uint8_t interior_mask;  // Bit i set: child i is a node
+    uint32_t child_base;
+    uint32_t prim_base;
+    uint8_t leaf_count[8];  // Primitives in leaf child i, 0 for nodes and empty slots
+    uint8_t qlo[3][8];      // Per axis, per child; empty slots have lo 255, hi 0
+    uint8_t qhi[3][8];
+};
+static_assert(sizeof(BVH8Node) == 80, "BVH8Node must stay 80 bytes");
+
+// Most primitives one leaf slot can hold
+const uint32_t BVH8_MAX_LEAF = 255;
+
+// Ray set up once for quantized box tests
+struct BVH8Ray {
+    float origin[3];
+    float inv_dir[3];
+    int negative[3];
+
+    BVH8Ray() {}
+    BVH8Ray(const Ray& r) {
+        for (int a = 0; a < 3; ++a) {
+            double d = r.direction()[a];
+            // Keep 1/d finite so quantized planes never produce inf * 0
+            if (d > -1e-20 && d < 1e-20) d = d < 0.0 ? -1e-20 : 1e-20;
+            origin[a] = static_cast<float>(r.origin()[a]);
+            inv_dir[a] = static_cast<float>(1.0 / d);
+            negative[a] = inv_dir[a] < 0.0f;
+        }
+    }
+};
+
+// Wide BVH converted from a binary one. About 80 bytes per 8 children
+// instead of 56 bytes per binary node, and one node visit tests all eight
+// children at once (AVX2 when available, scalar otherwise).
+class BVH8 {
+
+    public:
+        std::vector<BVH8Node> nodes;        // nodes[0] is the root
+        std::vector<uint32_t> prim_indices;
+        AABB bounds;                        // Exact root bounds
+
+        bool empty() const { return nodes.empty(); }
+        size_t memory_bytes() const { return nodes.size() * sizeof(BVH8Node) + prim_indices.size() * sizeof(uint32_t); }
+
+        // Decoded (conservative) bounds of one child, for validation
+        AABB child_bounds(const BVH8Node& node, int child) const;
+
+        // Closest-hit traversal, same contract as BVH::traverse
+        template<class LeafFunction>
+        bool traverse(const Ray& r, double t_min, double& t_max, const LeafFunction& leaf) const {
+            if (nodes.empty()) return false;
+
+            struct Entry { uint32_t index; uint32_t count; float t; }; // count 0: node
+            Entry stack[8 * BVH::MAX_DEPTH];
+            int stack_size = 0;
+            stack[stack_size++] = Entry{0, 0, static_cast<float>(t_min)};
+
+            BVH8Ray ray(r);
+            bool hit_anything = false;
+            while (stack_size > 0) {
+                Entry entry = stack[--stack_size];
+                if (entry.t > far_limit(t_max)) continue;
+
+                if (entry.count > 0) {
+                    for (uint32_t i = 0; i < entry.count; ++i) {
+                        if (leaf(prim_indices[entry.index + i], t_max)) hit_anything = true;
+                    }
+                    continue;
+                }
+
+                const BVH8Node& node = nodes[entry.index];
+                float t_entry[8];
+                int mask = intersect_children(node, ray, static_cast<float>(t_min), far_limit(t_max), t_entry);
+
+                // Sort hit children far to near so the nearest is popped first
+                Entry hits[8];
+                int hit_count = 0;
+                uint32_t prim_offset = node.prim_base;
+                uint32_t child_offset = node.child_base;
+                for (int i = 0; i < 8; ++i) {
+                    bool is_node = (node.interior_mask >> i) & 1;
+                    if ((mask >> i) & 1) {
+                        Entry child = is_node ? Entry{child_offset, 0, t_entry[i]} : Entry{prim_offset, node.leaf_count[i], t_entry[i]};
+                        int k = hit_count++;
+                        while (k > 0 && hits[k - 1].t < child.t) {
+                            hits[k] = hits[k - 1];
+                            --k;
+                        }
+                        hits[k] = child;
+                    }
+                    child_offset += is_node;
+                    prim_offset += node.leaf_count[i];
+                }
+                for (int i = 0; i < hit_count; ++i) stack[stack_size++] = hits[i];
+            }
+            return hit_anything;
+        }
+
+        // Any-hit traversal, same contract as BVH::traverse_any. Leaf children
+        // are tested as soon as their node is, since they can end the query
+        // without touching more memory; interior children go nearest first.
+        template<class BlockFunction>
+        bool traverse_any(const Ray& r, double t_min, double t_max, const BlockFunction& blocks) const {
+            if (nodes.empty()) return false;
+
+            uint32_t stack[8 * BVH::MAX_DEPTH];
+            int stack_size = 0;
+            stack[stack_size++] = 0;
+
+            BVH8Ray ray(r);
+            float near_limit = static_cast<float>(t_min);
+            float far = far_limit(t_max);
+            while (stack_size > 0) {
+                const BVH8Node& node = nodes[stack[--stack_size]];
+                float t_entry[8];
+                int mask = intersect_children(node, ray, near_limit, far, t_entry);
+
+                uint32_t children[8];
+                float child_t[8];
+                int child_count = 0;
+                uint32_t prim_offset = node.prim_base;
+                uint32_t child_offset = node.child_base;
+                for (int i = 0; i < 8; ++i) {
+                    bool is_node = (node.interior_mask >> i) & 1;
+                    if ((mask >> i) & 1) {
+                        if (is_node) {
+                            int k = child_count++;
+                            while (k > 0 && child_t[k - 1] < t_entry[i]) {
+                                children[k] = children[k - 1];
+                                child_t[k] = child_t[k - 1];
+                                --k;
+                            }
+                            children[k] = child_offset;
+                            child_t[k] = t_entry[i];
+                        } else {
+                            for (uint32_t p = 0; p < node.leaf_count[i]; ++p) {
+                                if (blocks(prim_indices[prim_offset + p])) return true;
+                            }
+                        }
+                    }
+                    child_offset += is_node;
+                    prim_offset += node.leaf_count[i];
+                }
+                for (int i = 0; i < child_count; ++i) stack[stack_size++] = children[i];
+            }
+            return false;
+        }
+
+        // Closest-hit traversal for SIMD leaf kernels. Primitives of a node's
+        // leaf children are consecutive, so the hit ones are passed as one run
+        // of prim_indices positions: run(first, count, t_max) returns true on
+        // a hit and shrinks t_max. Runs are tested when their node is visited.
+        template<class RunFunction>
+        bool traverse_runs(const Ray& r, double t_min, double& t_max, const RunFunction& run) const {
+            if (nodes.empty()) return false;
+
+            struct Entry { uint32_t index; float t; };
+            Entry stack[8 * BVH::MAX_DEPTH];
+            int stack_size = 0;
+            stack[stack_size++] = Entry{0, static_cast<float>(t_min)};
+
+            BVH8Ray ray(r);
+            bool hit_anything = false;
+            while (stack_size > 0) {
+                Entry entry = stack[--stack_size];
+                if (entry.t > far_limit(t_max)) continue;
+
+                const BVH8Node& node = nodes[entry.index];
+                float t_entry[8];
+                int mask = intersect_children(node, ray, static_cast<float>(t_min), far_limit(t_max), t_entry);
+
+                Entry hits[8];
+                int hit_count = 0;
+                uint32_t run_first = 0, run_end = 0;
+                uint32_t prim_offset = node.prim_base;
+                uint32_t child_offset = node.child_base;
+                for (int i = 0; i < 8; ++i) {
+                    bool is_node = (node.interior_mask >> i) & 1;
+                    if ((mask >> i) & 1) {
+                        if (is_node) {
+                            int k = hit_count++;
+                            while (k > 0 && hits[k - 1].t < t_entry[i]) {
+                                hits[k] = hits[k - 1];
+                                --k;
+                            }
+                            hits[k] = Entry{child_offset, t_entry[i]};
+                        } else {
+                            if (run_end == 0) run_first = prim_offset;
+                            run_end = prim_offset + node.leaf_count[i];
+                        }
+                    }
+                    child_offset += is_node;
+                    prim_offset += node.leaf_count[i];
+                }
+                if (run_end > 0 && run(run_first, run_end - run_first, t_max)) hit_anything = true;
+                for (int i = 0; i < hit_count; ++i) stack[stack_size++] = hits[i];
+            }
+            return hit_anything;
+        }
+
+        // Any-hit form of traverse_runs: blocks(first, count) returns true to stop
+        template<class RunFunction>
+        bool traverse_any_runs(const Ray& r, double t_min, double t_max, const RunFunction& blocks) const {
+            if (nodes.empty()) return false;
+
+            uint32_t stack[8 * BVH::MAX_DEPTH];
+            int stack_size = 0;
+            stack[stack_size++] = 0;
+
+            BVH8Ray ray(r);
+            float near_limit = static_cast<float>(t_min);
+            float far = far_limit(t_max);
+            while (stack_size > 0) {
+                const BVH8Node& node = nodes[stack[--stack_size]];
+                float t_entry[8];
+                int mask = intersect_children(node, ray, near_limit, far, t_entry);
+
+                uint32_t run_first = 0, run_end = 0;
+                uint32_t prim_offset = node.prim_base;
+                uint32_t child_offset = node.child_base;
+                for (int i = 0; i < 8; ++i) {
+                    bool is_node = (node.interior_mask >> i) & 1;
+                    if ((mask >> i) & 1) {
+                        if (is_node) {
+                            stack[stack_size++] = child_offset;
+                        } else {
+                            if (run_end == 0) run_first = prim_offset;
+                            run_end = prim_offset + node.leaf_count[i];
+                        }
+                    }
+                    child_offset += is_node;
+                    prim_offset += node.leaf_count[i];
+                }
+                if (run_end > 0 && blocks(run_first, run_end - run_first)) return true;
+            }
+            return false;
+        }
+
+        // Packet any-hit traversal, same contract as BVH::traverse_any_packet.
+        // Each stack entry carries the rays that hit it, so coherent shadow
+        // rays share node fetches.
+        template<class BlockFunction>
+        uint32_t traverse_any_packet(const Ray* rays, int count, double t_min, const double* t_max,
+                                     uint32_t active, const BlockFunction& blocks) const {
+            return traverse_any_packet_runs(rays, count, t_min, t_max, active, [&](uint32_t first, uint32_t run_count, uint32_t mask) {
+                uint32_t blocked = 0;
+                for (uint32_t p = 0; p < run_count && (mask & ~blocked) != 0; ++p) {
+                    blocked |= blocks(prim_indices[first + p], mask & ~blocked);
+                }
+                return blocked;
+            });
+        }
+
+        // Packet form of traverse_any_runs: adjacent leaves reached by the same
+        // rays are merged, and blocks(first, count, mask) returns the rays in
+        // mask occluded by prim_indices[first, first + count).
+        template<class RunFunction>
+        uint32_t traverse_any_packet_runs(const Ray* rays, int count, double t_min, const double* t_max,
+                                          uint32_t active, const RunFunction& blocks) const {
+            if (nodes.empty() || active == 0) return 0;
+
+            BVH8Ray packet[32];
+            float far[32];
+            for (int i = 0; i < count; ++i) {
+                packet[i] = BVH8Ray(rays[i]);
+                far[i] = far_limit(t_max[i]);
+            }
+
+            struct Entry { uint32_t node; uint32_t mask; };
+            Entry stack[8 * BVH::MAX_DEPTH];
+            int stack_size = 0;
+            stack[stack_size++] = Entry{0, active};
+            uint32_t remaining = active;
+            float near_limit = static_cast<float>(t_min);
+
+            while (stack_size > 0 && remaining != 0) {
+                Entry entry = stack[--stack_size];
+                uint32_t mask = entry.mask & remaining;
+                if (mask == 0) continue;
+
+                const BVH8Node& node = nodes[entry.node];
+                uint32_t child_masks[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+                for (uint32_t m = mask; m != 0; m &= m - 1) {
+                    int ray = __builtin_ctz(m);
+                    float t_entry[8];
+                    int hits = intersect_children(node, packet[ray], near_limit, far[ray], t_entry);
+                    for (; hits != 0; hits &= hits - 1) child_masks[__builtin_ctz(hits)] |= 1u << ray;
+                }
+
+                uint32_t run_first = 0, run_end = 0, run_mask = 0;
+                uint32_t prim_offset = node.prim_base;
+                uint32_t child_offset = node.child_base;
+                for (int i = 0; i < 8; ++i) {
+                    bool is_node = (node.interior_mask >> i) & 1;
+                    uint32_t child_mask = child_masks[i] & remaining;
+                    if (child_mask != 0) {
+                        if (is_node) {
+                            stack[stack_size++] = Entry{child_offset, child_mask};
+                        } else {
+                            if (run_end != prim_offset || run_mask != child_mask) {
+                                if (run_end > 0 && (run_mask & remaining) != 0) {
+                                    remaining &= ~blocks(run_first, run_end - run_first, run_mask & remaining);
+                                }
+                                run_first = prim_offset;
+                                run_mask = child_mask;
+                            }
+                            run_end = prim_offset + node.leaf_count[i];
+                        }
+                    }
+                    child_offset += is_node;
+                    prim_offset += node.leaf_count[i];
+                }
+                if (run_end > 0 && (run_mask & remaining) != 0) remaining &= ~blocks(run_first, run_end - run_first, run_mask & remaining);
+            }
+            return active & ~remaining;
+        }
+
+    private:
+        // Slightly widened single-precision bound so float box tests stay conservative
+        static inline float far_limit(double t_max) {
+            return static_cast<float>(t_max) * 1.00001f;
+        }
+
+        static inline float exponent_scale(int8_t exponent) {
+            uint32_t bits = static_cast<uint32_t>(exponent + 127) << 23;
+            float scale;
+            std::memcpy(&scale, &bits, sizeof(scale));
+            return scale;
+        }
+
+        // Returns a bit mask of the children hit in [t_min, t_max] and their entry distances
+        static inline int intersect_children(const BVH8Node& node, const BVH8Ray& ray, float t_min, float t_max, float t_entry[8]) {
+            int valid = node.interior_mask;
+            for (int i = 0; i < 8; ++i) valid |= (node.leaf_count[i] != 0) << i;
+
+#if defined(__AVX2__) && defined(__FMA__)
+            __m256 t_near = _mm256_set1_ps(t_min);
+            __m256 t_far = _mm256_set1_ps(t_max);
+            for (int a = 0; a < 3; ++a) {
+                float scale = exponent_scale(node.exponent[a]) * ray.inv_dir[a];
+                float offset = (node.origin[a] - ray.origin[a]) * ray.inv_dir[a];
+                const uint8_t* near_q = ray.negative[a] ? node.qhi[a] : node.qlo[a];
+                const uint8_t* far_q = ray.negative[a] ? node.qlo[a] : node.qhi[a];
+                __m256 q_near = _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(near_q))));
+                __m256 q_far = _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(far_q))));
+                __m256 s = _mm256_set1_ps(scale);
+                __m256 o = _mm256_set1_ps(offset);
+                t_near = _mm256_max_ps(t_near, _mm256_fmadd_ps(q_near, s, o));
+                t_far = _mm256_min_ps(t_far, _mm256_fmadd_ps(q_far, s, o));
+            }
+            _mm256_storeu_ps(t_entry, t_near);
+            return valid & _mm256_movemask_ps(_mm256_cmp_ps(t_near, t_far, _CMP_LE_OQ));
+#else
+            float t_far[8];
+            for (int i = 0; i < 8; ++i) {
+                t_entry[i] = t_min;
+                t_far[i] = t_max;
+            }
+            for (int a = 0; a < 3; ++a) {
+                float scale = exponent_scale(node.exponent[a]) * ray.inv_dir[a];
+                float offset = (node.origin[a] - ray.origin[a]) * ray.inv_dir[a];
+                const uint8_t* near_q = ray.negative[a] ? node.qhi[a] : node.qlo[a];
+                const uint8_t* far_q = ray.negative[a] ? node.qlo[a] : node.qhi[a];
+                for (int i = 0; i < 8; ++i) {
+                    t_entry[i] = std::max(t_entry[i], near_q[i] * scale + offset);
+                    t_far[i] = std::min(t_far[i], far_q[i] * scale + offset);
+                }
+            }
+            int mask = 0;
+            for (int i = 0; i < 8; ++i) mask |= (t_entry[i] <= t_far[i]) << i;
+            return valid & mask;
+#endif
+        }
+};
+
+// Collapse a binary BVH into an 8-wide one, greedily opening the child with
+// the largest surface area until eight slots are filled. Binary leaves over
+// BVH8_MAX_LEAF primitives are split across slots, and across extra nodes
+// when eight slots are not enough.
+BVH8 build_bvh8(const BVH& bvh);
+
+#endif
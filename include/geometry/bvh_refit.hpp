@@ -0,0 +1,59 @@
+#ifndef BVH_REFIT_H
+#define BVH_REFIT_H
+
+#include <vector>
+#include <functional>
+#include <cstdint>
+#include "geometry/bvh.hpp"
+
+// Incremental maintenance of an existing BVH whose primitives move.
+// Refitting only touches the leaves holding moved primitives and their
+// ancestors, so per-frame cost follows what moved rather than scene size.
+// Nodes whose surface area inflated too far since they were built are
+// reported so their subtrees can be rebuilt, typically in the background.
+class BVHRefitter {
+
+    public:
+        using BoundsFunction = std::function<AABB(uint32_t prim)>;
+
+        BVHRefitter();
+
+        // Record parents, depths, primitive-to-leaf links and build-time areas
+        void initialize(const BVH& bvh, size_t prim_count);
+        bool is_initialized() const { return !parents.empty(); }
+
+        // Recompute bounds for the given primitives' leaves and every ancestor,
+        // one tree level at a time with each level in parallel
+        void refit(BVH& bvh, const std::vector<uint32_t>& moved_prims, const BoundsFunction& bounds_of, ThreadPool* pool);
+        void refit_all(BVH& bvh, const BoundsFunction& bounds_of, ThreadPool* pool);
+
+        // Topmost nodes touched by the last refit whose area grew past the threshold
+        const std::vector<int>& degraded_subtrees() const { return degraded; }
+        void set_degradation_threshold(double ratio) { degradation_threshold = ratio; }
+
+        size_t last_refit_node_count() const { return last_refit_nodes; }
+
+    private:
+        void refit_nodes(BVH& bvh, std::vector<int>& dirty, const BoundsFunction& bounds_of, ThreadPool* pool);
+
+    private:
+        std::vector<int> parents;        // -1 for the root and unused nodes
+        std::vector<int> depths;
+        std::vector<int> leaf_of_prim;   // -1 for primitives not in the tree
+        std::vector<double> build_area;  // Surface area when the node was (re)built
+        std::vector<uint32_t> visit_stamp;
+        uint32_t stamp;
+
+        std::vector<std::vector<int>> levels; // Scratch: dirty nodes bucketed by depth
+        std::vector<int> degraded;
+        double degradation_threshold;
+        size_t last_refit_nodes;
+};
+
+// Rebuild one subtree in place with the binned SAH builder. The subtree's
+// primitives form a contiguous range of prim_indices, so only that range is
+// reordered; node slots are reused and any extra nodes are appended.
+// Callers must re-initialize their BVHRefitter afterwards.
+void rebuild_subtree(BVH& bvh, int root, const BVHRefitter::BoundsFunction& bounds_of, ThreadPool* pool);
+
+#endif
@@ -0,0 +1,63 @@
+#ifndef DYNAMIC_BLAS_H
+#define DYNAMIC_BLAS_H
+
+#include <memory>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include "geometry/instance.hpp"
+#include "geometry/bvh_refit.hpp"
+
+// Bottom level for a mesh whose vertices move every frame. Two mesh/BVH
+// buffers alternate: the front one is published to renderers while the back
+// one is brought up to date and refitted, so an update only touches the
+// vertices that moved since the back buffer was last current. Degraded
+// subtrees are rebuilt on a background thread and adopted by a later update.
+class DynamicBLAS{
+
+    public:
+        DynamicBLAS(const TriangleMesh& mesh, ThreadPool* pool);
+        ~DynamicBLAS();
+
+        DynamicBLAS(const DynamicBLAS&) = delete;
+        DynamicBLAS& operator=(const DynamicBLAS&) = delete;
+
+        // Move vertices and return the refitted bottom level to publish
+        std::shared_ptr<const BLAS> update_vertices(const std::vector<uint32_t>& vertex_ids,
+                                                    const std::vector<point3>& positions, ThreadPool* pool);
+
+        std::shared_ptr<const BLAS> current() const { return front; }
+
+        void set_degradation_threshold(double ratio) { refitter.set_degradation_threshold(ratio); }
+        bool rebuild_in_flight() const { return rebuild_thread.joinable(); }
+        void wait_for_rebuild();
+        int rebuild_count() const { return rebuilds_adopted; }
+        size_t last_refit_node_count() const { return refitter.last_refit_node_count(); }
+
+    private:
+        void prepare_back_buffer();
+        void collect_triangles(const std::vector<uint32_t>& vertex_ids);
+        void start_rebuild();
+
+    private:
+        std::shared_ptr<BLAS> front;
+        std::shared_ptr<BLAS> back;
+        std::shared_ptr<TriangleMesh> front_mesh;
+        std::shared_ptr<TriangleMesh> back_mesh;
+        bool back_stale;                          // Back buffer has an older topology
+
+        BVHRefitter refitter;
+        std::vector<uint32_t> last_moved;         // Vertices the back buffer has not seen
+        std::vector<uint32_t> vertex_offsets;     // Vertex to triangle adjacency (CSR)
+        std::vector<uint32_t> vertex_triangles;
+        std::vector<uint32_t> dirty_triangles;
+        std::vector<uint32_t> triangle_stamp;
+        uint32_t stamp;
+
+        std::thread rebuild_thread;
+        std::atomic<bool> rebuild_ready;
+        std::unique_ptr<BVH> rebuilt;
+        int rebuilds_adopted;
+};
+
+#endif
@@ -0,0 +1,23 @@
+#ifndef HIT_RECORD_H
+#define HIT_RECORD_H
+
+#include "math/ray.hpp"
+
+// Closest-hit result filled in by scene intersection
+struct HitRecord {
+    point3 p;
+    vec3 normal;      // Always faces against the incoming ray
+    double t;
+    double u, v;      // Barycentric coordinates of the hit on the triangle
+    int prim_id;      // Triangle index within its mesh
+    int instance_id;  // Instance the triangle was hit through
+    int material_id;  // Index into the scene's material table
+    bool front_face;
+
+    inline void set_face_normal(const Ray& r, const vec3& outward_normal) {
+        front_face = dot(r.direction(), outward_normal) < 0;
+        normal = front_face ? outward_normal : -outward_normal;
+    }
+};
+
+#endif
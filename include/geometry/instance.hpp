@@ -0,0 +1,71 @@
+#ifndef INSTANCE_H
+#define INSTANCE_H
+
+#include <memory>
+#include "math/transform.hpp"
+#include "geometry/triangle_mesh.hpp"
+#include "geometry/bvh.hpp"
+#include "geometry/bvh8.hpp"
+#include "geometry/lazy_bvh.hpp"
+#include "geometry/primitive_soa.hpp"
+#include "geometry/meshlet.hpp"
+#include "geometry/hit_record.hpp"
+
+// Bottom-level acceleration structure: one mesh and its BVH in object space.
+// Shared by reference between every instance of the mesh. Static meshes keep
+// only the compressed wide BVH plus its triangles in leaf order for the SIMD
+// kernels; animated ones keep the binary BVH for refits; lazily built ones
+// keep a LazyBVH that fills in as rays arrive. Compressed ones keep
+// meshlets in place of the mesh, and their primitive ids are meshlet ids.
+struct BLAS {
+    std::shared_ptr<const TriangleMesh> mesh;
+    std::shared_ptr<const MeshletMesh> meshlets;  // Set instead of mesh when compressed
+    BVH bvh;
+    BVH8 wide;
+    TriangleSoA triangles;  // Position i is triangle wide.prim_indices[i]
+    std::shared_ptr<const LazyBVH> lazy;
+
+    bool empty() const { return bvh.empty() && wide.empty() && (!lazy || lazy->empty()); }
+    AABB bounds() const {
+        if (!wide.empty()) return wide.bounds;
+        return lazy ? lazy->bounds() : bvh.nodes[0].bounds;
+    }
+
+    size_t triangle_count() const { return meshlets ? meshlets->triangle_count() : mesh->triangle_count(); }
+    vec3 face_normal(uint32_t prim) const { return meshlets ? meshlets->face_normal(prim) : mesh->face_normal(prim); }
+    inline bool intersect_triangle(uint32_t prim, const Ray& r, double t_min, double t_max, double& t, double& u, double& v) const {
+        return meshlets ? meshlets->intersect_triangle(prim, r, t_min, t_max, t, u, v)
+                        : mesh->intersect_triangle(prim, r, t_min, t_max, t, u, v);
+    }
+
+    // Closest hit of an object-space ray; fills t, u, v and prim_id only
+    bool intersect(const Ray& object_ray, double t_min, double t_max, HitRecord& rec) const;
+
+    // Any triangle in (t_min, t_max); stops at the first one found
+    bool occluded(const Ray& object_ray, double t_min, double t_max) const;
+    // Packet form over rays selected by active; returns the occluded ones
+    uint32_t occluded_packet(const Ray* object_rays, int count, double t_min, const double* t_max, uint32_t active) const;
+};
+
+// One placement of a mesh in the world
+struct Instance {
+    int mesh_id;
+    int material_id;
+    Transform object_to_world;
+    Transform world_to_object;
+    AABB world_bounds;
+};
+
+// World-space bounds of a transformed box (all eight corners)
+AABB transform_box(const Transform& xform, const AABB& box);
+
+std::shared_ptr<const BLAS> build_blas(std::shared_ptr<const TriangleMesh> mesh, ThreadPool* pool, bool use_sah);
+// Top levels only; subtrees of about subtree_size triangles build on first hit
+std::shared_ptr<const BLAS> build_blas_lazy(std::shared_ptr<const TriangleMesh> mesh, ThreadPool* pool, size_t subtree_size = 4096);
+// Wide BVH over meshlet-compressed triangles; primitive ids are meshlet ids
+std::shared_ptr<const BLAS> build_blas(std::shared_ptr<const MeshletMesh> meshlets, ThreadPool* pool, bool use_sah);
+// Meshlet-compressed copy of the mesh under a wide SAH BVH; the mesh itself
+// is not kept
+std::shared_ptr<const BLAS> build_blas_compressed(const TriangleMesh& mesh, ThreadPool* pool);
+
+#endif
@@ -0,0 +1,101 @@
+#ifndef LAZY_BVH_H
+#define LAZY_BVH_H
+
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include "geometry/bvh.hpp"
+
+// A run of primitives in a spatial grouping
+struct PrimGroup {
+    uint32_t first;  // Into the order array
+    uint32_t count;
+    AABB bounds;
+};
+
+// Orders primitive ids into spatially compact groups of at most group_size
+// by recursive median splits on the widest centroid axis. Much cheaper than
+// SAH; used for lazy subtrees and for paged clusters.
+std::vector<PrimGroup> split_into_groups(const std::vector<AABB>& prim_bounds, size_t group_size, std::vector<uint32_t>& order);
+
+// BVH whose lower levels are built on first use. Construction only splits
+// the primitives into spatially coherent groups of about subtree_size and
+// builds a small top-level BVH over them; a group's own SAH subtree is built
+// the first time a ray reaches it. Concurrent rays arriving at an unbuilt
+// group wait on a std::call_once, so each subtree is built exactly once, and
+// built subtrees are found with a single acquire load afterwards.
+class LazyBVH {
+
+    public:
+        LazyBVH() : subtree_count(0) {}
+
+        LazyBVH(const LazyBVH&) = delete;
+        LazyBVH& operator=(const LazyBVH&) = delete;
+
+        void build(std::vector<AABB> prim_bounds, ThreadPool* pool, size_t subtree_size = 4096);
+
+        bool empty() const { return top.empty(); }
+        AABB bounds() const { return top.empty() ? AABB() : top.nodes[0].bounds; }
+        size_t subtree_total() const { return subtree_count; }
+        size_t subtrees_built() const { return built_count.load(std::memory_order_relaxed); }
+
+        // Builds whatever is still lazy, e.g. before a full-frame render
+        void build_all(ThreadPool* pool) const;
+
+        // Same contracts as BVH::traverse and BVH::traverse_any
+        template<class LeafFunction>
+        bool traverse(const Ray& r, double t_min, double& t_max, const LeafFunction& leaf) const {
+            return top.traverse(r, t_min, t_max, [&](uint32_t group, double& closest) {
+                const Subtree& subtree = subtrees[group];
+                return ensure(group).traverse(r, t_min, closest, [&](uint32_t local, double& limit) {
+                    return leaf(prims[subtree.first + local], limit);
+                });
+            });
+        }
+
+        template<class BlockFunction>
+        bool traverse_any(const Ray& r, double t_min, double t_max, const BlockFunction& blocks) const {
+            return top.traverse_any(r, t_min, t_max, [&](uint32_t group) {
+                const Subtree& subtree = subtrees[group];
+                return ensure(group).traverse_any(r, t_min, t_max, [&](uint32_t local) {
+                    return blocks(prims[subtree.first + local]);
+                });
+            });
+        }
+
+        // Same contract as BVH::traverse_any_packet; a group is built once
+        // for the whole packet
+        template<class BlockFunction>
+        uint32_t traverse_any_packet(const Ray* rays, int count, double t_min, const double* t_max,
+                                     uint32_t active, const BlockFunction& blocks) const {
+            return top.traverse_any_packet(rays, count, t_min, t_max, active, [&](uint32_t group, uint32_t mask) {
+                const Subtree& subtree = subtrees[group];
+                return ensure(group).traverse_any_packet(rays, count, t_min, t_max, mask, [&](uint32_t local, uint32_t rays_left) {
+                    return blocks(prims[subtree.first + local], rays_left);
+                });
+            });
+        }
+
+    private:
+        struct Subtree {
+            uint32_t first;  // Range of prims
+            uint32_t count;
+            std::once_flag once;
+            std::atomic<const BVH*> bvh;
+            std::unique_ptr<BVH> storage;
+        };
+
+        // The built subtree of a group, building it on first call
+        const BVH& ensure(uint32_t group) const;
+
+    private:
+        BVH top;                            // Leaves are group indices
+        std::vector<uint32_t> prims;        // Primitive ids, grouped
+        std::vector<AABB> bounds_by_prim;
+        std::unique_ptr<Subtree[]> subtrees;
+        size_t subtree_count;
+        mutable std::atomic<size_t> built_count{0};
+};
+
+#endif
@@ -0,0 +1,31 @@
+#ifndef MESH_LOADER_H
+#define MESH_LOADER_H
+
+#include <cstddef>
+#include "core/thread_pool.hpp"
+#include "geometry/triangle_mesh.hpp"
+
+// Mesh import from Wavefront OBJ and PLY (ASCII and binary). Files are
+// memory-mapped and split into chunks that are parsed in parallel: a
+// counting pass sizes the mesh once, then every chunk writes its vertices
+// and triangles straight into the packed buffers at its prefix-sum offset.
+// Polygons are fan-triangulated. Texture coordinates (OBJ vt, PLY u/v or
+// s/t) become per-vertex uvs with v flipped, so v = 0 is a texture's top
+// row; an OBJ vertex whose faces use different vt keeps the last. Normals
+// and other attributes are skipped. Errors are printed and the load returns
+// false.
+
+// Chooses the format from the extension (.obj or .ply)
+bool load_mesh(const char* path, TriangleMesh& mesh, ThreadPool* pool);
+bool load_obj(const char* path, TriangleMesh& mesh, ThreadPool* pool);
+bool load_ply(const char* path, TriangleMesh& mesh, ThreadPool* pool);
+
+// In-memory forms; chunk_bytes is the target size of one parallel chunk
+bool parse_obj(const char* data, size_t size, TriangleMesh& mesh, ThreadPool* pool, size_t chunk_bytes = 1 << 20);
+bool parse_ply(const char* data, size_t size, TriangleMesh& mesh, ThreadPool* pool, size_t chunk_bytes = 1 << 20);
+
+// Decimal float parser without locale lookups or allocation, within one ulp
+// of strtof. Returns the end of the number, or nullptr if there is none.
+const char* parse_float(const char* p, const char* end, float& value);
+
+#endif
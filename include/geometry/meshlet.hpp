@@ -0,0 +1,84 @@
+#ifndef MESHLET_H
+#define MESHLET_H
+
+#include <vector>
+#include <cstdint>
+#include "geometry/triangle_mesh.hpp"
+#include "core/thread_pool.hpp"
+
+// One spatially compact group of triangles with its own small vertex table
+struct Meshlet {
+    int32_t base[3];         // Grid coordinates every local vertex is offset from
+    uint32_t vertex_offset;  // First vertex in MeshletMesh::quantized
+    uint32_t index_offset;   // First triangle in MeshletMesh::local_indices
+    uint8_t vertex_count;
+    uint8_t triangle_count;
+};
+
+// Compressed read-only triangle storage. Triangles are grouped into small
+// meshlets, so each triangle is three 8-bit indices into its meshlet's
+// vertices (3 bytes instead of 12). Vertices are snapped to
+// one mesh-wide grid and stored as 16-bit offsets from the meshlet's base
+// (6 bytes instead of 12, or 32 as a vec3). A vertex shared by two meshlets
+// snaps to the same grid point in both, so meshlet borders stay watertight.
+//
+// Triangle ids are meshlet << 8 | local triangle. Decoding happens at
+// intersection time; the grid step is a power of two, so decoded positions
+// are exact and identical wherever they are computed.
+class MeshletMesh {
+
+    public:
+        static constexpr size_t MESHLET_TRIANGLES = 128;
+        static constexpr size_t MESHLET_VERTICES = 255;  // Local indices and counts fit a byte
+
+        float origin[3];
+        float step;          // Grid spacing on every axis
+        std::vector<Meshlet> meshlets;
+        std::vector<uint16_t> quantized;     // xyz per meshlet vertex
+        std::vector<uint8_t> local_indices;  // 3 per triangle
+
+        MeshletMesh() : origin{0.0f, 0.0f, 0.0f}, step(1.0f) {}
+
+        // order receives the input id of each triangle in meshlet order
+        void build(const TriangleMesh& mesh, ThreadPool* pool, std::vector<uint32_t>* order = nullptr);
+
+        bool empty() const { return meshlets.empty(); }
+        size_t triangle_count() const { return local_indices.size() / 3; }
+        size_t meshlet_count() const { return meshlets.size(); }
+        size_t memory_bytes() const;
+        // Every meshlet's vertices and triangles lie inside the tables; for
+        // meshlets read from disk rather than built
+        bool valid() const;
+
+        static uint32_t encode(uint32_t meshlet, uint32_t local) { return meshlet << 8 | local; }
+        // Every encoded id in meshlet order, matching build's order output
+        std::vector<uint32_t> triangle_ids() const;
+
+        inline point3 vertex(const Meshlet& meshlet, uint32_t local) const {
+            const uint16_t* q = &quantized[3 * (static_cast<size_t>(meshlet.vertex_offset) + local)];
+            return point3(origin[0] + static_cast<float>(meshlet.base[0] + q[0]) * step,
+                          origin[1] + static_cast<float>(meshlet.base[1] + q[1]) * step,
+                          origin[2] + static_cast<float>(meshlet.base[2] + q[2]) * step);
+        }
+
+        inline void triangle(uint32_t id, point3& p0, point3& p1, point3& p2) const {
+            const Meshlet& meshlet = meshlets[id >> 8];
+            const uint8_t* local = &local_indices[3 * (static_cast<size_t>(meshlet.index_offset) + (id & 0xFF))];
+            p0 = vertex(meshlet, local[0]);
+            p1 = vertex(meshlet, local[1]);
+            p2 = vertex(meshlet, local[2]);
+        }
+
+        AABB triangle_bounds(uint32_t id) const;
+        vec3 face_normal(uint32_t id) const;
+
+        // Same contract as TriangleMesh::intersect_triangle
+        inline bool intersect_triangle(uint32_t id, const Ray& r, double t_min, double t_max,
+                                       double& t, double& u, double& v) const {
+            point3 p0, p1, p2;
+            triangle(id, p0, p1, p2);
+            return intersect_triangle_points(p0, p1, p2, r, t_min, t_max, t, u, v);
+        }
+};
+
+#endif
@@ -0,0 +1,117 @@
+#ifndef PAGED_MESH_H
+#define PAGED_MESH_H
+
+#include <vector>
+#include <memory>
+#include <atomic>
+#include "core/mapped_file.hpp"
+#include "geometry/instance.hpp"
+
+// Geometry larger than memory. write_paged_mesh splits a mesh into spatial
+// clusters and stores each as an independent BLAS image (local positions
+// and indices, BVH8, primitive order) in one file. PagedMesh maps the file
+// and keeps only a small top-level BVH over cluster bounds in memory;
+// clusters are copied in when rays need them and evicted least recently
+// used to stay within a byte budget.
+//
+// Tracing is batched. Each pass walks a ray's clusters front to back and,
+// at the first one that is not resident, parks the ray with a resume point
+// and requests the cluster. Requested clusters are paged in between passes,
+// so rays never wait on I/O and every pass makes progress.
+const uint32_t PAGED_MESH_VERSION = 1;
+
+struct PagedMeshHeader {
+    char magic[8];          // "RTPAGED1"
+    uint32_t version;
+    uint32_t byte_order;    // 0x01020304 as written by the producer
+    uint64_t cluster_count;
+    uint64_t table_offset;  // Array of PagedClusterEntry
+};
+
+struct PagedClusterEntry {
+    double bounds[6];        // Min then max
+    uint64_t offset;         // Cluster image, 64-byte aligned
+    uint64_t bytes[4];       // Positions, indices, BVH8 nodes, primitive order
+    uint32_t triangle_base;  // Paged id of the cluster's first triangle
+    uint32_t triangle_count;
+};
+
+// Writes clusters of at most cluster_triangles triangles, a batch at a time,
+// so only a few clusters are ever in memory. Triangles are renumbered
+// cluster by cluster; order[i] receives the input id of paged triangle i.
+bool write_paged_mesh(const char* path, const TriangleMesh& mesh, size_t cluster_triangles, ThreadPool* pool,
+                      std::vector<uint32_t>* order = nullptr);
+
+// Converts a mesh file (.obj or .ply) into a .paged file; the raytracer
+// --page command. Parsing still needs the whole mesh in memory once.
+const size_t DEFAULT_CLUSTER_TRIANGLES = 65536;
+bool page_mesh_file(const char* source_path, const char* paged_path, size_t cluster_triangles, ThreadPool* pool);
+
+// One ray of a batch and its progress
+struct PagedRay {
+    Ray ray;
+    double t_min;
+    double t_max;          // Shrinks to the closest hit
+    int triangle;          // Paged id of the closest hit, -1 for none
+    double u, v;
+    vec3 normal;           // Object-space face normal of the closest hit
+    double resume_t;       // Clusters ordered before (resume_t, resume_cluster) are done
+    uint32_t resume_cluster;
+    bool done;
+
+    PagedRay() {}
+    PagedRay(const Ray& r, double t_min_, double t_max_)
+        : ray(r), t_min(t_min_), t_max(t_max_), triangle(-1), u(0.0), v(0.0),
+          resume_t(-1e300), resume_cluster(0), done(false) {}
+};
+
+class PagedMesh {
+
+    public:
+        PagedMesh();
+
+        PagedMesh(const PagedMesh&) = delete;
+        PagedMesh& operator=(const PagedMesh&) = delete;
+
+        // Nothing is resident after opening
+        bool open(const char* path, size_t budget_bytes);
+        void set_budget(size_t bytes) { budget = bytes; }
+
+        // Traces every ray of the batch to completion
+        void trace(std::vector<PagedRay>& rays, ThreadPool* pool);
+
+        size_t cluster_count() const { return clusters.size(); }
+        size_t cluster_bytes(size_t cluster) const { return sizes[cluster]; }
+        AABB bounds() const { return top.empty() ? AABB() : top.nodes[0].bounds; }
+
+        size_t resident_bytes() const { return resident_total; }
+        size_t resident_clusters() const;
+        size_t page_ins() const { return page_in_count; }
+        size_t evictions() const { return eviction_count; }
+        size_t passes() const { return pass_count; }
+
+    private:
+        bool trace_pass(PagedRay& ray) const; // True once the ray is finished
+        bool page_in(ThreadPool* pool);       // False if nothing could be loaded
+        std::shared_ptr<const BLAS> load_cluster(uint32_t cluster) const;
+
+    private:
+        MappedFile file;
+        std::vector<PagedClusterEntry> clusters;
+        std::vector<size_t> sizes;  // Resident bytes per cluster
+        BVH top;                    // Leaves are cluster ids
+        size_t budget;
+
+        // Changed only between passes, read freely during them
+        std::vector<std::shared_ptr<const BLAS>> resident;
+        std::unique_ptr<std::atomic<uint8_t>[]> requested;
+        std::unique_ptr<std::atomic<uint64_t>[]> last_used; // Pass of the last visit, for LRU
+
+        uint64_t pass_stamp;
+        size_t resident_total;
+        size_t page_in_count;
+        size_t eviction_count;
+        size_t pass_count;
+};
+
+#endif
@@ -0,0 +1,64 @@
+#ifndef PRIMITIVE_SOA_H
+#define PRIMITIVE_SOA_H
+
+#include <vector>
+#include <cstdint>
+#include "geometry/triangle_mesh.hpp"
+
+// Single-precision ray for the SIMD leaf kernels
+struct RayF {
+    float origin[3];
+    float direction[3];
+
+    RayF() = default;  // Uninitialized, for packet arrays
+
+    explicit RayF(const Ray& r) {
+        for (int a = 0; a < 3; ++a) {
+            origin[a] = static_cast<float>(r.origin()[a]);
+            direction[a] = static_cast<float>(r.direction()[a]);
+        }
+    }
+};
+
+// Triangles as structure of arrays in BVH leaf order: vertex 0 and the two
+// edges, one float array per component. A leaf is a contiguous run, so its
+// triangles load straight into SIMD registers. Arrays are padded so full
+// width loads from any position stay in bounds.
+struct TriangleSoA {
+    std::vector<float> v0x, v0y, v0z;
+    std::vector<float> e1x, e1y, e1z;
+    std::vector<float> e2x, e2y, e2z;
+    size_t count = 0;
+
+    // Position i holds mesh triangle order[i]
+    void build(const TriangleMesh& mesh, const std::vector<uint32_t>& order);
+    bool empty() const { return count == 0; }
+    // Length of each array for count triangles, padding included
+    static size_t padded_size(size_t count);
+    size_t memory_bytes() const { return v0x.size() * 9 * sizeof(float); }
+};
+
+// Spheres as structure of arrays
+struct SphereSoA {
+    std::vector<float> cx, cy, cz, radius;
+    size_t count = 0;
+
+    void add(const point3& center, double r);
+};
+
+// Lanes processed per SIMD step: 8 with AVX2, 4 with SSE2, otherwise 1
+int soa_kernel_width();
+
+// Bit mask of the positions in [first, first + count) whose single-precision
+// Möller–Trumbore test hits in (t_min, t_max). Bounds are widened by a small
+// tolerance (and degenerate determinants pass), so the mask is a superset of
+// the double-precision hits; callers confirm candidates with
+// TriangleMesh::intersect_triangle. count must not exceed 32.
+uint32_t triangle_candidates_soa(const TriangleSoA& tris, uint32_t first, uint32_t count, const RayF& ray,
+                                 double t_min, double t_max);
+
+// Closest sphere hit among [first, first + count); returns the index or -1
+int intersect_spheres_soa(const SphereSoA& spheres, uint32_t first, uint32_t count, const RayF& ray,
+                          float t_min, float& t_max);
+
+#endif
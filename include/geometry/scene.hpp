@@ -0,0 +1,121 @@
+#ifndef SCENE_H
+#define SCENE_H
+
+#include <memory>
+#include <vector>
+#include <mutex>
+#include "geometry/instance.hpp"
+#include "geometry/dynamic_blas.hpp"
+#include "core/thread_pool.hpp"
+#include "rendering/environment.hpp"
+#include "rendering/material.hpp"
+#include "rendering/texture_cache.hpp"
+
+const double RAY_EPSILON = 0.001; // Self-intersection offset for secondary rays
+
+// Immutable two-level acceleration structure handed to renderers. Bottom
+// levels are shared between snapshots; only the instance list and the small
+// top-level BVH are rebuilt when instances move. The environment light and
+// texture cache travel with the snapshot, so a frame never sees them change
+// halfway.
+struct SceneAccel {
+    std::vector<std::shared_ptr<const BLAS>> blas; // Indexed by mesh id
+    std::vector<Instance> instances;
+    BVH tlas;                                      // Over instance world bounds
+    std::shared_ptr<const EnvironmentMap> environment; // Null for the default sun and sky
+    std::vector<Material> materials;               // Indexed by HitRecord::material_id
+    std::shared_ptr<TextureCache> textures;        // Null unless materials are textured
+
+    bool intersect(const Ray& r, double t_min, double t_max, HitRecord& rec) const;
+
+    // Visibility queries for shadow rays: true if anything lies in
+    // (RAY_EPSILON, t_max). Traversal ends at the first hit found.
+    bool occluded(const Ray& r, double t_max) const;
+    // Up to MAX_PACKET rays traced together; occluded[i] receives the answer for rays[i]
+    void occluded_packet(const Ray* rays, const double* t_max, int count, bool* occluded) const;
+
+    static constexpr int MAX_PACKET = 32;
+};
+
+// Scene geometry as unique meshes placed by instances. The current
+// SceneAccel is held through a shared_ptr that is swapped atomically, so
+// rendering can start on quick LBVHs while SAH builds finish in the
+// background, and instance edits never disturb a frame in flight.
+class Scene{
+
+    public:
+        // Starts with DEFAULT_PALETTE diffuse materials
+        Scene();
+
+        int add_mesh(TriangleMesh mesh);
+        int add_mesh(std::shared_ptr<const TriangleMesh> mesh);
+        // Meshlet-compressed mesh; builds put a wide BVH over its meshlets
+        int add_compressed_mesh(std::shared_ptr<const MeshletMesh> meshlets);
+        // Mesh with a bottom level built elsewhere (e.g. read from a scene
+        // cache); builds leave it as it is
+        int add_built_mesh(std::shared_ptr<const BLAS> built);
+        int add_material(const Material& material);
+        // A negative material cycles through the default palette by instance id
+        int add_instance(int mesh_id, const Transform& object_to_world, int material_id = -1);
+
+        // Moves one instance; only the top level is rebuilt
+        void set_instance_transform(int instance_id, const Transform& object_to_world, ThreadPool* pool);
+
+        // Moves mesh vertices; the mesh's BLAS is refitted rather than rebuilt
+        // and full builds leave it alone from then on
+        void update_mesh_vertices(int mesh_id, const std::vector<uint32_t>& vertex_ids,
+                                  const std::vector<point3>& positions, ThreadPool* pool);
+
+        size_t mesh_count() const;
+        size_t instance_count() const;
+        size_t material_count() const;
+        size_t unique_triangle_count() const;    // Stored geometry
+        size_t instanced_triangle_count() const; // Geometry as seen by rays
+        // Not available for meshes added compressed or built
+        const TriangleMesh& get_mesh(int mesh_id) const { return *meshes[mesh_id]; }
+
+        // Build every BLAS with the given builder plus the TLAS, then install
+        void build_lbvh(ThreadPool* pool);
+        void build_sah(ThreadPool* pool);
+        // Top levels only; BLAS subtrees are built by the first rays to reach them
+        void build_lazy(ThreadPool* pool);
+        // Quickest build to render a first frame from: LBVH, or lazy once
+        // there are more than lazy_threshold unique triangles. Returns true
+        // when it went lazy.
+        bool build_quick(ThreadPool* pool, size_t lazy_threshold);
+
+        // Background and light for later snapshots; null restores the default sky
+        void set_environment(std::shared_ptr<const EnvironmentMap> map, ThreadPool* pool);
+        // Textures that Material::texture ids refer to; open them before rendering
+        void set_textures(std::shared_ptr<TextureCache> cache, ThreadPool* pool);
+
+        // Snapshot of the current acceleration structure; hold it for a frame
+        std::shared_ptr<const SceneAccel> acquire() const;
+
+        static constexpr int DEFAULT_PALETTE = 4;
+
+    private:
+        enum BuildMode { BUILD_LBVH, BUILD_SAH, BUILD_LAZY };
+        void build(ThreadPool* pool, BuildMode mode);
+        void install_locked(ThreadPool* pool); // Rebuild the TLAS from current state and publish
+        size_t mesh_triangles_locked(size_t mesh_id) const;
+
+    private:
+        mutable std::mutex edit_mutex;
+        std::vector<std::shared_ptr<const TriangleMesh>> meshes;
+        std::vector<std::shared_ptr<const MeshletMesh>> compressed; // Per mesh, set instead of meshes[i]
+        std::vector<std::shared_ptr<const BLAS>> blas; // Latest bottom level per mesh
+        std::vector<Instance> instances;
+        std::vector<Material> materials;
+        std::vector<std::unique_ptr<DynamicBLAS>> dynamic; // Per mesh, created on first vertex update
+        std::vector<uint8_t> prebuilt;                     // Per mesh, set by add_built_mesh
+        std::shared_ptr<const EnvironmentMap> environment;
+        std::shared_ptr<TextureCache> textures;
+
+        std::shared_ptr<const SceneAccel> accel; // Accessed only through std::atomic_load/store
+};
+
+// Built-in demo scene: ground plane with three instances of one sphere mesh
+void add_default_scene(Scene& scene);
+
+#endif
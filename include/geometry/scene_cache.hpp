@@ -0,0 +1,87 @@
+#ifndef SCENE_CACHE_H
+#define SCENE_CACHE_H
+
+#include <memory>
+#include <string>
+#include <cstdint>
+#include "core/thread_pool.hpp"
+#include "geometry/instance.hpp"
+#include "geometry/scene.hpp"
+
+// Binary cache of a built mesh so later launches skip parsing and BVH
+// construction. The file is a fixed header followed by raw sections
+// (positions, indices and texture coordinates, or meshlets for compressed
+// meshes, then BVH8 nodes, primitive order and the TriangleSoA arrays of
+// uncompressed meshes), each 64-byte aligned and addressed by offset,
+// so it contains no pointers and maps directly. Reading checks the magic,
+// version, byte order and the content hash of the source file; any
+// mismatch makes the cache stale.
+const uint32_t SCENE_CACHE_VERSION = 4;
+
+enum SceneCacheSection {
+    CACHE_POSITIONS,
+    CACHE_INDICES,
+    CACHE_MESHLETS,
+    CACHE_QUANTIZED,
+    CACHE_LOCAL_INDICES,
+    CACHE_BVH8_NODES,
+    CACHE_PRIM_INDICES,
+    CACHE_TRIANGLES,    // The nine TriangleSoA arrays back to back, padding included
+    CACHE_UVS,          // Empty for meshes without texture coordinates
+    CACHE_SECTION_COUNT
+};
+
+struct SceneCacheHeader {
+    char magic[8];          // "RTSCACHE"
+    uint32_t version;
+    uint32_t byte_order;    // 0x01020304 as written by the producer
+    uint64_t content_hash;  // Of the source asset
+    double bounds[6];       // BVH8 root bounds, min then max
+    float meshlet_origin[3]; // Quantization grid of compressed meshes
+    float meshlet_step;
+    uint64_t offset[CACHE_SECTION_COUNT];
+    uint64_t bytes[CACHE_SECTION_COUNT];
+};
+
+// A mesh file opened through its cache. Exactly one of built, mesh and
+// meshlets is set: the cached bottom level on a hit, otherwise the parsed
+// geometry, not yet built.
+struct CachedMesh {
+    std::shared_ptr<const BLAS> built;
+    std::shared_ptr<const TriangleMesh> mesh;
+    std::shared_ptr<const MeshletMesh> meshlets; // Instead of mesh above the compression threshold
+    bool cache_hit = false;
+    uint64_t source_hash = 0;
+    std::string cache_path;
+    AABB bounds;
+    size_t triangle_count = 0;
+};
+
+// 64-bit FNV-1a over 1 MB blocks hashed in parallel, then over the block
+// hashes and the size. Stable across thread counts.
+uint64_t content_hash(const void* data, size_t size, ThreadPool* pool);
+
+// Writes through a temporary file and a rename, so readers never see a partial cache
+bool write_scene_cache(const char* path, const BLAS& blas, uint64_t source_hash);
+
+// Returns nullptr when the file is missing, malformed or built from other content
+std::shared_ptr<const BLAS> read_scene_cache(const char* path, uint64_t source_hash);
+
+// Opens a mesh file through the cache next to it (path + ".rtcache"). A miss
+// only parses the file, compressing meshes of more than compress_threshold
+// triangles straight to meshlets, so no BVH is built here; the caller
+// renders from a quick build and writes the cache from its SAH build.
+bool open_mesh_cached(const char* path, size_t compress_threshold, ThreadPool* pool, CachedMesh& out);
+
+// Adds the opened mesh to the scene: a cached bottom level as it is, parsed
+// geometry for the scene's own builds (lazy, LBVH, then SAH). Returns the mesh id.
+int add_cached_mesh(Scene& scene, const CachedMesh& mesh);
+
+// Writes built, the mesh's SAH bottom level, to the cache after a miss
+bool store_mesh_cache(const CachedMesh& mesh, const BLAS& built);
+
+// Loads a mesh file through its cache, building the SAH bottom level and
+// writing the cache right away when it is missing or stale
+std::shared_ptr<const BLAS> load_mesh_cached(const char* path, ThreadPool* pool, bool* cache_hit = nullptr);
+
+#endif
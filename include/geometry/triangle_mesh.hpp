@@ -0,0 +1,51 @@
+#ifndef TRIANGLE_MESH_H
+#define TRIANGLE_MESH_H
+
+#include <vector>
+#include <cstdint>
+#include "math/vec3.hpp"
+#include "geometry/aabb.hpp"
+
+// Möller–Trumbore test against one triangle; hits in (t_min, t_max) only
+bool intersect_triangle_points(const point3& p0, const point3& p1, const point3& p2, const Ray& r,
+                               double t_min, double t_max, double& t, double& u, double& v);
+
+// Indexed triangle mesh with compact storage: packed float xyz positions and
+// three 32-bit indices per triangle, instead of one 32-byte vec3 per vertex.
+class TriangleMesh{
+
+    public:
+        std::vector<float> positions;   // x0 y0 z0 x1 y1 z1 ...
+        std::vector<uint32_t> indices;  // 3 per triangle
+        std::vector<float> uvs;         // u0 v0 u1 v1 ..., or empty for meshes without texture coordinates
+
+        size_t vertex_count() const { return positions.size() / 3; }
+        size_t triangle_count() const { return indices.size() / 3; }
+        bool empty() const { return indices.empty(); }
+
+        uint32_t add_vertex(const point3& p);
+        void add_triangle(uint32_t a, uint32_t b, uint32_t c);
+        void append(const TriangleMesh& other);
+        // Gives every vertex a (0, 0) coordinate until it is set
+        void set_uv(uint32_t vertex, double u, double v);
+        bool has_uvs() const { return !uvs.empty() && uvs.size() == 2 * vertex_count(); }
+
+        inline point3 vertex(uint32_t index) const {
+            const float* p = &positions[3 * static_cast<size_t>(index)];
+            return point3(p[0], p[1], p[2]);
+        }
+
+        AABB triangle_bounds(size_t triangle) const;
+        AABB bounds() const;
+        vec3 face_normal(size_t triangle) const; // Unit geometric normal, counter-clockwise winding
+
+        // Möller–Trumbore test against one triangle; hits in (t_min, t_max) only
+        bool intersect_triangle(size_t triangle, const Ray& r, double t_min, double t_max,
+                                double& t, double& u, double& v) const;
+
+        // Procedural shapes for built-in scenes
+        void add_quad(const point3& corner, const vec3& edge_u, const vec3& edge_v);
+        void add_sphere(const point3& center, double radius, int segments, int rings);
+};
+
+#endif
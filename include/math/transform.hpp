@@ -0,0 +1,109 @@
+#ifndef TRANSFORM_H
+#define TRANSFORM_H
+
+#include <cmath>
+#include "vec3.hpp"
+#include "ray.hpp"
+
+// Affine transform stored as a 3x4 row-major matrix: a linear 3x3 part plus
+// a translation column. Rays keep their parameterization when transformed
+// (directions are not renormalized), so hit distances carry over unchanged.
+class Transform{
+    public:
+    double m[3][4];
+
+    Transform():m{{1,0,0,0},{0,1,0,0},{0,0,1,0}}{}
+
+    static Transform translate(const vec3& offset){
+        Transform t;
+        t.m[0][3] = offset.x();
+        t.m[1][3] = offset.y();
+        t.m[2][3] = offset.z();
+        return t;
+    }
+
+    static Transform scale(const vec3& factors){
+        Transform t;
+        t.m[0][0] = factors.x();
+        t.m[1][1] = factors.y();
+        t.m[2][2] = factors.z();
+        return t;
+    }
+
+    static Transform scale(double factor){
+        return scale(vec3(factor, factor, factor));
+    }
+
+    static Transform rotate_y(double radians){
+        Transform t;
+        double c = std::cos(radians), s = std::sin(radians);
+        t.m[0][0] = c;  t.m[0][2] = s;
+        t.m[2][0] = -s; t.m[2][2] = c;
+        return t;
+    }
+
+    // Composition: (a * b) applies b first, then a
+    inline Transform operator*(const Transform& b) const {
+        Transform r;
+        for (int i = 0; i < 3; ++i) {
+            for (int j = 0; j < 4; ++j) {
+                r.m[i][j] = m[i][0] * b.m[0][j] + m[i][1] * b.m[1][j] + m[i][2] * b.m[2][j];
+            }
+            r.m[i][3] += m[i][3];
+        }
+        return r;
+    }
+
+    inline point3 apply_point(const point3& p) const {
+        return point3(m[0][0] * p.e[0] + m[0][1] * p.e[1] + m[0][2] * p.e[2] + m[0][3],
+                      m[1][0] * p.e[0] + m[1][1] * p.e[1] + m[1][2] * p.e[2] + m[1][3],
+                      m[2][0] * p.e[0] + m[2][1] * p.e[1] + m[2][2] * p.e[2] + m[2][3]);
+    }
+
+    inline vec3 apply_vector(const vec3& v) const {
+        return vec3(m[0][0] * v.e[0] + m[0][1] * v.e[1] + m[0][2] * v.e[2],
+                    m[1][0] * v.e[0] + m[1][1] * v.e[1] + m[1][2] * v.e[2],
+                    m[2][0] * v.e[0] + m[2][1] * v.e[1] + m[2][2] * v.e[2]);
+    }
+
+    // Multiply by the transposed linear part. Called on the inverse transform,
+    // this maps object-space normals to world space.
+    inline vec3 apply_transpose(const vec3& v) const {
+        return vec3(m[0][0] * v.e[0] + m[1][0] * v.e[1] + m[2][0] * v.e[2],
+                    m[0][1] * v.e[0] + m[1][1] * v.e[1] + m[2][1] * v.e[2],
+                    m[0][2] * v.e[0] + m[1][2] * v.e[1] + m[2][2] * v.e[2]);
+    }
+
+    inline Ray apply(const Ray& r) const {
+        return Ray(apply_point(r.origin()), apply_vector(r.direction()));
+    }
+
+    Transform inverse() const {
+        // Inverse of the linear part via cofactors
+        double a = m[0][0], b = m[0][1], c = m[0][2];
+        double d = m[1][0], e = m[1][1], f = m[1][2];
+        double g = m[2][0], h = m[2][1], i = m[2][2];
+        double co00 = e * i - f * h, co01 = f * g - d * i, co02 = d * h - e * g;
+        double det = a * co00 + b * co01 + c * co02;
+        double inv_det = 1.0 / det;
+
+        Transform r;
+        r.m[0][0] = co00 * inv_det;
+        r.m[0][1] = (c * h - b * i) * inv_det;
+        r.m[0][2] = (b * f - c * e) * inv_det;
+        r.m[1][0] = co01 * inv_det;
+        r.m[1][1] = (a * i - c * g) * inv_det;
+        r.m[1][2] = (c * d - a * f) * inv_det;
+        r.m[2][0] = co02 * inv_det;
+        r.m[2][1] = (b * g - a * h) * inv_det;
+        r.m[2][2] = (a * e - b * d) * inv_det;
+
+        // Translation: -L^-1 * t
+        for (int row = 0; row < 3; ++row) {
+            r.m[row][3] = -(r.m[row][0] * m[0][3] + r.m[row][1] * m[1][3] + r.m[row][2] * m[2][3]);
+        }
+        return r;
+    }
+};
+
+#endif
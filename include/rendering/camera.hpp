@@ -9,6 +9,7 @@ class Camera{
 
         Camera();
 
+        // Translate along the view basis; the view direction is unchanged
         void moveforward(double delta);
         void movebackward(double delta);
         void moveright(double delta);
@@ -17,6 +18,12 @@ class Camera{
         void movedown(double delta);
         
         Ray get_ray(int i, int j) const;
+        Ray get_ray(int i, int j, double offset_u, double offset_v) const; // Sub-pixel offsets in pixel units
+        double pixel_spread_angle() const; // Angle one pixel subtends, for ray cones
+        // Continuous pixel coordinates of a world point, pixel centres at
+        // integers as in get_ray; false when the point is behind the camera
+        bool project(const point3& p, double& i, double& j) const;
+        point3 get_position() const { return position; }
 
         void set_aspect_ratio(double new_aspect_ratio);
         void update_dimensions(double new_width, double new_height);
@@ -34,6 +41,9 @@ class Camera{
         vec3 pixel_delta_u=viewport_u/double(image_width);
         vec3 pixel_delta_v=viewport_v/double(image_height);
         
+    private:
+        void translate(const vec3& offset);
+
     private:
         vec3 position;  // Camera position
         vec3 target;    // Point the camera is looking at
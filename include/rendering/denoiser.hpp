@@ -0,0 +1,68 @@
+#ifndef DENOISER_H
+#define DENOISER_H
+
+#include <vector>
+#include "core/thread_pool.hpp"
+#include "rendering/camera.hpp"
+#include "geometry/scene.hpp"
+
+// Per-pixel features of the primary hit, one plane per channel. Background
+// pixels get BACKGROUND_DEPTH, a normal facing back along the ray and unit
+// albedo, so the sky filters only with itself.
+struct GuideBuffers {
+    int width = 0, height = 0;
+    std::vector<float> albedo[3];
+    std::vector<float> normal[3];
+    std::vector<float> depth;
+    std::vector<float> depth_gradient[2]; // Smaller one-sided difference in x and y
+
+    void resize(int new_width, int new_height);
+};
+
+const float BACKGROUND_DEPTH = 1e6f;
+
+// One pixel-centre ray per pixel of the camera's image
+void render_guides(const SceneAccel& scene, const Camera& camera, GuideBuffers& guides, ThreadPool* pool);
+
+// Edge-avoiding a-trous wavelet filter (Dammertz et al. 2010) with the
+// normal and depth tests of SVGF. Colour is divided by albedo before
+// filtering and multiplied back after, so texture detail is kept while
+// lighting noise is smoothed. Each pass applies a 5x5 B3-spline kernel with
+// taps spread 2^pass pixels apart, so five passes cover a 125 pixel
+// footprint at 25 taps per pixel each. Passes run over rows on the thread
+// pool, and each tap's inner loop runs over a row of float planes.
+class Denoiser {
+
+    public:
+        Denoiser();
+
+        void set_passes(int count) { passes = count; }
+        // Demodulated colour distance at which a tap's weight falls to 1/e in
+        // the first pass; halved for every later pass
+        void set_color_sigma(double sigma) { color_sigma = sigma; }
+        void set_normal_power(double power) { normal_power = power; }
+        void set_depth_sigma(double sigma) { depth_sigma = sigma; }
+
+        // Filters width x height pixels of three doubles each, pixel_stride
+        // doubles apart, row-major, in place. guides must match the size.
+        void denoise(double* rgb, size_t pixel_stride, int width, int height, const GuideBuffers& guides, ThreadPool* pool);
+
+    private:
+        void filter_pass(int pass, const GuideBuffers& guides, ThreadPool* pool);
+
+    private:
+        int passes;
+        double color_sigma;
+        double normal_power;
+        double depth_sigma;
+        int width, height;
+
+        // Demodulated colour, ping-ponged between passes
+        std::vector<float> current[3];
+        std::vector<float> next[3];
+        // Per thread: weight and colour sums for one row
+        std::vector<float> row_sums;
+        static const int ROW_SUMS = 4;
+};
+
+#endif
@@ -0,0 +1,78 @@
+#ifndef ENVIRONMENT_H
+#define ENVIRONMENT_H
+
+#include <vector>
+#include <cstdint>
+#include "math/vec3.hpp"
+
+// Walker/Vose alias table: constant-time sampling from a discrete
+// distribution with one uniform number
+struct AliasTable {
+    std::vector<float> threshold;  // Keep the drawn bin below this, else take its alias
+    std::vector<uint32_t> alias;
+    std::vector<float> pmf;        // Normalized input weights
+
+    // Weights need not be normalized; all zero gives a uniform table
+    void build(const std::vector<double>& weights);
+
+    bool empty() const { return alias.empty(); }
+    size_t size() const { return alias.size(); }
+
+    // remapped receives a fresh uniform number left over from u
+    inline uint32_t sample(double u, double& remapped) const {
+        double scaled = u * alias.size();
+        uint32_t bin = static_cast<uint32_t>(scaled);
+        if (bin >= alias.size()) bin = static_cast<uint32_t>(alias.size() - 1);
+        double coin = scaled - bin;
+        if (coin < threshold[bin]) {
+            remapped = coin / threshold[bin];
+            return bin;
+        }
+        remapped = (coin - threshold[bin]) / (1.0 - threshold[bin]);
+        return alias[bin];
+    }
+};
+
+// Decodes a Radiance RGBE (.hdr), flat or run-length encoded, into linear
+// RGB, 3 floats per texel, row by row from the top; prints the reason on
+// failure
+bool read_hdr_image(const char* path, int& width, int& height, std::vector<float>& rgb);
+
+// HDR latitude-longitude environment used as background and light. Row 0 is
+// straight up (+y); columns sweep the azimuth from +x towards +z. Radiance is
+// constant over each texel, and texels are importance sampled in proportion
+// to luminance times solid angle through an alias table over all of them.
+class EnvironmentMap {
+
+    public:
+        EnvironmentMap() : width(0), height(0) {}
+
+        // Through read_hdr_image
+        bool load_hdr(const char* path);
+        // Linear RGB, 3 floats per texel, row by row
+        void set_image(int image_width, int image_height, std::vector<float> rgb);
+
+        bool empty() const { return texels.empty(); }
+        int get_width() const { return width; }
+        int get_height() const { return height; }
+
+        inline color radiance(const vec3& direction) const {
+            const float* p = &texels[3 * texel_index(direction)];
+            return color(p[0], p[1], p[2]);
+        }
+
+        // Direction drawn in proportion to the map; pdf is per unit solid angle
+        vec3 sample(double u1, double u2, color& value, double& pdf) const;
+        double pdf(const vec3& direction) const;
+
+    private:
+        size_t texel_index(const vec3& direction) const;
+        void build_sampling();
+
+    private:
+        int width, height;
+        std::vector<float> texels;
+        AliasTable table;
+};
+
+#endif
@@ -0,0 +1,45 @@
+#ifndef INTEGRATOR_H
+#define INTEGRATOR_H
+
+#include "rendering/camera.hpp"
+#include "rendering/path_tracer.hpp"
+
+// One camera path per call; pixel_spread starts its ray cone
+typedef color (*PathKernel)(const SceneAccel& scene, const Ray& camera_ray, Rng& rng, int max_depth, double pixel_spread);
+// Pixels [start_x, end_x) of one row for one sample, written to out[0 ..)
+typedef void (*RowKernel)(const SceneAccel& scene, const Camera& camera, int row, int start_x, int end_x,
+                          int sample, double offset_u, double offset_v, int max_depth, color* out);
+
+// Cheap single-hit outputs (AOVs) for interactive navigation, in place of
+// the full path. Misses show the background, or white for occlusion.
+enum PreviewMode {
+    PREVIEW_OFF,
+    PREVIEW_NORMALS,  // World normal mapped to [0, 1]
+    PREVIEW_DEPTH,    // 1 / (1 + distance) along the camera ray
+    PREVIEW_ALBEDO,   // Material albedo, textured
+    PREVIEW_AO,       // Unoccluded fraction of AO_SAMPLES cosine rays within AO_RADIUS
+    PREVIEW_MODE_COUNT
+};
+
+const int AO_SAMPLES = 4;
+const double AO_RADIUS = 0.5;
+
+// Pre-instantiated specializations of the megakernel for one feature set,
+// or of one preview mode. The row kernel calls its specialization
+// directly, so a tile pays for the table lookup once rather than per pixel.
+struct IntegratorKernels {
+    unsigned features;
+    PreviewMode preview;
+    PathKernel trace;
+    RowKernel render_row;
+};
+
+// Table lookup, done once per frame; unknown bits are ignored. A preview
+// mode other than PREVIEW_OFF replaces the path entirely.
+const IntegratorKernels& select_integrator(unsigned features, PreviewMode preview = PREVIEW_OFF);
+
+// Short form of a feature mask for logging, e.g. "roulette+clamp"
+const char* integrator_name(unsigned features);
+const char* preview_name(PreviewMode preview);
+
+#endif
@@ -0,0 +1,74 @@
+#ifndef MATERIAL_H
+#define MATERIAL_H
+
+#include <cstddef>
+#include <cstdint>
+#include "math/vec3.hpp"
+
+enum MaterialType : uint8_t {
+    MATERIAL_DIFFUSE,  // Lambertian, lit by light samples plus a cosine bounce
+    MATERIAL_METAL,    // Mirror reflection perturbed by fuzz; no light samples
+    MATERIAL_TYPE_COUNT
+};
+
+// Plain data; hits carry an index into the scene's material table
+struct Material {
+    MaterialType type;
+    color albedo;
+    double fuzz;  // Metal only: radius of the perturbation sphere
+    int texture;  // Scene TextureCache id scaling albedo at the hit's uv, -1 for none
+
+    static Material diffuse(const color& albedo) { return Material{MATERIAL_DIFFUSE, albedo, 0.0, -1}; }
+    static Material metal(const color& albedo, double fuzz) { return Material{MATERIAL_METAL, albedo, fuzz, -1}; }
+    static Material textured(int texture, const color& tint = color(1.0, 1.0, 1.0)) {
+        return Material{MATERIAL_DIFFUSE, tint, 0.0, texture};
+    }
+};
+
+// Outcome flags per lane
+const uint8_t SCATTER_CONTINUE = 1;  // Next direction is valid
+const uint8_t SCATTER_SHADOW = 2;    // Light direction adds cr, cg, cb if unoccluded
+
+// Up to LANES hits of one material in structure-of-arrays form. Material
+// constants other than albedo are uniform over the batch, so each kernel is
+// straight-line loops over unit-stride arrays that the compiler vectorizes.
+// Albedo is loaded per lane, since a texture varies it hit by hit. Random numbers
+// and light samples are drawn before the kernel runs (they need each path's
+// generator and the light's tables), in the same order for every
+// integrator.
+struct ShadingBatch {
+    static constexpr size_t LANES = 64;
+
+    size_t count;
+    bool delta_light;  // Light samples are a delta (sun) rather than sampled with a density
+
+    // In: hit point, shading normal, incoming direction, throughput, and
+    // albedo, which textures vary per hit
+    alignas(64) double px[LANES], py[LANES], pz[LANES];
+    alignas(64) double nx[LANES], ny[LANES], nz[LANES];
+    alignas(64) double dx[LANES], dy[LANES], dz[LANES];
+    alignas(64) double tr[LANES], tg[LANES], tb[LANES];
+    alignas(64) double ar[LANES], ag[LANES], ab[LANES];
+    // In: light sample direction, radiance (irradiance for a delta light) and density
+    alignas(64) double lx[LANES], ly[LANES], lz[LANES];
+    alignas(64) double lr[LANES], lg[LANES], lb[LANES];
+    alignas(64) double light_pdf[LANES];
+    // In: uniform numbers for the bounce
+    alignas(64) double u1[LANES], u2[LANES], u3[LANES];
+
+    // Out: continuation direction (in dx, dy, dz), its density (0 when it
+    // must not be MIS-weighted), throughput (in tr, tg, tb), direct light
+    alignas(64) double pdf[LANES];
+    alignas(64) double cr[LANES], cg[LANES], cb[LANES];
+    alignas(64) uint8_t flags[LANES];
+};
+
+// Random numbers a material consumes per hit for its bounce, and whether it
+// takes a light sample before them
+int material_bounce_randoms(MaterialType type);
+bool material_samples_light(MaterialType type);
+
+// Runs the kernel for material.type over the batch's lanes
+void shade_batch(const Material& material, ShadingBatch& batch);
+
+#endif
@@ -0,0 +1,92 @@
+#ifndef PATH_TRACER_H
+#define PATH_TRACER_H
+
+#include <cstdint>
+#include "math/ray.hpp"
+#include "geometry/scene.hpp"
+#include "rendering/material.hpp"
+
+// Small counter-based generator (splitmix64). Each path owns one, seeded from
+// its pixel and sample, so every integrator draws the same random numbers.
+struct Rng {
+    uint64_t state;
+
+    explicit Rng(uint64_t seed = 0) : state(seed) {}
+
+    inline uint64_t next_u64() {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+    inline double next_double() { return (next_u64() >> 11) * (1.0 / 9007199254740992.0); }
+};
+
+inline uint64_t pixel_seed(int x, int y, int sample) {
+    return (static_cast<uint64_t>(static_cast<uint32_t>(y)) << 40) ^
+           (static_cast<uint64_t>(static_cast<uint32_t>(x)) << 16) ^
+           static_cast<uint64_t>(static_cast<uint32_t>(sample)) * 0x2545F4914F6CDD1Dull;
+}
+
+// Shading model shared by the megakernel and wavefront integrators:
+// materials from the scene's table lit by a sun and a sky gradient, or by
+// the scene's environment map when it has one
+color sky_radiance(const vec3& direction);
+vec3 sun_direction();
+
+// Radiance reaching a ray that left the scene. bounce_pdf is the density the
+// ray's direction was sampled with by a bounce, or 0 for camera rays; it
+// weights environment hits against the light samples taken at that bounce.
+color miss_radiance(const SceneAccel& scene, const Ray& ray, double bounce_pdf);
+
+// Surface hits are shaded in batches of one material (see ShadingBatch).
+// begin_shading_batch resets the batch for the scene's light; each hit is
+// then loaded into a lane, which draws its light sample and random numbers
+// from rng in a fixed order, and after shade_batch the results are read
+// back: the continuation ray, its density, an optional shadow ray and the
+// contribution it adds if unoccluded. throughput is updated in place.
+void begin_shading_batch(ShadingBatch& batch, const EnvironmentMap* environment);
+void load_shading_lane(ShadingBatch& batch, const HitRecord& rec, const Ray& ray, const color& throughput,
+                       const Material& material, const color& albedo, const EnvironmentMap* environment, Rng& rng);
+
+// Albedo of the hit's material, scaled by its texture when it has one and
+// the mesh has texture coordinates. cone is the ray's cone at the hit; its
+// width picks the mip level, so distant surfaces read small levels only.
+color surface_albedo(const SceneAccel& scene, const HitRecord& rec, const Ray& ray, const RayCone& cone);
+
+struct SurfaceScatter {
+    Ray next;
+    Ray shadow;
+    color direct;
+    double pdf;  // Solid-angle density of next's direction
+    bool has_next;
+    bool has_shadow;
+};
+
+void read_shading_lane(const ShadingBatch& batch, size_t lane, color& throughput, SurfaceScatter& out);
+
+// Optional integrator behaviour, fixed at compile time. Every combination is
+// instantiated separately, so a path carries no runtime switches for them;
+// select_integrator (integrator.hpp) picks one per frame.
+enum IntegratorFeature : unsigned {
+    FEATURE_RUSSIAN_ROULETTE = 1,  // Past ROULETTE_DEPTH paths survive with probability of their throughput
+    FEATURE_CLAMP_INDIRECT = 2,    // Light arriving after a bounce is clamped to INDIRECT_CLAMP per channel
+    INTEGRATOR_FEATURE_COMBINATIONS = 4
+};
+
+const int ROULETTE_DEPTH = 2;
+const double INDIRECT_CLAMP = 10.0;
+
+// One path, fully traced before returning (megakernel). Features is a mask of
+// IntegratorFeature; instantiated for every combination. pixel_spread is
+// the camera's Camera::pixel_spread_angle, which starts the ray cone.
+template<unsigned Features>
+color trace_path_features(const SceneAccel& scene, const Ray& camera_ray, Rng& rng, int max_depth, double pixel_spread);
+
+// The plain path, as the wavefront integrator traces it
+inline color trace_path(const SceneAccel& scene, const Ray& camera_ray, Rng& rng, int max_depth, double pixel_spread = 0.0) {
+    return trace_path_features<0>(scene, camera_ray, rng, max_depth, pixel_spread);
+}
+
+#endif
@@ -0,0 +1,104 @@
+#ifndef PIXEL_BUFFER_H
+#define PIXEL_BUFFER_H
+
+#include <cstddef>
+#include <mutex>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+// Structure for better cache locality - pack RGB together. The fourth
+// slot, padding otherwise, holds the running sum of squared luminance
+// deviations of accumulated samples, for adaptive sampling.
+struct alignas(32) Pixel {
+    double r, g, b;
+    double luminance_m2;
+    Pixel() : r(0.0), g(0.0), b(0.0), luminance_m2(0.0) {}
+    Pixel(double red, double green, double blue) : r(red), g(green), b(blue), luminance_m2(0.0) {}
+    double luminance() const { return 0.2126 * r + 0.7152 * g + 0.0722 * b; }
+};
+
+// Welford update of a pixel's running sum of squared luminance deviations,
+// given its mean luminance before and after adding value
+inline double update_luminance_m2(double m2, double old_mean, double new_mean, double value) {
+    return m2 + (value - old_mean) * (value - new_mean);
+}
+
+// Standard error of a pixel's mean luminance after samples, relative to the
+// mean; dark pixels are measured against a floor so they do not dominate
+inline double pixel_relative_error(double mean, double m2, int samples) {
+    if (samples < 2) return std::numeric_limits<double>::infinity();
+    const double floor = 0.05;
+    double variance = m2 / (samples - 1);
+    return std::sqrt(variance / samples) / std::max(mean, floor);
+}
+
+// What happens to pixel contents when the image is resized
+enum class ResizeContent {
+    Clear,   // Zero every pixel
+    Discard, // Leave contents undefined - the next pass overwrites every pixel
+    Rescale  // Nearest-neighbour rescale of the old image as a placeholder
+};
+
+// Pixel storage of an Image, without the SDL presentation, so the renderer
+// side can be used and tested on its own
+class PixelBuffer {
+
+    public:
+        PixelBuffer();
+        ~PixelBuffer();
+
+        PixelBuffer(const PixelBuffer&) = delete;
+        PixelBuffer& operator=(const PixelBuffer&) = delete;
+
+        // Sizes the buffer and zeroes every pixel
+        void initialize(const double xSize, const double ySize);
+
+        // Optimized pixel setting with bounds checking
+        void setpixel(const double x, const double y, const double red, const double green, const double blue);
+        void setpixel_safe(const double x, const double y, const double red, const double green, const double blue);
+
+        // Bulk pixel operations for better performance
+        void setpixel_block(int start_x, int start_y, int end_x, int end_y, const double red, const double green, const double blue);
+
+        // Running average for multi-sample accumulation (sample_index 0 overwrites),
+        // tracking the luminance variance alongside
+        void accumulate_pixel(int x, int y, const double red, const double green, const double blue, int sample_index);
+
+        // Reuses the existing allocation whenever it is large enough
+        void resize(const double new_xSize, const double new_ySize, ResizeContent content = ResizeContent::Clear);
+
+        double get_width() const { return m_xSize; }
+        double get_height() const { return m_ySize; }
+        size_t get_capacity() const { return m_capacity; }
+
+        const Pixel& get_pixel(int x, int y) const { return m_pixels[y * m_intXSize + x]; }
+        Pixel* data() { return m_pixels; }
+        const Pixel* data() const { return m_pixels; }
+
+    private:
+        // Raw pixel storage - allocated without zero-filling
+        static Pixel* allocate_pixels(size_t count);
+        static void free_pixels(Pixel* pixels);
+        void reserve_pixels(size_t count);
+        void rescale_into(Pixel* destination, int new_width, int new_height) const;
+
+    protected:
+        // More cache-friendly pixel storage - single contiguous array.
+        // Kept as a raw buffer so resizes reuse capacity and skip zero-filling.
+        Pixel* m_pixels;
+        size_t m_pixelCount;
+        size_t m_capacity;
+
+        // Retained second buffer used as the rescale destination, swapped with m_pixels
+        Pixel* m_scratchPixels;
+        size_t m_scratchCapacity;
+
+        // Image dimensions
+        double m_xSize, m_ySize;
+        int m_intXSize, m_intYSize; // Cache integer versions
+
+        std::mutex m_pixelMutex; // Serializes setpixel_safe
+};
+
+#endif
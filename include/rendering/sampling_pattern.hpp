@@ -0,0 +1,44 @@
+#ifndef SAMPLING_PATTERN_H
+#define SAMPLING_PATTERN_H
+
+#include <cstddef>
+#include "rendering/tile_scheduler.hpp"
+
+// Which pixels an interactive frame traces; the rest are reconstructed
+enum SamplingMode {
+    SAMPLING_FULL,
+    SAMPLING_CHECKERBOARD, // Half the pixels, the other half on the next frame
+    SAMPLING_FOVEATED,     // Every pixel near the focus, sparser further out
+    SAMPLING_MODE_COUNT
+};
+
+// Foveated strides are chosen per aligned cell of this many pixels square,
+// and divide it, so a cell's traced pixels cover it on their own
+const int FOVEATED_CELL = 8;
+
+struct SamplingPattern {
+    SamplingMode mode = SAMPLING_FULL;
+    int parity = 0;             // Checkerboard traces pixels with (x + y) % 2 == parity
+    double focus_x = 0.0;       // Foveated: full density within fovea_radius
+    double focus_y = 0.0;       // pixels of the focus, then the stride doubles
+    double fovea_radius = 64.0; // every further radius, up to FOVEATED_CELL
+
+    // Foveated stride of the cell holding pixel (x, y); 1 in other modes
+    int stride(int x, int y) const;
+    bool traces(int x, int y) const;
+    // Pixels traced over a width x height frame
+    size_t traced_count(int width, int height) const;
+};
+
+const char* sampling_mode_name(SamplingMode mode);
+
+// Fills the pixels of tile the pattern did not trace, reading only traced
+// pixels (and the untraced pixel's own old value), so tiles can run in
+// parallel once every tile is traced. Checkerboard pixels keep their
+// previous value clamped to the range of their four traced neighbours;
+// foveated pixels copy the traced pixel at their block's corner.
+// Layout as in Denoiser::denoise.
+void reconstruct_tile(const SamplingPattern& pattern, const RenderTile& tile, double* rgb, size_t pixel_stride,
+                      int width, int height);
+
+#endif
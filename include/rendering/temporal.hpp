@@ -0,0 +1,76 @@
+#ifndef TEMPORAL_H
+#define TEMPORAL_H
+
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <cstdint>
+#include "core/thread_pool.hpp"
+#include "rendering/camera.hpp"
+#include "rendering/denoiser.hpp"
+
+// Reuses a finished frame after the camera moves. Each pixel of the new view
+// is placed in the world at its primary-hit depth and projected into the
+// camera the history was rendered with. History pixels around that point are
+// blended bilinearly, skipping any whose depth disagrees. Pixels with no
+// agreeing history (disocclusions, or off the old image) are rejected and
+// keep the new frame's colour.
+//
+// Navigation frames have no guides of their own, so reproject_splatted
+// first splats the history depth forward into the new view, and no ray is
+// traced for it.
+class TemporalReprojector {
+
+    public:
+        TemporalReprojector();
+
+        // Relative depth mismatch beyond which a history pixel is rejected
+        void set_depth_tolerance(double tolerance) { depth_tolerance = tolerance; }
+
+        bool has_history() const { return history_width > 0; }
+        void clear_history() { history_width = history_height = 0; }
+
+        // Keeps rgb as history, along with the guides and camera it was
+        // rendered with. Layout as in Denoiser::denoise, sized like guides.
+        void store(const double* rgb, size_t pixel_stride, const GuideBuffers& guides, const Camera& camera, ThreadPool* pool);
+
+        // Fetches history for every pixel of the view guides were rendered
+        // for; returns the number of pixels that found valid history
+        size_t reproject(const Camera& camera, const GuideBuffers& guides, ThreadPool* pool);
+        // Same for camera's full image, with depth splatted from history:
+        // each history pixel lands on the 2x2 pixels around its projection,
+        // nearest first. Pixels nothing lands on are rejected.
+        size_t reproject_splatted(const Camera& camera, ThreadPool* pool);
+
+        // Blends the last reprojection into rgb, sized like its guides:
+        // valid pixels become history + new_weight * (rgb - history)
+        void resolve(double* rgb, size_t pixel_stride, double new_weight, ThreadPool* pool) const;
+
+        bool is_valid(int x, int y) const { return valid[static_cast<size_t>(y) * width + x] != 0; }
+
+    private:
+        size_t fetch(const Camera& camera, const float* depth, ThreadPool* pool); // Sized width x height
+
+    private:
+        double depth_tolerance;
+
+        // History: colour and depth planes, and the camera they were seen from
+        int history_width, history_height;
+        std::vector<float> history_color[3];
+        std::vector<float> history_depth;
+        std::vector<float> history_slope; // Larger depth gradient, the change to a neighbouring pixel
+        Camera history_camera;
+
+        // Last reprojection
+        int width, height;
+        std::vector<float> reprojected[3];
+        std::vector<unsigned char> valid;
+
+        // Splatted depth as float bits; positive floats order like their bits,
+        // so an atomic minimum on the bits keeps the nearest surface
+        std::unique_ptr<std::atomic<uint32_t>[]> splat_bits;
+        size_t splat_capacity;
+        std::vector<float> splat_depth;
+};
+
+#endif
@@ -0,0 +1,131 @@
+#ifndef TEXTURE_CACHE_H
+#define TEXTURE_CACHE_H
+
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <cstdint>
+#include "core/mapped_file.hpp"
+#include "math/vec3.hpp"
+
+// Tiled, mipmapped texture files. Each level is cut into TEXTURE_TILE square
+// tiles of 8-bit sRGB texels, stored with one extra column and row copied
+// from the neighbouring tile (wrapping at the edges), so a bilinear lookup
+// never needs more than one tile.
+const uint32_t TEXTURE_FILE_VERSION = 1;
+const int TEXTURE_TILE = 64;
+const int TEXTURE_TILE_STRIDE = TEXTURE_TILE + 1;
+const size_t TEXTURE_TILE_BYTES = TEXTURE_TILE_STRIDE * TEXTURE_TILE_STRIDE * 3;
+
+struct TextureFileHeader {
+    char magic[8];         // "RTTEX001"
+    uint32_t version;
+    uint32_t width;
+    uint32_t height;
+    uint32_t level_count;  // Down to 1x1
+    uint64_t tile_offset;  // Tiles of every level, finest first, row by row
+};
+
+// One mip level and where its tiles start
+struct TextureLevel {
+    int width, height;
+    int tiles_x, tiles_y;
+    uint32_t first_tile;  // Counting from the finest level's first tile
+};
+
+// Level sizes halve (rounding down, at least 1) until both reach 1
+std::vector<TextureLevel> texture_levels(int width, int height);
+
+// Builds the mip chain of linear RGB texels (3 floats each, row by row) with
+// a box filter and writes it tiled
+bool write_tiled_texture(const char* path, int width, int height, const float* rgb);
+
+// Ray cones as a cheap stand-in for ray differentials: a camera ray starts
+// with zero width and spreads by one pixel's angle per unit distance.
+struct RayCone {
+    double width;
+    double spread;  // Radians
+
+    RayCone() : width(0.0), spread(0.0) {}
+    RayCone(double width_, double spread_) : width(width_), spread(spread_) {}
+
+    RayCone at(double t) const { return RayCone(width + spread * t, spread); }
+};
+
+// Mip level where one texel matches the cone's footprint on a triangle.
+// uv_area and world_area are the triangle's areas in texture and object
+// space; cos_incidence is between the ray and the surface normal.
+double texture_lod(const RayCone& cone, double cos_incidence, double uv_area, double world_area, int width, int height);
+
+// Textures share one pool of tile slots under a byte budget, but never fewer
+// than MIN_SLOTS tiles. Tiles are read from the mapped file the first time
+// they are sampled and evicted least recently used when the pool is full.
+//
+// Hits take no lock: a sample pins the slot with an atomic increment and
+// checks it still holds the wanted tile. Misses serialize on one mutex,
+// which loads the tile into the least recently used unpinned slot.
+class TextureCache {
+
+    public:
+        static constexpr size_t MIN_SLOTS = 64;
+
+        explicit TextureCache(size_t budget_bytes);
+
+        TextureCache(const TextureCache&) = delete;
+        TextureCache& operator=(const TextureCache&) = delete;
+
+        // Returns the texture id, or -1 after printing the reason. Open
+        // textures before sampling starts.
+        int open(const char* path);
+
+        size_t texture_count() const { return textures.size(); }
+        int width(int texture) const { return textures[texture]->levels[0].width; }
+        int height(int texture) const { return textures[texture]->levels[0].height; }
+        int level_count(int texture) const { return static_cast<int>(textures[texture]->levels.size()); }
+        uint32_t tile_count(int texture) const { return textures[texture]->tile_count; }
+
+        // Trilinear linear-RGB lookup with wrapping (u, v); lod is in mip
+        // levels and is clamped to the chain. Safe from any thread.
+        color sample(int texture, double u, double v, double lod);
+        // Bilinear lookup in one level
+        color sample_level(int texture, double u, double v, int level);
+
+        size_t slot_count() const { return slot_total; }
+        size_t resident_tiles() const;
+        size_t resident_bytes() const { return resident_tiles() * TEXTURE_TILE_BYTES; }
+        size_t misses() const { return miss_count.load(std::memory_order_relaxed); }
+        size_t evictions() const { return eviction_count.load(std::memory_order_relaxed); }
+
+    private:
+        struct Texture {
+            MappedFile file;
+            std::vector<TextureLevel> levels;
+            uint64_t tile_offset;
+            std::unique_ptr<std::atomic<int32_t>[]> tile_slot; // Slot holding each tile, -1 if none
+            uint32_t tile_count;
+        };
+
+        struct Slot {
+            std::atomic<uint64_t> key;        // Texture + 1 in the high half, tile in the low; 0 when empty
+            std::atomic<int32_t> pins;        // Samples reading the slot; negative while it is refilled
+            std::atomic<uint64_t> last_used;  // Miss clock at the last hit, for LRU
+        };
+
+        const uint8_t* acquire(int texture, uint32_t tile, int32_t& slot); // Pinned; release when done
+        void release(int32_t slot) { slots[slot].pins.fetch_sub(1, std::memory_order_release); }
+        int32_t load(int texture, uint32_t tile);
+
+    private:
+        std::vector<std::unique_ptr<Texture>> textures;
+        std::unique_ptr<Slot[]> slots;
+        size_t slot_total;
+        std::vector<uint8_t> tile_data;  // TEXTURE_TILE_BYTES per slot
+
+        std::mutex load_mutex;
+        std::atomic<uint64_t> miss_clock;
+        std::atomic<size_t> miss_count;
+        std::atomic<size_t> eviction_count;
+};
+
+#endif
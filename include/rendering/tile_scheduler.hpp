@@ -0,0 +1,82 @@
+#ifndef TILE_SCHEDULER_H
+#define TILE_SCHEDULER_H
+
+#include <vector>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include "core/thread_pool.hpp"
+#include "rendering/pixel_buffer.hpp"
+
+struct RenderTile {
+    int start_x, end_x;
+    int start_y, end_y;
+    int tile_id;
+};
+
+// Resumable per-tile state - a tile interrupted by a deadline picks up
+// at next_row of the same sample on the following frame
+struct TileProgress {
+    int next_row;      // Absolute row index to render next
+    int samples_done;  // Completed full passes over this tile
+    bool converged;    // Adaptive sampling judged it done before the target
+};
+
+// Adaptive sampling: once a tile has min_samples, error(tile, samples) is
+// checked after each of its passes, and a tile at or below threshold is
+// converged - it counts as complete and gets no more samples
+struct AdaptiveSampling {
+    int min_samples = 4;
+    double threshold = 0.0;
+    std::function<double(const RenderTile& tile, int samples)> error; // Empty disables adaptive sampling
+};
+
+// Time-sliced tile scheduler. Each call to run_until() renders rows until
+// the frame deadline passes, then returns so the caller can present.
+// Passes are sample-major: every tile gets sample N before any tile gets N+1.
+class TileScheduler {
+
+    public:
+        using Clock = std::chrono::steady_clock;
+        // Renders one row of a tile for the given sample index
+        using RowFunction = std::function<void(const RenderTile& tile, int row, int sample)>;
+
+        TileScheduler();
+
+        void reset(int width, int height, int tile_size, int target_samples);
+        void restart(); // Keep the tile layout, discard all progress
+        void set_adaptive(const AdaptiveSampling& settings) { adaptive = settings; }
+
+        // Render until the deadline or until all samples are done, on the pool
+        // if one is given. Returns true once every tile reached the target sample count.
+        // Re-running on an unchanged layout does not allocate.
+        bool run_until(Clock::time_point deadline, ThreadPool* pool, const RowFunction& render_row);
+
+        bool is_complete() const;
+        double progress() const; // Fraction of the total work finished [0, 1]
+
+        int get_width() const { return width; }
+        int get_height() const { return height; }
+        int get_target_samples() const { return target_samples; }
+        int get_current_pass() const; // Lowest sample count across tiles still sampling
+        size_t converged_tiles() const;
+
+        const std::vector<RenderTile>& get_tiles() const { return tiles; }
+        const TileProgress& get_tile_progress(size_t index) const { return tile_progress[index]; }
+
+    private:
+        // Renders rows of one tile until it finishes the pass or the deadline hits
+        void render_tile_slice(size_t index, Clock::time_point deadline, const RowFunction& render_row);
+
+    private:
+        std::vector<RenderTile> tiles;
+        std::vector<TileProgress> tile_progress;
+        int width;
+        int height;
+        int target_samples;
+        AdaptiveSampling adaptive;
+
+        std::atomic<bool> deadline_hit;
+};
+
+#endif
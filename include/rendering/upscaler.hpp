@@ -0,0 +1,31 @@
+#ifndef UPSCALER_H
+#define UPSCALER_H
+
+#include <vector>
+#include "core/thread_pool.hpp"
+
+// Edge-adaptive spatial upscaler after AMD's FidelityFX Super Resolution 1.
+// EASU reconstructs each output pixel from the 4x4 input pixels around it
+// with a Lanczos-like kernel stretched along the local edge direction, then
+// clamps it to the nearest 2x2 inputs so it cannot ring. RCAS then sharpens
+// at output resolution, limiting its negative lobe per pixel so no channel
+// overshoots its four neighbours. Both stages run over rows on the pool.
+class Upscaler {
+
+    public:
+        Upscaler();
+
+        // RCAS strength in stops below full; negative disables sharpening
+        void set_sharpening(double stops) { sharpening = stops; }
+
+        // Scales a src_width x src_height image into dst_width x dst_height.
+        // Pixels are three doubles, *_stride doubles apart, row-major.
+        void upscale(const double* src, size_t src_stride, int src_width, int src_height,
+                     double* dst, size_t dst_stride, int dst_width, int dst_height, ThreadPool* pool);
+
+    private:
+        double sharpening;
+        std::vector<double> scaled; // EASU output, three doubles per pixel
+};
+
+#endif
@@ -0,0 +1,100 @@
+#ifndef WAVEFRONT_H
+#define WAVEFRONT_H
+
+#include <vector>
+#include <cstdint>
+#include "rendering/camera.hpp"
+#include "rendering/path_tracer.hpp"
+#include "rendering/tile_scheduler.hpp"
+#include "geometry/paged_mesh.hpp"
+
+// Wavefront path tracer. Instead of finishing one path before the next, a
+// batch of paths moves through staged queues - generate, extend (closest
+// hit), shade, shadow (any-hit packets) - and each stage runs over the
+// whole queue on the thread pool. Between bounces the extend queue is sorted by ray direction
+// octant and origin cell, so neighbouring rays walk the same BVH nodes, and
+// the shade stage buckets hits by material so each material's kernel runs
+// over full structure-of-arrays batches instead of dispatching per hit.
+// Uses the same shading model and random streams as trace_path.
+//
+// Out-of-core geometry joins through set_paged_geometry: the extend and
+// shadow stages hand their whole queue to PagedMesh::trace, which defers
+// rays on non-resident clusters and pages them in between passes.
+class WavefrontIntegrator{
+
+    public:
+        WavefrontIntegrator();
+
+        void set_max_depth(int depth) { max_depth = depth; }
+        void set_ray_sorting(bool enabled) { sort_rays = enabled; }
+        void set_batch_size(size_t paths) { batch_size = paths; }
+        // Traced alongside the scene with material_id; nullptr removes it
+        void set_paged_geometry(PagedMesh* mesh, const Transform& object_to_world, int material_id);
+
+        // One sample for every pixel of region; output is row-major, region-sized
+        void render(const SceneAccel& scene, const Camera& camera, const RenderTile& region, int sample,
+                    double offset_u, double offset_v, color* output, ThreadPool* pool);
+
+        size_t rays_traced() const { return extension_rays; }
+        size_t shadow_rays_traced() const { return shadow_ray_count; }
+
+        static constexpr int SHADOW_PACKET_SIZE = 8;
+
+    private:
+        void generate(const Camera& camera, const RenderTile& region, size_t first_pixel, size_t count,
+                      int sample, double offset_u, double offset_v, ThreadPool* pool);
+        void sort_queue(const AABB& scene_bounds, ThreadPool* pool);
+        void extend(const SceneAccel& scene, ThreadPool* pool);
+        void shade(const SceneAccel& scene, int depth, ThreadPool* pool);
+        void trace_shadows(const SceneAccel& scene, ThreadPool* pool);
+        void extend_paged(ThreadPool* pool);
+
+    private:
+        int max_depth;
+        bool sort_rays;
+        size_t batch_size;
+
+        // Path state, structure of arrays indexed by path, kept between frames
+        std::vector<Ray> rays;
+        std::vector<color> throughput;
+        std::vector<color> radiance;
+        std::vector<Rng> rngs;
+        std::vector<HitRecord> hits;
+        std::vector<uint8_t> hit_flags;
+        std::vector<Ray> shadow_rays;
+        std::vector<color> shadow_contribution;
+        std::vector<double> bounce_pdfs; // Density of each ray's direction, 0 for camera rays
+        std::vector<RayCone> cones;      // Footprint for texture filtering, at the ray's origin
+
+        // Stage queues hold path indices; flags are per queue position
+        std::vector<uint32_t> extend_queue;
+        std::vector<uint32_t> shadow_queue;
+        std::vector<uint8_t> continue_flags;
+        std::vector<uint8_t> shadow_flags;
+        std::vector<uint8_t> shadow_blocked; // Per shadow queue position
+
+        // Paged geometry and one ray per queue position for its batches
+        PagedMesh* paged;
+        Transform paged_to_world;
+        Transform world_to_paged;
+        int paged_material;
+        std::vector<PagedRay> paged_rays;
+
+        // Shade stage: queue positions of hits bucketed by material, bucket
+        // starts (one extra entry for the end), and one task per batch
+        std::vector<uint32_t> material_queue;
+        std::vector<uint32_t> material_offsets;
+        std::vector<uint32_t> material_cursor;
+        std::vector<uint32_t> shading_tasks;
+
+        // Counting sort scratch
+        std::vector<uint16_t> sort_keys;
+        std::vector<uint16_t> sort_keys_scratch;
+        std::vector<uint32_t> sort_scratch;
+        std::vector<uint32_t> histogram;
+
+        size_t extension_rays;
+        size_t shadow_ray_count;
+};
+
+#endif
@@ -1,4 +1,5 @@
 #include "core/app.hpp"
+#include "geometry/scene_cache.hpp"
 
 
 APP::APP()
@@ -15,13 +16,14 @@ APP::APP()
     use_multithreading = true;
     progressive_rendering = true;
     real_time_resize = true;
-    preview_scale_factor = 0.25; // Start with 1/4 resolution for preview
+    preview_scale_factor = 0.6; // Quick previews render at 60% and are upscaled
     last_resize_time = 0;
     current_window_width = 0;
     current_window_height = 0;
     
     // Multi-threading setup
-    num_threads = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    num_threads = thread_pool.size();
+    scratch_arenas.resize(num_threads);
     tile_size = 64; // 64x64 pixel tiles for good load balancing
     render_in_progress = false;
     completed_tiles = 0;
@@ -31,6 +33,34 @@ APP::APP()
     current_progressive_level = 0;
     is_progressive_complete = false;
     
+    // Time-sliced rendering setup
+    time_sliced_rendering = true;
+    frame_budget_ms = 12.0; // Leaves headroom for texture upload within a 60 Hz frame
+    samples_per_pixel = 1;
+    time_sliced_active = false;
+    use_adaptive = true;
+    
+    // Integrator setup - 'I' toggles the wavefront integrator at runtime
+    use_wavefront = false;
+    max_path_depth = 3;
+    wavefront.set_max_depth(max_path_depth);
+    integrator_features = 0;
+    integrator = &select_integrator(integrator_features);
+    preview_mode = PREVIEW_ALBEDO;
+    navigating = false;
+    last_navigation_time = 0;
+    use_denoiser = true;
+    use_temporal = true;
+    sampling_mode = SAMPLING_FULL;
+    sampling_frame = 0;
+    cursor_x = -1;
+    cursor_y = -1;
+    navigation_scale = 1.0;
+    lazy_build_threshold = 1000000;
+    compress_threshold = 4000000;
+    paged_budget = size_t(512) << 20;
+    texture_budget = size_t(256) << 20;
+    
     printf("Initialized with %d threads, tile size %dx%d\n", num_threads, tile_size, tile_size);
 }
 
@@ -58,11 +88,91 @@ bool APP::oninit(){
         
         // Initialize current window size
         SDL_GetWindowSize(pwindow, &current_window_width, &current_window_height);
+        
+        load_scene();
     }
     
     return (pwindow != nullptr && prenderer != nullptr);
 }
 
+void APP::load_scene() {
+    // A cache miss only parses the mesh (very large ones straight into
+    // meshlets, at about a third of the memory); the scene builds it below
+    auto load_start = std::chrono::steady_clock::now();
+    CachedMesh loaded;
+    int loaded_id = -1;
+    AABB bounds;
+    bool paged = mesh_path.size() > 6 && mesh_path.compare(mesh_path.size() - 6, 6, ".paged") == 0;
+    if (paged && paged_mesh.open(mesh_path.c_str(), paged_budget)) {
+        printf("Paged %s: %zu clusters, %zu MB resident budget\n", mesh_path.c_str(), paged_mesh.cluster_count(), paged_budget >> 20);
+        bounds = paged_mesh.bounds();
+    } else if (!paged && !mesh_path.empty() && open_mesh_cached(mesh_path.c_str(), compress_threshold, &thread_pool, loaded)) {
+        double load_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - load_start).count();
+        printf("Loaded %s%s: %zu triangles in %.1f ms\n", mesh_path.c_str(), loaded.cache_hit ? " from cache" : "",
+               loaded.triangle_count, load_ms);
+        const MeshletMesh* meshlets = loaded.meshlets ? loaded.meshlets.get() : loaded.built ? loaded.built->meshlets.get() : nullptr;
+        if (meshlets != nullptr) {
+            printf("Compressed to %zu meshlets, %.1f MB of geometry\n", meshlets->meshlet_count(), meshlets->memory_bytes() / 1048576.0);
+        }
+        bounds = loaded.bounds;
+    }
+
+    if (!bounds.empty()) {
+        // Fit into a unit box resting on the ground in front of the camera
+        vec3 extent = bounds.extent();
+        double scale = 1.0 / std::max(extent.x(), std::max(extent.y(), extent.z()));
+        point3 center = 0.5 * (bounds.min + bounds.max);
+        Transform placement = Transform::translate(vec3(0.0, -0.5 + 0.5 * extent.y() * scale, -1.4)) *
+                              Transform::scale(scale) * Transform::translate(-center);
+
+        TriangleMesh ground;
+        ground.add_quad(point3(-50.0, 0.0, 50.0), vec3(100.0, 0.0, 0.0), vec3(0.0, 0.0, -100.0));
+        scene.add_instance(scene.add_mesh(std::move(ground)), Transform::translate(vec3(0.0, -0.5, 0.0)));
+        if (paged) {
+            // Only the wavefront stages batch rays for paging, so it is the
+            // integrator that shows the paged mesh; previews leave it out
+            wavefront.set_paged_geometry(&paged_mesh, placement, 0);
+            use_wavefront = true;
+        } else {
+            loaded_id = add_cached_mesh(scene, loaded);
+            const TriangleMesh* mesh = loaded.mesh ? loaded.mesh.get() : loaded.built ? loaded.built->mesh.get() : nullptr;
+            scene.add_instance(loaded_id, placement, load_texture_material(mesh));
+        }
+    } else {
+        add_default_scene(scene);
+    }
+
+    if (!environment_path.empty()) {
+        std::shared_ptr<EnvironmentMap> environment = std::make_shared<EnvironmentMap>();
+        if (environment->load_hdr(environment_path.c_str())) {
+            printf("Environment %s: %dx%d\n", environment_path.c_str(), environment->get_width(), environment->get_height());
+            scene.set_environment(std::move(environment), &thread_pool);
+        }
+    }
+    
+    // LBVH on every core gets the first pixels out almost immediately; huge
+    // scenes go lazy so the first frame only builds the subtrees it sees
+    auto start = std::chrono::steady_clock::now();
+    bool lazy = scene.build_quick(&thread_pool, lazy_build_threshold);
+    double lbvh_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    printf("Scene: %zu meshes (%zu unique triangles), %zu instances (%zu triangles), %s built in %.1f ms\n",
+           scene.mesh_count(), scene.unique_triangle_count(), scene.instance_count(),
+           scene.instanced_triangle_count(), lazy ? "lazy BVH top levels" : "LBVH", lbvh_ms);
+    
+    // The SAH build gets its own smaller pool so it does not stall
+    // interactive frames; after a cache miss its result is what gets cached
+    bvh_build_thread = std::thread([this, loaded, loaded_id]() {
+        ThreadPool build_pool(std::max(1, num_threads / 2));
+        auto sah_start = std::chrono::steady_clock::now();
+        scene.build_sah(&build_pool);
+        double sah_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - sah_start).count();
+        printf("SAH BVHs built in %.1f ms, swapped in\n", sah_ms);
+        if (loaded_id >= 0 && !loaded.cache_hit && store_mesh_cache(loaded, *scene.acquire()->blas[loaded_id])) {
+            printf("Wrote %s\n", loaded.cache_path.c_str());
+        }
+    });
+}
+
 int APP::onexecute(){
 
     SDL_Event event;
@@ -88,6 +198,68 @@ void APP::onevent(SDL_Event *event){
     if(event->type ==SDL_QUIT){
         isrunning=false;
     }
+    if (event->type == SDL_KEYDOWN && event->key.keysym.sym == SDLK_i) {
+        use_wavefront = !use_wavefront;
+        printf("Integrator: %s\n", use_wavefront ? "wavefront" : "megakernel");
+        time_sliced_active = false;
+        need_rerender = true;
+    }
+    if (event->type == SDL_KEYDOWN && (event->key.keysym.sym == SDLK_r || event->key.keysym.sym == SDLK_f)) {
+        integrator_features ^= event->key.keysym.sym == SDLK_r ? FEATURE_RUSSIAN_ROULETTE : FEATURE_CLAMP_INDIRECT;
+        // The wavefront integrator always traces the plain path
+        printf("Megakernel features: %s\n", integrator_name(integrator_features));
+        time_sliced_active = false;
+        need_rerender = true;
+    }
+    if (event->type == SDL_KEYDOWN && event->key.keysym.sym == SDLK_n) {
+        use_denoiser = !use_denoiser;
+        printf("Denoiser: %s\n", use_denoiser ? "on" : "off");
+        time_sliced_active = false;
+        need_rerender = true;
+    }
+    if (event->type == SDL_KEYDOWN && event->key.keysym.sym == SDLK_v) {
+        use_adaptive = !use_adaptive;
+        printf("Adaptive sampling: %s\n", use_adaptive ? "on" : "off");
+        time_sliced_active = false;
+        need_rerender = true;
+    }
+    if (event->type == SDL_KEYDOWN && event->key.keysym.sym == SDLK_t) {
+        use_temporal = !use_temporal;
+        printf("Temporal reprojection: %s\n", use_temporal ? "on" : "off");
+    }
+    if (event->type == SDL_KEYDOWN && event->key.keysym.sym == SDLK_c) {
+        sampling_mode = static_cast<SamplingMode>((sampling_mode + 1) % SAMPLING_MODE_COUNT);
+        printf("Navigation sampling: %s\n", sampling_mode_name(sampling_mode));
+    }
+    if (event->type == SDL_KEYDOWN && event->key.keysym.sym == SDLK_u) {
+        navigation_scale = navigation_scale > 0.75 ? 2.0 / 3.0 : (navigation_scale > 0.6 ? 0.5 : 1.0);
+        printf("Navigation render scale: %.0f%%\n", navigation_scale * 100.0);
+    }
+    if (event->type == SDL_MOUSEMOTION) {
+        cursor_x = event->motion.x;
+        cursor_y = event->motion.y;
+    }
+    if (event->type == SDL_KEYDOWN && event->key.keysym.sym == SDLK_p) {
+        preview_mode = static_cast<PreviewMode>((preview_mode + 1) % PREVIEW_MODE_COUNT);
+        printf("Navigation preview: %s\n", preview_name(preview_mode));
+    }
+    if (event->type == SDL_KEYDOWN) {
+        bool moved = true;
+        switch (event->key.keysym.sym) {
+            case SDLK_w: camera.moveforward(NAVIGATION_STEP); break;
+            case SDLK_s: camera.movebackward(NAVIGATION_STEP); break;
+            case SDLK_a: camera.moveleft(NAVIGATION_STEP); break;
+            case SDLK_d: camera.moveright(NAVIGATION_STEP); break;
+            case SDLK_e: camera.moveup(NAVIGATION_STEP); break;
+            case SDLK_q: camera.movedown(NAVIGATION_STEP); break;
+            default: moved = false; break;
+        }
+        if (moved) {
+            navigating = true;
+            last_navigation_time = SDL_GetTicks();
+            time_sliced_active = false;
+        }
+    }
     if (event->type == SDL_WINDOWEVENT) {
         if (event->window.event == SDL_WINDOWEVENT_RESIZED) {
             // This fires continuously during resize - perfect for real-time updates!
@@ -118,6 +290,34 @@ void APP::onevent(SDL_Event *event){
 void APP::onloop(){
     static bool initial_rendered = false;
     
+    // Release last frame's scratch state - steady-state frames reuse the same blocks
+    frame_arena.reset();
+    scratch_arenas.reset_all();
+    
+    // Pick up a newly finished BVH and the integrator at a frame boundary only
+    frame_scene = scene.acquire();
+    
+    // While the camera moves, show the preview at full frame rate; once it
+    // settles, restart the full integrator from its coarsest level, or
+    // straight at full resolution over the reprojected history
+    if (navigating && SDL_GetTicks() - last_navigation_time >= NAVIGATION_SETTLE_MS) {
+        navigating = false;
+        bool keep_history = use_temporal && temporal.has_history();
+        current_progressive_level = keep_history ? static_cast<int>(progressive_scales.size()) - 1 : 0;
+        is_progressive_complete = false;
+        need_rerender = true;
+    }
+    integrator = &select_integrator(integrator_features, navigating ? preview_mode : PREVIEW_OFF);
+    if (navigating) {
+        if (preview_mode == PREVIEW_OFF && sampling_mode == SAMPLING_FULL && navigation_scale >= 1.0) {
+            render_progressive(progressive_scales[0]);
+        } else {
+            render_navigation_preview();
+        }
+        reproject_history();
+        return;
+    }
+    
     // Check if we need to handle a pending resize (debounced system)
     if (pending_resize && !real_time_resize) {
         uint32_t current_time = SDL_GetTicks();
@@ -130,11 +330,13 @@ void APP::onloop(){
             camera.update_dimensions(static_cast<double>(current_window_width), 
                                    static_cast<double>(current_window_height));
             image.resize(static_cast<double>(current_window_width), 
-                        static_cast<double>(current_window_height));
+                        static_cast<double>(current_window_height),
+                        resize_content());
             
             // Reset progressive rendering
             current_progressive_level = 0;
             is_progressive_complete = false;
+            time_sliced_active = false;
             
             need_rerender = true;
             pending_resize = false;
@@ -152,25 +354,42 @@ void APP::onloop(){
             camera.update_dimensions(static_cast<double>(current_window_width), 
                                    static_cast<double>(current_window_height));
             image.resize(static_cast<double>(current_window_width), 
-                        static_cast<double>(current_window_height));
+                        static_cast<double>(current_window_height),
+                        resize_content());
             
             current_progressive_level = 0;
             is_progressive_complete = false;
+            time_sliced_active = false;
             need_rerender = true;
         }
     }
     
-    // Only render if we haven't rendered yet, or if we need to re-render
-    if (!initial_rendered || need_rerender) {
-        if (progressive_rendering && !is_progressive_complete) {
-            render_progressive(progressive_scales[current_progressive_level]);
+    // Render if we haven't rendered yet, need to re-render, or still have progressive levels left
+    bool progressive_pending = progressive_rendering && !is_progressive_complete;
+    if (!initial_rendered || need_rerender || progressive_pending) {
+        if (progressive_pending) {
+            int scale = progressive_scales[current_progressive_level];
+            if (scale == 1 && use_wavefront) {
+                render_wavefront();
+            } else if (scale == 1 && time_sliced_rendering) {
+                // Full resolution level runs in frame-sized slices below
+                begin_time_sliced_render();
+            } else {
+                render_progressive(scale);
+                if (scale == 1) finish_frame(); // Full resolution level is a finished frame
+            }
             current_progressive_level++;
             if (current_progressive_level >= static_cast<int>(progressive_scales.size())) {
                 is_progressive_complete = true;
                 printf("Progressive rendering complete.\n");
             }
+        } else if (use_wavefront) {
+            render_wavefront();
+        } else if (time_sliced_rendering) {
+            begin_time_sliced_render();
         } else if (use_multithreading) {
             render_multithreaded();
+            finish_frame();
         } else {
             // Fallback to single-threaded rendering
             if (need_rerender) {
@@ -181,7 +400,8 @@ void APP::onloop(){
             for (int j = 0; j < camera.image_height; ++j) {
                 for (int i = 0; i < camera.image_width; ++i) {
                     Ray r = camera.get_ray(i, j);
-                    color pixel_color = ray_color(r);
+                    Rng rng(pixel_seed(i, j, 0));
+                    color pixel_color = ray_color(r, rng);
                     image.setpixel(i, j, pixel_color.x(), pixel_color.y(), pixel_color.z());
                 }
             }
@@ -194,6 +414,11 @@ void APP::onloop(){
         initial_rendered = true;
         need_rerender = false;
     }
+    
+    // Resume the interrupted full resolution pass; onrender presents whatever is done
+    if (time_sliced_active) {
+        render_time_sliced();
+    }
 }
 
 void APP::onrender(){
@@ -212,32 +437,62 @@ void APP::onrender(){
 }
 
 void APP::onexit(){
+    if (bvh_build_thread.joinable()) {
+        bvh_build_thread.join();
+    }
     SDL_DestroyRenderer(prenderer);
     SDL_DestroyWindow(pwindow);
     pwindow =nullptr;
     SDL_Quit();
 }
 
-// Basic ray color function - creates a simple gradient background
-color APP::ray_color(const Ray& r) const {
-    vec3 unit_direction = unit_vector(r.direction());
-    auto a = 0.5*(unit_direction.y() + 1.0);
-    return (1.0-a)*color(1.0, 1.0, 1.0) + a*color(0.5, 0.7, 1.0);
+// The progressive 1/8 level overwrites every pixel immediately after a resize;
+// without it, keep a rescaled copy of the old frame visible until tiles land
+ResizeContent APP::resize_content() const {
+    return progressive_rendering ? ResizeContent::Discard : ResizeContent::Rescale;
+}
+
+// Megakernel integrator - one path traced to completion per call
+color APP::ray_color(const Ray& r, Rng& rng) const {
+    if (!frame_scene) return sky_radiance(r.direction());
+    return integrator->trace(*frame_scene, r, rng, max_path_depth, camera.pixel_spread_angle());
 }
 
-// Render a specific tile of the image
+int APP::load_texture_material(const TriangleMesh* mesh) {
+    if (texture_path.empty()) return -1;
+    std::shared_ptr<TextureCache> textures = std::make_shared<TextureCache>(texture_budget);
+    int texture = textures->open(texture_path.c_str());
+    if (texture < 0) return -1;
+    printf("Texture %s: %dx%d, %zu MB tile budget\n", texture_path.c_str(), textures->width(texture), textures->height(texture),
+           texture_budget >> 20);
+    // Compressed meshes drop their texture coordinates
+    if (mesh == nullptr || !mesh->has_uvs()) printf("Texture %s: mesh has no texture coordinates, showing the tint\n", texture_path.c_str());
+    scene.set_textures(std::move(textures), &thread_pool);
+    return scene.add_material(Material::textured(texture));
+}
+
+// Render a specific tile of the image through the frame's row kernel
 void APP::render_tile(const RenderTile& tile, Image* target_image, Camera* target_camera) {
-    for (int j = tile.start_y; j < tile.end_y; ++j) {
-        for (int i = tile.start_x; i < tile.end_x; ++i) {
-            if (i < target_camera->image_width && j < target_camera->image_height) {
-                Ray r = target_camera->get_ray(i, j);
-                color pixel_color = ray_color(r);
-                target_image->setpixel(i, j, pixel_color.x(), pixel_color.y(), pixel_color.z());
-            }
+    if (!frame_scene) return;
+    int end_x = std::min(tile.end_x, static_cast<int>(target_camera->image_width));
+    int end_y = std::min(tile.end_y, static_cast<int>(target_camera->image_height));
+    if (end_x <= tile.start_x) return;
+    ArenaScope scope(thread_scratch());
+    color* row_colors = thread_scratch().allocate_array<color>(end_x - tile.start_x);
+    for (int j = tile.start_y; j < end_y; ++j) {
+        integrator->render_row(*frame_scene, *target_camera, j, tile.start_x, end_x, 0, 0.0, 0.0, max_path_depth, row_colors);
+        for (int i = tile.start_x; i < end_x; ++i) {
+            const color& c = row_colors[i - tile.start_x];
+            target_image->setpixel(i, j, c.x(), c.y(), c.z());
         }
     }
 }
 
+// Scratch arena of the pool thread running the caller
+FrameArena& APP::thread_scratch() {
+    return scratch_arenas.local(ThreadPool::current_thread_index());
+}
+
 // Progressive rendering - start with low resolution, then refine
 void APP::render_progressive(int resolution_scale) {
     int width = static_cast<int>(camera.image_width);
@@ -250,7 +505,8 @@ void APP::render_progressive(int resolution_scale) {
         for (int j = 0; j < height; j += resolution_scale) {
             for (int i = 0; i < width; i += resolution_scale) {
                 Ray r = camera.get_ray(i, j);
-                color pixel_color = ray_color(r);
+                Rng rng(pixel_seed(i, j, 0));
+                color pixel_color = ray_color(r, rng);
                 
                 // Fill a block of pixels with the same color
                 for (int dy = 0; dy < resolution_scale && j + dy < height; ++dy) {
@@ -266,6 +522,28 @@ void APP::render_progressive(int resolution_scale) {
     }
 }
 
+// Create tiles in frame memory - the count is known up front
+RenderTile* APP::make_frame_tiles(size_t& tile_count) {
+    int width = static_cast<int>(camera.image_width);
+    int height = static_cast<int>(camera.image_height);
+    int tiles_x = (width + tile_size - 1) / tile_size;
+    int tiles_y = (height + tile_size - 1) / tile_size;
+    tile_count = static_cast<size_t>(tiles_x) * tiles_y;
+    RenderTile* tiles = frame_arena.allocate_array<RenderTile>(tile_count);
+    
+    for (int ty = 0; ty < tiles_y; ++ty) {
+        for (int tx = 0; tx < tiles_x; ++tx) {
+            RenderTile& tile = tiles[ty * tiles_x + tx];
+            tile.start_x = tx * tile_size;
+            tile.end_x = std::min(tile.start_x + tile_size, width);
+            tile.start_y = ty * tile_size;
+            tile.end_y = std::min(tile.start_y + tile_size, height);
+            tile.tile_id = ty * tiles_x + tx;
+        }
+    }
+    return tiles;
+}
+
 // Multi-threaded tile-based rendering
 void APP::render_multithreaded() {
     if (render_in_progress.load()) {
@@ -275,53 +553,80 @@ void APP::render_multithreaded() {
     render_in_progress = true;
     completed_tiles = 0;
     
-    int width = static_cast<int>(camera.image_width);
-    int height = static_cast<int>(camera.image_height);
-    
-    // Create tiles
-    std::vector<RenderTile> tiles;
-    int tile_id = 0;
-    
-    for (int y = 0; y < height; y += tile_size) {
-        for (int x = 0; x < width; x += tile_size) {
-            RenderTile tile;
-            tile.start_x = x;
-            tile.end_x = std::min(x + tile_size, width);
-            tile.start_y = y;
-            tile.end_y = std::min(y + tile_size, height);
-            tile.tile_id = tile_id++;
-            tiles.push_back(tile);
-        }
-    }
+    size_t tile_count;
+    RenderTile* tiles = make_frame_tiles(tile_count);
     
-    printf("Rendering %zu tiles using %d threads...\n", tiles.size(), num_threads);
+    printf("Rendering %zu tiles using %d threads...\n", tile_count, num_threads);
     
-    // Launch worker threads
-    std::vector<std::future<void>> futures;
-    std::atomic<size_t> tile_index(0);
+    // Tiles are claimed dynamically by the persistent pool workers
+    thread_pool.parallel_for(tile_count, [&](size_t index, int) {
+        render_tile(tiles[index], &image, &camera);
+        int done = ++completed_tiles;
+        
+        // Progress reporting every 10 tiles
+        if (done % 10 == 0) {
+            printf("Completed %d/%zu tiles\n", done, tile_count);
+        }
+    });
     
-    for (int t = 0; t < num_threads; ++t) {
-        futures.push_back(std::async(std::launch::async, [&]() {
-            size_t local_tile_index;
-            while ((local_tile_index = tile_index.fetch_add(1)) < tiles.size()) {
-                render_tile(tiles[local_tile_index], &image, &camera);
-                completed_tiles++;
-                
-                // Progress reporting every 10 tiles
-                if (completed_tiles % 10 == 0) {
-                    printf("Completed %d/%zu tiles\n", completed_tiles.load(), tiles.size());
-                }
-            }
-        }));
+    printf("Multi-threaded rendering complete. Rendered %zu tiles.\n", tile_count);
+    render_in_progress = false;
+}
+
+// Preview kernel over the same tiles as the full render, quietly, every frame
+void APP::render_navigation_preview() {
+    if (sampling_mode == SAMPLING_FULL && navigation_scale < 1.0) {
+        render_upscaled(camera, *integrator, navigation_scale);
+        return;
     }
-    
-    // Wait for all threads to complete
-    for (auto& future : futures) {
-        future.wait();
+    size_t tile_count;
+    RenderTile* tiles = make_frame_tiles(tile_count);
+    if (sampling_mode == SAMPLING_FULL) {
+        thread_pool.parallel_for(tile_count, [&](size_t index, int) {
+            render_tile(tiles[index], &image, &camera);
+        });
+        return;
     }
     
-    printf("Multi-threaded rendering complete. Rendered %zu tiles.\n", tiles.size());
-    render_in_progress = false;
+    // Reconstruction reads neighbouring tiles, so it waits for every tile to be traced
+    int width = static_cast<int>(camera.image_width);
+    int height = static_cast<int>(camera.image_height);
+    if (static_cast<int>(image.get_width()) != width || static_cast<int>(image.get_height()) != height) return;
+    SamplingPattern pattern = make_sampling_pattern();
+    thread_pool.parallel_for(tile_count, [&](size_t index, int) {
+        render_tile_sampled(tiles[index], pattern);
+    });
+    thread_pool.parallel_for(tile_count, [&](size_t index, int) {
+        reconstruct_tile(pattern, tiles[index], &image.data()[0].r, sizeof(Pixel) / sizeof(double), width, height);
+    });
+    sampling_frame++;
+}
+
+// Current frame's pattern, with the fovea under the cursor once it has moved
+SamplingPattern APP::make_sampling_pattern() const {
+    SamplingPattern pattern;
+    pattern.mode = sampling_mode;
+    pattern.parity = sampling_frame & 1;
+    pattern.focus_x = camera.image_width * 0.5;
+    pattern.focus_y = camera.image_height * 0.5;
+    if (cursor_x >= 0 && current_window_width > 0 && current_window_height > 0) {
+        pattern.focus_x = cursor_x * camera.image_width / current_window_width;
+        pattern.focus_y = cursor_y * camera.image_height / current_window_height;
+    }
+    pattern.fovea_radius = camera.image_height * FOVEA_FRACTION;
+    return pattern;
+}
+
+void APP::render_tile_sampled(const RenderTile& tile, const SamplingPattern& pattern) {
+    if (!frame_scene) return;
+    for (int j = tile.start_y; j < tile.end_y; ++j) {
+        for (int i = tile.start_x; i < tile.end_x; ++i) {
+            if (!pattern.traces(i, j)) continue;
+            Rng rng(pixel_seed(i, j, 0));
+            color c = integrator->trace(*frame_scene, camera.get_ray(i, j), rng, max_path_depth, camera.pixel_spread_angle());
+            image.setpixel(i, j, c.x(), c.y(), c.z());
+        }
+    }
 }
 
 // Render a quick low-resolution preview during resize
@@ -330,24 +635,186 @@ void APP::render_quick_preview(int width, int height) {
     Camera temp_camera = camera;
     temp_camera.update_dimensions(static_cast<double>(width), static_cast<double>(height));
     
-    // Calculate low-resolution dimensions
-    int preview_width = static_cast<int>(width * preview_scale_factor);
-    int preview_height = static_cast<int>(height * preview_scale_factor);
-    
     // Skip if too small
-    if (preview_width < 10 || preview_height < 10) return;
+    if (width * preview_scale_factor < 10 || height * preview_scale_factor < 10) return;
+    
+    // The image takes the window's size now; the full render restarts once resizing stops
+    time_sliced_active = false;
+    render_upscaled(temp_camera, select_integrator(integrator_features, preview_mode), preview_scale_factor);
+    printf("Quick preview rendered: %dx%d\n", static_cast<int>(preview_image.get_width()), static_cast<int>(preview_image.get_height()));
+}
+
+// Renders full_camera's view at scale of its size into preview_image, then
+// reconstructs the full size image from it
+void APP::render_upscaled(const Camera& full_camera, const IntegratorKernels& kernels, double scale) {
+    if (!frame_scene) return;
+    int width = static_cast<int>(full_camera.image_width);
+    int height = static_cast<int>(full_camera.image_height);
+    int low_width = std::max(1, static_cast<int>(width * scale));
+    int low_height = std::max(1, static_cast<int>(height * scale));
+    Camera low_camera = full_camera;
+    low_camera.update_dimensions(static_cast<double>(low_width), static_cast<double>(low_height));
+    
+    // Every pixel is overwritten below, so skip clearing
+    preview_image.resize(static_cast<double>(low_width), static_cast<double>(low_height), ResizeContent::Discard);
+    for_each_row(&thread_pool, low_height, [&](int j, int thread) {
+        FrameArena& scratch = scratch_arenas.local(thread);
+        ArenaScope scope(scratch);
+        color* row_colors = scratch.allocate_array<color>(low_width);
+        kernels.render_row(*frame_scene, low_camera, j, 0, low_width, 0, 0.0, 0.0, max_path_depth, row_colors);
+        for (int i = 0; i < low_width; ++i) {
+            const color& c = row_colors[i];
+            preview_image.setpixel(i, j, c.x(), c.y(), c.z());
+        }
+    });
+    
+    if (static_cast<int>(image.get_width()) != width || static_cast<int>(image.get_height()) != height) {
+        image.resize(static_cast<double>(width), static_cast<double>(height), ResizeContent::Discard);
+    }
+    upscaler.upscale(&preview_image.data()[0].r, sizeof(Pixel) / sizeof(double), low_width, low_height,
+                     &image.data()[0].r, sizeof(Pixel) / sizeof(double), width, height, &thread_pool);
+}
+
+// Sub-pixel jitter from the R2 low-discrepancy sequence; sample 0 stays at the pixel center
+static void sample_offset(int sample, double& offset_u, double& offset_v) {
+    if (sample == 0) {
+        offset_u = 0.0;
+        offset_v = 0.0;
+        return;
+    }
+    double u = 0.5 + sample * 0.7548776662466927;
+    double v = 0.5 + sample * 0.5698402909980532;
+    offset_u = (u - std::floor(u)) - 0.5;
+    offset_v = (v - std::floor(v)) - 0.5;
+}
+
+// Start a new full resolution pass with fresh per-tile state
+void APP::begin_time_sliced_render() {
+    int target = use_adaptive ? ADAPTIVE_MAX_SAMPLES : samples_per_pixel;
+    scheduler.reset(static_cast<int>(camera.image_width), static_cast<int>(camera.image_height), tile_size, target);
+    AdaptiveSampling adaptive;
+    if (use_adaptive) {
+        adaptive.min_samples = ADAPTIVE_MIN_SAMPLES;
+        adaptive.threshold = ADAPTIVE_THRESHOLD;
+        adaptive.error = [this](const RenderTile& tile, int samples) { return tile_error(tile, samples); };
+    }
+    scheduler.set_adaptive(adaptive);
+    time_sliced_active = true;
+    printf("Time-sliced render started: %zu tiles, %d spp%s, %.1f ms/frame budget\n",
+           scheduler.get_tiles().size(), target, use_adaptive ? " max (adaptive)" : "", frame_budget_ms);
+}
+
+// Render as much as fits in this frame's budget; returns true when the pass is finished
+bool APP::render_time_sliced() {
+    auto budget = std::chrono::microseconds(static_cast<long long>(frame_budget_ms * 1000.0));
+    auto deadline = TileScheduler::Clock::now() + budget;
     
-    // Resize the preview image
-    preview_image.resize(static_cast<double>(preview_width), static_cast<double>(preview_height));
+    bool done = scheduler.run_until(deadline, use_multithreading ? &thread_pool : nullptr,
+        [this](const RenderTile& tile, int row, int sample) {
+            render_row(tile, row, sample);
+        });
+    
+    if (done) {
+        time_sliced_active = false;
+        printf("Time-sliced render complete: %zu of %zu tiles converged early.\n",
+               scheduler.converged_tiles(), scheduler.get_tiles().size());
+        finish_frame();
+    }
+    return done;
+}
+
+// Render a single row of a tile for one sample, accumulating into the image
+void APP::render_row(const RenderTile& tile, int row, int sample) {
+    double offset_u, offset_v;
+    sample_offset(sample, offset_u, offset_v);
     
-    // Render at low resolution - this should be very fast
-    for (int j = 0; j < preview_height; ++j) {
-        for (int i = 0; i < preview_width; ++i) {
-            Ray r = temp_camera.get_ray(i, j);
-            color pixel_color = ray_color(r);
-            preview_image.setpixel(i, j, pixel_color.x(), pixel_color.y(), pixel_color.z());
+    if (!frame_scene || tile.end_x <= tile.start_x) return;
+    ArenaScope scope(thread_scratch());
+    color* row_colors = thread_scratch().allocate_array<color>(tile.end_x - tile.start_x);
+    integrator->render_row(*frame_scene, camera, row, tile.start_x, tile.end_x, sample, offset_u, offset_v, max_path_depth, row_colors);
+    for (int i = tile.start_x; i < tile.end_x; ++i) {
+        const color& c = row_colors[i - tile.start_x];
+        image.accumulate_pixel(i, row, c.x(), c.y(), c.z(), sample);
+    }
+}
+
+// Called by the scheduler after a tile's pass; RMS rather than the maximum,
+// so a single firefly does not keep a whole tile sampling
+double APP::tile_error(const RenderTile& tile, int samples) const {
+    double sum_sq = 0.0;
+    for (int y = tile.start_y; y < tile.end_y; ++y) {
+        for (int x = tile.start_x; x < tile.end_x; ++x) {
+            const Pixel& pixel = image.get_pixel(x, y);
+            double error = pixel_relative_error(pixel.luminance(), pixel.luminance_m2, samples);
+            sum_sq += error * error;
         }
     }
+    return std::sqrt(sum_sq / ((tile.end_x - tile.start_x) * (tile.end_y - tile.start_y)));
+}
+
+// Full frame through the wavefront integrator, one sample per pass
+void APP::render_wavefront() {
+    if (!frame_scene) return;
+    
+    RenderTile frame;
+    frame.start_x = 0;
+    frame.start_y = 0;
+    frame.end_x = static_cast<int>(camera.image_width);
+    frame.end_y = static_cast<int>(camera.image_height);
+    frame.tile_id = 0;
+    int width = frame.end_x;
+    wavefront_output.resize(static_cast<size_t>(width) * frame.end_y);
     
-    printf("Quick preview rendered: %dx%d\n", preview_width, preview_height);
-}
\ No newline at end of file
+    ThreadPool* pool = use_multithreading ? &thread_pool : nullptr;
+    auto start = std::chrono::steady_clock::now();
+    for (int sample = 0; sample < samples_per_pixel; ++sample) {
+        double offset_u, offset_v;
+        sample_offset(sample, offset_u, offset_v);
+        wavefront.render(*frame_scene, camera, frame, sample, offset_u, offset_v, wavefront_output.data(), pool);
+        
+        for_each_row(pool, frame.end_y, [&](int row, int) {
+            for (int x = 0; x < width; ++x) {
+                const color& c = wavefront_output[static_cast<size_t>(row) * width + x];
+                image.accumulate_pixel(x, row, c.x(), c.y(), c.z(), sample);
+            }
+        });
+    }
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    printf("Wavefront render: %zu extension + %zu shadow rays in %.1f ms\n",
+           wavefront.rays_traced(), wavefront.shadow_rays_traced(), ms);
+    finish_frame();
+}
+
+// Edge-aware filter over the finished image, guided by the primary hits,
+// which the next camera move reprojects
+void APP::finish_frame() {
+    if ((!use_denoiser && !use_temporal) || !frame_scene) return;
+    int width = static_cast<int>(camera.image_width);
+    int height = static_cast<int>(camera.image_height);
+    if (static_cast<int>(image.get_width()) != width || static_cast<int>(image.get_height()) != height) return;
+    
+    ThreadPool* pool = use_multithreading ? &thread_pool : nullptr;
+    auto start = std::chrono::steady_clock::now();
+    render_guides(*frame_scene, camera, guides, pool);
+    if (use_denoiser) {
+        denoiser.denoise(&image.data()[0].r, sizeof(Pixel) / sizeof(double), width, height, guides, pool);
+    }
+    temporal.store(&image.data()[0].r, sizeof(Pixel) / sizeof(double), guides, camera, pool);
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    printf("Finished %dx%d frame%s in %.1f ms\n", width, height, use_denoiser ? " (denoised)" : "", ms);
+}
+
+// History replaces the navigation frame where it is valid. A preview is not
+// radiance, so it only fills rejected pixels; a path traced frame is blended in.
+void APP::reproject_history() {
+    if (!use_temporal || !temporal.has_history() || !frame_scene) return;
+    int width = static_cast<int>(camera.image_width);
+    int height = static_cast<int>(camera.image_height);
+    if (static_cast<int>(image.get_width()) != width || static_cast<int>(image.get_height()) != height) return;
+    
+    // Depth comes from splatting the history, so navigation frames trace no guide rays
+    ThreadPool* pool = use_multithreading ? &thread_pool : nullptr;
+    temporal.reproject_splatted(camera, pool);
+    double new_weight = preview_mode == PREVIEW_OFF ? TEMPORAL_BLEND : 0.0;
+    temporal.resolve(&image.data()[0].r, sizeof(Pixel) / sizeof(double), new_weight, pool);
+}
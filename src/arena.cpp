@@ -0,0 +1,97 @@
+#include "core/arena.hpp"
+#include <algorithm>
+#include <cstdint>
+
+FrameArena::FrameArena(size_t initial_capacity) : initial_capacity(std::max<size_t>(initial_capacity, 256)) {
+    current_block = 0;
+    offset = 0;
+    used_before_current = 0;
+    add_block(this->initial_capacity);
+}
+
+FrameArena::~FrameArena() {
+    release_blocks();
+}
+
+void FrameArena::add_block(size_t min_size) {
+    // Geometric growth keeps the number of overflow blocks per frame small
+    size_t size = blocks.empty() ? min_size : std::max(min_size, blocks.back().size * 2);
+    Block block;
+    block.data = static_cast<char*>(::operator new(size));
+    block.size = size;
+    blocks.push_back(block);
+}
+
+void FrameArena::release_blocks() {
+    for (Block& block : blocks) {
+        ::operator delete(block.data);
+    }
+    blocks.clear();
+}
+
+void* FrameArena::allocate(size_t size, size_t alignment) {
+    while (true) {
+        Block& block = blocks[current_block];
+        uintptr_t base = reinterpret_cast<uintptr_t>(block.data);
+        uintptr_t aligned = (base + offset + alignment - 1) & ~(static_cast<uintptr_t>(alignment) - 1);
+        size_t new_offset = static_cast<size_t>(aligned - base) + size;
+
+        if (new_offset <= block.size) {
+            offset = new_offset;
+            return reinterpret_cast<void*>(aligned);
+        }
+
+        // Move on to the next block, creating one large enough if needed
+        used_before_current += offset;
+        if (current_block + 1 == blocks.size()) {
+            add_block(size + alignment);
+        }
+        current_block++;
+        offset = 0;
+    }
+}
+
+void FrameArena::reset() {
+    // Coalesce an overflowed frame into a single block sized for the whole frame
+    if (blocks.size() > 1) {
+        size_t total = capacity();
+        release_blocks();
+        add_block(total);
+    }
+    current_block = 0;
+    offset = 0;
+    used_before_current = 0;
+}
+
+// Later blocks stay allocated and are reused by the allocations that follow
+void FrameArena::rewind(const Marker& marker) {
+    current_block = marker.block;
+    offset = marker.offset;
+    used_before_current = marker.used_before;
+}
+
+size_t FrameArena::capacity() const {
+    size_t total = 0;
+    for (const Block& block : blocks) {
+        total += block.size;
+    }
+    return total;
+}
+
+ScratchArenas::ScratchArenas(int num_threads, size_t capacity_per_thread) : capacity_per_thread(capacity_per_thread) {
+    resize(num_threads);
+}
+
+void ScratchArenas::resize(int num_threads) {
+    num_threads = std::max(1, num_threads);
+    arenas.resize(num_threads);
+    for (auto& arena : arenas) {
+        if (!arena) arena.reset(new FrameArena(capacity_per_thread));
+    }
+}
+
+void ScratchArenas::reset_all() {
+    for (auto& arena : arenas) {
+        arena->reset();
+    }
+}
@@ -0,0 +1,536 @@
+#include "geometry/bvh.hpp"
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
+// Primitives per chunk when a parallel loop works on ranges rather than single items
+static const size_t CHUNK_SIZE = 4096;
+
+static size_t chunk_count(size_t count) {
+    return (count + CHUNK_SIZE - 1) / CHUNK_SIZE;
+}
+
+// Run fn(begin, end) over CHUNK_SIZE ranges of [0, count), on the pool if there is one
+template<class Function>
+static void parallel_chunks(ThreadPool* pool, size_t count, const Function& fn) {
+    size_t chunks = chunk_count(count);
+    auto run_chunk = [&](size_t chunk, int) {
+        size_t begin = chunk * CHUNK_SIZE;
+        fn(chunk, begin, std::min(begin + CHUNK_SIZE, count));
+    };
+    parallel_for(pool, chunks, run_chunk);
+}
+
+int BVH::depth() const {
+    if (nodes.empty()) return 0;
+
+    int max_depth = 0;
+    int stack[MAX_DEPTH * 2][2];
+    int stack_size = 0;
+    stack[stack_size][0] = 0;
+    stack[stack_size][1] = 1;
+    stack_size++;
+    while (stack_size > 0) {
+        stack_size--;
+        int index = stack[stack_size][0];
+        int level = stack[stack_size][1];
+        max_depth = std::max(max_depth, level);
+        const BVHNode& node = nodes[index];
+        if (!node.is_leaf()) {
+            stack[stack_size][0] = node.left_first;
+            stack[stack_size][1] = level + 1;
+            stack[stack_size + 1][0] = node.left_first + 1;
+            stack[stack_size + 1][1] = level + 1;
+            stack_size += 2;
+        }
+    }
+    return max_depth;
+}
+
+double BVH::sah_cost() const {
+    if (nodes.empty()) return 0.0;
+
+    // Standard SAH with unit traversal and intersection costs
+    double root_area = nodes[0].bounds.surface_area();
+    if (root_area <= 0.0) return 0.0;
+
+    double cost = 0.0;
+    for (const BVHNode& node : nodes) {
+        double area = node.bounds.surface_area() / root_area;
+        cost += node.is_leaf() ? area * node.prim_count : area;
+    }
+    return cost;
+}
+
+//==============================================================================
+// Binned SAH builder
+//==============================================================================
+
+static const int SAH_BINS = 16;
+// Ranges larger than this are split with data-parallel binning before the
+// remaining subtrees are built as independent tasks
+static const uint32_t PARALLEL_SPLIT_THRESHOLD = 16384;
+
+struct SahBin {
+    AABB bounds;
+    uint32_t count = 0;
+};
+
+struct SahSplit {
+    int axis = -1;
+    int bin = 0;       // Primitives in bins [0, bin] go left
+    double cost = 0.0;
+};
+
+struct SahContext {
+    const std::vector<AABB>* prim_bounds;
+    std::vector<point3> centroids;
+    std::vector<uint32_t> indices;
+    int max_leaf_size;
+};
+
+static AABB centroid_bounds_of(const SahContext& ctx, uint32_t begin, uint32_t end) {
+    AABB box;
+    for (uint32_t i = begin; i < end; ++i) box.expand(ctx.centroids[ctx.indices[i]]);
+    return box;
+}
+
+static AABB bounds_of(const SahContext& ctx, uint32_t begin, uint32_t end) {
+    AABB box;
+    for (uint32_t i = begin; i < end; ++i) box.expand((*ctx.prim_bounds)[ctx.indices[i]]);
+    return box;
+}
+
+static inline int bin_of(const point3& c, const AABB& centroid_box, int axis, double scale) {
+    int bin = static_cast<int>((c.e[axis] - centroid_box.min.e[axis]) * scale);
+    return std::min(SAH_BINS - 1, std::max(0, bin));
+}
+
+static void bin_range(const SahContext& ctx, uint32_t begin, uint32_t end, const AABB& centroid_box,
+                      SahBin bins[3][SAH_BINS]) {
+    double scale[3];
+    for (int axis = 0; axis < 3; ++axis) {
+        double extent = centroid_box.max.e[axis] - centroid_box.min.e[axis];
+        scale[axis] = extent > 0.0 ? SAH_BINS / extent : 0.0;
+    }
+    for (uint32_t i = begin; i < end; ++i) {
+        uint32_t prim = ctx.indices[i];
+        const point3& c = ctx.centroids[prim];
+        for (int axis = 0; axis < 3; ++axis) {
+            SahBin& bin = bins[axis][bin_of(c, centroid_box, axis, scale[axis])];
+            bin.bounds.expand((*ctx.prim_bounds)[prim]);
+            bin.count++;
+        }
+    }
+}
+
+// Sweep the bins of every axis for the cheapest split plane
+static SahSplit best_split(SahBin bins[3][SAH_BINS], const AABB& centroid_box) {
+    SahSplit best;
+    best.cost = std::numeric_limits<double>::infinity();
+
+    for (int axis = 0; axis < 3; ++axis) {
+        if (centroid_box.max.e[axis] <= centroid_box.min.e[axis]) continue;
+
+        double right_cost[SAH_BINS];
+        AABB right_box;
+        uint32_t right_count = 0;
+        for (int b = SAH_BINS - 1; b > 0; --b) {
+            right_box.expand(bins[axis][b].bounds);
+            right_count += bins[axis][b].count;
+            right_cost[b] = right_box.surface_area() * right_count;
+        }
+
+        AABB left_box;
+        uint32_t left_count = 0;
+        for (int b = 0; b < SAH_BINS - 1; ++b) {
+            left_box.expand(bins[axis][b].bounds);
+            left_count += bins[axis][b].count;
+            double cost = left_box.surface_area() * left_count + right_cost[b + 1];
+            if (left_count > 0 && cost < best.cost) {
+                best.axis = axis;
+                best.bin = b;
+                best.cost = cost;
+            }
+        }
+    }
+    return best;
+}
+
+// Partition [begin, end) by the chosen split, falling back to a median split
+// when the centroids cannot be separated. Returns the first right-side index.
+static uint32_t partition_range(SahContext& ctx, uint32_t begin, uint32_t end, const AABB& centroid_box,
+                                const SahSplit& split) {
+    uint32_t mid = begin;
+    if (split.axis >= 0) {
+        double extent = centroid_box.max.e[split.axis] - centroid_box.min.e[split.axis];
+        double scale = SAH_BINS / extent;
+        auto first_right = std::partition(ctx.indices.begin() + begin, ctx.indices.begin() + end,
+            [&](uint32_t prim) {
+                return bin_of(ctx.centroids[prim], centroid_box, split.axis, scale) <= split.bin;
+            });
+        mid = static_cast<uint32_t>(first_right - ctx.indices.begin());
+    }
+    if (mid == begin || mid == end) {
+        mid = begin + (end - begin) / 2;
+    }
+    return mid;
+}
+
+// Serial top-down build of one subtree. The subtree root is out[0]; child
+// links are local to `out` and are rebased when the subtree is stitched in.
+static void build_subtree(SahContext& ctx, uint32_t begin, uint32_t end, int depth, std::vector<BVHNode>& out) {
+    struct Task { int node; uint32_t begin, end; int depth; };
+    Task stack[BVH::MAX_DEPTH * 2];
+    int stack_size = 0;
+
+    out.push_back(BVHNode());
+    stack[stack_size++] = {0, begin, end, depth};
+
+    while (stack_size > 0) {
+        Task task = stack[--stack_size];
+        uint32_t count = task.end - task.begin;
+        AABB bounds = bounds_of(ctx, task.begin, task.end);
+        out[task.node].bounds = bounds;
+
+        bool make_leaf = count <= static_cast<uint32_t>(ctx.max_leaf_size) || task.depth >= BVH::MAX_DEPTH - 1;
+        uint32_t mid = 0;
+        if (!make_leaf) {
+            AABB centroid_box = centroid_bounds_of(ctx, task.begin, task.end);
+            SahBin bins[3][SAH_BINS];
+            bin_range(ctx, task.begin, task.end, centroid_box, bins);
+            SahSplit split = best_split(bins, centroid_box);
+
+            // Stop when splitting costs more than intersecting everything here,
+            // unless the leaf would be too large
+            double leaf_cost = bounds.surface_area() * count;
+            double split_cost = bounds.surface_area() + split.cost;
+            if (split.axis >= 0 && split_cost >= leaf_cost && count <= 16) {
+                make_leaf = true;
+            } else {
+                mid = partition_range(ctx, task.begin, task.end, centroid_box, split);
+            }
+        }
+
+        if (make_leaf) {
+            out[task.node].left_first = static_cast<int>(task.begin);
+            out[task.node].prim_count = static_cast<int>(count);
+            continue;
+        }
+
+        int left = static_cast<int>(out.size());
+        out.push_back(BVHNode());
+        out.push_back(BVHNode());
+        out[task.node].left_first = left;
+        out[task.node].prim_count = 0;
+        stack[stack_size++] = {left + 1, mid, task.end, task.depth + 1};
+        stack[stack_size++] = {left, task.begin, mid, task.depth + 1};
+    }
+}
+
+BVH build_bvh_binned_sah(const std::vector<AABB>& prim_bounds, ThreadPool* pool, int max_leaf_size) {
+    BVH bvh;
+    uint32_t n = static_cast<uint32_t>(prim_bounds.size());
+    if (n == 0) return bvh;
+
+    SahContext ctx;
+    ctx.prim_bounds = &prim_bounds;
+    ctx.max_leaf_size = std::max(1, max_leaf_size);
+    ctx.centroids.resize(n);
+    ctx.indices.resize(n);
+    parallel_chunks(pool, n, [&](size_t, size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            ctx.centroids[i] = prim_bounds[i].centroid();
+            ctx.indices[i] = static_cast<uint32_t>(i);
+        }
+    });
+
+    // Phase 1: split large ranges with data-parallel binning until there are
+    // enough independent subtrees to keep every thread busy
+    struct PendingSubtree { int node; uint32_t begin, end; int depth; };
+    std::vector<PendingSubtree> pending;
+    std::vector<PendingSubtree> large;
+    bvh.nodes.push_back(BVHNode());
+    large.push_back({0, 0, n, 0});
+
+    size_t target_tasks = pool != nullptr ? static_cast<size_t>(pool->size()) * 4 : 1;
+    while (!large.empty()) {
+        PendingSubtree task = large.back();
+        large.pop_back();
+        uint32_t count = task.end - task.begin;
+        if (pool == nullptr || count < PARALLEL_SPLIT_THRESHOLD || pending.size() + large.size() >= target_tasks) {
+            pending.push_back(task);
+            continue;
+        }
+
+        // Per-chunk bins and bounds, reduced after the parallel pass
+        size_t chunks = chunk_count(count);
+        std::vector<AABB> chunk_centroids(chunks);
+        parallel_chunks(pool, count, [&](size_t chunk, size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                chunk_centroids[chunk].expand(ctx.centroids[ctx.indices[task.begin + i]]);
+            }
+        });
+        AABB centroid_box;
+        for (const AABB& box : chunk_centroids) centroid_box.expand(box);
+
+        std::unique_ptr<SahBin[][SAH_BINS]> chunk_bins(new SahBin[chunks * 3][SAH_BINS]);
+        std::vector<AABB> chunk_bounds(chunks);
+        parallel_chunks(pool, count, [&](size_t chunk, size_t begin, size_t end) {
+            bin_range(ctx, task.begin + static_cast<uint32_t>(begin), task.begin + static_cast<uint32_t>(end),
+                      centroid_box, &chunk_bins[chunk * 3]);
+            for (size_t i = begin; i < end; ++i) {
+                chunk_bounds[chunk].expand(prim_bounds[ctx.indices[task.begin + i]]);
+            }
+        });
+
+        SahBin bins[3][SAH_BINS];
+        AABB bounds;
+        for (size_t chunk = 0; chunk < chunks; ++chunk) {
+            bounds.expand(chunk_bounds[chunk]);
+            for (int axis = 0; axis < 3; ++axis) {
+                for (int b = 0; b < SAH_BINS; ++b) {
+                    bins[axis][b].bounds.expand(chunk_bins[chunk * 3 + axis][b].bounds);
+                    bins[axis][b].count += chunk_bins[chunk * 3 + axis][b].count;
+                }
+            }
+        }
+
+        SahSplit split = best_split(bins, centroid_box);
+        uint32_t mid = partition_range(ctx, task.begin, task.end, centroid_box, split);
+
+        int left = static_cast<int>(bvh.nodes.size());
+        bvh.nodes.push_back(BVHNode());
+        bvh.nodes.push_back(BVHNode());
+        bvh.nodes[task.node].bounds = bounds;
+        bvh.nodes[task.node].left_first = left;
+        bvh.nodes[task.node].prim_count = 0;
+        large.push_back({left, task.begin, mid, task.depth + 1});
+        large.push_back({left + 1, mid, task.end, task.depth + 1});
+    }
+
+    // Phase 2: build the independent subtrees in parallel
+    std::vector<std::vector<BVHNode>> subtrees(pending.size());
+    auto build_pending = [&](size_t index, int) {
+        const PendingSubtree& task = pending[index];
+        build_subtree(ctx, task.begin, task.end, task.depth, subtrees[index]);
+    };
+    parallel_for(pool, pending.size(), build_pending);
+
+    // Phase 3: stitch subtrees into the node array, rebasing their child links
+    for (size_t s = 0; s < pending.size(); ++s) {
+        const std::vector<BVHNode>& local = subtrees[s];
+        int offset = static_cast<int>(bvh.nodes.size()) - 1; // local index k > 0 lands at offset + k
+        for (size_t k = 0; k < local.size(); ++k) {
+            BVHNode node = local[k];
+            if (!node.is_leaf()) node.left_first += offset;
+            if (k == 0) {
+                bvh.nodes[pending[s].node] = node;
+            } else {
+                bvh.nodes.push_back(node);
+            }
+        }
+    }
+
+    bvh.prim_indices = std::move(ctx.indices);
+    return bvh;
+}
+
+//==============================================================================
+// LBVH builder (Karras 2012: fully parallel hierarchy from sorted Morton codes)
+//==============================================================================
+
+// Spread the low 10 bits of v so there are two zero bits between each
+static inline uint32_t expand_bits(uint32_t v) {
+    v = (v * 0x00010001u) & 0xFF0000FFu;
+    v = (v * 0x00000101u) & 0x0F00F00Fu;
+    v = (v * 0x00000011u) & 0xC30C30C3u;
+    v = (v * 0x00000005u) & 0x49249249u;
+    return v;
+}
+
+static inline uint32_t morton_code(const point3& p, const AABB& box) {
+    uint32_t code = 0;
+    for (int axis = 0; axis < 3; ++axis) {
+        double extent = box.max.e[axis] - box.min.e[axis];
+        double normalized = extent > 0.0 ? (p.e[axis] - box.min.e[axis]) / extent : 0.5;
+        uint32_t quantized = static_cast<uint32_t>(std::min(1023.0, std::max(0.0, normalized * 1024.0)));
+        code |= expand_bits(quantized) << (2 - axis);
+    }
+    return code;
+}
+
+// Stable parallel LSD radix sort of (code, prim) pairs by code, 8 bits per pass
+static void radix_sort_codes(std::vector<uint32_t>& codes, std::vector<uint32_t>& prims, ThreadPool* pool) {
+    size_t n = codes.size();
+    size_t chunks = chunk_count(n);
+    std::vector<uint32_t> codes_tmp(n), prims_tmp(n);
+    std::vector<size_t> histogram(chunks * 256);
+
+    for (int shift = 0; shift < 32; shift += 8) {
+        std::fill(histogram.begin(), histogram.end(), 0);
+        parallel_chunks(pool, n, [&](size_t chunk, size_t begin, size_t end) {
+            size_t* local = &histogram[chunk * 256];
+            for (size_t i = begin; i < end; ++i) local[(codes[i] >> shift) & 0xFF]++;
+        });
+
+        // Digit-major prefix sum gives every chunk its scatter offset per digit
+        size_t sum = 0;
+        for (int digit = 0; digit < 256; ++digit) {
+            for (size_t chunk = 0; chunk < chunks; ++chunk) {
+                size_t count = histogram[chunk * 256 + digit];
+                histogram[chunk * 256 + digit] = sum;
+                sum += count;
+            }
+        }
+
+        parallel_chunks(pool, n, [&](size_t chunk, size_t begin, size_t end) {
+            size_t* offsets = &histogram[chunk * 256];
+            for (size_t i = begin; i < end; ++i) {
+                size_t dst = offsets[(codes[i] >> shift) & 0xFF]++;
+                codes_tmp[dst] = codes[i];
+                prims_tmp[dst] = prims[i];
+            }
+        });
+        codes.swap(codes_tmp);
+        prims.swap(prims_tmp);
+    }
+}
+
+// Length of the common prefix of keys i and j; equal codes fall back to the index bits
+static inline int common_prefix(const std::vector<uint32_t>& codes, int i, int j) {
+    int n = static_cast<int>(codes.size());
+    if (j < 0 || j >= n) return -1;
+    uint32_t a = codes[i], b = codes[j];
+    if (a == b) return 32 + __builtin_clz(static_cast<uint32_t>(i ^ j));
+    return __builtin_clz(a ^ b);
+}
+
+BVH build_bvh_lbvh(const std::vector<AABB>& prim_bounds, ThreadPool* pool, int max_leaf_size) {
+    BVH bvh;
+    int n = static_cast<int>(prim_bounds.size());
+    if (n == 0) return bvh;
+    max_leaf_size = std::max(1, max_leaf_size);
+
+    if (n == 1) {
+        BVHNode leaf;
+        leaf.bounds = prim_bounds[0];
+        leaf.left_first = 0;
+        leaf.prim_count = 1;
+        bvh.nodes.push_back(leaf);
+        bvh.prim_indices.push_back(0);
+        return bvh;
+    }
+
+    // Centroid bounds (parallel reduction)
+    std::vector<AABB> chunk_boxes(chunk_count(n));
+    parallel_chunks(pool, n, [&](size_t chunk, size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) chunk_boxes[chunk].expand(prim_bounds[i].centroid());
+    });
+    AABB centroid_box;
+    for (const AABB& box : chunk_boxes) centroid_box.expand(box);
+
+    // Morton codes, then sort primitives along the curve
+    std::vector<uint32_t> codes(n), prims(n);
+    parallel_chunks(pool, n, [&](size_t, size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            codes[i] = morton_code(prim_bounds[i].centroid(), centroid_box);
+            prims[i] = static_cast<uint32_t>(i);
+        }
+    });
+    radix_sort_codes(codes, prims, pool);
+
+    // Internal node i of n-1 covers sorted range [first[i], last[i]]. Children
+    // are encoded as >= 0 for internal nodes and ~leaf for leaves.
+    std::vector<int> child_left(n - 1), child_right(n - 1), range_first(n - 1), range_last(n - 1);
+    parallel_chunks(pool, n - 1, [&](size_t, size_t begin, size_t end) {
+        for (size_t node = begin; node < end; ++node) {
+            int i = static_cast<int>(node);
+            int direction = common_prefix(codes, i, i + 1) - common_prefix(codes, i, i - 1) > 0 ? 1 : -1;
+            int min_prefix = common_prefix(codes, i, i - direction);
+
+            // Exponential then binary search for the other end of the range
+            int max_length = 2;
+            while (common_prefix(codes, i, i + max_length * direction) > min_prefix) max_length *= 2;
+            int length = 0;
+            for (int step = max_length / 2; step >= 1; step /= 2) {
+                if (common_prefix(codes, i, i + (length + step) * direction) > min_prefix) length += step;
+            }
+            int j = i + length * direction;
+
+            // Find the split position within the range
+            int node_prefix = common_prefix(codes, i, j);
+            int split = 0;
+            int step = length;
+            do {
+                step = (step + 1) / 2;
+                if (common_prefix(codes, i, i + (split + step) * direction) > node_prefix) split += step;
+            } while (step > 1);
+            int gamma = i + split * direction + std::min(direction, 0);
+
+            int first = std::min(i, j), last = std::max(i, j);
+            child_left[i] = first == gamma ? ~gamma : gamma;
+            child_right[i] = last == gamma + 1 ? ~(gamma + 1) : gamma + 1;
+            range_first[i] = first;
+            range_last[i] = last;
+        }
+    });
+
+    // Lay the hierarchy out with adjacent siblings; small ranges become leaves
+    // directly since a Karras subtree always covers a contiguous sorted range
+    bvh.prim_indices = std::move(prims);
+    bvh.nodes.reserve(2 * static_cast<size_t>(n));
+    bvh.nodes.push_back(BVHNode());
+
+    struct Pending { int target; int source; int depth; };
+    std::vector<Pending> stack;
+    stack.push_back({0, 0, 0});
+    while (!stack.empty()) {
+        Pending item = stack.back();
+        stack.pop_back();
+
+        int first, last;
+        if (item.source < 0) {
+            first = last = ~item.source;
+        } else {
+            first = range_first[item.source];
+            last = range_last[item.source];
+        }
+
+        BVHNode& node = bvh.nodes[item.target];
+        int count = last - first + 1;
+        if (item.source < 0 || count <= max_leaf_size || item.depth >= BVH::MAX_DEPTH - 1) {
+            node.left_first = first;
+            node.prim_count = count;
+            continue;
+        }
+
+        int left = static_cast<int>(bvh.nodes.size());
+        node.left_first = left;
+        node.prim_count = 0;
+        bvh.nodes.push_back(BVHNode());
+        bvh.nodes.push_back(BVHNode());
+        stack.push_back({left + 1, child_right[item.source], item.depth + 1});
+        stack.push_back({left, child_left[item.source], item.depth + 1});
+    }
+
+    // Bounds: leaves in parallel, then interior nodes bottom-up. Children are
+    // always stored after their parent, so a reverse sweep sees them first.
+    parallel_chunks(pool, bvh.nodes.size(), [&](size_t, size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            BVHNode& node = bvh.nodes[i];
+            if (!node.is_leaf()) continue;
+            AABB box;
+            for (int k = 0; k < node.prim_count; ++k) box.expand(prim_bounds[bvh.prim_indices[node.left_first + k]]);
+            node.bounds = box;
+        }
+    });
+    for (size_t i = bvh.nodes.size(); i-- > 0;) {
+        BVHNode& node = bvh.nodes[i];
+        if (!node.is_leaf()) {
+            node.bounds = surrounding_box(bvh.nodes[node.left_first].bounds, bvh.nodes[node.left_first + 1].bounds);
+        }
+    }
+
+    return bvh;
+}
@@ -0,0 +1,152 @@
+#include "geometry/bvh8.hpp"
+#include <cmath>
+
+namespace {
+
+// Largest float not above x, so the grid origin never sits inside the box
+float round_down(double x) {
+    float f = static_cast<float>(x);
+    return static_cast<double>(f) > x ? std::nextafter(f, -INFINITY) : f;
+}
+
+float decode(float origin, int q, int exponent) {
+    return origin + static_cast<float>(std::ldexp(static_cast<double>(q), exponent));
+}
+
+// Fill the quantized frame of one node and the grid cells of its children
+void quantize_node(BVH8Node& node, const AABB& parent, const std::vector<AABB>& children) {
+    for (int a = 0; a < 3; ++a) {
+        float origin = round_down(parent.min[a]);
+        double extent = parent.max[a] - static_cast<double>(origin);
+
+        // Smallest power of two for which 254 cells cover the extent; one cell of slack
+        int exponent = -100;
+        if (extent > 0.0) exponent = std::max(exponent, static_cast<int>(std::ceil(std::log2(extent / 254.0))));
+        while (std::ldexp(254.0, exponent) < extent) ++exponent;
+
+        node.origin[a] = origin;
+        node.exponent[a] = static_cast<int8_t>(exponent);
+
+        for (size_t i = 0; i < 8; ++i) {
+            if (i >= children.size()) {
+                node.qlo[a][i] = 255;
+                node.qhi[a][i] = 0;
+                continue;
+            }
+            double cell = std::ldexp(1.0, exponent);
+            int lo = static_cast<int>(std::floor((children[i].min[a] - origin) / cell));
+            int hi = static_cast<int>(std::ceil((children[i].max[a] - origin) / cell));
+            lo = std::max(0, std::min(255, lo));
+            hi = std::max(0, std::min(255, hi));
+
+            // Step outwards until the single-precision decode contains the child
+            while (lo > 0 && static_cast<double>(decode(origin, lo, exponent)) > children[i].min[a]) --lo;
+            while (hi < 255 && static_cast<double>(decode(origin, hi, exponent)) < children[i].max[a]) ++hi;
+            node.qlo[a][i] = static_cast<uint8_t>(lo);
+            node.qhi[a][i] = static_cast<uint8_t>(hi);
+        }
+    }
+}
+
+// One child candidate: a binary node, or a slice of an oversized leaf's
+// primitives, which keeps the leaf's bounds
+struct Source {
+    int binary; // -1 for a slice
+    uint32_t first, count;
+    AABB bounds;
+};
+
+Source node_source(const BVH& bvh, int index) {
+    const BVHNode& node = bvh.nodes[index];
+    return Source{index, static_cast<uint32_t>(node.left_first), static_cast<uint32_t>(node.prim_count), node.bounds};
+}
+
+bool is_leaf(const BVH& bvh, const Source& source) {
+    return source.binary < 0 || bvh.nodes[source.binary].is_leaf();
+}
+
+// Interior nodes and leaves too large for one slot can be opened
+bool can_open(const BVH& bvh, const Source& source) {
+    return !is_leaf(bvh, source) || source.count > BVH8_MAX_LEAF;
+}
+
+}
+
+AABB BVH8::child_bounds(const BVH8Node& node, int child) const {
+    point3 lo, hi;
+    for (int a = 0; a < 3; ++a) {
+        lo[a] = decode(node.origin[a], node.qlo[a][child], node.exponent[a]);
+        hi[a] = decode(node.origin[a], node.qhi[a][child], node.exponent[a]);
+    }
+    return AABB(lo, hi);
+}
+
+BVH8 build_bvh8(const BVH& bvh) {
+    BVH8 wide;
+    if (bvh.empty()) return wide;
+
+    wide.bounds = bvh.nodes[0].bounds;
+    wide.prim_indices.reserve(bvh.prim_indices.size());
+    wide.nodes.reserve(bvh.nodes.size() / 4 + 1);
+    wide.nodes.push_back(BVH8Node());
+
+    // Breadth first, so each node's interior children can be allocated together
+    struct Pending { Source source; uint32_t wide; };
+    std::vector<Pending> queue;
+    queue.push_back(Pending{node_source(bvh, 0), 0});
+    std::vector<Source> children;
+    std::vector<AABB> child_boxes;
+
+    for (size_t head = 0; head < queue.size(); ++head) {
+        Pending item = queue[head];
+
+        // Open the largest child until all eight slots are used. An oversized
+        // leaf opens into two halves of its primitives.
+        children.assign(1, item.source);
+        while (children.size() < 8) {
+            int best = -1;
+            double best_area = -1.0;
+            for (size_t i = 0; i < children.size(); ++i) {
+                if (can_open(bvh, children[i]) && children[i].bounds.surface_area() > best_area) {
+                    best_area = children[i].bounds.surface_area();
+                    best = static_cast<int>(i);
+                }
+            }
+            if (best < 0) break;
+            Source opened = children[best];
+            if (is_leaf(bvh, opened)) {
+                uint32_t half = opened.count / 2;
+                children[best] = Source{-1, opened.first, half, opened.bounds};
+                children.push_back(Source{-1, opened.first + half, opened.count - half, opened.bounds});
+            } else {
+                int left = bvh.nodes[opened.binary].left_first;
+                children[best] = node_source(bvh, left);
+                children.push_back(node_source(bvh, left + 1));
+            }
+        }
+
+        child_boxes.clear();
+        for (const Source& child : children) child_boxes.push_back(child.bounds);
+
+        BVH8Node node;
+        std::memset(&node, 0, sizeof(node));
+        quantize_node(node, item.source.bounds, child_boxes);
+        node.child_base = static_cast<uint32_t>(wide.nodes.size());
+        node.prim_base = static_cast<uint32_t>(wide.prim_indices.size());
+
+        // Leaves still too large after eight slots become nodes of their own
+        for (size_t i = 0; i < children.size(); ++i) {
+            const Source& child = children[i];
+            if (!can_open(bvh, child)) {
+                node.leaf_count[i] = static_cast<uint8_t>(child.count);
+                for (uint32_t k = 0; k < child.count; ++k) wide.prim_indices.push_back(bvh.prim_indices[child.first + k]);
+            } else {
+                node.interior_mask |= static_cast<uint8_t>(1u << i);
+                queue.push_back(Pending{child, static_cast<uint32_t>(wide.nodes.size())});
+                wide.nodes.push_back(BVH8Node());
+            }
+        }
+        wide.nodes[item.wide] = node;
+    }
+    return wide;
+}
@@ -0,0 +1,181 @@
+#include "geometry/bvh_refit.hpp"
+#include <algorithm>
+
+BVHRefitter::BVHRefitter() {
+    stamp = 0;
+    degradation_threshold = 2.0; // Rebuild once a node's area has doubled
+    last_refit_nodes = 0;
+}
+
+void BVHRefitter::initialize(const BVH& bvh, size_t prim_count) {
+    size_t n = bvh.nodes.size();
+    parents.assign(n, -1);
+    depths.assign(n, 0);
+    build_area.assign(n, 0.0);
+    visit_stamp.assign(n, 0);
+    leaf_of_prim.assign(prim_count, -1);
+    stamp = 0;
+    degraded.clear();
+    if (n == 0) return;
+
+    // Walk only reachable nodes; slots orphaned by partial rebuilds keep parent -1
+    std::vector<int> stack;
+    stack.push_back(0);
+    while (!stack.empty()) {
+        int index = stack.back();
+        stack.pop_back();
+        const BVHNode& node = bvh.nodes[index];
+        build_area[index] = node.bounds.surface_area();
+
+        if (node.is_leaf()) {
+            for (int i = 0; i < node.prim_count; ++i) {
+                leaf_of_prim[bvh.prim_indices[node.left_first + i]] = index;
+            }
+            continue;
+        }
+        for (int child = node.left_first; child <= node.left_first + 1; ++child) {
+            parents[child] = index;
+            depths[child] = depths[index] + 1;
+            stack.push_back(child);
+        }
+    }
+}
+
+void BVHRefitter::refit(BVH& bvh, const std::vector<uint32_t>& moved_prims, const BoundsFunction& bounds_of, ThreadPool* pool) {
+    if (++stamp == 0) {
+        std::fill(visit_stamp.begin(), visit_stamp.end(), 0);
+        stamp = 1;
+    }
+
+    // Collect the dirty leaves and their ancestors, stopping at nodes already collected
+    std::vector<int> dirty;
+    for (uint32_t prim : moved_prims) {
+        int node = leaf_of_prim[prim];
+        while (node >= 0 && visit_stamp[node] != stamp) {
+            visit_stamp[node] = stamp;
+            dirty.push_back(node);
+            node = parents[node];
+        }
+    }
+    refit_nodes(bvh, dirty, bounds_of, pool);
+}
+
+void BVHRefitter::refit_all(BVH& bvh, const BoundsFunction& bounds_of, ThreadPool* pool) {
+    std::vector<int> dirty;
+    for (size_t i = 0; i < bvh.nodes.size(); ++i) {
+        if (i == 0 || parents[i] >= 0) dirty.push_back(static_cast<int>(i));
+    }
+    refit_nodes(bvh, dirty, bounds_of, pool);
+}
+
+void BVHRefitter::refit_nodes(BVH& bvh, std::vector<int>& dirty, const BoundsFunction& bounds_of, ThreadPool* pool) {
+    degraded.clear();
+    last_refit_nodes = dirty.size();
+    if (dirty.empty()) return;
+
+    // Bucket by depth; buckets keep their capacity between frames
+    int max_depth = 0;
+    for (int node : dirty) max_depth = std::max(max_depth, depths[node]);
+    if (static_cast<int>(levels.size()) <= max_depth) levels.resize(max_depth + 1);
+    for (auto& level : levels) level.clear();
+    for (int node : dirty) levels[depths[node]].push_back(node);
+
+    // Deepest level first: every node's children are final before it is visited
+    for (int depth = max_depth; depth >= 0; --depth) {
+        const std::vector<int>& level = levels[depth];
+        auto refit_node = [&](size_t i, int) {
+            BVHNode& node = bvh.nodes[level[i]];
+            if (node.is_leaf()) {
+                AABB box;
+                for (int k = 0; k < node.prim_count; ++k) box.expand(bounds_of(bvh.prim_indices[node.left_first + k]));
+                node.bounds = box;
+            } else {
+                node.bounds = surrounding_box(bvh.nodes[node.left_first].bounds, bvh.nodes[node.left_first + 1].bounds);
+            }
+        };
+        // Narrow levels near the root are not worth waking the workers for
+        parallel_for(level.size() >= 64 ? pool : nullptr, level.size(), refit_node, 32);
+    }
+
+    // Report the topmost inflated nodes; their subtrees are rebuild candidates
+    auto inflated = [&](int node) {
+        double area = bvh.nodes[node].bounds.surface_area();
+        return area > degradation_threshold * std::max(build_area[node], 1e-12);
+    };
+    for (int node : dirty) {
+        if (bvh.nodes[node].is_leaf() || !inflated(node)) continue;
+        bool ancestor_inflated = false;
+        for (int p = parents[node]; p >= 0 && !ancestor_inflated; p = parents[p]) {
+            ancestor_inflated = inflated(p);
+        }
+        if (!ancestor_inflated) degraded.push_back(node);
+    }
+}
+
+void rebuild_subtree(BVH& bvh, int root, const BVHRefitter::BoundsFunction& bounds_of, ThreadPool* pool) {
+    // Gather the subtree's primitive range and the sibling pairs it occupies
+    int range_begin = static_cast<int>(bvh.prim_indices.size());
+    int range_end = 0;
+    std::vector<int> old_pairs;
+    std::vector<int> stack;
+    stack.push_back(root);
+    while (!stack.empty()) {
+        int index = stack.back();
+        stack.pop_back();
+        const BVHNode& node = bvh.nodes[index];
+        if (node.is_leaf()) {
+            range_begin = std::min(range_begin, node.left_first);
+            range_end = std::max(range_end, node.left_first + node.prim_count);
+        } else {
+            old_pairs.push_back(node.left_first);
+            stack.push_back(node.left_first);
+            stack.push_back(node.left_first + 1);
+        }
+    }
+    if (old_pairs.empty()) return; // Already a single leaf
+    std::sort(old_pairs.begin(), old_pairs.end());
+
+    std::vector<uint32_t> range_prims(bvh.prim_indices.begin() + range_begin, bvh.prim_indices.begin() + range_end);
+    std::vector<AABB> local_bounds(range_prims.size());
+    for (size_t i = 0; i < range_prims.size(); ++i) local_bounds[i] = bounds_of(range_prims[i]);
+
+    BVH local = build_bvh_binned_sah(local_bounds, pool);
+    for (size_t i = 0; i < local.prim_indices.size(); ++i) {
+        bvh.prim_indices[range_begin + i] = range_prims[local.prim_indices[i]];
+    }
+
+    // Assign slots: old pairs in ascending order, then appended pairs, so
+    // children still always sit after their parent
+    std::vector<int> remap(local.nodes.size());
+    remap[0] = root;
+    size_t next_pair = 0;
+    for (size_t k = 0; k < local.nodes.size(); ++k) {
+        const BVHNode& node = local.nodes[k];
+        if (node.is_leaf()) continue;
+        int slot;
+        if (next_pair < old_pairs.size()) {
+            slot = old_pairs[next_pair++];
+        } else {
+            slot = static_cast<int>(bvh.nodes.size());
+            bvh.nodes.push_back(BVHNode());
+            bvh.nodes.push_back(BVHNode());
+        }
+        remap[node.left_first] = slot;
+        remap[node.left_first + 1] = slot + 1;
+    }
+
+    for (size_t k = 0; k < local.nodes.size(); ++k) {
+        BVHNode node = local.nodes[k];
+        node.left_first = node.is_leaf() ? node.left_first + range_begin : remap[node.left_first];
+        bvh.nodes[remap[k]] = node;
+    }
+
+    // Unused slots become unreachable empty nodes that add nothing to the SAH cost
+    for (size_t j = next_pair; j < old_pairs.size(); ++j) {
+        for (int slot = old_pairs[j]; slot <= old_pairs[j] + 1; ++slot) {
+            bvh.nodes[slot] = BVHNode();
+            bvh.nodes[slot].left_first = -1;
+            bvh.nodes[slot].prim_count = 0;
+        }
+    }
+}
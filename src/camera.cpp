@@ -1,4 +1,5 @@
 #include "rendering/camera.hpp"
+#include <cmath>
 
 Camera::Camera() {
     position = point3(0.0, 0.0, 0.0);
@@ -26,6 +27,32 @@ Ray Camera::get_ray(int i, int j) const {
     return Ray(position, ray_direction);
 }
 
+Ray Camera::get_ray(int i, int j, double offset_u, double offset_v) const {
+    // Jittered sample point inside pixel i,j - offsets of 0 hit the pixel center
+    auto pixel_sample = pixel00_loc + ((i + offset_u) * pixel_delta_u) + ((j + offset_v) * pixel_delta_v);
+    auto ray_direction = pixel_sample - position;
+
+    return Ray(position, ray_direction);
+}
+
+double Camera::pixel_spread_angle() const {
+    return std::atan(pixel_delta_v.length() / focal_length);
+}
+
+bool Camera::project(const point3& p, double& i, double& j) const {
+    // Scale the offset onto the image plane through pixel (0,0), then read
+    // the coordinates off the pixel deltas, which lie in that plane
+    vec3 forward = unit_vector(target - position);
+    vec3 offset = p - position;
+    vec3 corner = pixel00_loc - position;
+    double along = dot(offset, forward);
+    if (along <= 0.0) return false;
+    vec3 on_plane = offset * (dot(corner, forward) / along) - corner;
+    i = dot(on_plane, pixel_delta_u) / pixel_delta_u.length_squared();
+    j = dot(on_plane, pixel_delta_v) / pixel_delta_v.length_squared();
+    return true;
+}
+
 void Camera::set_aspect_ratio(double new_aspect_ratio) {
     aspect_ratio = new_aspect_ratio;
     image_height = image_width / aspect_ratio;
@@ -62,4 +89,34 @@ void Camera::update_dimensions(double new_width, double new_height) {
     // Recalculate pixel00_loc
     auto viewport_upper_left = position - vec3(0, 0, focal_length) - viewport_u/2 - viewport_v/2;
     pixel00_loc = viewport_upper_left + 0.5 * (pixel_delta_u + pixel_delta_v);
-}
\ No newline at end of file
+}
+
+void Camera::translate(const vec3& offset) {
+    position += offset;
+    target += offset;
+    pixel00_loc += offset;
+}
+
+void Camera::moveforward(double delta) {
+    translate(delta * unit_vector(target - position));
+}
+
+void Camera::movebackward(double delta) {
+    moveforward(-delta);
+}
+
+void Camera::moveright(double delta) {
+    translate(delta * right);
+}
+
+void Camera::moveleft(double delta) {
+    moveright(-delta);
+}
+
+void Camera::moveup(double delta) {
+    translate(delta * up);
+}
+
+void Camera::movedown(double delta) {
+    moveup(-delta);
+}
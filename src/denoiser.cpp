@@ -0,0 +1,187 @@
+#include "rendering/denoiser.hpp"
+#include "rendering/path_tracer.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+void GuideBuffers::resize(int new_width, int new_height) {
+    width = new_width;
+    height = new_height;
+    size_t count = static_cast<size_t>(width) * height;
+    for (int c = 0; c < 3; ++c) {
+        albedo[c].resize(count);
+        normal[c].resize(count);
+    }
+    depth.resize(count);
+    depth_gradient[0].resize(count);
+    depth_gradient[1].resize(count);
+}
+
+// Smaller of the two one-sided differences, so silhouettes do not inflate it
+static inline float one_sided_gradient(float before, float centre, float after) {
+    return std::min(std::fabs(centre - before), std::fabs(after - centre));
+}
+
+void render_guides(const SceneAccel& scene, const Camera& camera, GuideBuffers& guides, ThreadPool* pool) {
+    int width = static_cast<int>(camera.image_width);
+    int height = static_cast<int>(camera.image_height);
+    guides.resize(width, height);
+    const double infinity = std::numeric_limits<double>::infinity();
+    const RayCone camera_cone(0.0, camera.pixel_spread_angle());
+
+    for_each_row(pool, height, [&](int y, int) {
+        for (int x = 0; x < width; ++x) {
+            size_t i = static_cast<size_t>(y) * width + x;
+            Ray ray = camera.get_ray(x, y);
+            HitRecord rec;
+            if (scene.intersect(ray, RAY_EPSILON, infinity, rec)) {
+                color albedo = surface_albedo(scene, rec, ray, camera_cone.at(rec.t * ray.direction().length()));
+                for (int c = 0; c < 3; ++c) {
+                    guides.albedo[c][i] = static_cast<float>(albedo[c]);
+                    guides.normal[c][i] = static_cast<float>(rec.normal[c]);
+                }
+                guides.depth[i] = static_cast<float>(rec.t * ray.direction().length());
+            } else {
+                vec3 back = -unit_vector(ray.direction());
+                for (int c = 0; c < 3; ++c) {
+                    guides.albedo[c][i] = 1.0f;
+                    guides.normal[c][i] = static_cast<float>(back[c]);
+                }
+                guides.depth[i] = BACKGROUND_DEPTH;
+            }
+        }
+    });
+
+    for_each_row(pool, height, [&](int y, int) {
+        const float* row = &guides.depth[static_cast<size_t>(y) * width];
+        const float* above = &guides.depth[static_cast<size_t>(std::max(y - 1, 0)) * width];
+        const float* below = &guides.depth[static_cast<size_t>(std::min(y + 1, height - 1)) * width];
+        for (int x = 0; x < width; ++x) {
+            size_t i = static_cast<size_t>(y) * width + x;
+            guides.depth_gradient[0][i] = one_sided_gradient(row[std::max(x - 1, 0)], row[x], row[std::min(x + 1, width - 1)]);
+            guides.depth_gradient[1][i] = one_sided_gradient(above[x], row[x], below[x]);
+        }
+    });
+}
+
+Denoiser::Denoiser() {
+    passes = 5;
+    color_sigma = 1.0;
+    normal_power = 128.0;
+    depth_sigma = 1.0;
+    width = 0;
+    height = 0;
+}
+
+// Albedo floor for demodulation, so black surfaces do not blow up
+static const float MIN_ALBEDO = 0.01f;
+
+void Denoiser::denoise(double* rgb, size_t pixel_stride, int image_width, int image_height, const GuideBuffers& guides,
+                       ThreadPool* pool) {
+    if (image_width <= 0 || image_height <= 0 || guides.width != image_width || guides.height != image_height) return;
+    width = image_width;
+    height = image_height;
+    size_t count = static_cast<size_t>(width) * height;
+    for (int c = 0; c < 3; ++c) {
+        current[c].resize(count);
+        next[c].resize(count);
+    }
+    int threads = pool != nullptr ? pool->size() : 1;
+    row_sums.resize(static_cast<size_t>(threads) * ROW_SUMS * width);
+
+    for_each_row(pool, height, [&](int y, int) {
+        for (int x = 0; x < width; ++x) {
+            size_t i = static_cast<size_t>(y) * width + x;
+            const double* p = rgb + i * pixel_stride;
+            for (int c = 0; c < 3; ++c) current[c][i] = static_cast<float>(p[c]) / std::max(guides.albedo[c][i], MIN_ALBEDO);
+        }
+    });
+
+    for (int pass = 0; pass < passes; ++pass) {
+        filter_pass(pass, guides, pool);
+        for (int c = 0; c < 3; ++c) current[c].swap(next[c]);
+    }
+
+    for_each_row(pool, height, [&](int y, int) {
+        for (int x = 0; x < width; ++x) {
+            size_t i = static_cast<size_t>(y) * width + x;
+            double* p = rgb + i * pixel_stride;
+            for (int c = 0; c < 3; ++c) p[c] = current[c][i] * std::max(guides.albedo[c][i], MIN_ALBEDO);
+        }
+    });
+}
+
+void Denoiser::filter_pass(int pass, const GuideBuffers& guides, ThreadPool* pool) {
+    static const float kernel[5] = {1.0f / 16.0f, 1.0f / 4.0f, 3.0f / 8.0f, 1.0f / 4.0f, 1.0f / 16.0f};
+    const int step = 1 << pass;
+    // Later passes see smoother colour, so they need a tighter colour test
+    const float sigma = static_cast<float>(color_sigma) / static_cast<float>(step);
+    const float inv_sigma_sq = 1.0f / (sigma * sigma);
+    const float power = static_cast<float>(normal_power);
+    const float depth_scale = static_cast<float>(depth_sigma);
+
+    for_each_row(pool, height, [&](int y, int thread) {
+        float* sum_w = &row_sums[static_cast<size_t>(thread) * ROW_SUMS * width];
+        float* sum_r = sum_w + width;
+        float* sum_g = sum_r + width;
+        float* sum_b = sum_g + width;
+        std::fill(sum_w, sum_w + ROW_SUMS * width, 0.0f);
+
+        const size_t p0 = static_cast<size_t>(y) * width;
+        const float* pr = &current[0][p0];
+        const float* pg = &current[1][p0];
+        const float* pb = &current[2][p0];
+        const float* pnx = &guides.normal[0][p0];
+        const float* pny = &guides.normal[1][p0];
+        const float* pnz = &guides.normal[2][p0];
+        const float* pz = &guides.depth[p0];
+        const float* pgx = &guides.depth_gradient[0][p0];
+        const float* pgy = &guides.depth_gradient[1][p0];
+
+        for (int ky = -2; ky <= 2; ++ky) {
+            int qy = y + ky * step;
+            if (qy < 0 || qy >= height) continue;
+            const size_t q0 = static_cast<size_t>(qy) * width;
+            const float* qr = &current[0][q0];
+            const float* qg = &current[1][q0];
+            const float* qb = &current[2][q0];
+            const float* qnx = &guides.normal[0][q0];
+            const float* qny = &guides.normal[1][q0];
+            const float* qnz = &guides.normal[2][q0];
+            const float* qz = &guides.depth[q0];
+            const float offset_y = static_cast<float>(std::abs(ky * step));
+
+            for (int kx = -2; kx <= 2; ++kx) {
+                const int ox = kx * step;
+                const float h = kernel[ky + 2] * kernel[kx + 2];
+                const float offset_x = static_cast<float>(std::abs(ox));
+                // Pixels whose tap lands inside the row
+                const int x_begin = std::max(0, -ox);
+                const int x_end = std::min(width, width - ox);
+
+                for (int x = x_begin; x < x_end; ++x) {
+                    const int q = x + ox;
+                    float dr = pr[x] - qr[q], dg = pg[x] - qg[q], db = pb[x] - qb[q];
+                    float w_color = std::exp(-(dr * dr + dg * dg + db * db) * inv_sigma_sq);
+                    float facing = std::max(0.0f, pnx[x] * qnx[q] + pny[x] * qny[q] + pnz[x] * qnz[q]);
+                    float w_normal = std::pow(facing, power);
+                    float expected = depth_scale * (pgx[x] * offset_x + pgy[x] * offset_y) + 1e-4f * pz[x];
+                    float w_depth = std::exp(-std::fabs(pz[x] - qz[q]) / expected);
+                    float w = h * w_color * w_normal * w_depth;
+                    sum_w[x] += w;
+                    sum_r[x] += w * qr[q];
+                    sum_g[x] += w * qg[q];
+                    sum_b[x] += w * qb[q];
+                }
+            }
+        }
+
+        // The centre tap always has full weight, so the sum is positive
+        for (int x = 0; x < width; ++x) {
+            float inv = 1.0f / sum_w[x];
+            next[0][p0 + x] = sum_r[x] * inv;
+            next[1][p0 + x] = sum_g[x] * inv;
+            next[2][p0 + x] = sum_b[x] * inv;
+        }
+    });
+}
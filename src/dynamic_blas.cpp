@@ -0,0 +1,131 @@
+#include "geometry/dynamic_blas.hpp"
+#include <algorithm>
+
+DynamicBLAS::DynamicBLAS(const TriangleMesh& mesh, ThreadPool* pool) {
+    back_stale = false;
+    stamp = 0;
+    rebuild_ready = false;
+    rebuilds_adopted = 0;
+
+    front_mesh = std::make_shared<TriangleMesh>(mesh);
+    std::vector<AABB> bounds(mesh.triangle_count());
+    for (size_t i = 0; i < bounds.size(); ++i) bounds[i] = mesh.triangle_bounds(i);
+    front = std::make_shared<BLAS>();
+    front->mesh = front_mesh;
+    front->bvh = build_bvh_binned_sah(bounds, pool);
+    refitter.initialize(front->bvh, mesh.triangle_count());
+
+    // Vertex to triangle adjacency, so moved vertices map to their triangles
+    vertex_offsets.assign(mesh.vertex_count() + 1, 0);
+    for (uint32_t index : mesh.indices) vertex_offsets[index + 1]++;
+    for (size_t i = 1; i < vertex_offsets.size(); ++i) vertex_offsets[i] += vertex_offsets[i - 1];
+    vertex_triangles.resize(mesh.indices.size());
+    std::vector<uint32_t> cursor(vertex_offsets.begin(), vertex_offsets.end() - 1);
+    for (size_t i = 0; i < mesh.indices.size(); ++i) {
+        vertex_triangles[cursor[mesh.indices[i]]++] = static_cast<uint32_t>(i / 3);
+    }
+    triangle_stamp.assign(mesh.triangle_count(), 0);
+}
+
+DynamicBLAS::~DynamicBLAS() {
+    if (rebuild_thread.joinable()) rebuild_thread.join();
+}
+
+void DynamicBLAS::wait_for_rebuild() {
+    if (rebuild_thread.joinable()) rebuild_thread.join();
+}
+
+void DynamicBLAS::prepare_back_buffer() {
+    // A snapshot still rendering the back buffer keeps it; start a fresh copy
+    bool reusable = back != nullptr && back.use_count() == 1 && back_mesh.use_count() == 2;
+    if (!reusable) {
+        back_mesh = std::make_shared<TriangleMesh>(*front_mesh);
+        back = std::make_shared<BLAS>();
+        back->mesh = back_mesh;
+        back->bvh = front->bvh;
+        back_stale = false;
+    } else if (back_stale) {
+        back_mesh->positions = front_mesh->positions;
+        back->bvh = front->bvh;
+        back_stale = false;
+    } else {
+        // Catch up on the vertices moved by the previous update
+        for (uint32_t vertex : last_moved) {
+            std::copy_n(&front_mesh->positions[3 * static_cast<size_t>(vertex)], 3,
+                        &back_mesh->positions[3 * static_cast<size_t>(vertex)]);
+        }
+    }
+}
+
+void DynamicBLAS::collect_triangles(const std::vector<uint32_t>& vertex_ids) {
+    for (uint32_t vertex : vertex_ids) {
+        for (uint32_t k = vertex_offsets[vertex]; k < vertex_offsets[vertex + 1]; ++k) {
+            uint32_t triangle = vertex_triangles[k];
+            if (triangle_stamp[triangle] == stamp) continue;
+            triangle_stamp[triangle] = stamp;
+            dirty_triangles.push_back(triangle);
+        }
+    }
+}
+
+std::shared_ptr<const BLAS> DynamicBLAS::update_vertices(const std::vector<uint32_t>& vertex_ids,
+                                                         const std::vector<point3>& positions, ThreadPool* pool) {
+    bool adopt = rebuild_ready.load(std::memory_order_acquire);
+    if (adopt) {
+        if (rebuild_thread.joinable()) rebuild_thread.join();
+        rebuild_ready = false;
+    }
+
+    prepare_back_buffer();
+    if (adopt) back->bvh = std::move(*rebuilt);
+
+    for (size_t i = 0; i < vertex_ids.size(); ++i) {
+        float* p = &back_mesh->positions[3 * static_cast<size_t>(vertex_ids[i])];
+        p[0] = static_cast<float>(positions[i].x());
+        p[1] = static_cast<float>(positions[i].y());
+        p[2] = static_cast<float>(positions[i].z());
+    }
+
+    const TriangleMesh* mesh = back_mesh.get();
+    auto bounds_of = [mesh](uint32_t triangle) { return mesh->triangle_bounds(triangle); };
+
+    if (adopt) {
+        // The rebuilt tree predates the latest moves; refit it completely once
+        refitter.initialize(back->bvh, mesh->triangle_count());
+        refitter.refit_all(back->bvh, bounds_of, pool);
+        rebuilds_adopted++;
+    } else {
+        if (++stamp == 0) {
+            std::fill(triangle_stamp.begin(), triangle_stamp.end(), 0);
+            stamp = 1;
+        }
+        dirty_triangles.clear();
+        collect_triangles(last_moved);
+        collect_triangles(vertex_ids);
+        refitter.refit(back->bvh, dirty_triangles, bounds_of, pool);
+    }
+
+    std::swap(front, back);
+    std::swap(front_mesh, back_mesh);
+    last_moved = vertex_ids;
+    // After adopting, the new back buffer still has the old topology
+    if (adopt) back_stale = true;
+
+    bool idle = !rebuild_thread.joinable() && !rebuild_ready.load();
+    if (!refitter.degraded_subtrees().empty() && idle) start_rebuild();
+    return front;
+}
+
+void DynamicBLAS::start_rebuild() {
+    // Private copies: both buffers keep changing while the rebuild runs
+    std::shared_ptr<BVH> bvh = std::make_shared<BVH>(front->bvh);
+    std::shared_ptr<TriangleMesh> mesh = std::make_shared<TriangleMesh>(*front_mesh);
+    std::vector<int> roots = refitter.degraded_subtrees();
+
+    rebuild_thread = std::thread([this, bvh, mesh, roots]() {
+        auto bounds_of = [&](uint32_t triangle) { return mesh->triangle_bounds(triangle); };
+        for (int root : roots) rebuild_subtree(*bvh, root, bounds_of, nullptr);
+        rebuilt = std::make_unique<BVH>(std::move(*bvh));
+        rebuild_ready.store(true, std::memory_order_release);
+    });
+}
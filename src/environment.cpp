@@ -0,0 +1,189 @@
+#include "rendering/environment.hpp"
+#include "core/mapped_file.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+static const double PI = 3.14159265358979323846;
+
+void AliasTable::build(const std::vector<double>& weights) {
+    size_t n = weights.size();
+    threshold.assign(n, 1.0f);
+    alias.resize(n);
+    pmf.assign(n, 0.0f);
+    if (n == 0) return;
+
+    double total = 0.0;
+    for (double w : weights) total += std::max(w, 0.0);
+    std::vector<double> scaled(n);
+    for (size_t i = 0; i < n; ++i) {
+        double p = total > 0.0 ? std::max(weights[i], 0.0) / total : 1.0 / n;
+        pmf[i] = static_cast<float>(p);
+        scaled[i] = p * n;
+        alias[i] = static_cast<uint32_t>(i);
+    }
+
+    // Vose: pair each underfull bin with an overfull one until all are level
+    std::vector<uint32_t> small, large;
+    for (size_t i = 0; i < n; ++i) (scaled[i] < 1.0 ? small : large).push_back(static_cast<uint32_t>(i));
+    while (!small.empty() && !large.empty()) {
+        uint32_t s = small.back(), l = large.back();
+        small.pop_back();
+        threshold[s] = static_cast<float>(scaled[s]);
+        alias[s] = l;
+        scaled[l] -= 1.0 - scaled[s];
+        if (scaled[l] < 1.0) {
+            large.pop_back();
+            small.push_back(l);
+        }
+    }
+    // Leftovers are full up to rounding
+    for (uint32_t i : small) threshold[i] = 1.0f;
+    for (uint32_t i : large) threshold[i] = 1.0f;
+}
+
+bool read_hdr_image(const char* path, int& image_width, int& image_height, std::vector<float>& rgb) {
+    MappedFile file;
+    if (!file.open(path)) return false;
+    const char* data = file.data();
+    const char* end = data + file.size();
+
+    // Header lines up to a blank one, then the resolution line
+    auto read_line = [&](std::string& line) {
+        const char* newline = static_cast<const char*>(std::memchr(data, '\n', end - data));
+        if (newline == nullptr) return false;
+        line.assign(data, newline);
+        data = newline + 1;
+        return true;
+    };
+    std::string line;
+    if (!read_line(line) || line.compare(0, 2, "#?") != 0) {
+        printf("HDR: %s is not a Radiance HDR file\n", path);
+        return false;
+    }
+    while (read_line(line) && !line.empty()) {
+        if (line.compare(0, 7, "FORMAT=") == 0 && line != "FORMAT=32-bit_rle_rgbe") {
+            printf("HDR: %s has unsupported %s\n", path, line.c_str());
+            return false;
+        }
+    }
+    image_width = 0;
+    image_height = 0;
+    if (!read_line(line) || std::sscanf(line.c_str(), "-Y %d +X %d", &image_height, &image_width) != 2 ||
+        image_width <= 0 || image_height <= 0) {
+        printf("HDR: %s has an unsupported resolution line\n", path);
+        return false;
+    }
+
+    rgb.assign(3 * static_cast<size_t>(image_width) * image_height, 0.0f);
+    std::vector<uint8_t> scanline(4 * static_cast<size_t>(image_width));
+    for (int y = 0; y < image_height; ++y) {
+        bool encoded = image_width >= 8 && image_width < 32768 && end - data >= 4 && data[0] == 2 && data[1] == 2 &&
+                       ((static_cast<uint8_t>(data[2]) << 8) | static_cast<uint8_t>(data[3])) == image_width;
+        if (encoded) {
+            // Four channel planes, each as runs and literal spans
+            data += 4;
+            for (int c = 0; c < 4; ++c) {
+                int x = 0;
+                while (x < image_width) {
+                    if (data >= end) break;
+                    int count = static_cast<uint8_t>(*data++);
+                    bool run = count > 128;
+                    if (run) count -= 128;
+                    if (count == 0 || x + count > image_width || end - data < (run ? 1 : count)) {
+                        x = -1;
+                        break;
+                    }
+                    for (int i = 0; i < count; ++i) scanline[4 * (x + i) + c] = static_cast<uint8_t>(run ? *data : data[i]);
+                    data += run ? 1 : count;
+                    x += count;
+                }
+                if (x != image_width) {
+                    printf("HDR: %s has a corrupt scanline %d\n", path, y);
+                    return false;
+                }
+            }
+        } else {
+            if (end - data < static_cast<ptrdiff_t>(scanline.size())) {
+                printf("HDR: %s is truncated\n", path);
+                return false;
+            }
+            std::memcpy(scanline.data(), data, scanline.size());
+            data += scanline.size();
+        }
+
+        for (int x = 0; x < image_width; ++x) {
+            const uint8_t* rgbe = &scanline[4 * x];
+            float scale = rgbe[3] == 0 ? 0.0f : std::ldexp(1.0f, rgbe[3] - (128 + 8));
+            float* out = &rgb[3 * (static_cast<size_t>(y) * image_width + x)];
+            for (int c = 0; c < 3; ++c) out[c] = rgbe[c] * scale;
+        }
+    }
+
+    return true;
+}
+
+bool EnvironmentMap::load_hdr(const char* path) {
+    int image_width, image_height;
+    std::vector<float> rgb;
+    if (!read_hdr_image(path, image_width, image_height, rgb)) return false;
+    set_image(image_width, image_height, std::move(rgb));
+    return true;
+}
+
+void EnvironmentMap::set_image(int image_width, int image_height, std::vector<float> rgb) {
+    width = image_width;
+    height = image_height;
+    texels = std::move(rgb);
+    build_sampling();
+}
+
+void EnvironmentMap::build_sampling() {
+    // Texel solid angle is proportional to the sine of its row's polar angle
+    std::vector<double> weights(static_cast<size_t>(width) * height);
+    for (int y = 0; y < height; ++y) {
+        double sin_theta = std::sin(PI * (y + 0.5) / height);
+        for (int x = 0; x < width; ++x) {
+            size_t i = static_cast<size_t>(y) * width + x;
+            const float* p = &texels[3 * i];
+            weights[i] = (0.2126 * p[0] + 0.7152 * p[1] + 0.0722 * p[2]) * sin_theta;
+        }
+    }
+    table.build(weights);
+}
+
+size_t EnvironmentMap::texel_index(const vec3& direction) const {
+    vec3 d = unit_vector(direction);
+    double theta = std::acos(std::min(1.0, std::max(-1.0, d.y())));
+    double phi = std::atan2(d.z(), d.x());
+    if (phi < 0.0) phi += 2.0 * PI;
+    int x = std::min(width - 1, static_cast<int>(phi * (0.5 / PI) * width));
+    int y = std::min(height - 1, static_cast<int>(theta * (1.0 / PI) * height));
+    return static_cast<size_t>(y) * width + x;
+}
+
+vec3 EnvironmentMap::sample(double u1, double u2, color& value, double& pdf) const {
+    double jitter_x;
+    uint32_t texel = table.sample(u1, jitter_x);
+    int x = static_cast<int>(texel % width), y = static_cast<int>(texel / width);
+
+    double phi = 2.0 * PI * (x + jitter_x) / width;
+    double theta = PI * (y + u2) / height;
+    double sin_theta = std::sin(theta);
+    vec3 direction(sin_theta * std::cos(phi), std::cos(theta), sin_theta * std::sin(phi));
+
+    const float* p = &texels[3 * static_cast<size_t>(texel)];
+    value = color(p[0], p[1], p[2]);
+    // Uniform over the texel in (phi, theta), mapped to solid angle
+    pdf = sin_theta > 0.0 ? table.pmf[texel] * width * height / (2.0 * PI * PI * sin_theta) : 0.0;
+    return direction;
+}
+
+double EnvironmentMap::pdf(const vec3& direction) const {
+    vec3 d = unit_vector(direction);
+    double sin_theta = std::sqrt(std::max(0.0, 1.0 - d.y() * d.y()));
+    if (sin_theta <= 0.0) return 0.0;
+    return table.pmf[texel_index(d)] * width * height / (2.0 * PI * PI * sin_theta);
+}
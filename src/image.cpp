@@ -2,12 +2,9 @@
 #include <fstream>
 #include <cstring>
 #include <cmath>
+#include <algorithm>
 
 Image::Image(){
-    m_xSize = 0.0;
-    m_ySize = 0.0;
-    m_intXSize = 0;
-    m_intYSize = 0;
     m_pTexture = nullptr;
     m_pRenderer = nullptr;
 }
@@ -20,56 +17,12 @@ Image::~Image(){
 }
 
 void Image::initialize(const double xSize, const double ySize, SDL_Renderer *prenderer) {
-    m_xSize = xSize;
-    m_ySize = ySize;
     m_pRenderer = prenderer;
-    
-    // Cache integer versions for performance
-    m_intXSize = static_cast<int>(xSize);
-    m_intYSize = static_cast<int>(ySize);
-  
-    // Allocate contiguous pixel array for better cache performance
-    m_pixels.resize(m_intXSize * m_intYSize);
+    PixelBuffer::initialize(xSize, ySize);
     
     InitTexture();
 }
 
-// Fast pixel setting for performance-critical paths
-void Image::setpixel(const double x, const double y, const double red, const double green, const double blue) {
-    int int_x = static_cast<int>(x);
-    int int_y = static_cast<int>(y);
-    
-    // Bounds check
-    if (int_x >= 0 && int_x < m_intXSize && int_y >= 0 && int_y < m_intYSize) {
-        int index = int_y * m_intXSize + int_x; // Row-major order for cache efficiency
-        m_pixels[index] = Pixel(red, green, blue);
-    }
-}
-
-// Thread-safe version for multi-threaded rendering
-void Image::setpixel_safe(const double x, const double y, const double red, const double green, const double blue) {
-    int int_x = static_cast<int>(x);
-    int int_y = static_cast<int>(y);
-    
-    if (int_x >= 0 && int_x < m_intXSize && int_y >= 0 && int_y < m_intYSize) {
-        int index = int_y * m_intXSize + int_x;
-        std::lock_guard<std::mutex> lock(m_textureMutex);
-        m_pixels[index] = Pixel(red, green, blue);
-    }
-}
-
-// Set a block of pixels to the same color (useful for progressive rendering)
-void Image::setpixel_block(int start_x, int start_y, int end_x, int end_y, const double red, const double green, const double blue) {
-    Pixel pixel(red, green, blue);
-    
-    for (int y = start_y; y < end_y && y < m_intYSize; ++y) {
-        for (int x = start_x; x < end_x && x < m_intXSize; ++x) {
-            int index = y * m_intXSize + x;
-            m_pixels[index] = pixel;
-        }
-    }
-}
-
 void Image::display() {
     create_texture_from_pixels();
     
@@ -89,7 +42,7 @@ void Image::create_texture_from_pixels() {
         return;
     }
     
-    if (m_pixels.empty()) {
+    if (m_pixelCount == 0) {
         printf("Error: No pixel data\n");
         return;
     }
@@ -169,24 +122,3 @@ Uint32 Image::ConvertColor(const double red, const double green, const double bl
     
     return (a << 24) | (b << 16) | (g << 8) | r;
 }
-
-void Image::resize(const double new_xSize, const double new_ySize) {
-    // Safety checks
-    if (new_xSize <= 0 || new_ySize <= 0 || new_xSize > 5000 || new_ySize > 5000) {
-        printf("Resize rejected: invalid dimensions %.0fx%.0f\n", new_xSize, new_ySize);
-        return;
-    }
-    
-    m_xSize = new_xSize;
-    m_ySize = new_ySize;
-    
-    // Cache integer versions
-    m_intXSize = static_cast<int>(new_xSize);
-    m_intYSize = static_cast<int>(new_ySize);
-    
-    // Resize pixel array
-    m_pixels.clear();
-    m_pixels.resize(m_intXSize * m_intYSize);
-    
-    // Don't recreate texture here - let display() handle it
-}
\ No newline at end of file
@@ -0,0 +1,168 @@
+#include "geometry/instance.hpp"
+#include <algorithm>
+
+// Single-precision candidates from the SIMD kernel, confirmed in double
+template<class ConfirmFunction>
+static bool test_run(const BLAS& blas, uint32_t first, uint32_t count, const RayF& ray, double t_min, const double& t_max,
+                     const ConfirmFunction& confirm) {
+    bool hit = false;
+    for (uint32_t chunk = 0; chunk < count; chunk += 32) {
+        uint32_t n = std::min<uint32_t>(32, count - chunk);
+        uint32_t mask = triangle_candidates_soa(blas.triangles, first + chunk, n, ray, t_min, t_max);
+        for (; mask != 0; mask &= mask - 1) {
+            if (confirm(blas.wide.prim_indices[first + chunk + __builtin_ctz(mask)])) hit = true;
+        }
+    }
+    return hit;
+}
+
+bool BLAS::intersect(const Ray& object_ray, double t_min, double t_max, HitRecord& rec) const {
+    int hit_triangle = -1;
+    double hit_u = 0.0, hit_v = 0.0;
+
+    auto leaf = [&](uint32_t triangle, double& closest) {
+        double t, u, v;
+        if (intersect_triangle(triangle, object_ray, t_min, closest, t, u, v)) {
+            closest = t;
+            hit_triangle = static_cast<int>(triangle);
+            hit_u = u;
+            hit_v = v;
+            return true;
+        }
+        return false;
+    };
+    if (!triangles.empty()) {
+        RayF ray(object_ray);
+        wide.traverse_runs(object_ray, t_min, t_max, [&](uint32_t first, uint32_t count, double& closest) {
+            return test_run(*this, first, count, ray, t_min, closest, [&](uint32_t triangle) { return leaf(triangle, closest); });
+        });
+    } else if (!wide.empty()) {
+        wide.traverse(object_ray, t_min, t_max, leaf);
+    } else if (lazy) {
+        lazy->traverse(object_ray, t_min, t_max, leaf);
+    } else {
+        bvh.traverse(object_ray, t_min, t_max, leaf);
+    }
+
+    if (hit_triangle < 0) return false;
+
+    rec.t = t_max;
+    rec.u = hit_u;
+    rec.v = hit_v;
+    rec.prim_id = hit_triangle;
+    return true;
+}
+
+bool BLAS::occluded(const Ray& object_ray, double t_min, double t_max) const {
+    auto blocks = [&](uint32_t triangle) {
+        double t, u, v;
+        return intersect_triangle(triangle, object_ray, t_min, t_max, t, u, v);
+    };
+    if (!triangles.empty()) {
+        RayF ray(object_ray);
+        return wide.traverse_any_runs(object_ray, t_min, t_max, [&](uint32_t first, uint32_t count) {
+            return test_run(*this, first, count, ray, t_min, t_max, blocks);
+        });
+    }
+    if (!wide.empty()) return wide.traverse_any(object_ray, t_min, t_max, blocks);
+    if (lazy) return lazy->traverse_any(object_ray, t_min, t_max, blocks);
+    return bvh.traverse_any(object_ray, t_min, t_max, blocks);
+}
+
+uint32_t BLAS::occluded_packet(const Ray* object_rays, int count, double t_min, const double* t_max, uint32_t active) const {
+    if (!triangles.empty()) {
+        RayF rays[32];
+        for (uint32_t mask = active; mask != 0; mask &= mask - 1) rays[__builtin_ctz(mask)] = RayF(object_rays[__builtin_ctz(mask)]);
+        return wide.traverse_any_packet_runs(object_rays, count, t_min, t_max, active, [&](uint32_t first, uint32_t run_count, uint32_t mask) {
+            uint32_t blocked = 0;
+            for (; mask != 0; mask &= mask - 1) {
+                int i = __builtin_ctz(mask);
+                auto blocks = [&](uint32_t triangle) {
+                    double t, u, v;
+                    return intersect_triangle(triangle, object_rays[i], t_min, t_max[i], t, u, v);
+                };
+                if (test_run(*this, first, run_count, rays[i], t_min, t_max[i], blocks)) blocked |= 1u << i;
+            }
+            return blocked;
+        });
+    }
+
+    auto blocks = [&](uint32_t triangle, uint32_t mask) {
+        uint32_t blocked = 0;
+        for (; mask != 0; mask &= mask - 1) {
+            int i = __builtin_ctz(mask);
+            double t, u, v;
+            if (intersect_triangle(triangle, object_rays[i], t_min, t_max[i], t, u, v)) blocked |= 1u << i;
+        }
+        return blocked;
+    };
+    if (!wide.empty()) return wide.traverse_any_packet(object_rays, count, t_min, t_max, active, blocks);
+    if (lazy) return lazy->traverse_any_packet(object_rays, count, t_min, t_max, active, blocks);
+    return bvh.traverse_any_packet(object_rays, count, t_min, t_max, active, blocks);
+}
+
+AABB transform_box(const Transform& xform, const AABB& box) {
+    AABB result;
+    if (box.empty()) return result;
+    for (int corner = 0; corner < 8; ++corner) {
+        point3 p((corner & 1) ? box.max.x() : box.min.x(),
+                 (corner & 2) ? box.max.y() : box.min.y(),
+                 (corner & 4) ? box.max.z() : box.min.z());
+        result.expand(xform.apply_point(p));
+    }
+    return result;
+}
+
+static std::vector<AABB> triangle_bounds(const TriangleMesh& mesh, ThreadPool* pool) {
+    std::vector<AABB> bounds(mesh.triangle_count());
+    auto compute = [&](size_t triangle, int) { bounds[triangle] = mesh.triangle_bounds(triangle); };
+    parallel_for(pool, bounds.size(), compute, 1024);
+    return bounds;
+}
+
+static std::vector<AABB> triangle_bounds(const MeshletMesh& meshlets, const std::vector<uint32_t>& ids, ThreadPool* pool) {
+    std::vector<AABB> bounds(ids.size());
+    auto compute = [&](size_t i, int) { bounds[i] = meshlets.triangle_bounds(ids[i]); };
+    parallel_for(pool, bounds.size(), compute, 1024);
+    return bounds;
+}
+
+std::shared_ptr<const BLAS> build_blas(std::shared_ptr<const TriangleMesh> mesh, ThreadPool* pool, bool use_sah) {
+    std::vector<AABB> bounds = triangle_bounds(*mesh, pool);
+
+    std::shared_ptr<BLAS> blas = std::make_shared<BLAS>();
+    blas->mesh = std::move(mesh);
+    BVH binary = use_sah ? build_bvh_binned_sah(bounds, pool) : build_bvh_lbvh(bounds, pool);
+    blas->wide = build_bvh8(binary);
+    blas->triangles.build(*blas->mesh, blas->wide.prim_indices);
+    return blas;
+}
+
+std::shared_ptr<const BLAS> build_blas_lazy(std::shared_ptr<const TriangleMesh> mesh, ThreadPool* pool, size_t subtree_size) {
+    std::shared_ptr<LazyBVH> lazy = std::make_shared<LazyBVH>();
+    lazy->build(triangle_bounds(*mesh, pool), pool, subtree_size);
+
+    std::shared_ptr<BLAS> blas = std::make_shared<BLAS>();
+    blas->mesh = std::move(mesh);
+    blas->lazy = std::move(lazy);
+    return blas;
+}
+
+std::shared_ptr<const BLAS> build_blas(std::shared_ptr<const MeshletMesh> meshlets, ThreadPool* pool, bool use_sah) {
+    // Bounds of the decoded triangles, so quantization never lets a hit escape its box
+    std::vector<uint32_t> ids = meshlets->triangle_ids();
+    std::vector<AABB> bounds = triangle_bounds(*meshlets, ids, pool);
+    BVH binary = use_sah ? build_bvh_binned_sah(bounds, pool) : build_bvh_lbvh(bounds, pool);
+
+    std::shared_ptr<BLAS> blas = std::make_shared<BLAS>();
+    blas->wide = build_bvh8(binary);
+    for (uint32_t& prim : blas->wide.prim_indices) prim = ids[prim];
+    blas->meshlets = std::move(meshlets);
+    return blas;
+}
+
+std::shared_ptr<const BLAS> build_blas_compressed(const TriangleMesh& mesh, ThreadPool* pool) {
+    std::shared_ptr<MeshletMesh> meshlets = std::make_shared<MeshletMesh>();
+    meshlets->build(mesh, pool);
+    return build_blas(std::move(meshlets), pool, true);
+}
@@ -0,0 +1,91 @@
+#include "rendering/integrator.hpp"
+#include <cmath>
+#include <limits>
+
+static const double PI = 3.14159265358979323846;
+
+template<PathKernel Trace>
+static void render_row_with(const SceneAccel& scene, const Camera& camera, int row, int start_x, int end_x,
+                            int sample, double offset_u, double offset_v, int max_depth, color* out) {
+    double pixel_spread = camera.pixel_spread_angle();
+    for (int x = start_x; x < end_x; ++x) {
+        Rng rng(pixel_seed(x, row, sample));
+        out[x - start_x] = Trace(scene, camera.get_ray(x, row, offset_u, offset_v), rng, max_depth, pixel_spread);
+    }
+}
+
+// Unoccluded fraction of cosine-weighted rays of length AO_RADIUS
+static double ambient_occlusion(const SceneAccel& scene, const HitRecord& rec, Rng& rng) {
+    // Orthonormal basis around n (Duff et al.)
+    const vec3& n = rec.normal;
+    double sign = std::copysign(1.0, n.z());
+    double a = -1.0 / (sign + n.z());
+    double c = n.x() * n.y() * a;
+    vec3 t(1.0 + sign * n.x() * n.x() * a, sign * c, -sign * n.x());
+    vec3 b(c, sign + n.y() * n.y() * a, -n.y());
+
+    int open = 0;
+    for (int i = 0; i < AO_SAMPLES; ++i) {
+        double u1 = rng.next_double();
+        double u2 = rng.next_double();
+        double r = std::sqrt(u1), phi = 2.0 * PI * u2;
+        vec3 direction = r * std::cos(phi) * t + r * std::sin(phi) * b + std::sqrt(std::max(0.0, 1.0 - u1)) * n;
+        open += !scene.occluded(Ray(rec.p, direction), AO_RADIUS);
+    }
+    return static_cast<double>(open) / AO_SAMPLES;
+}
+
+// First hit only; max_depth is ignored
+template<PreviewMode Mode>
+static color trace_preview(const SceneAccel& scene, const Ray& camera_ray, Rng& rng, int, double pixel_spread) {
+    HitRecord rec;
+    if (!scene.intersect(camera_ray, RAY_EPSILON, std::numeric_limits<double>::infinity(), rec)) {
+        return Mode == PREVIEW_AO ? color(1.0, 1.0, 1.0) : miss_radiance(scene, camera_ray, 0.0);
+    }
+    switch (Mode) {
+        case PREVIEW_NORMALS:
+            return 0.5 * (rec.normal + color(1.0, 1.0, 1.0));
+        case PREVIEW_DEPTH: {
+            double depth = 1.0 / (1.0 + rec.t * camera_ray.direction().length());
+            return color(depth, depth, depth);
+        }
+        case PREVIEW_ALBEDO:
+            return surface_albedo(scene, rec, camera_ray, RayCone(0.0, pixel_spread).at(rec.t * camera_ray.direction().length()));
+        default: {
+            double open = ambient_occlusion(scene, rec, rng);
+            return color(open, open, open);
+        }
+    }
+}
+
+// Indexed by feature mask
+static const IntegratorKernels kernel_table[INTEGRATOR_FEATURE_COMBINATIONS] = {
+    {0, PREVIEW_OFF, trace_path_features<0>, render_row_with<trace_path_features<0>>},
+    {1, PREVIEW_OFF, trace_path_features<1>, render_row_with<trace_path_features<1>>},
+    {2, PREVIEW_OFF, trace_path_features<2>, render_row_with<trace_path_features<2>>},
+    {3, PREVIEW_OFF, trace_path_features<3>, render_row_with<trace_path_features<3>>},
+};
+
+// Indexed by preview mode; the PREVIEW_OFF slot is never returned
+static const IntegratorKernels preview_table[PREVIEW_MODE_COUNT] = {
+    {0, PREVIEW_OFF, trace_path_features<0>, render_row_with<trace_path_features<0>>},
+    {0, PREVIEW_NORMALS, trace_preview<PREVIEW_NORMALS>, render_row_with<trace_preview<PREVIEW_NORMALS>>},
+    {0, PREVIEW_DEPTH, trace_preview<PREVIEW_DEPTH>, render_row_with<trace_preview<PREVIEW_DEPTH>>},
+    {0, PREVIEW_ALBEDO, trace_preview<PREVIEW_ALBEDO>, render_row_with<trace_preview<PREVIEW_ALBEDO>>},
+    {0, PREVIEW_AO, trace_preview<PREVIEW_AO>, render_row_with<trace_preview<PREVIEW_AO>>},
+};
+
+const IntegratorKernels& select_integrator(unsigned features, PreviewMode preview) {
+    if (preview > PREVIEW_OFF && preview < PREVIEW_MODE_COUNT) return preview_table[preview];
+    return kernel_table[features & (INTEGRATOR_FEATURE_COMBINATIONS - 1)];
+}
+
+const char* integrator_name(unsigned features) {
+    static const char* names[INTEGRATOR_FEATURE_COMBINATIONS] = {"plain", "roulette", "clamp", "roulette+clamp"};
+    return names[features & (INTEGRATOR_FEATURE_COMBINATIONS - 1)];
+}
+
+const char* preview_name(PreviewMode preview) {
+    static const char* names[PREVIEW_MODE_COUNT] = {"off", "normals", "depth", "albedo", "ambient occlusion"};
+    return preview >= PREVIEW_OFF && preview < PREVIEW_MODE_COUNT ? names[preview] : "off";
+}
@@ -0,0 +1,74 @@
+#include "geometry/lazy_bvh.hpp"
+#include <algorithm>
+#include <numeric>
+
+namespace {
+
+void split_groups(std::vector<uint32_t>& prims, const std::vector<AABB>& bounds, uint32_t first, uint32_t count,
+                  size_t group_size, std::vector<PrimGroup>& groups) {
+    AABB box, centroids;
+    for (uint32_t i = first; i < first + count; ++i) {
+        box.expand(bounds[prims[i]]);
+        centroids.expand(bounds[prims[i]].centroid());
+    }
+    if (count <= group_size) {
+        groups.push_back(PrimGroup{first, count, box});
+        return;
+    }
+
+    int axis = centroids.largest_axis();
+    uint32_t half = count / 2;
+    std::nth_element(prims.begin() + first, prims.begin() + first + half, prims.begin() + first + count,
+                     [&](uint32_t a, uint32_t b) { return bounds[a].centroid()[axis] < bounds[b].centroid()[axis]; });
+    split_groups(prims, bounds, first, half, group_size, groups);
+    split_groups(prims, bounds, first + half, count - half, group_size, groups);
+}
+
+}
+
+std::vector<PrimGroup> split_into_groups(const std::vector<AABB>& prim_bounds, size_t group_size, std::vector<uint32_t>& order) {
+    order.resize(prim_bounds.size());
+    std::iota(order.begin(), order.end(), 0u);
+    std::vector<PrimGroup> groups;
+    if (!order.empty()) {
+        split_groups(order, prim_bounds, 0, static_cast<uint32_t>(order.size()), std::max<size_t>(group_size, 1), groups);
+    }
+    return groups;
+}
+
+void LazyBVH::build(std::vector<AABB> prim_bounds, ThreadPool* pool, size_t subtree_size) {
+    bounds_by_prim = std::move(prim_bounds);
+    std::vector<PrimGroup> groups = split_into_groups(bounds_by_prim, subtree_size, prims);
+
+    subtree_count = groups.size();
+    subtrees.reset(new Subtree[subtree_count]);
+    built_count.store(0, std::memory_order_relaxed);
+    std::vector<AABB> group_bounds(groups.size());
+    for (size_t g = 0; g < groups.size(); ++g) {
+        subtrees[g].first = groups[g].first;
+        subtrees[g].count = groups[g].count;
+        subtrees[g].bvh.store(nullptr, std::memory_order_relaxed);
+        group_bounds[g] = groups[g].bounds;
+    }
+    top = build_bvh_binned_sah(group_bounds, pool, 1);
+}
+
+const BVH& LazyBVH::ensure(uint32_t group) const {
+    Subtree& subtree = subtrees[group];
+    const BVH* bvh = subtree.bvh.load(std::memory_order_acquire);
+    if (bvh != nullptr) return *bvh;
+
+    std::call_once(subtree.once, [&]() {
+        std::vector<AABB> local(subtree.count);
+        for (uint32_t i = 0; i < subtree.count; ++i) local[i] = bounds_by_prim[prims[subtree.first + i]];
+        // Called from render workers, where a nested pool job would run serially anyway
+        subtree.storage.reset(new BVH(build_bvh_binned_sah(local, nullptr)));
+        subtree.bvh.store(subtree.storage.get(), std::memory_order_release);
+        built_count.fetch_add(1, std::memory_order_relaxed);
+    });
+    return *subtree.bvh.load(std::memory_order_acquire);
+}
+
+void LazyBVH::build_all(ThreadPool* pool) const {
+    parallel_for(pool, subtree_count, [&](size_t g, int) { ensure(static_cast<uint32_t>(g)); });
+}
@@ -1,7 +1,35 @@
 #include "core/app.hpp"
+#include "geometry/paged_mesh.hpp"
+#include "rendering/environment.hpp"
+#include "rendering/texture_cache.hpp"
+#include <cstring>
+#include <string>
+#include <vector>
 
 int main(int argc,char* argv[]){
 
+    // raytracer --page model.ply [model.ply.paged] converts and exits
+    if (argc > 2 && std::strcmp(argv[1], "--page") == 0) {
+        std::string output = argc > 3 ? argv[3] : std::string(argv[2]) + ".paged";
+        ThreadPool pool;
+        if (!page_mesh_file(argv[2], output.c_str(), DEFAULT_CLUSTER_TRIANGLES, &pool)) return 1;
+        printf("Wrote %s\n", output.c_str());
+        return 0;
+    }
+
+    // raytracer --tile image.hdr [image.hdr.rttex] writes a tiled texture and exits
+    if (argc > 2 && std::strcmp(argv[1], "--tile") == 0) {
+        std::string output = argc > 3 ? argv[3] : std::string(argv[2]) + ".rttex";
+        int width, height;
+        std::vector<float> rgb;
+        if (!read_hdr_image(argv[2], width, height, rgb) || !write_tiled_texture(output.c_str(), width, height, rgb.data())) return 1;
+        printf("Wrote %s\n", output.c_str());
+        return 0;
+    }
+
     APP theapp;
+    if (argc > 1) theapp.set_mesh_path(argv[1]);
+    if (argc > 2) theapp.set_environment_path(argv[2]);
+    if (argc > 3) theapp.set_texture_path(argv[3]);
     return theapp.onexecute();
 }
\ No newline at end of file
@@ -0,0 +1,56 @@
+#include "core/mapped_file.hpp"
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+MappedFile::MappedFile() : bytes(nullptr), length(0), opened(false) {}
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+bool MappedFile::open(const char* path) {
+    close();
+
+    int fd = ::open(path, O_RDONLY);
+    if (fd < 0) {
+        printf("Cannot open %s: %s\n", path, strerror(errno));
+        return false;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+        printf("Cannot stat %s: %s\n", path, strerror(errno));
+        ::close(fd);
+        return false;
+    }
+
+    // mmap rejects empty files; an empty mapping is still a valid open
+    length = static_cast<size_t>(info.st_size);
+    if (length > 0) {
+        void* mapping = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapping == MAP_FAILED) {
+            printf("Cannot map %s: %s\n", path, strerror(errno));
+            ::close(fd);
+            length = 0;
+            return false;
+        }
+        // Chunks are read concurrently from everywhere in the file
+        madvise(mapping, length, MADV_WILLNEED);
+        bytes = static_cast<const char*>(mapping);
+    }
+    ::close(fd);
+    opened = true;
+    return true;
+}
+
+void MappedFile::close() {
+    if (bytes != nullptr) munmap(const_cast<char*>(bytes), length);
+    bytes = nullptr;
+    length = 0;
+    opened = false;
+}
@@ -0,0 +1,122 @@
+#include "rendering/material.hpp"
+#include <algorithm>
+#include <cmath>
+
+static const double PI = 3.14159265358979323846;
+
+int material_bounce_randoms(MaterialType type) {
+    return type == MATERIAL_METAL ? 3 : 2;
+}
+
+bool material_samples_light(MaterialType type) {
+    return type == MATERIAL_DIFFUSE;
+}
+
+// Lambertian: the light sample's contribution, MIS-weighted against the
+// bounce unless the light is a delta, then a cosine-weighted bounce whose
+// cos / pdf cancels the 1/pi and leaves the albedo
+static void shade_diffuse(const Material&, ShadingBatch& b) {
+    const size_t n = b.count;
+    const bool delta_light = b.delta_light;
+
+    for (size_t i = 0; i < n; ++i) {
+        double cos_light = b.nx[i] * b.lx[i] + b.ny[i] * b.ly[i] + b.nz[i] * b.lz[i];
+        double factor;
+        if (delta_light) {
+            // Lambertian BRDF against a delta light: albedo / pi * E * cos
+            factor = cos_light > 0.0 ? cos_light / PI : 0.0;
+        } else {
+            double light_pdf = b.light_pdf[i] > 0.0 ? b.light_pdf[i] : 1.0;
+            double bounce_pdf = cos_light / PI;
+            double weight = light_pdf * light_pdf / (light_pdf * light_pdf + bounce_pdf * bounce_pdf);
+            factor = (cos_light > 0.0) & (b.light_pdf[i] > 0.0) ? cos_light / PI * weight / light_pdf : 0.0;
+        }
+        b.cr[i] = b.tr[i] * b.ar[i] * b.lr[i] * factor;
+        b.cg[i] = b.tg[i] * b.ag[i] * b.lg[i] * factor;
+        b.cb[i] = b.tb[i] * b.ab[i] * b.lb[i] * factor;
+    }
+
+    // Flags in their own pass; mixing byte and double lanes blocks vectorization
+    for (size_t i = 0; i < n; ++i) {
+        double cos_light = b.nx[i] * b.lx[i] + b.ny[i] * b.ly[i] + b.nz[i] * b.lz[i];
+        bool shadow = cos_light > 0.0 && (delta_light || b.light_pdf[i] > 0.0);
+        b.flags[i] = static_cast<uint8_t>(SCATTER_CONTINUE | (shadow ? SCATTER_SHADOW : 0));
+    }
+
+    for (size_t i = 0; i < n; ++i) {
+        // Orthonormal basis around n (Duff et al.)
+        double sign = std::copysign(1.0, b.nz[i]);
+        double a = -1.0 / (sign + b.nz[i]);
+        double c = b.nx[i] * b.ny[i] * a;
+        double tx = 1.0 + sign * b.nx[i] * b.nx[i] * a, ty = sign * c, tz = -sign * b.nx[i];
+        double bx = c, by = sign + b.ny[i] * b.ny[i] * a, bz = -b.ny[i];
+
+        double r = std::sqrt(b.u1[i]);
+        double phi = 2.0 * PI * b.u2[i];
+        double cos_bounce = std::sqrt(std::max(0.0, 1.0 - b.u1[i]));
+        // Sine from the cosine: sin and cos together become a sincos call
+        // that does not vectorize
+        double cos_phi = std::cos(phi);
+        double sin_phi = std::copysign(std::sqrt(std::max(0.0, 1.0 - cos_phi * cos_phi)), 0.5 - b.u2[i]);
+        double s = r * sin_phi, k = r * cos_phi;
+        b.dx[i] = k * tx + s * bx + cos_bounce * b.nx[i];
+        b.dy[i] = k * ty + s * by + cos_bounce * b.ny[i];
+        b.dz[i] = k * tz + s * bz + cos_bounce * b.nz[i];
+        b.pdf[i] = cos_bounce / PI;
+        b.tr[i] *= b.ar[i];
+        b.tg[i] *= b.ag[i];
+        b.tb[i] *= b.ab[i];
+    }
+}
+
+// Mirror reflection plus a point drawn uniformly in a sphere of radius fuzz.
+// Reflections pushed below the surface are absorbed. The density is not
+// tracked, so environment hits after a metal bounce count in full.
+static void shade_metal(const Material& material, ShadingBatch& b) {
+    const size_t n = b.count;
+    const double fuzz = material.fuzz;
+
+    for (size_t i = 0; i < n; ++i) {
+        double inv_length = 1.0 / std::sqrt(b.dx[i] * b.dx[i] + b.dy[i] * b.dy[i] + b.dz[i] * b.dz[i]);
+        double dx = b.dx[i] * inv_length, dy = b.dy[i] * inv_length, dz = b.dz[i] * inv_length;
+        double d_n = 2.0 * (dx * b.nx[i] + dy * b.ny[i] + dz * b.nz[i]);
+
+        double z = 1.0 - 2.0 * b.u1[i];
+        double ring = std::sqrt(std::max(0.0, 1.0 - z * z));
+        double phi = 2.0 * PI * b.u2[i];
+        double cos_phi = std::cos(phi);
+        double sin_phi = std::copysign(std::sqrt(std::max(0.0, 1.0 - cos_phi * cos_phi)), 0.5 - b.u2[i]);
+        double radius = fuzz * std::cbrt(b.u3[i]);
+
+        double ox = dx - d_n * b.nx[i] + radius * ring * cos_phi;
+        double oy = dy - d_n * b.ny[i] + radius * ring * sin_phi;
+        double oz = dz - d_n * b.nz[i] + radius * z;
+        b.dx[i] = ox;
+        b.dy[i] = oy;
+        b.dz[i] = oz;
+        b.pdf[i] = 0.0;
+        b.cr[i] = 0.0;
+        b.cg[i] = 0.0;
+        b.cb[i] = 0.0;
+        b.tr[i] *= b.ar[i];
+        b.tg[i] *= b.ag[i];
+        b.tb[i] *= b.ab[i];
+    }
+
+    // Reflections pushed below the surface stop; flags in their own pass
+    for (size_t i = 0; i < n; ++i) {
+        bool above = b.dx[i] * b.nx[i] + b.dy[i] * b.ny[i] + b.dz[i] * b.nz[i] > 0.0;
+        b.flags[i] = above ? SCATTER_CONTINUE : 0;
+    }
+}
+
+void shade_batch(const Material& material, ShadingBatch& batch) {
+    switch (material.type) {
+        case MATERIAL_METAL:
+            shade_metal(material, batch);
+            break;
+        default:
+            shade_diffuse(material, batch);
+            break;
+    }
+}
@@ -0,0 +1,821 @@
+#include "geometry/mesh_loader.hpp"
+#include "core/mapped_file.hpp"
+#include <algorithm>
+#include <string>
+#include <cstring>
+#include <cstdio>
+#include <cmath>
+
+namespace {
+
+inline bool is_space(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+inline bool is_digit(char c) { return c >= '0' && c <= '9'; }
+
+inline const char* skip_spaces(const char* p, const char* end) {
+    while (p < end && is_space(*p)) ++p;
+    return p;
+}
+
+inline const char* skip_token(const char* p, const char* end) {
+    while (p < end && !is_space(*p)) ++p;
+    return p;
+}
+
+inline const char* line_end(const char* p, const char* end) {
+    const char* newline = static_cast<const char*>(std::memchr(p, '\n', end - p));
+    return newline != nullptr ? newline : end;
+}
+
+inline const char* next_line(const char* eol, const char* end) {
+    return eol < end ? eol + 1 : end;
+}
+
+// Signed decimal integer; nullptr if there are no digits
+const char* parse_integer(const char* p, const char* end, long long& value) {
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+')) negative = *p++ == '-';
+    if (p == end || !is_digit(*p)) return nullptr;
+    long long result = 0;
+    while (p < end && is_digit(*p)) result = result * 10 + (*p++ - '0');
+    value = negative ? -result : result;
+    return p;
+}
+
+// A run of whole lines, parsed by one task
+struct TextChunk {
+    const char* begin;
+    const char* end;
+    size_t first_line;
+    size_t lines;
+    size_t vertices;
+    size_t triangles;
+    size_t texcoords;  // OBJ vt lines
+    size_t vertex_offset;
+    size_t triangle_offset;
+    size_t texcoord_offset;
+    const char* error;
+};
+
+// Splits [begin, end) into chunks of about chunk_bytes ending on line breaks
+std::vector<TextChunk> split_lines(const char* begin, const char* end, size_t chunk_bytes) {
+    std::vector<TextChunk> chunks;
+    chunk_bytes = std::max<size_t>(chunk_bytes, 1);
+    for (const char* p = begin; p < end;) {
+        const char* stop = p + std::min<size_t>(chunk_bytes, end - p);
+        if (stop < end) stop = next_line(line_end(stop, end), end);
+        chunks.push_back(TextChunk{p, stop, 0, 0, 0, 0, 0, 0, 0, 0, nullptr});
+        p = stop;
+    }
+    return chunks;
+}
+
+// Running sums of per-chunk counts into offsets; returns the totals
+void prefix_offsets(std::vector<TextChunk>& chunks, size_t& vertices, size_t& triangles) {
+    vertices = 0;
+    triangles = 0;
+    for (TextChunk& chunk : chunks) {
+        chunk.vertex_offset = vertices;
+        chunk.triangle_offset = triangles;
+        vertices += chunk.vertices;
+        triangles += chunk.triangles;
+    }
+}
+
+const char* first_error(const std::vector<TextChunk>& chunks) {
+    for (const TextChunk& chunk : chunks) {
+        if (chunk.error != nullptr) return chunk.error;
+    }
+    return nullptr;
+}
+
+// OBJ --------------------------------------------------------------------
+
+// No texture coordinate on a face corner
+const uint32_t NO_TEXCOORD = UINT32_MAX;
+
+// 'v', 'f' and 't' for vertex, face and texture coordinate (vt) lines, 0 for anything else
+inline char obj_keyword(const char* p, const char* eol) {
+    if (eol - p >= 3 && p[0] == 'v' && p[1] == 't' && is_space(p[2])) return 't';
+    if (eol - p < 2 || !is_space(p[1])) return 0;
+    return (p[0] == 'v' || p[0] == 'f') ? p[0] : 0;
+}
+
+void count_obj_chunk(TextChunk& chunk) {
+    for (const char* line = chunk.begin; line < chunk.end;) {
+        const char* eol = line_end(line, chunk.end);
+        const char* p = skip_spaces(line, eol);
+        char keyword = obj_keyword(p, eol);
+        if (keyword == 'v') {
+            chunk.vertices++;
+        } else if (keyword == 't') {
+            chunk.texcoords++;
+        } else if (keyword == 'f') {
+            size_t corners = 0;
+            for (p = skip_spaces(p + 1, eol); p < eol; p = skip_spaces(skip_token(p, eol), eol)) corners++;
+            if (corners >= 3) chunk.triangles += corners - 2;
+        }
+        line = next_line(eol, chunk.end);
+    }
+}
+
+// 1-based OBJ index, negative counting back from the count read so far
+inline const char* parse_obj_index(const char* p, const char* eol, size_t before, size_t total, uint32_t& index) {
+    long long value;
+    const char* next = parse_integer(p, eol, value);
+    if (next == nullptr || value == 0) return nullptr;
+    long long resolved = value > 0 ? value - 1 : static_cast<long long>(before) + value;
+    if (resolved < 0 || resolved >= static_cast<long long>(total)) return nullptr;
+    index = static_cast<uint32_t>(resolved);
+    return next;
+}
+
+// One face corner "v", "v/vt", "v//vn" or "v/vt/vn"; texcoord is
+// NO_TEXCOORD without a vt
+inline const char* parse_obj_corner(const char* p, const char* eol, size_t vertices_before, size_t vertex_total,
+                                    size_t texcoords_before, size_t texcoord_total, uint32_t& index, uint32_t& texcoord) {
+    p = parse_obj_index(p, eol, vertices_before, vertex_total, index);
+    if (p == nullptr) return nullptr;
+    texcoord = NO_TEXCOORD;
+    if (p + 1 < eol && p[0] == '/' && p[1] != '/' && !is_space(p[1])) {
+        p = parse_obj_index(p + 1, eol, texcoords_before, texcoord_total, texcoord);
+        if (p == nullptr) return nullptr;
+    }
+    return skip_token(p, eol);
+}
+
+// texcoords receives the vt lines and corner_texcoords the vt of every
+// index; both are empty when the file has no vt lines
+void parse_obj_chunk(TextChunk& chunk, TriangleMesh& mesh, size_t vertex_total, std::vector<float>& texcoords,
+                     std::vector<uint32_t>& corner_texcoords) {
+    float* positions = mesh.positions.data() + 3 * chunk.vertex_offset;
+    uint32_t* indices = mesh.indices.data() + 3 * chunk.triangle_offset;
+    size_t texcoord_total = texcoords.size() / 2;
+    float* uv = texcoords.data() + 2 * chunk.texcoord_offset;
+    uint32_t* corner_uv = texcoord_total > 0 ? corner_texcoords.data() + 3 * chunk.triangle_offset : nullptr;
+    size_t vertices = 0, texcoords_read = 0;
+
+    for (const char* line = chunk.begin; line < chunk.end;) {
+        const char* eol = line_end(line, chunk.end);
+        const char* p = skip_spaces(line, eol);
+        char keyword = obj_keyword(p, eol);
+        if (keyword == 'v') {
+            ++p;
+            for (int a = 0; a < 3; ++a) {
+                p = parse_float(skip_spaces(p, eol), eol, positions[a]);
+                if (p == nullptr) {
+                    chunk.error = "malformed vertex";
+                    return;
+                }
+            }
+            positions += 3;
+            vertices++;
+        } else if (keyword == 't') {
+            // u required, v optional, w ignored
+            p = parse_float(skip_spaces(p + 2, eol), eol, uv[0]);
+            if (p == nullptr) {
+                chunk.error = "malformed texture coordinate";
+                return;
+            }
+            const char* after_u = skip_spaces(p, eol);
+            if (after_u == eol || parse_float(after_u, eol, uv[1]) == nullptr) uv[1] = 0.0f;
+            uv += 2;
+            texcoords_read++;
+        } else if (keyword == 'f') {
+            size_t before = chunk.vertex_offset + vertices;
+            size_t texcoords_before = chunk.texcoord_offset + texcoords_read;
+            uint32_t first = 0, previous = 0, current = 0;
+            uint32_t first_uv = NO_TEXCOORD, previous_uv = NO_TEXCOORD, current_uv = NO_TEXCOORD;
+            int corner = 0;
+            for (p = skip_spaces(p + 1, eol); p < eol; p = skip_spaces(p, eol)) {
+                p = parse_obj_corner(p, eol, before, vertex_total, texcoords_before, texcoord_total, current, current_uv);
+                if (p == nullptr) {
+                    chunk.error = "bad face index";
+                    return;
+                }
+                if (corner == 0) {
+                    first = current;
+                    first_uv = current_uv;
+                }
+                if (corner >= 2) {
+                    indices[0] = first;
+                    indices[1] = previous;
+                    indices[2] = current;
+                    indices += 3;
+                    if (corner_uv != nullptr) {
+                        corner_uv[0] = first_uv;
+                        corner_uv[1] = previous_uv;
+                        corner_uv[2] = current_uv;
+                        corner_uv += 3;
+                    }
+                }
+                previous = current;
+                previous_uv = current_uv;
+                corner++;
+            }
+        }
+        line = next_line(eol, chunk.end);
+    }
+}
+
+// PLY --------------------------------------------------------------------
+
+enum PlyType { PLY_INT8, PLY_UINT8, PLY_INT16, PLY_UINT16, PLY_INT32, PLY_UINT32, PLY_FLOAT32, PLY_FLOAT64, PLY_INVALID };
+enum PlyFormat { PLY_ASCII, PLY_BINARY_LE, PLY_BINARY_BE };
+
+struct PlyProperty {
+    std::string name;
+    PlyType type;        // Value type, or element type of a list
+    PlyType count_type;  // PLY_INVALID for scalars
+};
+
+struct PlyElement {
+    std::string name;
+    size_t count;
+    std::vector<PlyProperty> properties;
+};
+
+PlyType ply_type(const std::string& name) {
+    static const char* names[][2] = {{"char", "int8"}, {"uchar", "uint8"}, {"short", "int16"}, {"ushort", "uint16"},
+                                     {"int", "int32"}, {"uint", "uint32"}, {"float", "float32"}, {"double", "float64"}};
+    for (int t = 0; t < PLY_INVALID; ++t) {
+        if (name == names[t][0] || name == names[t][1]) return static_cast<PlyType>(t);
+    }
+    return PLY_INVALID;
+}
+
+inline size_t ply_size(PlyType type) {
+    static const size_t sizes[] = {1, 1, 2, 2, 4, 4, 4, 8};
+    return sizes[type];
+}
+
+inline double read_binary(PlyType type, const char* p, bool swap) {
+    // Bytes are copied one at a time, reversed for the other endianness
+    unsigned char raw[8];
+    size_t size = ply_size(type);
+    for (size_t i = 0; i < size; ++i) raw[i] = static_cast<unsigned char>(p[swap ? size - 1 - i : i]);
+    switch (type) {
+        case PLY_INT8: { int8_t v; std::memcpy(&v, raw, 1); return v; }
+        case PLY_UINT8: return raw[0];
+        case PLY_INT16: { int16_t v; std::memcpy(&v, raw, 2); return v; }
+        case PLY_UINT16: { uint16_t v; std::memcpy(&v, raw, 2); return v; }
+        case PLY_INT32: { int32_t v; std::memcpy(&v, raw, 4); return v; }
+        case PLY_UINT32: { uint32_t v; std::memcpy(&v, raw, 4); return v; }
+        case PLY_FLOAT32: { float v; std::memcpy(&v, raw, 4); return v; }
+        default: { double v; std::memcpy(&v, raw, 8); return v; }
+    }
+}
+
+int find_property(const PlyElement& element, const char* name) {
+    for (size_t i = 0; i < element.properties.size(); ++i) {
+        if (element.properties[i].name == name) return static_cast<int>(i);
+    }
+    return -1;
+}
+
+// Fills format and elements; returns the first body byte or nullptr
+const char* parse_ply_header(const char* data, const char* end, PlyFormat& format, std::vector<PlyElement>& elements) {
+    const char* line = data;
+    const char* eol = line_end(line, end);
+    if (std::string(line, skip_token(line, eol)) != "ply") {
+        printf("PLY: missing magic\n");
+        return nullptr;
+    }
+
+    bool have_format = false;
+    for (line = next_line(eol, end); line < end; line = next_line(eol, end)) {
+        eol = line_end(line, end);
+        std::vector<std::string> words;
+        for (const char* p = skip_spaces(line, eol); p < eol; p = skip_spaces(p, eol)) {
+            const char* stop = skip_token(p, eol);
+            words.push_back(std::string(p, stop));
+            p = stop;
+        }
+        if (words.empty() || words[0] == "comment" || words[0] == "obj_info") continue;
+
+        if (words[0] == "end_header") {
+            if (!have_format) printf("PLY: missing format line\n");
+            return have_format ? next_line(eol, end) : nullptr;
+        } else if (words[0] == "format" && words.size() >= 2) {
+            have_format = true;
+            if (words[1] == "ascii") format = PLY_ASCII;
+            else if (words[1] == "binary_little_endian") format = PLY_BINARY_LE;
+            else if (words[1] == "binary_big_endian") format = PLY_BINARY_BE;
+            else have_format = false;
+        } else if (words[0] == "element" && words.size() == 3) {
+            elements.push_back(PlyElement{words[1], static_cast<size_t>(std::strtoull(words[2].c_str(), nullptr, 10)), {}});
+        } else if (words[0] == "property" && !elements.empty()) {
+            PlyProperty property{words.back(), PLY_INVALID, PLY_INVALID};
+            if (words.size() == 5 && words[1] == "list") {
+                property.count_type = ply_type(words[2]);
+                property.type = ply_type(words[3]);
+                if (property.count_type == PLY_INVALID) property.type = PLY_INVALID;
+            } else if (words.size() == 3) {
+                property.type = ply_type(words[1]);
+            }
+            if (property.type == PLY_INVALID) {
+                printf("PLY: unsupported property '%s'\n", std::string(line, eol).c_str());
+                return nullptr;
+            }
+            elements.back().properties.push_back(property);
+        } else {
+            printf("PLY: unexpected header line '%s'\n", std::string(line, eol).c_str());
+            return nullptr;
+        }
+    }
+    printf("PLY: missing end_header\n");
+    return nullptr;
+}
+
+// Where the mesh lives in the element list
+struct PlyLayout {
+    int vertex_element = -1;
+    int face_element = -1;
+    int xyz[3] = {-1, -1, -1};
+    int uv[2] = {-1, -1};  // Texture coordinates, both or neither
+    int index_list = -1;
+};
+
+bool find_layout(const std::vector<PlyElement>& elements, PlyLayout& layout) {
+    for (size_t e = 0; e < elements.size(); ++e) {
+        if (elements[e].name == "vertex") layout.vertex_element = static_cast<int>(e);
+        if (elements[e].name == "face") layout.face_element = static_cast<int>(e);
+    }
+    if (layout.vertex_element < 0) {
+        printf("PLY: no vertex element\n");
+        return false;
+    }
+    const PlyElement& vertex = elements[layout.vertex_element];
+    for (const PlyProperty& property : vertex.properties) {
+        if (property.count_type != PLY_INVALID) {
+            printf("PLY: list properties on vertices are not supported\n");
+            return false;
+        }
+    }
+    const char* axes[3] = {"x", "y", "z"};
+    for (int a = 0; a < 3; ++a) {
+        layout.xyz[a] = find_property(vertex, axes[a]);
+        if (layout.xyz[a] < 0) {
+            printf("PLY: vertex has no '%s'\n", axes[a]);
+            return false;
+        }
+    }
+    const char* uv_names[][2] = {{"u", "v"}, {"s", "t"}, {"texture_u", "texture_v"}, {"texture_s", "texture_t"}};
+    for (const auto& names : uv_names) {
+        if (layout.uv[0] >= 0) break;
+        layout.uv[0] = find_property(vertex, names[0]);
+        layout.uv[1] = find_property(vertex, names[1]);
+        if (layout.uv[1] < 0) layout.uv[0] = -1;
+    }
+    if (layout.face_element >= 0) {
+        const PlyElement& face = elements[layout.face_element];
+        layout.index_list = find_property(face, "vertex_indices");
+        if (layout.index_list < 0) layout.index_list = find_property(face, "vertex_index");
+        if (layout.index_list < 0 || face.properties[layout.index_list].count_type == PLY_INVALID) {
+            printf("PLY: face has no vertex index list\n");
+            return false;
+        }
+    }
+    return true;
+}
+
+inline void emit_fan(uint32_t*& out, const uint32_t* corners, size_t count) {
+    for (size_t k = 2; k < count; ++k) {
+        out[0] = corners[0];
+        out[1] = corners[k - 1];
+        out[2] = corners[k];
+        out += 3;
+    }
+}
+
+// Faces with more corners than this are rejected
+const size_t MAX_FACE_CORNERS = 256;
+
+// Binary bodies: fixed-stride elements decode in parallel directly; faces
+// are first walked serially to find block offsets, since lists make their
+// records variable length
+struct FaceBlock {
+    const char* begin;
+    size_t first_face;
+    size_t triangle_offset;
+};
+
+const size_t VERTEX_BLOCK = 65536;
+const size_t FACE_BLOCK = 16384;
+
+// Walks one record; returns its end, or nullptr past end
+inline const char* skip_binary_record(const PlyElement& element, const char* p, const char* end, bool swap,
+                                      int list_property, size_t& list_count) {
+    for (size_t i = 0; i < element.properties.size(); ++i) {
+        const PlyProperty& property = element.properties[i];
+        if (property.count_type == PLY_INVALID) {
+            p += ply_size(property.type);
+        } else {
+            if (static_cast<size_t>(end - p) < ply_size(property.count_type)) return nullptr;
+            double count = read_binary(property.count_type, p, swap);
+            if (count < 0.0) return nullptr;
+            size_t n = static_cast<size_t>(count);
+            if (static_cast<int>(i) == list_property) list_count = n;
+            p += ply_size(property.count_type) + n * ply_size(property.type);
+        }
+        if (p > end) return nullptr;
+    }
+    return p;
+}
+
+bool parse_ply_binary(const char* body, const char* end, bool swap, const std::vector<PlyElement>& elements,
+                      const PlyLayout& layout, TriangleMesh& mesh, ThreadPool* pool) {
+    const char* p = body;
+    for (size_t e = 0; e < elements.size(); ++e) {
+        const PlyElement& element = elements[e];
+        bool fixed = true;
+        size_t stride = 0;
+        for (const PlyProperty& property : element.properties) {
+            fixed = fixed && property.count_type == PLY_INVALID;
+            stride += ply_size(property.type);
+        }
+
+        if (static_cast<int>(e) == layout.vertex_element) {
+            if (static_cast<size_t>(end - p) / std::max<size_t>(stride, 1) < element.count) {
+                printf("PLY: truncated vertex data\n");
+                return false;
+            }
+            // x, y, z, then u, v if present
+            int columns[5] = {layout.xyz[0], layout.xyz[1], layout.xyz[2], layout.uv[0], layout.uv[1]};
+            int column_count = layout.uv[0] >= 0 ? 5 : 3;
+            size_t offsets[5];
+            PlyType types[5];
+            for (int a = 0; a < column_count; ++a) {
+                offsets[a] = 0;
+                for (int i = 0; i < columns[a]; ++i) offsets[a] += ply_size(element.properties[i].type);
+                types[a] = element.properties[columns[a]].type;
+            }
+            mesh.positions.resize(3 * element.count);
+            if (column_count == 5) mesh.uvs.resize(2 * element.count);
+            const char* vertices = p;
+            size_t blocks = (element.count + VERTEX_BLOCK - 1) / VERTEX_BLOCK;
+            parallel_for(pool, blocks, [&](size_t block, int) {
+                size_t last = std::min(element.count, (block + 1) * VERTEX_BLOCK);
+                for (size_t v = block * VERTEX_BLOCK; v < last; ++v) {
+                    const char* record = vertices + v * stride;
+                    for (int a = 0; a < 3; ++a) {
+                        mesh.positions[3 * v + a] = static_cast<float>(read_binary(types[a], record + offsets[a], swap));
+                    }
+                    if (column_count == 5) {
+                        mesh.uvs[2 * v] = static_cast<float>(read_binary(types[3], record + offsets[3], swap));
+                        mesh.uvs[2 * v + 1] = 1.0f - static_cast<float>(read_binary(types[4], record + offsets[4], swap));
+                    }
+                }
+            });
+            p += element.count * stride;
+        } else if (static_cast<int>(e) == layout.face_element) {
+            std::vector<FaceBlock> blocks;
+            size_t triangles = 0;
+            for (size_t f = 0; f < element.count; ++f) {
+                if (f % FACE_BLOCK == 0) blocks.push_back(FaceBlock{p, f, triangles});
+                size_t corners = 0;
+                p = skip_binary_record(element, p, end, swap, layout.index_list, corners);
+                if (p == nullptr) {
+                    printf("PLY: truncated face data\n");
+                    return false;
+                }
+                if (corners > MAX_FACE_CORNERS) {
+                    printf("PLY: face with more than %zu corners\n", MAX_FACE_CORNERS);
+                    return false;
+                }
+                if (corners >= 3) triangles += corners - 2;
+            }
+
+            mesh.indices.resize(3 * triangles);
+            const PlyProperty& list = element.properties[layout.index_list];
+            size_t vertex_total = elements[layout.vertex_element].count;
+            std::vector<uint8_t> bad(blocks.size(), 0);
+            parallel_for(pool, blocks.size(), [&](size_t b, int) {
+                const char* record = blocks[b].begin;
+                uint32_t* out = mesh.indices.data() + 3 * blocks[b].triangle_offset;
+                size_t last = std::min(element.count, blocks[b].first_face + FACE_BLOCK);
+                uint32_t corners[MAX_FACE_CORNERS];
+                for (size_t f = blocks[b].first_face; f < last; ++f) {
+                    for (size_t i = 0; i < element.properties.size(); ++i) {
+                        const PlyProperty& property = element.properties[i];
+                        if (property.count_type == PLY_INVALID) {
+                            record += ply_size(property.type);
+                            continue;
+                        }
+                        size_t n = static_cast<size_t>(read_binary(property.count_type, record, swap));
+                        record += ply_size(property.count_type);
+                        if (static_cast<int>(i) == layout.index_list) {
+                            for (size_t k = 0; k < n; ++k) {
+                                double index = read_binary(list.type, record + k * ply_size(list.type), swap);
+                                if (index < 0.0 || index >= static_cast<double>(vertex_total)) bad[b] = 1;
+                                corners[k] = static_cast<uint32_t>(index);
+                            }
+                            emit_fan(out, corners, n);
+                        }
+                        record += n * ply_size(property.type);
+                    }
+                }
+            });
+            if (std::find(bad.begin(), bad.end(), 1) != bad.end()) {
+                printf("PLY: face index out of range\n");
+                return false;
+            }
+        } else if (fixed) {
+            if (static_cast<size_t>(end - p) / std::max<size_t>(stride, 1) < element.count) {
+                printf("PLY: truncated '%s' data\n", element.name.c_str());
+                return false;
+            }
+            p += element.count * stride;
+        } else {
+            for (size_t i = 0; i < element.count && p != nullptr; ++i) {
+                size_t unused = 0;
+                p = skip_binary_record(element, p, end, swap, -1, unused);
+            }
+            if (p == nullptr) {
+                printf("PLY: truncated '%s' data\n", element.name.c_str());
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// ASCII bodies: one record per line. Chunks first count their lines to learn
+// which element each line belongs to, then count triangles, then parse.
+bool parse_ply_ascii(const char* body, const char* end, const std::vector<PlyElement>& elements,
+                     const PlyLayout& layout, TriangleMesh& mesh, ThreadPool* pool, size_t chunk_bytes) {
+    size_t vertex_first = 0, face_first = 0, line = 0;
+    for (size_t e = 0; e < elements.size(); ++e) {
+        if (static_cast<int>(e) == layout.vertex_element) vertex_first = line;
+        if (static_cast<int>(e) == layout.face_element) face_first = line;
+        line += elements[e].count;
+    }
+    const PlyElement& vertex = elements[layout.vertex_element];
+    size_t vertex_total = vertex.count;
+    size_t face_total = layout.face_element >= 0 ? elements[layout.face_element].count : 0;
+
+    std::vector<TextChunk> chunks = split_lines(body, end, chunk_bytes);
+    parallel_for(pool, chunks.size(), [&](size_t c, int) {
+        for (const char* p = chunks[c].begin; p < chunks[c].end; p = next_line(line_end(p, chunks[c].end), chunks[c].end)) {
+            chunks[c].lines++;
+        }
+    });
+    size_t lines = 0;
+    for (TextChunk& chunk : chunks) {
+        chunk.first_line = lines;
+        lines += chunk.lines;
+    }
+    if (lines < line) {
+        printf("PLY: expected %zu data lines, found %zu\n", line, lines);
+        return false;
+    }
+
+    // Walks the scalar properties before the index list; returns the list count position
+    auto index_list_start = [&](const char* p, const char* eol) -> const char* {
+        const PlyElement& face = elements[layout.face_element];
+        for (int i = 0; i < layout.index_list && p != nullptr; ++i) {
+            p = skip_spaces(p, eol);
+            if (face.properties[i].count_type != PLY_INVALID) {
+                long long n;
+                p = parse_integer(p, eol, n);
+                for (long long k = 0; k < n && p != nullptr; ++k) p = skip_token(skip_spaces(p, eol), eol);
+            } else {
+                p = p < eol ? skip_token(p, eol) : nullptr;
+            }
+        }
+        return p != nullptr ? skip_spaces(p, eol) : nullptr;
+    };
+
+    auto for_each_line = [&](TextChunk& chunk, size_t first, size_t count, auto&& fn) {
+        size_t index = chunk.first_line;
+        for (const char* p = chunk.begin; p < chunk.end; ++index) {
+            const char* eol = line_end(p, chunk.end);
+            if (index >= first && index < first + count && !fn(index - first, p, eol)) return;
+            p = next_line(eol, chunk.end);
+        }
+    };
+
+    parallel_for(pool, chunks.size(), [&](size_t c, int) {
+        if (face_total == 0) return;
+        for_each_line(chunks[c], face_first, face_total, [&](size_t, const char* p, const char* eol) {
+            long long n;
+            p = index_list_start(p, eol);
+            if (p == nullptr || parse_integer(p, eol, n) == nullptr || n < 0 || n > static_cast<long long>(MAX_FACE_CORNERS)) {
+                chunks[c].error = "malformed face";
+                return false;
+            }
+            if (n >= 3) chunks[c].triangles += static_cast<size_t>(n) - 2;
+            return true;
+        });
+    });
+    size_t unused, triangle_total;
+    prefix_offsets(chunks, unused, triangle_total);
+    if (const char* error = first_error(chunks)) {
+        printf("PLY: %s\n", error);
+        return false;
+    }
+
+    // x, y, z, then u, v if present
+    int columns[5] = {layout.xyz[0], layout.xyz[1], layout.xyz[2], layout.uv[0], layout.uv[1]};
+    bool has_uv = layout.uv[0] >= 0;
+    mesh.positions.resize(3 * vertex_total);
+    if (has_uv) mesh.uvs.resize(2 * vertex_total);
+    mesh.indices.resize(3 * triangle_total);
+    parallel_for(pool, chunks.size(), [&](size_t c, int) {
+        TextChunk& chunk = chunks[c];
+        for_each_line(chunk, vertex_first, vertex_total, [&](size_t v, const char* p, const char* eol) {
+            float values[5] = {0.0f, 0.0f, 0.0f, 0.0f, 0.0f};
+            for (int i = 0; i < static_cast<int>(vertex.properties.size()) && p != nullptr; ++i) {
+                float value;
+                p = parse_float(skip_spaces(p, eol), eol, value);
+                for (int a = 0; a < 5; ++a) {
+                    if (columns[a] == i) values[a] = value;
+                }
+            }
+            if (p == nullptr) {
+                chunk.error = "malformed vertex";
+                return false;
+            }
+            std::copy(values, values + 3, &mesh.positions[3 * v]);
+            if (has_uv) {
+                mesh.uvs[2 * v] = values[3];
+                mesh.uvs[2 * v + 1] = 1.0f - values[4];
+            }
+            return true;
+        });
+        if (face_total == 0 || chunk.error != nullptr) return;
+
+        uint32_t* out = mesh.indices.data() + 3 * chunk.triangle_offset;
+        for_each_line(chunk, face_first, face_total, [&](size_t, const char* p, const char* eol) {
+            long long n;
+            p = parse_integer(index_list_start(p, eol), eol, n);
+            if (p == nullptr || n < 0 || n > static_cast<long long>(MAX_FACE_CORNERS)) {
+                chunk.error = "malformed face";
+                return false;
+            }
+            uint32_t corners[MAX_FACE_CORNERS];
+            for (long long k = 0; k < n; ++k) {
+                long long index;
+                p = parse_integer(skip_spaces(p, eol), eol, index);
+                if (p == nullptr || index < 0 || index >= static_cast<long long>(vertex_total)) {
+                    chunk.error = "bad face index";
+                    return false;
+                }
+                corners[k] = static_cast<uint32_t>(index);
+            }
+            emit_fan(out, corners, static_cast<size_t>(n));
+            return true;
+        });
+    });
+    if (const char* error = first_error(chunks)) {
+        printf("PLY: %s\n", error);
+        return false;
+    }
+    return true;
+}
+
+bool has_extension(const char* path, const char* extension) {
+    size_t length = std::strlen(path), ext_length = std::strlen(extension);
+    if (length < ext_length) return false;
+    for (size_t i = 0; i < ext_length; ++i) {
+        char c = path[length - ext_length + i];
+        if (c >= 'A' && c <= 'Z') c = static_cast<char>(c - 'A' + 'a');
+        if (c != extension[i]) return false;
+    }
+    return true;
+}
+
+}
+
+const char* parse_float(const char* p, const char* end, float& value) {
+    // Exact powers of ten in double
+    static const double powers[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+                                    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+')) negative = *p++ == '-';
+
+    // Up to 19 significant digits fit a 64-bit mantissa exactly
+    uint64_t mantissa = 0;
+    int digits = 0, exponent = 0;
+    bool any = false;
+    for (; p < end && is_digit(*p); ++p, any = true) {
+        if (digits < 19) {
+            mantissa = mantissa * 10 + (*p - '0');
+            digits += mantissa != 0;
+        } else {
+            exponent++;
+        }
+    }
+    if (p < end && *p == '.') {
+        for (++p; p < end && is_digit(*p); ++p, any = true) {
+            if (digits < 19) {
+                mantissa = mantissa * 10 + (*p - '0');
+                digits += mantissa != 0;
+                exponent--;
+            }
+        }
+    }
+    if (!any) return nullptr;
+
+    if (p < end && (*p == 'e' || *p == 'E')) {
+        long long power;
+        const char* after = parse_integer(p + 1, end, power);
+        if (after != nullptr) {
+            exponent += static_cast<int>(std::max(-1000LL, std::min(1000LL, power)));
+            p = after;
+        }
+    }
+
+    double result = static_cast<double>(mantissa);
+    if (mantissa == 0) {
+        result = 0.0;
+    } else if (exponent >= 0 && exponent <= 22) {
+        result *= powers[exponent];
+    } else if (exponent < 0 && exponent >= -22) {
+        result /= powers[-exponent];
+    } else {
+        result *= std::pow(10.0, exponent);
+    }
+    value = static_cast<float>(negative ? -result : result);
+    return p;
+}
+
+bool parse_obj(const char* data, size_t size, TriangleMesh& mesh, ThreadPool* pool, size_t chunk_bytes) {
+    std::vector<TextChunk> chunks = split_lines(data, data + size, chunk_bytes);
+    parallel_for(pool, chunks.size(), [&](size_t c, int) { count_obj_chunk(chunks[c]); });
+
+    size_t vertices, triangles, texcoord_total = 0;
+    prefix_offsets(chunks, vertices, triangles);
+    for (TextChunk& chunk : chunks) {
+        chunk.texcoord_offset = texcoord_total;
+        texcoord_total += chunk.texcoords;
+    }
+    mesh.positions.resize(3 * vertices);
+    mesh.indices.resize(3 * triangles);
+    mesh.uvs.clear();
+    std::vector<float> texcoords(2 * texcoord_total);
+    std::vector<uint32_t> corner_texcoords(texcoord_total > 0 ? 3 * triangles : 0);
+    parallel_for(pool, chunks.size(), [&](size_t c, int) { parse_obj_chunk(chunks[c], mesh, vertices, texcoords, corner_texcoords); });
+
+    if (const char* error = first_error(chunks)) {
+        printf("OBJ: %s\n", error);
+        mesh.positions.clear();
+        mesh.indices.clear();
+        mesh.uvs.clear();
+        return false;
+    }
+
+    // Serial, so a vertex shared by corners with different vt keeps the last one
+    if (texcoord_total > 0) {
+        mesh.uvs.assign(2 * vertices, 0.0f);
+        for (size_t k = 0; k < corner_texcoords.size(); ++k) {
+            uint32_t t = corner_texcoords[k];
+            if (t == NO_TEXCOORD) continue;
+            mesh.uvs[2 * static_cast<size_t>(mesh.indices[k])] = texcoords[2 * static_cast<size_t>(t)];
+            mesh.uvs[2 * static_cast<size_t>(mesh.indices[k]) + 1] = 1.0f - texcoords[2 * static_cast<size_t>(t) + 1];
+        }
+    }
+    return true;
+}
+
+bool parse_ply(const char* data, size_t size, TriangleMesh& mesh, ThreadPool* pool, size_t chunk_bytes) {
+    const char* end = data + size;
+    PlyFormat format = PLY_ASCII;
+    std::vector<PlyElement> elements;
+    PlyLayout layout;
+    const char* body = parse_ply_header(data, end, format, elements);
+    if (body == nullptr || !find_layout(elements, layout)) return false;
+    mesh.uvs.clear();
+
+    bool ok;
+    if (format == PLY_ASCII) {
+        ok = parse_ply_ascii(body, end, elements, layout, mesh, pool, chunk_bytes);
+    } else {
+        uint16_t probe = 1;
+        bool little_endian_host = *reinterpret_cast<const uint8_t*>(&probe) == 1;
+        ok = parse_ply_binary(body, end, little_endian_host != (format == PLY_BINARY_LE), elements, layout, mesh, pool);
+    }
+    if (!ok) {
+        mesh.positions.clear();
+        mesh.indices.clear();
+        mesh.uvs.clear();
+    }
+    return ok;
+}
+
+bool load_obj(const char* path, TriangleMesh& mesh, ThreadPool* pool) {
+    MappedFile file;
+    return file.open(path) && parse_obj(file.data(), file.size(), mesh, pool);
+}
+
+bool load_ply(const char* path, TriangleMesh& mesh, ThreadPool* pool) {
+    MappedFile file;
+    return file.open(path) && parse_ply(file.data(), file.size(), mesh, pool);
+}
+
+bool load_mesh(const char* path, TriangleMesh& mesh, ThreadPool* pool) {
+    if (has_extension(path, ".obj")) return load_obj(path, mesh, pool);
+    if (has_extension(path, ".ply")) return load_ply(path, mesh, pool);
+    printf("Unknown mesh format: %s\n", path);
+    return false;
+}
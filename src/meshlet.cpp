@@ -0,0 +1,167 @@
+#include "geometry/meshlet.hpp"
+#include "geometry/lazy_bvh.hpp"
+#include <algorithm>
+#include <cmath>
+
+// Offsets are kept two below the 16-bit range to leave room for rounding
+static const double MAX_OFFSET = 65533.0;
+// Grid coordinates stay below 2^23 so they convert to float exactly
+static const double MAX_GRID = 8388608.0;
+
+static void collect_vertices(const TriangleMesh& mesh, const std::vector<uint32_t>& order, const PrimGroup& group,
+                             std::vector<uint32_t>& vertices) {
+    vertices.clear();
+    for (uint32_t i = group.first; i < group.first + group.count; ++i) {
+        const uint32_t* tri = &mesh.indices[3 * static_cast<size_t>(order[i])];
+        vertices.insert(vertices.end(), tri, tri + 3);
+    }
+    std::sort(vertices.begin(), vertices.end());
+    vertices.erase(std::unique(vertices.begin(), vertices.end()), vertices.end());
+}
+
+void MeshletMesh::build(const TriangleMesh& mesh, ThreadPool* pool, std::vector<uint32_t>* order) {
+    meshlets.clear();
+    quantized.clear();
+    local_indices.clear();
+    size_t triangles = mesh.triangle_count();
+
+    std::vector<AABB> bounds(triangles);
+    for (size_t i = 0; i < triangles; ++i) bounds[i] = mesh.triangle_bounds(i);
+    std::vector<uint32_t> triangle_order;
+    std::vector<PrimGroup> groups = split_into_groups(bounds, MESHLET_TRIANGLES, triangle_order);
+    if (order != nullptr) *order = triangle_order;
+    if (groups.empty()) return;
+
+    // Vertex tables per meshlet
+    std::vector<std::vector<uint32_t>> tables(groups.size());
+    auto collect = [&](size_t g, int) { collect_vertices(mesh, triangle_order, groups[g], tables[g]); };
+    parallel_for(pool, groups.size(), collect, 64);
+
+    // Loosely connected triangles can need more vertices than a byte
+    // indexes; such meshlets are cut into pieces that always fit
+    std::vector<PrimGroup> fitted;
+    std::vector<std::vector<uint32_t>> fitted_tables;
+    for (size_t g = 0; g < groups.size(); ++g) {
+        if (tables[g].size() <= MESHLET_VERTICES) {
+            fitted.push_back(groups[g]);
+            fitted_tables.push_back(std::move(tables[g]));
+            continue;
+        }
+        for (uint32_t first = groups[g].first; first < groups[g].first + groups[g].count; first += MESHLET_VERTICES / 3) {
+            PrimGroup piece;
+            piece.first = first;
+            piece.count = std::min<uint32_t>(MESHLET_VERTICES / 3, groups[g].first + groups[g].count - first);
+            for (uint32_t i = piece.first; i < piece.first + piece.count; ++i) piece.bounds.expand(bounds[triangle_order[i]]);
+            fitted.push_back(piece);
+            fitted_tables.emplace_back();
+            collect_vertices(mesh, triangle_order, piece, fitted_tables.back());
+        }
+    }
+    groups.swap(fitted);
+    tables.swap(fitted_tables);
+
+    // The step must cover the widest meshlet in 16 bits and the whole mesh in
+    // 23; a power of two keeps every decode exact
+    AABB box = mesh.bounds();
+    double widest = 0.0, total = 0.0;
+    for (int axis = 0; axis < 3; ++axis) {
+        total = std::max(total, box.max[axis] - box.min[axis]);
+        for (const PrimGroup& group : groups) {
+            widest = std::max(widest, group.bounds.max[axis] - group.bounds.min[axis]);
+        }
+    }
+    double needed = std::max(std::max(widest / MAX_OFFSET, total / MAX_GRID), 1e-30);
+    step = std::ldexp(1.0f, static_cast<int>(std::ceil(std::log2(needed))));
+    for (int axis = 0; axis < 3; ++axis) origin[axis] = static_cast<float>(box.min[axis]);
+
+    // Snap every vertex once so shared vertices agree across meshlets
+    std::vector<int32_t> grid(mesh.positions.size());
+    for (size_t i = 0; i < grid.size(); ++i) {
+        grid[i] = static_cast<int32_t>(std::llround((mesh.positions[i] - origin[i % 3]) / static_cast<double>(step)));
+    }
+
+    meshlets.resize(groups.size());
+    size_t vertex_total = 0;
+    for (size_t g = 0; g < groups.size(); ++g) {
+        meshlets[g].vertex_offset = static_cast<uint32_t>(vertex_total);
+        meshlets[g].index_offset = groups[g].first;
+        meshlets[g].vertex_count = static_cast<uint8_t>(tables[g].size());
+        meshlets[g].triangle_count = static_cast<uint8_t>(groups[g].count);
+        vertex_total += tables[g].size();
+    }
+    quantized.resize(3 * vertex_total);
+    local_indices.resize(3 * triangles);
+
+    auto pack = [&](size_t g, int) {
+        Meshlet& meshlet = meshlets[g];
+        const std::vector<uint32_t>& table = tables[g];
+        for (int axis = 0; axis < 3; ++axis) {
+            int32_t low = grid[3 * static_cast<size_t>(table[0]) + axis];
+            for (uint32_t vertex : table) low = std::min(low, grid[3 * static_cast<size_t>(vertex) + axis]);
+            meshlet.base[axis] = low;
+        }
+        uint16_t* q = &quantized[3 * static_cast<size_t>(meshlet.vertex_offset)];
+        for (size_t i = 0; i < table.size(); ++i) {
+            for (int axis = 0; axis < 3; ++axis) {
+                q[3 * i + axis] = static_cast<uint16_t>(grid[3 * static_cast<size_t>(table[i]) + axis] - meshlet.base[axis]);
+            }
+        }
+        const PrimGroup& group = groups[g];
+        for (uint32_t i = 0; i < group.count; ++i) {
+            const uint32_t* tri = &mesh.indices[3 * static_cast<size_t>(triangle_order[group.first + i])];
+            for (int k = 0; k < 3; ++k) {
+                size_t local = std::lower_bound(table.begin(), table.end(), tri[k]) - table.begin();
+                local_indices[3 * (static_cast<size_t>(group.first) + i) + k] = static_cast<uint8_t>(local);
+            }
+        }
+    };
+    parallel_for(pool, groups.size(), pack, 64);
+}
+
+size_t MeshletMesh::memory_bytes() const {
+    return meshlets.size() * sizeof(Meshlet) + quantized.size() * sizeof(uint16_t) + local_indices.size();
+}
+
+bool MeshletMesh::valid() const {
+    if (quantized.size() % 3 != 0 || local_indices.size() % 3 != 0) return false;
+    size_t vertex_total = quantized.size() / 3;
+    size_t triangle_total = triangle_count();
+    for (const Meshlet& meshlet : meshlets) {
+        if (meshlet.vertex_offset > vertex_total || meshlet.vertex_count > vertex_total - meshlet.vertex_offset ||
+            meshlet.index_offset > triangle_total || meshlet.triangle_count > triangle_total - meshlet.index_offset) {
+            return false;
+        }
+        const uint8_t* local = local_indices.data() + 3 * static_cast<size_t>(meshlet.index_offset);
+        for (size_t i = 0; i < 3 * static_cast<size_t>(meshlet.triangle_count); ++i) {
+            if (local[i] >= meshlet.vertex_count) return false;
+        }
+    }
+    return true;
+}
+
+std::vector<uint32_t> MeshletMesh::triangle_ids() const {
+    std::vector<uint32_t> ids;
+    ids.reserve(triangle_count());
+    for (size_t m = 0; m < meshlets.size(); ++m) {
+        for (uint32_t local = 0; local < meshlets[m].triangle_count; ++local) {
+            ids.push_back(encode(static_cast<uint32_t>(m), local));
+        }
+    }
+    return ids;
+}
+
+AABB MeshletMesh::triangle_bounds(uint32_t id) const {
+    point3 p0, p1, p2;
+    triangle(id, p0, p1, p2);
+    AABB box;
+    box.expand(p0);
+    box.expand(p1);
+    box.expand(p2);
+    return box;
+}
+
+vec3 MeshletMesh::face_normal(uint32_t id) const {
+    point3 p0, p1, p2;
+    triangle(id, p0, p1, p2);
+    return unit_vector(cross(p1 - p0, p2 - p0));
+}
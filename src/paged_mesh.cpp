@@ -0,0 +1,318 @@
+#include "geometry/paged_mesh.hpp"
+#include "geometry/lazy_bvh.hpp"
+#include "geometry/mesh_loader.hpp"
+#include "core/binary_format.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+namespace {
+
+const char PAGED_MAGIC[8] = {'R', 'T', 'P', 'A', 'G', 'E', 'D', '1'};
+// Cluster images are written in batches so memory stays at a few clusters
+const size_t WRITE_BATCH = 64;
+
+// Resident footprint: the four sections plus the SIMD leaf copy of the triangles
+size_t resident_size(const PagedClusterEntry& entry) {
+    size_t total = 0;
+    for (uint64_t bytes : entry.bytes) total += bytes;
+    return total + (entry.triangle_count + 8) * 9 * sizeof(float);
+}
+
+struct Candidate {
+    double t;
+    uint32_t cluster;
+
+    bool operator<(const Candidate& other) const {
+        return t < other.t || (t == other.t && cluster < other.cluster);
+    }
+};
+
+}
+
+bool write_paged_mesh(const char* path, const TriangleMesh& mesh, size_t cluster_triangles, ThreadPool* pool,
+                      std::vector<uint32_t>* order) {
+    std::vector<AABB> bounds(mesh.triangle_count());
+    for (size_t t = 0; t < bounds.size(); ++t) bounds[t] = mesh.triangle_bounds(t);
+    std::vector<uint32_t> triangle_order;
+    std::vector<PrimGroup> groups = split_into_groups(bounds, cluster_triangles, triangle_order);
+
+    FILE* file = fopen(path, "wb");
+    if (file == nullptr) {
+        printf("Paged mesh: cannot write %s\n", path);
+        return false;
+    }
+
+    PagedMeshHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, PAGED_MAGIC, sizeof(PAGED_MAGIC));
+    header.version = PAGED_MESH_VERSION;
+    header.byte_order = BYTE_ORDER_MARK;
+    header.cluster_count = groups.size();
+    header.table_offset = align_up(sizeof(header));
+    std::vector<PagedClusterEntry> table(groups.size());
+    size_t offset = align_up(header.table_offset + table.size() * sizeof(PagedClusterEntry));
+
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1;
+    size_t written = sizeof(header);
+
+    std::vector<std::shared_ptr<const BLAS>> batch;
+    for (size_t batch_first = 0; batch_first < groups.size() && ok; batch_first += WRITE_BATCH) {
+        size_t batch_count = std::min(WRITE_BATCH, groups.size() - batch_first);
+        batch.assign(batch_count, nullptr);
+
+        // Each cluster gets its own vertices, so it loads without the rest of the mesh
+        auto build_cluster = [&](size_t b, int) {
+            const PrimGroup& group = groups[batch_first + b];
+            std::vector<uint32_t> vertices;
+            for (uint32_t i = 0; i < group.count; ++i) {
+                const uint32_t* tri = &mesh.indices[3 * static_cast<size_t>(triangle_order[group.first + i])];
+                vertices.insert(vertices.end(), tri, tri + 3);
+            }
+            std::sort(vertices.begin(), vertices.end());
+            vertices.erase(std::unique(vertices.begin(), vertices.end()), vertices.end());
+
+            TriangleMesh local;
+            for (uint32_t vertex : vertices) local.add_vertex(mesh.vertex(vertex));
+            for (uint32_t i = 0; i < group.count; ++i) {
+                const uint32_t* tri = &mesh.indices[3 * static_cast<size_t>(triangle_order[group.first + i])];
+                uint32_t corners[3];
+                for (int k = 0; k < 3; ++k) {
+                    corners[k] = static_cast<uint32_t>(std::lower_bound(vertices.begin(), vertices.end(), tri[k]) - vertices.begin());
+                }
+                local.add_triangle(corners[0], corners[1], corners[2]);
+            }
+            batch[b] = build_blas(std::make_shared<const TriangleMesh>(std::move(local)), nullptr, true);
+        };
+        parallel_for(pool, batch_count, build_cluster);
+
+        for (size_t b = 0; b < batch_count && ok; ++b) {
+            const BLAS& blas = *batch[b];
+            PagedClusterEntry& entry = table[batch_first + b];
+            for (int a = 0; a < 3; ++a) {
+                entry.bounds[a] = blas.wide.bounds.min[a];
+                entry.bounds[3 + a] = blas.wide.bounds.max[a];
+            }
+            entry.triangle_base = groups[batch_first + b].first;
+            entry.triangle_count = groups[batch_first + b].count;
+            entry.bytes[0] = blas.mesh->positions.size() * sizeof(float);
+            entry.bytes[1] = blas.mesh->indices.size() * sizeof(uint32_t);
+            entry.bytes[2] = blas.wide.nodes.size() * sizeof(BVH8Node);
+            entry.bytes[3] = blas.wide.prim_indices.size() * sizeof(uint32_t);
+            entry.offset = offset;
+
+            // Sections follow each other; all are multiples of 4 bytes, nodes of 80
+            const void* sections[4] = {blas.mesh->positions.data(), blas.mesh->indices.data(),
+                                       blas.wide.nodes.data(), blas.wide.prim_indices.data()};
+            ok = write_padding(file, written, offset);
+            for (int s = 0; s < 4 && ok; ++s) {
+                ok = fwrite(sections[s], 1, entry.bytes[s], file) == entry.bytes[s];
+                written += entry.bytes[s];
+            }
+            offset = align_up(written);
+        }
+    }
+
+    // Pad the tail so every image ends inside the file, then fill in the table
+    ok = ok && write_padding(file, written, offset);
+    ok = ok && fseek(file, static_cast<long>(header.table_offset), SEEK_SET) == 0;
+    ok = ok && (table.empty() || fwrite(table.data(), sizeof(PagedClusterEntry), table.size(), file) == table.size());
+    ok = fclose(file) == 0 && ok;
+    if (!ok) {
+        printf("Paged mesh: failed writing %s\n", path);
+        std::remove(path);
+        return false;
+    }
+    if (order != nullptr) *order = std::move(triangle_order);
+    return true;
+}
+
+bool page_mesh_file(const char* source_path, const char* paged_path, size_t cluster_triangles, ThreadPool* pool) {
+    TriangleMesh mesh;
+    if (!load_mesh(source_path, mesh, pool) || mesh.empty()) {
+        printf("Paged mesh: cannot load %s\n", source_path);
+        return false;
+    }
+    return write_paged_mesh(paged_path, mesh, cluster_triangles, pool);
+}
+
+PagedMesh::PagedMesh()
+    : budget(0), pass_stamp(0), resident_total(0), page_in_count(0), eviction_count(0), pass_count(0) {}
+
+bool PagedMesh::open(const char* path, size_t budget_bytes) {
+    budget = budget_bytes;
+    clusters.clear();
+    resident.clear();
+    resident_total = 0;
+    if (!file.open(path)) return false;
+
+    PagedMeshHeader header;
+    if (file.size() < sizeof(header)) {
+        printf("Paged mesh: %s is too small\n", path);
+        return false;
+    }
+    std::memcpy(&header, file.data(), sizeof(header));
+    if (std::memcmp(header.magic, PAGED_MAGIC, sizeof(PAGED_MAGIC)) != 0 || header.version != PAGED_MESH_VERSION ||
+        header.byte_order != BYTE_ORDER_MARK || header.table_offset > file.size() ||
+        header.cluster_count > (file.size() - header.table_offset) / sizeof(PagedClusterEntry)) {
+        printf("Paged mesh: %s has an unsupported header\n", path);
+        return false;
+    }
+
+    clusters.resize(header.cluster_count);
+    if (!clusters.empty()) std::memcpy(clusters.data(), file.data() + header.table_offset, clusters.size() * sizeof(PagedClusterEntry));
+    std::vector<AABB> cluster_bounds(clusters.size());
+    sizes.resize(clusters.size());
+    for (size_t c = 0; c < clusters.size(); ++c) {
+        const PagedClusterEntry& entry = clusters[c];
+        uint64_t total = entry.bytes[0] + entry.bytes[1] + entry.bytes[2] + entry.bytes[3];
+        if (!section_in_file(entry.offset, total, file.size()) || entry.bytes[2] % sizeof(BVH8Node) != 0) {
+            printf("Paged mesh: cluster %zu of %s is out of bounds\n", c, path);
+            clusters.clear();
+            return false;
+        }
+        cluster_bounds[c] = AABB(point3(entry.bounds[0], entry.bounds[1], entry.bounds[2]),
+                                 point3(entry.bounds[3], entry.bounds[4], entry.bounds[5]));
+        sizes[c] = resident_size(entry);
+    }
+    top = build_bvh_binned_sah(cluster_bounds, nullptr, 1);
+
+    resident.assign(clusters.size(), nullptr);
+    requested.reset(new std::atomic<uint8_t>[clusters.size()]);
+    last_used.reset(new std::atomic<uint64_t>[clusters.size()]);
+    for (size_t c = 0; c < clusters.size(); ++c) {
+        requested[c].store(0, std::memory_order_relaxed);
+        last_used[c].store(0, std::memory_order_relaxed);
+    }
+    return true;
+}
+
+size_t PagedMesh::resident_clusters() const {
+    size_t count = 0;
+    for (const auto& cluster : resident) count += cluster != nullptr;
+    return count;
+}
+
+std::shared_ptr<const BLAS> PagedMesh::load_cluster(uint32_t cluster) const {
+    const PagedClusterEntry& entry = clusters[cluster];
+    const char* data = file.data() + entry.offset;
+
+    std::shared_ptr<TriangleMesh> mesh = std::make_shared<TriangleMesh>();
+    std::shared_ptr<BLAS> blas = std::make_shared<BLAS>();
+    copy_section(data, entry.bytes[0], mesh->positions);
+    copy_section(data + entry.bytes[0], entry.bytes[1], mesh->indices);
+    copy_section(data + entry.bytes[0] + entry.bytes[1], entry.bytes[2], blas->wide.nodes);
+    copy_section(data + entry.bytes[0] + entry.bytes[1] + entry.bytes[2], entry.bytes[3], blas->wide.prim_indices);
+    blas->wide.bounds = AABB(point3(entry.bounds[0], entry.bounds[1], entry.bounds[2]),
+                             point3(entry.bounds[3], entry.bounds[4], entry.bounds[5]));
+    blas->triangles.build(*mesh, blas->wide.prim_indices);
+    blas->mesh = std::move(mesh);
+    return blas;
+}
+
+bool PagedMesh::trace_pass(PagedRay& ray) const {
+    // Front-to-back list of the clusters the ray can still reach
+    thread_local std::vector<Candidate> candidates;
+    candidates.clear();
+    const point3& origin = ray.ray.origin();
+    vec3 inv_dir(1.0 / ray.ray.direction().x(), 1.0 / ray.ray.direction().y(), 1.0 / ray.ray.direction().z());
+    double t_limit = ray.t_max;
+    top.traverse(ray.ray, ray.t_min, t_limit, [&](uint32_t cluster, double& limit) {
+        const double* b = clusters[cluster].bounds;
+        double t_entry;
+        if (AABB(point3(b[0], b[1], b[2]), point3(b[3], b[4], b[5])).hit(origin, inv_dir, ray.t_min, limit, t_entry)) {
+            candidates.push_back(Candidate{t_entry, cluster});
+        }
+        return false;
+    });
+    std::sort(candidates.begin(), candidates.end());
+
+    Candidate resume{ray.resume_t, ray.resume_cluster};
+    for (const Candidate& candidate : candidates) {
+        if (candidate < resume) continue;
+        if (candidate.t > ray.t_max) break;
+
+        const BLAS* cluster = resident[candidate.cluster].get();
+        if (cluster == nullptr) {
+            requested[candidate.cluster].store(1, std::memory_order_relaxed);
+            ray.resume_t = candidate.t;
+            ray.resume_cluster = candidate.cluster;
+            return false;
+        }
+        last_used[candidate.cluster].store(pass_stamp, std::memory_order_relaxed);
+
+        HitRecord rec;
+        if (cluster->intersect(ray.ray, ray.t_min, ray.t_max, rec)) {
+            ray.t_max = rec.t;
+            ray.u = rec.u;
+            ray.v = rec.v;
+            ray.normal = cluster->face_normal(rec.prim_id);
+            ray.triangle = static_cast<int>(clusters[candidate.cluster].triangle_base) + rec.prim_id;
+        }
+    }
+    ray.done = true;
+    return true;
+}
+
+bool PagedMesh::page_in(ThreadPool* pool) {
+    std::vector<uint32_t> wanted;
+    for (size_t c = 0; c < clusters.size(); ++c) {
+        if (requested[c].exchange(0, std::memory_order_relaxed)) wanted.push_back(static_cast<uint32_t>(c));
+    }
+    if (wanted.empty()) return false;
+
+    // Take requests while they fit; always at least one, so tiny budgets still progress
+    size_t needed = 0;
+    size_t take = 0;
+    for (; take < wanted.size(); ++take) {
+        if (take > 0 && needed + sizes[wanted[take]] > budget) break;
+        needed += sizes[wanted[take]];
+    }
+    wanted.resize(take);
+
+    // Evict least recently used clusters until the new ones fit
+    if (resident_total + needed > budget) {
+        std::vector<uint32_t> victims;
+        for (size_t c = 0; c < resident.size(); ++c) {
+            if (resident[c]) victims.push_back(static_cast<uint32_t>(c));
+        }
+        std::sort(victims.begin(), victims.end(), [&](uint32_t a, uint32_t b) {
+            return last_used[a].load(std::memory_order_relaxed) < last_used[b].load(std::memory_order_relaxed);
+        });
+        for (size_t i = 0; i < victims.size() && resident_total + needed > budget; ++i) {
+            resident[victims[i]] = nullptr;
+            resident_total -= sizes[victims[i]];
+            eviction_count++;
+        }
+    }
+
+    auto load = [&](size_t i, int) { resident[wanted[i]] = load_cluster(wanted[i]); };
+    parallel_for(pool, wanted.size(), load);
+    for (uint32_t cluster : wanted) last_used[cluster].store(pass_stamp, std::memory_order_relaxed);
+    resident_total += needed;
+    page_in_count += wanted.size();
+    return true;
+}
+
+void PagedMesh::trace(std::vector<PagedRay>& rays, ThreadPool* pool) {
+    std::vector<uint32_t> pending;
+    for (size_t i = 0; i < rays.size(); ++i) {
+        if (!rays[i].done) pending.push_back(static_cast<uint32_t>(i));
+    }
+
+    std::vector<uint8_t> finished;
+    while (!pending.empty()) {
+        pass_count++;
+        pass_stamp++;
+        finished.assign(pending.size(), 0);
+        auto pass = [&](size_t i, int) { finished[i] = trace_pass(rays[pending[i]]); };
+        parallel_for(pool, pending.size(), pass, 64);
+
+        size_t kept = 0;
+        for (size_t i = 0; i < pending.size(); ++i) {
+            if (!finished[i]) pending[kept++] = pending[i];
+        }
+        pending.resize(kept);
+        if (!pending.empty() && !page_in(pool)) break;
+    }
+}
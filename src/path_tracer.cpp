@@ -0,0 +1,188 @@
+#include "rendering/path_tracer.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+static const double PI = 3.14159265358979323846;
+
+color sky_radiance(const vec3& direction) {
+    vec3 unit_direction = unit_vector(direction);
+    auto a = 0.5*(unit_direction.y() + 1.0);
+    return (1.0-a)*color(1.0, 1.0, 1.0) + a*color(0.5, 0.7, 1.0);
+}
+
+vec3 sun_direction() {
+    return unit_vector(vec3(0.5, 1.0, 0.4));
+}
+
+static color sun_irradiance() {
+    return color(2.2, 2.1, 1.9);
+}
+
+// Power heuristic (beta = 2) weight of the strategy with density a
+static inline double power_heuristic(double a, double b) {
+    return a * a / (a * a + b * b);
+}
+
+color miss_radiance(const SceneAccel& scene, const Ray& ray, double bounce_pdf) {
+    const EnvironmentMap* environment = scene.environment.get();
+    if (environment == nullptr) return sky_radiance(ray.direction());
+    color value = environment->radiance(ray.direction());
+    if (bounce_pdf <= 0.0) return value;
+    return value * power_heuristic(bounce_pdf, environment->pdf(ray.direction()));
+}
+
+void begin_shading_batch(ShadingBatch& batch, const EnvironmentMap* environment) {
+    batch.count = 0;
+    batch.delta_light = environment == nullptr;
+}
+
+void load_shading_lane(ShadingBatch& batch, const HitRecord& rec, const Ray& ray, const color& throughput,
+                       const Material& material, const color& albedo, const EnvironmentMap* environment, Rng& rng) {
+    size_t i = batch.count++;
+    batch.px[i] = rec.p.x();
+    batch.py[i] = rec.p.y();
+    batch.pz[i] = rec.p.z();
+    batch.nx[i] = rec.normal.x();
+    batch.ny[i] = rec.normal.y();
+    batch.nz[i] = rec.normal.z();
+    batch.dx[i] = ray.direction().x();
+    batch.dy[i] = ray.direction().y();
+    batch.dz[i] = ray.direction().z();
+    batch.tr[i] = throughput.x();
+    batch.tg[i] = throughput.y();
+    batch.tb[i] = throughput.z();
+    batch.ar[i] = albedo.x();
+    batch.ag[i] = albedo.y();
+    batch.ab[i] = albedo.z();
+
+    if (material_samples_light(material.type)) {
+        vec3 light;
+        color value;
+        double light_pdf = 0.0;
+        if (environment == nullptr) {
+            light = sun_direction();
+            value = sun_irradiance();
+        } else {
+            double u1 = rng.next_double();
+            double u2 = rng.next_double();
+            light = environment->sample(u1, u2, value, light_pdf);
+        }
+        batch.lx[i] = light.x();
+        batch.ly[i] = light.y();
+        batch.lz[i] = light.z();
+        batch.lr[i] = value.x();
+        batch.lg[i] = value.y();
+        batch.lb[i] = value.z();
+        batch.light_pdf[i] = light_pdf;
+    }
+
+    int randoms = material_bounce_randoms(material.type);
+    batch.u1[i] = rng.next_double();
+    batch.u2[i] = rng.next_double();
+    batch.u3[i] = randoms > 2 ? rng.next_double() : 0.0;
+}
+
+color surface_albedo(const SceneAccel& scene, const HitRecord& rec, const Ray& ray, const RayCone& cone) {
+    const Material& material = scene.materials[rec.material_id];
+    TextureCache* textures = scene.textures.get(); // Sampling updates the shared tile pool
+    if (material.texture < 0 || textures == nullptr || static_cast<size_t>(material.texture) >= textures->texture_count() ||
+        rec.instance_id < 0) {
+        return material.albedo;
+    }
+    // Compressed meshes keep no texture coordinates
+    const Instance& instance = scene.instances[rec.instance_id];
+    const TriangleMesh* mesh = scene.blas[instance.mesh_id]->mesh.get();
+    if (mesh == nullptr || !mesh->has_uvs()) return material.albedo;
+
+    const uint32_t* corners = &mesh->indices[3 * static_cast<size_t>(rec.prim_id)];
+    const float* uv0 = &mesh->uvs[2 * static_cast<size_t>(corners[0])];
+    const float* uv1 = &mesh->uvs[2 * static_cast<size_t>(corners[1])];
+    const float* uv2 = &mesh->uvs[2 * static_cast<size_t>(corners[2])];
+    double w = 1.0 - rec.u - rec.v;
+    double u = w * uv0[0] + rec.u * uv1[0] + rec.v * uv2[0];
+    double v = w * uv0[1] + rec.u * uv1[1] + rec.v * uv2[1];
+
+    // Triangle areas in texture space and in world space, through the instance
+    double uv_area = 0.5 * std::fabs((uv1[0] - uv0[0]) * (uv2[1] - uv0[1]) - (uv2[0] - uv0[0]) * (uv1[1] - uv0[1]));
+    point3 p0 = instance.object_to_world.apply_point(mesh->vertex(corners[0]));
+    point3 p1 = instance.object_to_world.apply_point(mesh->vertex(corners[1]));
+    point3 p2 = instance.object_to_world.apply_point(mesh->vertex(corners[2]));
+    double world_area = 0.5 * cross(p1 - p0, p2 - p0).length();
+    double cos_incidence = dot(unit_vector(ray.direction()), rec.normal);
+
+    double lod = texture_lod(cone, cos_incidence, uv_area, world_area, textures->width(material.texture),
+                             textures->height(material.texture));
+    return material.albedo * textures->sample(material.texture, u, v, lod);
+}
+
+void read_shading_lane(const ShadingBatch& batch, size_t lane, color& throughput, SurfaceScatter& out) {
+    point3 p(batch.px[lane], batch.py[lane], batch.pz[lane]);
+    out.has_next = (batch.flags[lane] & SCATTER_CONTINUE) != 0;
+    out.has_shadow = (batch.flags[lane] & SCATTER_SHADOW) != 0;
+    out.next = Ray(p, vec3(batch.dx[lane], batch.dy[lane], batch.dz[lane]));
+    out.pdf = batch.pdf[lane];
+    if (out.has_shadow) {
+        out.shadow = Ray(p, vec3(batch.lx[lane], batch.ly[lane], batch.lz[lane]));
+        out.direct = color(batch.cr[lane], batch.cg[lane], batch.cb[lane]);
+    }
+    throughput = color(batch.tr[lane], batch.tg[lane], batch.tb[lane]);
+}
+
+// Scales a contribution down so no channel exceeds INDIRECT_CLAMP
+static inline color clamp_indirect(const color& value) {
+    double peak = std::max(value.x(), std::max(value.y(), value.z()));
+    return peak > INDIRECT_CLAMP ? value * (INDIRECT_CLAMP / peak) : value;
+}
+
+template<unsigned Features>
+color trace_path_features(const SceneAccel& scene, const Ray& camera_ray, Rng& rng, int max_depth, double pixel_spread) {
+    const bool roulette = (Features & FEATURE_RUSSIAN_ROULETTE) != 0;
+    const bool clamp = (Features & FEATURE_CLAMP_INDIRECT) != 0;
+    const double infinity = std::numeric_limits<double>::infinity();
+    color radiance(0.0, 0.0, 0.0);
+    color throughput(1.0, 1.0, 1.0);
+    Ray ray = camera_ray;
+    double bounce_pdf = 0.0;
+    RayCone cone(0.0, pixel_spread); // Surfaces are taken as flat, so bounces keep the spread
+    ShadingBatch batch;
+
+    for (int depth = 0; depth < max_depth; ++depth) {
+        HitRecord rec;
+        if (!scene.intersect(ray, RAY_EPSILON, infinity, rec)) {
+            color value = throughput * miss_radiance(scene, ray, bounce_pdf);
+            if (clamp && depth > 0) value = clamp_indirect(value);
+            radiance += value;
+            break;
+        }
+
+        // A batch of one lane, through the same kernels the wavefront uses
+        const Material& material = scene.materials[rec.material_id];
+        cone = cone.at(rec.t * ray.direction().length());
+        begin_shading_batch(batch, scene.environment.get());
+        load_shading_lane(batch, rec, ray, throughput, material, surface_albedo(scene, rec, ray, cone),
+                          scene.environment.get(), rng);
+        shade_batch(material, batch);
+        SurfaceScatter scatter;
+        read_shading_lane(batch, 0, throughput, scatter);
+        if (scatter.has_shadow && !scene.occluded(scatter.shadow, infinity)) {
+            radiance += clamp && depth > 0 ? clamp_indirect(scatter.direct) : scatter.direct;
+        }
+        if (!scatter.has_next) break;
+
+        // Survivors are reweighted by 1 / p, keeping the estimate unbiased
+        if (roulette && depth + 1 >= ROULETTE_DEPTH && depth + 1 < max_depth) {
+            double survive = std::min(0.95, std::max(throughput.x(), std::max(throughput.y(), throughput.z())));
+            if (rng.next_double() >= survive) break;
+            throughput = throughput / survive;
+        }
+        ray = scatter.next;
+        bounce_pdf = scatter.pdf;
+    }
+    return radiance;
+}
+
+template color trace_path_features<0>(const SceneAccel&, const Ray&, Rng&, int, double);
+template color trace_path_features<1>(const SceneAccel&, const Ray&, Rng&, int, double);
+template color trace_path_features<2>(const SceneAccel&, const Ray&, Rng&, int, double);
+template color trace_path_features<3>(const SceneAccel&, const Ray&, Rng&, int, double);
@@ -0,0 +1,165 @@
+#include "rendering/pixel_buffer.hpp"
+#include <cstdio>
+#include <new>
+#include <algorithm>
+
+PixelBuffer::PixelBuffer() {
+    m_xSize = 0.0;
+    m_ySize = 0.0;
+    m_intXSize = 0;
+    m_intYSize = 0;
+    m_pixels = nullptr;
+    m_pixelCount = 0;
+    m_capacity = 0;
+    m_scratchPixels = nullptr;
+    m_scratchCapacity = 0;
+}
+
+PixelBuffer::~PixelBuffer() {
+    free_pixels(m_pixels);
+    free_pixels(m_scratchPixels);
+}
+
+// Pixel is trivially copyable, so raw storage can be used without constructing each element
+Pixel* PixelBuffer::allocate_pixels(size_t count) {
+    return static_cast<Pixel*>(::operator new(count * sizeof(Pixel), std::align_val_t(alignof(Pixel))));
+}
+
+void PixelBuffer::free_pixels(Pixel* pixels) {
+    if (pixels != nullptr) {
+        ::operator delete(pixels, std::align_val_t(alignof(Pixel)));
+    }
+}
+
+// Grow the pixel buffer only when it is too small; contents are not preserved
+void PixelBuffer::reserve_pixels(size_t count) {
+    if (count <= m_capacity) return;
+    
+    // Headroom absorbs the small growth steps of an interactive window drag
+    size_t new_capacity = count + count / 4;
+    free_pixels(m_pixels);
+    m_pixels = allocate_pixels(new_capacity);
+    m_capacity = new_capacity;
+}
+
+void PixelBuffer::initialize(const double xSize, const double ySize) {
+    m_xSize = xSize;
+    m_ySize = ySize;
+    
+    // Cache integer versions for performance
+    m_intXSize = static_cast<int>(xSize);
+    m_intYSize = static_cast<int>(ySize);
+  
+    // Allocate contiguous pixel array for better cache performance
+    m_pixelCount = static_cast<size_t>(m_intXSize) * m_intYSize;
+    reserve_pixels(m_pixelCount);
+    std::fill(m_pixels, m_pixels + m_pixelCount, Pixel());
+}
+
+// Fast pixel setting for performance-critical paths
+void PixelBuffer::setpixel(const double x, const double y, const double red, const double green, const double blue) {
+    int int_x = static_cast<int>(x);
+    int int_y = static_cast<int>(y);
+    
+    // Bounds check
+    if (int_x >= 0 && int_x < m_intXSize && int_y >= 0 && int_y < m_intYSize) {
+        int index = int_y * m_intXSize + int_x; // Row-major order for cache efficiency
+        m_pixels[index] = Pixel(red, green, blue);
+    }
+}
+
+// Thread-safe version for multi-threaded rendering
+void PixelBuffer::setpixel_safe(const double x, const double y, const double red, const double green, const double blue) {
+    int int_x = static_cast<int>(x);
+    int int_y = static_cast<int>(y);
+    
+    if (int_x >= 0 && int_x < m_intXSize && int_y >= 0 && int_y < m_intYSize) {
+        int index = int_y * m_intXSize + int_x;
+        std::lock_guard<std::mutex> lock(m_pixelMutex);
+        m_pixels[index] = Pixel(red, green, blue);
+    }
+}
+
+// Set a block of pixels to the same color (useful for progressive rendering)
+void PixelBuffer::setpixel_block(int start_x, int start_y, int end_x, int end_y, const double red, const double green, const double blue) {
+    Pixel pixel(red, green, blue);
+    
+    for (int y = start_y; y < end_y && y < m_intYSize; ++y) {
+        for (int x = start_x; x < end_x && x < m_intXSize; ++x) {
+            int index = y * m_intXSize + x;
+            m_pixels[index] = pixel;
+        }
+    }
+}
+
+// Blend a new sample into the running mean without a separate sum buffer
+void PixelBuffer::accumulate_pixel(int x, int y, const double red, const double green, const double blue, int sample_index) {
+    if (x < 0 || x >= m_intXSize || y < 0 || y >= m_intYSize) return;
+    
+    Pixel& pixel = m_pixels[y * m_intXSize + x];
+    if (sample_index <= 0) {
+        pixel = Pixel(red, green, blue);
+        return;
+    }
+    
+    double weight = 1.0 / (sample_index + 1);
+    double old_luminance = pixel.luminance();
+    pixel.r += (red - pixel.r) * weight;
+    pixel.g += (green - pixel.g) * weight;
+    pixel.b += (blue - pixel.b) * weight;
+    double value = Pixel(red, green, blue).luminance();
+    pixel.luminance_m2 = update_luminance_m2(pixel.luminance_m2, old_luminance, pixel.luminance(), value);
+}
+
+void PixelBuffer::resize(const double new_xSize, const double new_ySize, ResizeContent content) {
+    // Safety checks
+    if (new_xSize <= 0 || new_ySize <= 0 || new_xSize > 5000 || new_ySize > 5000) {
+        printf("Resize rejected: invalid dimensions %.0fx%.0f\n", new_xSize, new_ySize);
+        return;
+    }
+    
+    int new_width = static_cast<int>(new_xSize);
+    int new_height = static_cast<int>(new_ySize);
+    size_t new_count = static_cast<size_t>(new_width) * new_height;
+    
+    if (content == ResizeContent::Rescale && m_pixelCount > 0) {
+        // Rescale into the retained scratch buffer, then swap it in
+        if (new_count > m_scratchCapacity) {
+            free_pixels(m_scratchPixels);
+            m_scratchCapacity = new_count + new_count / 4;
+            m_scratchPixels = allocate_pixels(m_scratchCapacity);
+        }
+        rescale_into(m_scratchPixels, new_width, new_height);
+        std::swap(m_pixels, m_scratchPixels);
+        std::swap(m_capacity, m_scratchCapacity);
+    } else {
+        reserve_pixels(new_count);
+        if (content != ResizeContent::Discard) {
+            std::fill(m_pixels, m_pixels + new_count, Pixel());
+        }
+    }
+    
+    m_xSize = new_xSize;
+    m_ySize = new_ySize;
+    
+    // Cache integer versions
+    m_intXSize = new_width;
+    m_intYSize = new_height;
+    m_pixelCount = new_count;
+    
+    // Image::display() recreates the texture at the new size
+}
+
+// Nearest-neighbour resample of the current pixels into a buffer of the new size
+void PixelBuffer::rescale_into(Pixel* destination, int new_width, int new_height) const {
+    for (int y = 0; y < new_height; ++y) {
+        int src_y = static_cast<int>((static_cast<long long>(y) * m_intYSize) / new_height);
+        const Pixel* src_row = m_pixels + static_cast<size_t>(src_y) * m_intXSize;
+        Pixel* dst_row = destination + static_cast<size_t>(y) * new_width;
+        
+        for (int x = 0; x < new_width; ++x) {
+            int src_x = static_cast<int>((static_cast<long long>(x) * m_intXSize) / new_width);
+            dst_row[x] = src_row[src_x];
+        }
+    }
+}
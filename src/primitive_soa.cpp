@@ -0,0 +1,217 @@
+#include "geometry/primitive_soa.hpp"
+#include <cmath>
+
+#if defined(__AVX2__) && defined(__FMA__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+// Thin wrappers so one kernel body serves every width
+#if defined(__AVX2__) && defined(__FMA__)
+const int WIDTH = 8;
+typedef __m256 vfloat;
+inline vfloat load(const float* p) { return _mm256_loadu_ps(p); }
+inline vfloat splat(float x) { return _mm256_set1_ps(x); }
+inline vfloat add(vfloat a, vfloat b) { return _mm256_add_ps(a, b); }
+inline vfloat sub(vfloat a, vfloat b) { return _mm256_sub_ps(a, b); }
+inline vfloat mul(vfloat a, vfloat b) { return _mm256_mul_ps(a, b); }
+inline vfloat div(vfloat a, vfloat b) { return _mm256_div_ps(a, b); }
+inline vfloat msub(vfloat a, vfloat b, vfloat c, vfloat d) { return _mm256_fmsub_ps(a, b, _mm256_mul_ps(c, d)); }
+inline vfloat sqrt_v(vfloat a) { return _mm256_sqrt_ps(a); }
+inline vfloat select(vfloat mask, vfloat a, vfloat b) { return _mm256_blendv_ps(b, a, mask); }
+inline vfloat mask_and(vfloat a, vfloat b) { return _mm256_and_ps(a, b); }
+inline vfloat greater(vfloat a, vfloat b) { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+inline vfloat greater_equal(vfloat a, vfloat b) { return _mm256_cmp_ps(a, b, _CMP_GE_OQ); }
+inline vfloat less(vfloat a, vfloat b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+inline vfloat not_equal(vfloat a, vfloat b) { return _mm256_cmp_ps(a, b, _CMP_NEQ_OQ); }
+inline int bits(vfloat mask) { return _mm256_movemask_ps(mask); }
+inline void store(float* p, vfloat a) { _mm256_storeu_ps(p, a); }
+#elif defined(__SSE2__)
+const int WIDTH = 4;
+typedef __m128 vfloat;
+inline vfloat load(const float* p) { return _mm_loadu_ps(p); }
+inline vfloat splat(float x) { return _mm_set1_ps(x); }
+inline vfloat add(vfloat a, vfloat b) { return _mm_add_ps(a, b); }
+inline vfloat sub(vfloat a, vfloat b) { return _mm_sub_ps(a, b); }
+inline vfloat mul(vfloat a, vfloat b) { return _mm_mul_ps(a, b); }
+inline vfloat div(vfloat a, vfloat b) { return _mm_div_ps(a, b); }
+inline vfloat msub(vfloat a, vfloat b, vfloat c, vfloat d) { return _mm_sub_ps(_mm_mul_ps(a, b), _mm_mul_ps(c, d)); }
+inline vfloat sqrt_v(vfloat a) { return _mm_sqrt_ps(a); }
+inline vfloat select(vfloat mask, vfloat a, vfloat b) { return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b)); }
+inline vfloat mask_and(vfloat a, vfloat b) { return _mm_and_ps(a, b); }
+inline vfloat greater(vfloat a, vfloat b) { return _mm_cmpgt_ps(a, b); }
+inline vfloat greater_equal(vfloat a, vfloat b) { return _mm_cmpge_ps(a, b); }
+inline vfloat less(vfloat a, vfloat b) { return _mm_cmplt_ps(a, b); }
+inline vfloat not_equal(vfloat a, vfloat b) { return _mm_cmpneq_ps(a, b); }
+inline int bits(vfloat mask) { return _mm_movemask_ps(mask); }
+inline void store(float* p, vfloat a) { _mm_storeu_ps(p, a); }
+#else
+const int WIDTH = 1;
+typedef float vfloat;
+inline vfloat load(const float* p) { return *p; }
+inline vfloat splat(float x) { return x; }
+inline vfloat add(vfloat a, vfloat b) { return a + b; }
+inline vfloat sub(vfloat a, vfloat b) { return a - b; }
+inline vfloat mul(vfloat a, vfloat b) { return a * b; }
+inline vfloat div(vfloat a, vfloat b) { return a / b; }
+inline vfloat msub(vfloat a, vfloat b, vfloat c, vfloat d) { return a * b - c * d; }
+inline vfloat sqrt_v(vfloat a) { return std::sqrt(a); }
+// Masks are 0 or 1 in the scalar build
+inline vfloat select(vfloat mask, vfloat a, vfloat b) { return mask != 0.0f ? a : b; }
+inline vfloat mask_and(vfloat a, vfloat b) { return (a != 0.0f && b != 0.0f) ? 1.0f : 0.0f; }
+inline vfloat greater(vfloat a, vfloat b) { return a > b ? 1.0f : 0.0f; }
+inline vfloat greater_equal(vfloat a, vfloat b) { return a >= b ? 1.0f : 0.0f; }
+inline vfloat less(vfloat a, vfloat b) { return a < b ? 1.0f : 0.0f; }
+inline vfloat not_equal(vfloat a, vfloat b) { return a != b ? 1.0f : 0.0f; }
+inline int bits(vfloat mask) { return mask != 0.0f ? 1 : 0; }
+inline void store(float* p, vfloat a) { *p = a; }
+#endif
+
+// Padding keeps WIDTH-wide loads in bounds from the last position
+const size_t PADDING = 8;
+
+// Relative slack on barycentrics and t, far above float rounding error
+const float TOLERANCE = 1e-4f;
+
+// Möller–Trumbore on WIDTH triangles starting at position base; returns the
+// lane mask of candidate hits in the widened (t_min, t_max)
+inline int triangle_lanes(const TriangleSoA& tris, size_t base, const RayF& ray, vfloat t_min, vfloat t_max) {
+    vfloat dx = splat(ray.direction[0]), dy = splat(ray.direction[1]), dz = splat(ray.direction[2]);
+    vfloat e1x = load(&tris.e1x[base]), e1y = load(&tris.e1y[base]), e1z = load(&tris.e1z[base]);
+    vfloat e2x = load(&tris.e2x[base]), e2y = load(&tris.e2y[base]), e2z = load(&tris.e2z[base]);
+
+    // p = d x e2, det = e1 . p
+    vfloat px = msub(dy, e2z, dz, e2y);
+    vfloat py = msub(dz, e2x, dx, e2z);
+    vfloat pz = msub(dx, e2y, dy, e2x);
+    vfloat det = add(add(mul(e1x, px), mul(e1y, py)), mul(e1z, pz));
+    vfloat inv_det = div(splat(1.0f), det);
+
+    vfloat sx = sub(splat(ray.origin[0]), load(&tris.v0x[base]));
+    vfloat sy = sub(splat(ray.origin[1]), load(&tris.v0y[base]));
+    vfloat sz = sub(splat(ray.origin[2]), load(&tris.v0z[base]));
+    vfloat u = mul(add(add(mul(sx, px), mul(sy, py)), mul(sz, pz)), inv_det);
+
+    // q = s x e1
+    vfloat qx = msub(sy, e1z, sz, e1y);
+    vfloat qy = msub(sz, e1x, sx, e1z);
+    vfloat qz = msub(sx, e1y, sy, e1x);
+    vfloat v = mul(add(add(mul(dx, qx), mul(dy, qy)), mul(dz, qz)), inv_det);
+    vfloat t = mul(add(add(mul(e2x, qx), mul(e2y, qy)), mul(e2z, qz)), inv_det);
+
+    vfloat low = splat(-TOLERANCE);
+    vfloat hit = greater_equal(u, low);
+    hit = mask_and(hit, greater_equal(v, low));
+    hit = mask_and(hit, greater_equal(splat(1.0f + TOLERANCE), add(u, v)));
+    hit = mask_and(hit, greater(t, t_min));
+    hit = mask_and(hit, less(t, t_max));
+    // A zero float determinant may still be a valid double hit
+    return bits(hit) | (bits(not_equal(det, splat(0.0f))) ^ ((1 << WIDTH) - 1));
+}
+
+inline int lane_limit(uint32_t remaining) {
+    return remaining >= static_cast<uint32_t>(WIDTH) ? (1 << WIDTH) - 1 : (1 << remaining) - 1;
+}
+
+}
+
+size_t TriangleSoA::padded_size(size_t count) {
+    return count + PADDING;
+}
+
+int soa_kernel_width() {
+    return WIDTH;
+}
+
+void TriangleSoA::build(const TriangleMesh& mesh, const std::vector<uint32_t>& order) {
+    count = order.size();
+    std::vector<float>* arrays[9] = {&v0x, &v0y, &v0z, &e1x, &e1y, &e1z, &e2x, &e2y, &e2z};
+    for (std::vector<float>* values : arrays) {
+        values->clear();
+        values->resize(padded_size(count), 0.0f);
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        const uint32_t* tri = &mesh.indices[3 * static_cast<size_t>(order[i])];
+        point3 p0 = mesh.vertex(tri[0]);
+        vec3 e1 = mesh.vertex(tri[1]) - p0;
+        vec3 e2 = mesh.vertex(tri[2]) - p0;
+        for (int a = 0; a < 3; ++a) {
+            (*arrays[a])[i] = static_cast<float>(p0[a]);
+            (*arrays[3 + a])[i] = static_cast<float>(e1[a]);
+            (*arrays[6 + a])[i] = static_cast<float>(e2[a]);
+        }
+    }
+}
+
+void SphereSoA::add(const point3& center, double r) {
+    std::vector<float>* arrays[4] = {&cx, &cy, &cz, &radius};
+    float values[4] = {static_cast<float>(center.x()), static_cast<float>(center.y()),
+                       static_cast<float>(center.z()), static_cast<float>(r)};
+    for (int k = 0; k < 4; ++k) {
+        arrays[k]->resize(count + PADDING, 0.0f);
+        (*arrays[k])[count] = values[k];
+    }
+    count++;
+}
+
+uint32_t triangle_candidates_soa(const TriangleSoA& tris, uint32_t first, uint32_t count, const RayF& ray,
+                                 double t_min, double t_max) {
+    // Widen the interval; infinite t_max stays infinite
+    float near_t = static_cast<float>(t_min - TOLERANCE * (1.0 + std::fabs(t_min)));
+    float far_t = static_cast<float>(t_max + TOLERANCE * (1.0 + std::fabs(t_max)));
+    vfloat near_v = splat(near_t), far_v = splat(far_t);
+
+    uint32_t result = 0;
+    for (uint32_t offset = 0; offset < count; offset += WIDTH) {
+        int mask = triangle_lanes(tris, first + offset, ray, near_v, far_v);
+        result |= static_cast<uint32_t>(mask & lane_limit(count - offset)) << offset;
+    }
+    return result;
+}
+
+int intersect_spheres_soa(const SphereSoA& spheres, uint32_t first, uint32_t count, const RayF& ray,
+                          float t_min, float& t_max) {
+    int best = -1;
+    vfloat dx = splat(ray.direction[0]), dy = splat(ray.direction[1]), dz = splat(ray.direction[2]);
+    vfloat a = add(add(mul(dx, dx), mul(dy, dy)), mul(dz, dz));
+    vfloat zero = splat(0.0f);
+
+    for (uint32_t offset = 0; offset < count; offset += WIDTH) {
+        size_t base = first + offset;
+        vfloat ox = sub(splat(ray.origin[0]), load(&spheres.cx[base]));
+        vfloat oy = sub(splat(ray.origin[1]), load(&spheres.cy[base]));
+        vfloat oz = sub(splat(ray.origin[2]), load(&spheres.cz[base]));
+        vfloat r = load(&spheres.radius[base]);
+
+        // Half-b form: t = (-b -+ sqrt(b^2 - a c)) / a
+        vfloat b = add(add(mul(ox, dx), mul(oy, dy)), mul(oz, dz));
+        vfloat c = sub(add(add(mul(ox, ox), mul(oy, oy)), mul(oz, oz)), mul(r, r));
+        vfloat disc = msub(b, b, a, c);
+        vfloat root = sqrt_v(select(greater_equal(disc, zero), disc, zero));
+        vfloat t_near = div(sub(sub(zero, b), root), a);
+        vfloat t_far = div(add(sub(zero, b), root), a);
+
+        // Nearer root unless it lies before t_min (origin inside the sphere)
+        vfloat t = select(greater(t_near, splat(t_min)), t_near, t_far);
+        vfloat hit = mask_and(greater_equal(disc, zero), greater(r, zero));
+        hit = mask_and(hit, greater(t, splat(t_min)));
+        hit = mask_and(hit, less(t, splat(t_max)));
+        int mask = bits(hit) & lane_limit(count - offset);
+        if (mask == 0) continue;
+
+        float t_lanes[WIDTH];
+        store(t_lanes, t);
+        for (; mask != 0; mask &= mask - 1) {
+            int lane = __builtin_ctz(mask);
+            if (t_lanes[lane] < t_max) {
+                t_max = t_lanes[lane];
+                best = static_cast<int>(base + lane);
+            }
+        }
+    }
+    return best;
+}
@@ -0,0 +1,77 @@
+#include "rendering/sampling_pattern.hpp"
+#include <algorithm>
+#include <cmath>
+
+int SamplingPattern::stride(int x, int y) const {
+    if (mode != SAMPLING_FOVEATED) return 1;
+    // Distance from the cell centre, so every pixel of a cell agrees
+    double cx = (x / FOVEATED_CELL + 0.5) * FOVEATED_CELL;
+    double cy = (y / FOVEATED_CELL + 0.5) * FOVEATED_CELL;
+    double rings = std::sqrt((cx - focus_x) * (cx - focus_x) + (cy - focus_y) * (cy - focus_y)) / std::max(fovea_radius, 1.0);
+    int step = 1;
+    for (int ring = 1; ring <= rings && step < FOVEATED_CELL; ++ring) step *= 2;
+    return step;
+}
+
+bool SamplingPattern::traces(int x, int y) const {
+    switch (mode) {
+        case SAMPLING_CHECKERBOARD: return ((x + y) & 1) == parity;
+        case SAMPLING_FOVEATED: {
+            int step = stride(x, y);
+            return x % step == 0 && y % step == 0;
+        }
+        default: return true;
+    }
+}
+
+size_t SamplingPattern::traced_count(int width, int height) const {
+    size_t count = 0;
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) count += traces(x, y);
+    }
+    return count;
+}
+
+const char* sampling_mode_name(SamplingMode mode) {
+    switch (mode) {
+        case SAMPLING_FULL: return "full";
+        case SAMPLING_CHECKERBOARD: return "checkerboard";
+        case SAMPLING_FOVEATED: return "foveated";
+        default: return "unknown";
+    }
+}
+
+void reconstruct_tile(const SamplingPattern& pattern, const RenderTile& tile, double* rgb, size_t pixel_stride,
+                      int width, int height) {
+    if (pattern.mode == SAMPLING_FULL) return;
+    auto pixel = [&](int x, int y) { return rgb + (static_cast<size_t>(y) * width + x) * pixel_stride; };
+
+    for (int y = tile.start_y; y < tile.end_y; ++y) {
+        for (int x = tile.start_x; x < tile.end_x; ++x) {
+            if (pattern.traces(x, y)) continue;
+            double* out = pixel(x, y);
+
+            if (pattern.mode == SAMPLING_FOVEATED) {
+                int step = pattern.stride(x, y);
+                const double* source = pixel(x - x % step, y - y % step);
+                for (int c = 0; c < 3; ++c) out[c] = source[c];
+                continue;
+            }
+
+            // Checkerboard: edge-on neighbours all have the traced parity
+            static const int offsets[4][2] = {{-1, 0}, {1, 0}, {0, -1}, {0, 1}};
+            double low[3] = {1e300, 1e300, 1e300}, high[3] = {-1e300, -1e300, -1e300};
+            for (const int* offset : offsets) {
+                int nx = x + offset[0], ny = y + offset[1];
+                if (nx < 0 || nx >= width || ny < 0 || ny >= height) continue;
+                const double* neighbour = pixel(nx, ny);
+                for (int c = 0; c < 3; ++c) {
+                    low[c] = std::min(low[c], neighbour[c]);
+                    high[c] = std::max(high[c], neighbour[c]);
+                }
+            }
+            if (low[0] > high[0]) continue; // A 1x1 image has no neighbours
+            for (int c = 0; c < 3; ++c) out[c] = std::clamp(out[c], low[c], high[c]);
+        }
+    }
+}
@@ -0,0 +1,289 @@
+#include "geometry/scene.hpp"
+#include <cstdio>
+
+bool SceneAccel::intersect(const Ray& r, double t_min, double t_max, HitRecord& rec) const {
+    int hit_instance = -1;
+
+    tlas.traverse(r, t_min, t_max, [&](uint32_t instance_index, double& closest) {
+        const Instance& instance = instances[instance_index];
+        const BLAS* bottom = blas[instance.mesh_id].get();
+        if (bottom == nullptr) return false;
+
+        // Same parameterization in object space, so closest carries over as-is
+        Ray object_ray = instance.world_to_object.apply(r);
+        HitRecord object_rec;
+        if (!bottom->intersect(object_ray, t_min, closest, object_rec)) return false;
+
+        closest = object_rec.t;
+        rec.u = object_rec.u;
+        rec.v = object_rec.v;
+        rec.prim_id = object_rec.prim_id;
+        hit_instance = static_cast<int>(instance_index);
+        return true;
+    });
+
+    if (hit_instance < 0) return false;
+
+    const Instance& instance = instances[hit_instance];
+    vec3 object_normal = blas[instance.mesh_id]->face_normal(rec.prim_id);
+    rec.t = t_max;
+    rec.p = r.at(t_max);
+    rec.instance_id = hit_instance;
+    rec.material_id = instance.material_id;
+    rec.set_face_normal(r, unit_vector(instance.world_to_object.apply_transpose(object_normal)));
+    return true;
+}
+
+bool SceneAccel::occluded(const Ray& r, double t_max) const {
+    return tlas.traverse_any(r, RAY_EPSILON, t_max, [&](uint32_t instance_index) {
+        const Instance& instance = instances[instance_index];
+        const BLAS* bottom = blas[instance.mesh_id].get();
+        return bottom != nullptr && bottom->occluded(instance.world_to_object.apply(r), RAY_EPSILON, t_max);
+    });
+}
+
+void SceneAccel::occluded_packet(const Ray* rays, const double* t_max, int count, bool* occluded) const {
+    uint32_t active = count >= 32 ? 0xFFFFFFFFu : (1u << count) - 1;
+    Ray object_rays[MAX_PACKET];
+
+    uint32_t blocked = tlas.traverse_any_packet(rays, count, RAY_EPSILON, t_max, active, [&](uint32_t instance_index, uint32_t mask) {
+        const Instance& instance = instances[instance_index];
+        const BLAS* bottom = blas[instance.mesh_id].get();
+        if (bottom == nullptr) return 0u;
+        for (uint32_t m = mask; m != 0; m &= m - 1) {
+            int i = __builtin_ctz(m);
+            object_rays[i] = instance.world_to_object.apply(rays[i]);
+        }
+        return bottom->occluded_packet(object_rays, count, RAY_EPSILON, t_max, mask);
+    });
+
+    for (int i = 0; i < count; ++i) occluded[i] = (blocked >> i) & 1;
+}
+
+Scene::Scene() {
+    materials.push_back(Material::diffuse(color(0.6, 0.6, 0.6)));
+    materials.push_back(Material::diffuse(color(0.8, 0.35, 0.3)));
+    materials.push_back(Material::diffuse(color(0.35, 0.75, 0.35)));
+    materials.push_back(Material::diffuse(color(0.3, 0.4, 0.8)));
+}
+
+int Scene::add_mesh(TriangleMesh mesh) {
+    return add_mesh(std::make_shared<const TriangleMesh>(std::move(mesh)));
+}
+
+int Scene::add_mesh(std::shared_ptr<const TriangleMesh> mesh) {
+    std::lock_guard<std::mutex> lock(edit_mutex);
+    meshes.push_back(std::move(mesh));
+    compressed.push_back(nullptr);
+    blas.push_back(nullptr);
+    dynamic.push_back(nullptr);
+    prebuilt.push_back(0);
+    return static_cast<int>(meshes.size()) - 1;
+}
+
+int Scene::add_compressed_mesh(std::shared_ptr<const MeshletMesh> meshlets) {
+    std::lock_guard<std::mutex> lock(edit_mutex);
+    meshes.push_back(nullptr);
+    compressed.push_back(std::move(meshlets));
+    blas.push_back(nullptr);
+    dynamic.push_back(nullptr);
+    prebuilt.push_back(0);
+    return static_cast<int>(meshes.size()) - 1;
+}
+
+int Scene::add_built_mesh(std::shared_ptr<const BLAS> built) {
+    std::lock_guard<std::mutex> lock(edit_mutex);
+    meshes.push_back(built->mesh);
+    compressed.push_back(nullptr);
+    blas.push_back(std::move(built));
+    dynamic.push_back(nullptr);
+    prebuilt.push_back(1);
+    return static_cast<int>(meshes.size()) - 1;
+}
+
+int Scene::add_material(const Material& material) {
+    std::lock_guard<std::mutex> lock(edit_mutex);
+    materials.push_back(material);
+    return static_cast<int>(materials.size()) - 1;
+}
+
+int Scene::add_instance(int mesh_id, const Transform& object_to_world, int material_id) {
+    std::lock_guard<std::mutex> lock(edit_mutex);
+    if (material_id >= static_cast<int>(materials.size())) {
+        printf("Material %d does not exist; using the default palette\n", material_id);
+        material_id = -1;
+    }
+    Instance instance;
+    instance.mesh_id = mesh_id;
+    instance.material_id = material_id < 0 ? static_cast<int>(instances.size()) % DEFAULT_PALETTE : material_id;
+    instance.object_to_world = object_to_world;
+    instance.world_to_object = object_to_world.inverse();
+    instances.push_back(instance);
+    return static_cast<int>(instances.size()) - 1;
+}
+
+void Scene::set_instance_transform(int instance_id, const Transform& object_to_world, ThreadPool* pool) {
+    std::lock_guard<std::mutex> lock(edit_mutex);
+    instances[instance_id].object_to_world = object_to_world;
+    instances[instance_id].world_to_object = object_to_world.inverse();
+    install_locked(pool);
+}
+
+void Scene::set_environment(std::shared_ptr<const EnvironmentMap> map, ThreadPool* pool) {
+    std::lock_guard<std::mutex> lock(edit_mutex);
+    environment = std::move(map);
+    install_locked(pool);
+}
+
+void Scene::set_textures(std::shared_ptr<TextureCache> cache, ThreadPool* pool) {
+    std::lock_guard<std::mutex> lock(edit_mutex);
+    textures = std::move(cache);
+    install_locked(pool);
+}
+
+void Scene::update_mesh_vertices(int mesh_id, const std::vector<uint32_t>& vertex_ids,
+                                 const std::vector<point3>& positions, ThreadPool* pool) {
+    std::lock_guard<std::mutex> lock(edit_mutex);
+    if (!meshes[mesh_id]) {
+        printf("Mesh %d is compressed and cannot be animated\n", mesh_id);
+        return;
+    }
+    if (!dynamic[mesh_id]) dynamic[mesh_id] = std::make_unique<DynamicBLAS>(*meshes[mesh_id], pool);
+
+    blas[mesh_id] = dynamic[mesh_id]->update_vertices(vertex_ids, positions, pool);
+    meshes[mesh_id] = blas[mesh_id]->mesh;
+    install_locked(pool);
+}
+
+size_t Scene::mesh_count() const {
+    std::lock_guard<std::mutex> lock(edit_mutex);
+    return meshes.size();
+}
+
+size_t Scene::instance_count() const {
+    std::lock_guard<std::mutex> lock(edit_mutex);
+    return instances.size();
+}
+
+size_t Scene::material_count() const {
+    std::lock_guard<std::mutex> lock(edit_mutex);
+    return materials.size();
+}
+
+size_t Scene::unique_triangle_count() const {
+    std::lock_guard<std::mutex> lock(edit_mutex);
+    size_t total = 0;
+    for (size_t i = 0; i < meshes.size(); ++i) total += mesh_triangles_locked(i);
+    return total;
+}
+
+size_t Scene::instanced_triangle_count() const {
+    std::lock_guard<std::mutex> lock(edit_mutex);
+    size_t total = 0;
+    for (const Instance& instance : instances) total += mesh_triangles_locked(instance.mesh_id);
+    return total;
+}
+
+size_t Scene::mesh_triangles_locked(size_t mesh_id) const {
+    // Compressed prebuilt meshes have only their bottom level
+    if (meshes[mesh_id]) return meshes[mesh_id]->triangle_count();
+    return compressed[mesh_id] ? compressed[mesh_id]->triangle_count() : blas[mesh_id]->triangle_count();
+}
+
+void Scene::build_lbvh(ThreadPool* pool) {
+    build(pool, BUILD_LBVH);
+}
+
+void Scene::build_sah(ThreadPool* pool) {
+    build(pool, BUILD_SAH);
+}
+
+void Scene::build_lazy(ThreadPool* pool) {
+    build(pool, BUILD_LAZY);
+}
+
+bool Scene::build_quick(ThreadPool* pool, size_t lazy_threshold) {
+    bool lazy = unique_triangle_count() > lazy_threshold;
+    build(pool, lazy ? BUILD_LAZY : BUILD_LBVH);
+    return lazy;
+}
+
+void Scene::build(ThreadPool* pool, BuildMode mode) {
+    // Build bottom levels outside the lock so instance edits stay responsive
+    std::vector<std::shared_ptr<const TriangleMesh>> mesh_list;
+    std::vector<std::shared_ptr<const MeshletMesh>> compressed_list;
+    {
+        std::lock_guard<std::mutex> lock(edit_mutex);
+        mesh_list = meshes;
+        compressed_list = compressed;
+        for (size_t i = 0; i < mesh_list.size(); ++i) {
+            if (dynamic[i] || prebuilt[i]) mesh_list[i] = nullptr;
+        }
+    }
+
+    // Meshlets have no lazy form; their LBVH is already quick
+    std::vector<std::shared_ptr<const BLAS>> built(mesh_list.size());
+    for (size_t i = 0; i < mesh_list.size(); ++i) {
+        if (compressed_list[i]) {
+            built[i] = build_blas(compressed_list[i], pool, mode == BUILD_SAH);
+        } else if (mesh_list[i]) {
+            built[i] = mode == BUILD_LAZY ? build_blas_lazy(mesh_list[i], pool) : build_blas(mesh_list[i], pool, mode == BUILD_SAH);
+        }
+    }
+
+    // Publish against the instance transforms current at install time
+    std::lock_guard<std::mutex> lock(edit_mutex);
+    for (size_t i = 0; i < built.size(); ++i) {
+        // A mesh that started animating during the build keeps its refitted BLAS
+        if (built[i] && !dynamic[i]) blas[i] = built[i];
+    }
+    install_locked(pool);
+}
+
+void Scene::install_locked(ThreadPool* pool) {
+    std::shared_ptr<SceneAccel> next = std::make_shared<SceneAccel>();
+    next->blas = blas;
+    next->instances = instances;
+    next->environment = environment;
+    next->materials = materials;
+    next->textures = textures;
+
+    // Instances whose mesh has no bottom level yet are left out of the top level
+    std::vector<AABB> instance_bounds;
+    std::vector<uint32_t> placed;
+    for (size_t i = 0; i < instances.size(); ++i) {
+        Instance& instance = next->instances[i];
+        const BLAS* bottom = blas[instance.mesh_id].get();
+        if (bottom == nullptr || bottom->empty()) continue;
+        instance.world_bounds = transform_box(instance.object_to_world, bottom->bounds());
+        instance_bounds.push_back(instance.world_bounds);
+        placed.push_back(static_cast<uint32_t>(i));
+    }
+
+    // The top level is small; SAH quality is cheap here
+    next->tlas = build_bvh_binned_sah(instance_bounds, pool, 1);
+    for (uint32_t& index : next->tlas.prim_indices) {
+        index = placed[index];
+    }
+    std::atomic_store(&accel, std::shared_ptr<const SceneAccel>(std::move(next)));
+}
+
+std::shared_ptr<const SceneAccel> Scene::acquire() const {
+    return std::atomic_load(&accel);
+}
+
+void add_default_scene(Scene& scene) {
+    TriangleMesh ground;
+    ground.add_quad(point3(-50.0, 0.0, 50.0), vec3(100.0, 0.0, 0.0), vec3(0.0, 0.0, -100.0));
+    int ground_id = scene.add_mesh(std::move(ground));
+    scene.add_instance(ground_id, Transform::translate(vec3(0.0, -0.5, 0.0)));
+
+    // One unit sphere mesh, placed three times
+    TriangleMesh sphere;
+    sphere.add_sphere(point3(0.0, 0.0, 0.0), 1.0, 96, 48);
+    int sphere_id = scene.add_mesh(std::move(sphere));
+    scene.add_instance(sphere_id, Transform::translate(vec3(0.0, 0.0, -1.2)) * Transform::scale(0.5));
+    scene.add_instance(sphere_id, Transform::translate(vec3(-1.1, 0.0, -1.4)) * Transform::scale(0.5));
+    int metal = scene.add_material(Material::metal(color(0.8, 0.8, 0.85), 0.15));
+    scene.add_instance(sphere_id, Transform::translate(vec3(1.1, 0.0, -1.4)) * Transform::scale(0.5), metal);
+}
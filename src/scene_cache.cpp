@@ -0,0 +1,245 @@
+#include "geometry/scene_cache.hpp"
+#include "geometry/mesh_loader.hpp"
+#include "core/mapped_file.hpp"
+#include "core/binary_format.hpp"
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+namespace {
+
+const char CACHE_MAGIC[8] = {'R', 'T', 'S', 'C', 'A', 'C', 'H', 'E'};
+const size_t HASH_BLOCK = 1 << 20;
+const uint64_t FNV_OFFSET = 14695981039346656037ull;
+const uint64_t FNV_PRIME = 1099511628211ull;
+
+uint64_t fnv1a(const unsigned char* data, size_t size, uint64_t hash) {
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= data[i];
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+// Copies one section into a vector after checking it is aligned and inside the file
+template<class T>
+bool read_section(const MappedFile& file, const SceneCacheHeader& header, int section, std::vector<T>& out) {
+    uint64_t offset = header.offset[section], bytes = header.bytes[section];
+    return offset % SECTION_ALIGNMENT == 0 && section_in_file(offset, bytes, file.size()) &&
+           copy_section(file.data() + offset, bytes, out);
+}
+
+// Splits the triangle section into the nine SoA arrays, each copied once
+bool read_triangles(const MappedFile& file, const SceneCacheHeader& header, size_t count, TriangleSoA& out) {
+    uint64_t offset = header.offset[CACHE_TRIANGLES], bytes = header.bytes[CACHE_TRIANGLES];
+    uint64_t array_bytes = TriangleSoA::padded_size(count) * sizeof(float);
+    if (offset % SECTION_ALIGNMENT != 0 || !section_in_file(offset, bytes, file.size()) || bytes != 9 * array_bytes) return false;
+    std::vector<float>* arrays[9] = {&out.v0x, &out.v0y, &out.v0z, &out.e1x, &out.e1y, &out.e1z, &out.e2x, &out.e2y, &out.e2z};
+    for (int k = 0; k < 9; ++k) copy_section(file.data() + offset + k * array_bytes, array_bytes, *arrays[k]);
+    out.count = count;
+    return true;
+}
+
+}
+
+uint64_t content_hash(const void* data, size_t size, ThreadPool* pool) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    std::vector<uint64_t> blocks((size + HASH_BLOCK - 1) / HASH_BLOCK);
+    auto hash_block = [&](size_t b, int) {
+        size_t begin = b * HASH_BLOCK;
+        blocks[b] = fnv1a(bytes + begin, std::min(HASH_BLOCK, size - begin), FNV_OFFSET);
+    };
+    parallel_for(pool, blocks.size(), hash_block);
+
+    uint64_t hash = fnv1a(reinterpret_cast<const unsigned char*>(blocks.data()), blocks.size() * sizeof(uint64_t), FNV_OFFSET);
+    uint64_t length = size;
+    return fnv1a(reinterpret_cast<const unsigned char*>(&length), sizeof(length), hash);
+}
+
+bool write_scene_cache(const char* path, const BLAS& blas, uint64_t source_hash) {
+    if (blas.wide.empty() || (!blas.mesh && !blas.meshlets) || (!blas.meshlets && blas.triangles.empty())) {
+        printf("Scene cache: only static meshes with a wide BVH can be cached\n");
+        return false;
+    }
+
+    SceneCacheHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+    header.version = SCENE_CACHE_VERSION;
+    header.byte_order = BYTE_ORDER_MARK;
+    header.content_hash = source_hash;
+    for (int a = 0; a < 3; ++a) {
+        header.bounds[a] = blas.wide.bounds.min[a];
+        header.bounds[3 + a] = blas.wide.bounds.max[a];
+    }
+
+    const void* sections[CACHE_SECTION_COUNT] = {};
+    std::vector<float> triangles;
+    if (blas.meshlets) {
+        const MeshletMesh& meshlets = *blas.meshlets;
+        for (int a = 0; a < 3; ++a) header.meshlet_origin[a] = meshlets.origin[a];
+        header.meshlet_step = meshlets.step;
+        sections[CACHE_MESHLETS] = meshlets.meshlets.data();
+        sections[CACHE_QUANTIZED] = meshlets.quantized.data();
+        sections[CACHE_LOCAL_INDICES] = meshlets.local_indices.data();
+        header.bytes[CACHE_MESHLETS] = meshlets.meshlets.size() * sizeof(Meshlet);
+        header.bytes[CACHE_QUANTIZED] = meshlets.quantized.size() * sizeof(uint16_t);
+        header.bytes[CACHE_LOCAL_INDICES] = meshlets.local_indices.size();
+    } else {
+        sections[CACHE_POSITIONS] = blas.mesh->positions.data();
+        sections[CACHE_INDICES] = blas.mesh->indices.data();
+        header.bytes[CACHE_POSITIONS] = blas.mesh->positions.size() * sizeof(float);
+        header.bytes[CACHE_INDICES] = blas.mesh->indices.size() * sizeof(uint32_t);
+
+        const TriangleSoA& soa = blas.triangles;
+        for (const std::vector<float>* values : {&soa.v0x, &soa.v0y, &soa.v0z, &soa.e1x, &soa.e1y, &soa.e1z, &soa.e2x, &soa.e2y, &soa.e2z}) {
+            triangles.insert(triangles.end(), values->begin(), values->end());
+        }
+        sections[CACHE_TRIANGLES] = triangles.data();
+        header.bytes[CACHE_TRIANGLES] = triangles.size() * sizeof(float);
+        sections[CACHE_UVS] = blas.mesh->uvs.data();
+        header.bytes[CACHE_UVS] = blas.mesh->has_uvs() ? blas.mesh->uvs.size() * sizeof(float) : 0;
+    }
+    sections[CACHE_BVH8_NODES] = blas.wide.nodes.data();
+    sections[CACHE_PRIM_INDICES] = blas.wide.prim_indices.data();
+    header.bytes[CACHE_BVH8_NODES] = blas.wide.nodes.size() * sizeof(BVH8Node);
+    header.bytes[CACHE_PRIM_INDICES] = blas.wide.prim_indices.size() * sizeof(uint32_t);
+    size_t offset = align_up(sizeof(header));
+    for (int s = 0; s < CACHE_SECTION_COUNT; ++s) {
+        header.offset[s] = offset;
+        offset = align_up(offset + header.bytes[s]);
+    }
+
+    std::string temp_path = std::string(path) + ".tmp";
+    FILE* file = fopen(temp_path.c_str(), "wb");
+    if (file == nullptr) {
+        printf("Scene cache: cannot write %s\n", temp_path.c_str());
+        return false;
+    }
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1;
+    size_t written = sizeof(header);
+    for (int s = 0; s < CACHE_SECTION_COUNT && ok; ++s) {
+        ok = write_padding(file, written, header.offset[s]);
+        ok = ok && fwrite(sections[s], 1, header.bytes[s], file) == header.bytes[s];
+        written += header.bytes[s];
+    }
+    ok = fclose(file) == 0 && ok;
+    if (!ok || std::rename(temp_path.c_str(), path) != 0) {
+        printf("Scene cache: failed writing %s\n", path);
+        std::remove(temp_path.c_str());
+        return false;
+    }
+    return true;
+}
+
+std::shared_ptr<const BLAS> read_scene_cache(const char* path, uint64_t source_hash) {
+    // A missing cache is the normal first-launch case, so stay quiet
+    FILE* probe = fopen(path, "rb");
+    if (probe == nullptr) return nullptr;
+    fclose(probe);
+
+    MappedFile file;
+    if (!file.open(path) || file.size() < sizeof(SceneCacheHeader)) return nullptr;
+    SceneCacheHeader header;
+    std::memcpy(&header, file.data(), sizeof(header));
+    if (std::memcmp(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) != 0 || header.version != SCENE_CACHE_VERSION ||
+        header.byte_order != BYTE_ORDER_MARK || header.content_hash != source_hash) {
+        return nullptr;
+    }
+
+    std::shared_ptr<TriangleMesh> mesh = std::make_shared<TriangleMesh>();
+    std::shared_ptr<MeshletMesh> meshlets = std::make_shared<MeshletMesh>();
+    std::shared_ptr<BLAS> blas = std::make_shared<BLAS>();
+    bool ok = read_section(file, header, CACHE_POSITIONS, mesh->positions) &&
+              read_section(file, header, CACHE_INDICES, mesh->indices) &&
+              read_section(file, header, CACHE_UVS, mesh->uvs) &&
+              read_section(file, header, CACHE_MESHLETS, meshlets->meshlets) &&
+              read_section(file, header, CACHE_QUANTIZED, meshlets->quantized) &&
+              read_section(file, header, CACHE_LOCAL_INDICES, meshlets->local_indices) &&
+              read_section(file, header, CACHE_BVH8_NODES, blas->wide.nodes) &&
+              read_section(file, header, CACHE_PRIM_INDICES, blas->wide.prim_indices) &&
+              !blas->wide.nodes.empty() && mesh->positions.size() % 3 == 0 && mesh->indices.size() % 3 == 0;
+
+    // Compressed caches hold meshlets and no mesh; primitive ids are meshlet ids
+    bool compressed = !meshlets->empty();
+    if (ok && compressed) {
+        for (int a = 0; a < 3; ++a) meshlets->origin[a] = header.meshlet_origin[a];
+        meshlets->step = header.meshlet_step;
+        ok = mesh->indices.empty() && meshlets->valid() && blas->wide.prim_indices.size() == meshlets->triangle_count();
+        for (size_t i = 0; i < blas->wide.prim_indices.size() && ok; ++i) {
+            uint32_t prim = blas->wide.prim_indices[i];
+            ok = (prim >> 8) < meshlets->meshlet_count() && (prim & 0xFF) < meshlets->meshlets[prim >> 8].triangle_count;
+        }
+    } else if (ok) {
+        ok = blas->wide.prim_indices.size() == mesh->triangle_count() && (mesh->uvs.empty() || mesh->has_uvs());
+        for (size_t i = 0; i < blas->wide.prim_indices.size() && ok; ++i) ok = blas->wide.prim_indices[i] < mesh->triangle_count();
+        ok = ok && read_triangles(file, header, mesh->triangle_count(), blas->triangles);
+    }
+    if (!ok) {
+        printf("Scene cache: %s is malformed, ignoring it\n", path);
+        return nullptr;
+    }
+
+    blas->wide.bounds = AABB(point3(header.bounds[0], header.bounds[1], header.bounds[2]),
+                             point3(header.bounds[3], header.bounds[4], header.bounds[5]));
+    if (compressed) {
+        blas->meshlets = std::move(meshlets);
+    } else {
+        blas->mesh = std::move(mesh);
+    }
+    return blas;
+}
+
+bool open_mesh_cached(const char* path, size_t compress_threshold, ThreadPool* pool, CachedMesh& out) {
+    out = CachedMesh();
+    MappedFile source;
+    if (!source.open(path)) return false;
+    out.source_hash = content_hash(source.data(), source.size(), pool);
+    source.close();
+
+    out.cache_path = std::string(path) + ".rtcache";
+    out.built = read_scene_cache(out.cache_path.c_str(), out.source_hash);
+    if (out.built) {
+        out.cache_hit = true;
+        out.bounds = out.built->bounds();
+        out.triangle_count = out.built->triangle_count();
+        return true;
+    }
+
+    TriangleMesh mesh;
+    if (!load_mesh(path, mesh, pool) || mesh.empty()) return false;
+    out.bounds = mesh.bounds();
+    out.triangle_count = mesh.triangle_count();
+    if (mesh.triangle_count() > compress_threshold) {
+        std::shared_ptr<MeshletMesh> meshlets = std::make_shared<MeshletMesh>();
+        meshlets->build(mesh, pool);
+        out.meshlets = std::move(meshlets);
+    } else {
+        out.mesh = std::make_shared<const TriangleMesh>(std::move(mesh));
+    }
+    return true;
+}
+
+int add_cached_mesh(Scene& scene, const CachedMesh& mesh) {
+    if (mesh.built) return scene.add_built_mesh(mesh.built);
+    return mesh.meshlets ? scene.add_compressed_mesh(mesh.meshlets) : scene.add_mesh(mesh.mesh);
+}
+
+bool store_mesh_cache(const CachedMesh& mesh, const BLAS& built) {
+    if (mesh.cache_hit) return true;
+    return write_scene_cache(mesh.cache_path.c_str(), built, mesh.source_hash);
+}
+
+std::shared_ptr<const BLAS> load_mesh_cached(const char* path, ThreadPool* pool, bool* cache_hit) {
+    if (cache_hit != nullptr) *cache_hit = false;
+    CachedMesh opened;
+    if (!open_mesh_cached(path, SIZE_MAX, pool, opened)) return nullptr;
+    if (opened.cache_hit) {
+        if (cache_hit != nullptr) *cache_hit = true;
+        return opened.built;
+    }
+
+    std::shared_ptr<const BLAS> built = build_blas(opened.mesh, pool, true);
+    store_mesh_cache(opened, *built);
+    return built;
+}
@@ -0,0 +1,152 @@
+#include "rendering/temporal.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+TemporalReprojector::TemporalReprojector() {
+    depth_tolerance = 0.02;
+    history_width = 0;
+    history_height = 0;
+    width = 0;
+    height = 0;
+    splat_capacity = 0;
+}
+
+void TemporalReprojector::store(const double* rgb, size_t pixel_stride, const GuideBuffers& guides, const Camera& camera,
+                                ThreadPool* pool) {
+    history_width = guides.width;
+    history_height = guides.height;
+    history_camera = camera;
+    size_t count = static_cast<size_t>(history_width) * history_height;
+    for (int c = 0; c < 3; ++c) history_color[c].resize(count);
+    history_depth.assign(guides.depth.begin(), guides.depth.end());
+    history_slope.resize(count);
+
+    for_each_row(pool, history_height, [&](int y, int) {
+        for (int x = 0; x < history_width; ++x) {
+            size_t i = static_cast<size_t>(y) * history_width + x;
+            const double* p = rgb + i * pixel_stride;
+            for (int c = 0; c < 3; ++c) history_color[c][i] = static_cast<float>(p[c]);
+            history_slope[i] = std::max(guides.depth_gradient[0][i], guides.depth_gradient[1][i]);
+        }
+    });
+}
+
+size_t TemporalReprojector::reproject(const Camera& camera, const GuideBuffers& guides, ThreadPool* pool) {
+    width = guides.width;
+    height = guides.height;
+    return fetch(camera, guides.depth.data(), pool);
+}
+
+size_t TemporalReprojector::reproject_splatted(const Camera& camera, ThreadPool* pool) {
+    width = static_cast<int>(camera.image_width);
+    height = static_cast<int>(camera.image_height);
+    size_t count = static_cast<size_t>(width) * height;
+    if (!has_history()) return fetch(camera, nullptr, pool);
+
+    if (splat_capacity < count) {
+        splat_bits.reset(new std::atomic<uint32_t>[count]);
+        splat_capacity = count;
+    }
+    const float far = std::numeric_limits<float>::infinity();
+    uint32_t far_bits;
+    std::memcpy(&far_bits, &far, sizeof(far));
+    for_each_row(pool, height, [&](int y, int) {
+        for (int x = 0; x < width; ++x) splat_bits[static_cast<size_t>(y) * width + x].store(far_bits, std::memory_order_relaxed);
+    });
+
+    const point3 position = camera.get_position();
+    for_each_row(pool, history_height, [&](int y, int) {
+        for (int x = 0; x < history_width; ++x) {
+            Ray ray = history_camera.get_ray(x, y);
+            point3 p = ray.origin() + static_cast<double>(history_depth[static_cast<size_t>(y) * history_width + x]) * unit_vector(ray.direction());
+            double px, py;
+            if (!camera.project(p, px, py)) continue;
+            float depth = static_cast<float>((p - position).length());
+            uint32_t bits;
+            std::memcpy(&bits, &depth, sizeof(depth));
+
+            // Covering the 2x2 pixels around the point closes the gaps a
+            // moderate zoom would leave between neighbouring history pixels
+            int x0 = static_cast<int>(std::floor(px)), y0 = static_cast<int>(std::floor(py));
+            for (int ty = y0; ty <= y0 + 1; ++ty) {
+                if (ty < 0 || ty >= height) continue;
+                for (int tx = x0; tx <= x0 + 1; ++tx) {
+                    if (tx < 0 || tx >= width) continue;
+                    std::atomic<uint32_t>& target = splat_bits[static_cast<size_t>(ty) * width + tx];
+                    uint32_t current = target.load(std::memory_order_relaxed);
+                    while (bits < current && !target.compare_exchange_weak(current, bits, std::memory_order_relaxed)) {}
+                }
+            }
+        }
+    });
+
+    splat_depth.resize(count);
+    for_each_row(pool, height, [&](int y, int) {
+        for (int x = 0; x < width; ++x) {
+            size_t i = static_cast<size_t>(y) * width + x;
+            uint32_t bits = splat_bits[i].load(std::memory_order_relaxed);
+            std::memcpy(&splat_depth[i], &bits, sizeof(bits));
+        }
+    });
+    return fetch(camera, splat_depth.data(), pool);
+}
+
+// Pixels of infinite depth have nothing to fetch
+size_t TemporalReprojector::fetch(const Camera& camera, const float* depth, ThreadPool* pool) {
+    size_t count = static_cast<size_t>(width) * height;
+    for (int c = 0; c < 3; ++c) reprojected[c].resize(count);
+    valid.assign(count, 0);
+    if (!has_history()) return 0;
+    const point3 history_position = history_camera.get_position();
+
+    for_each_row(pool, height, [&](int y, int) {
+        for (int x = 0; x < width; ++x) {
+            size_t i = static_cast<size_t>(y) * width + x;
+            if (std::isinf(depth[i])) continue;
+            Ray ray = camera.get_ray(x, y);
+            point3 p = ray.origin() + static_cast<double>(depth[i]) * unit_vector(ray.direction());
+            double hx, hy;
+            if (!history_camera.project(p, hx, hy)) continue;
+            double expected = (p - history_position).length();
+
+            // Bilinear over the four history pixels around the point, keeping
+            // only those that saw the same surface
+            int x0 = static_cast<int>(std::floor(hx));
+            int y0 = static_cast<int>(std::floor(hy));
+            double fx = hx - x0, fy = hy - y0;
+            double sum_w = 0.0, sum[3] = {0.0, 0.0, 0.0};
+            for (int ty = 0; ty < 2; ++ty) {
+                int sy = y0 + ty;
+                if (sy < 0 || sy >= history_height) continue;
+                for (int tx = 0; tx < 2; ++tx) {
+                    int sx = x0 + tx;
+                    if (sx < 0 || sx >= history_width) continue;
+                    size_t s = static_cast<size_t>(sy) * history_width + sx;
+                    // The slope allows for the tap being up to a pixel off the point
+                    double allowed = depth_tolerance * expected + history_slope[s];
+                    if (std::fabs(history_depth[s] - expected) > allowed) continue;
+                    double w = (tx ? fx : 1.0 - fx) * (ty ? fy : 1.0 - fy);
+                    sum_w += w;
+                    for (int c = 0; c < 3; ++c) sum[c] += w * history_color[c][s];
+                }
+            }
+            if (sum_w <= 0.0) continue;
+            for (int c = 0; c < 3; ++c) reprojected[c][i] = static_cast<float>(sum[c] / sum_w);
+            valid[i] = 1;
+        }
+    });
+    return static_cast<size_t>(std::count(valid.begin(), valid.end(), 1));
+}
+
+void TemporalReprojector::resolve(double* rgb, size_t pixel_stride, double new_weight, ThreadPool* pool) const {
+    for_each_row(pool, height, [&](int y, int) {
+        for (int x = 0; x < width; ++x) {
+            size_t i = static_cast<size_t>(y) * width + x;
+            if (!valid[i]) continue;
+            double* p = rgb + i * pixel_stride;
+            for (int c = 0; c < 3; ++c) p[c] = reprojected[c][i] + new_weight * (p[c] - reprojected[c][i]);
+        }
+    });
+}
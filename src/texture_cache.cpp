@@ -0,0 +1,311 @@
+#include "rendering/texture_cache.hpp"
+#include "core/binary_format.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <thread>
+
+namespace {
+
+const char TEXTURE_MAGIC[8] = {'R', 'T', 'T', 'E', 'X', '0', '0', '1'};
+const int32_t REFILL_BIAS = 1 << 30; // Subtracted from pins while a slot is refilled
+
+uint8_t encode_srgb(float linear) {
+    float x = std::min(std::max(linear, 0.0f), 1.0f);
+    float encoded = x <= 0.0031308f ? 12.92f * x : 1.055f * std::pow(x, 1.0f / 2.4f) - 0.055f;
+    return static_cast<uint8_t>(encoded * 255.0f + 0.5f);
+}
+
+struct SrgbTable {
+    float linear[256];
+
+    SrgbTable() {
+        for (int i = 0; i < 256; ++i) {
+            float x = i / 255.0f;
+            linear[i] = x <= 0.04045f ? x / 12.92f : std::pow((x + 0.055f) / 1.055f, 2.4f);
+        }
+    }
+};
+
+const SrgbTable SRGB;
+
+inline int wrap(int x, int size) {
+    int r = x % size;
+    return r < 0 ? r + size : r;
+}
+
+inline color texel(const uint8_t* tile, int x, int y) {
+    const uint8_t* p = tile + 3 * (y * TEXTURE_TILE_STRIDE + x);
+    return color(SRGB.linear[p[0]], SRGB.linear[p[1]], SRGB.linear[p[2]]);
+}
+
+}
+
+std::vector<TextureLevel> texture_levels(int width, int height) {
+    std::vector<TextureLevel> levels;
+    uint32_t first = 0;
+    for (;;) {
+        TextureLevel level;
+        level.width = width;
+        level.height = height;
+        level.tiles_x = (width + TEXTURE_TILE - 1) / TEXTURE_TILE;
+        level.tiles_y = (height + TEXTURE_TILE - 1) / TEXTURE_TILE;
+        level.first_tile = first;
+        levels.push_back(level);
+        first += static_cast<uint32_t>(level.tiles_x * level.tiles_y);
+        if (width == 1 && height == 1) break;
+        width = std::max(1, width / 2);
+        height = std::max(1, height / 2);
+    }
+    return levels;
+}
+
+bool write_tiled_texture(const char* path, int width, int height, const float* rgb) {
+    if (width <= 0 || height <= 0) {
+        printf("Texture: invalid size %dx%d for %s\n", width, height, path);
+        return false;
+    }
+    std::vector<TextureLevel> levels = texture_levels(width, height);
+
+    // Box-filtered chain; odd sizes fold their last row or column into the one before
+    std::vector<std::vector<float>> chain(levels.size());
+    chain[0].assign(rgb, rgb + 3 * static_cast<size_t>(width) * height);
+    for (size_t l = 1; l < levels.size(); ++l) {
+        const TextureLevel& fine = levels[l - 1];
+        const TextureLevel& coarse = levels[l];
+        chain[l].assign(3 * static_cast<size_t>(coarse.width) * coarse.height, 0.0f);
+        for (int y = 0; y < fine.height; ++y) {
+            int cy = std::min(y / 2, coarse.height - 1);
+            for (int x = 0; x < fine.width; ++x) {
+                int cx = std::min(x / 2, coarse.width - 1);
+                for (int c = 0; c < 3; ++c) {
+                    chain[l][3 * (static_cast<size_t>(cy) * coarse.width + cx) + c] +=
+                        chain[l - 1][3 * (static_cast<size_t>(y) * fine.width + x) + c];
+                }
+            }
+        }
+        for (int y = 0; y < coarse.height; ++y) {
+            int rows = (y == coarse.height - 1) ? fine.height - 2 * y : 2;
+            for (int x = 0; x < coarse.width; ++x) {
+                int columns = (x == coarse.width - 1) ? fine.width - 2 * x : 2;
+                float scale = 1.0f / (std::max(rows, 1) * std::max(columns, 1));
+                for (int c = 0; c < 3; ++c) chain[l][3 * (static_cast<size_t>(y) * coarse.width + x) + c] *= scale;
+            }
+        }
+    }
+
+    FILE* file = fopen(path, "wb");
+    if (file == nullptr) {
+        printf("Texture: cannot write %s\n", path);
+        return false;
+    }
+
+    TextureFileHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, TEXTURE_MAGIC, sizeof(TEXTURE_MAGIC));
+    header.version = TEXTURE_FILE_VERSION;
+    header.width = static_cast<uint32_t>(width);
+    header.height = static_cast<uint32_t>(height);
+    header.level_count = static_cast<uint32_t>(levels.size());
+    header.tile_offset = align_up(sizeof(header));
+
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1;
+    size_t written = sizeof(header);
+    ok = ok && write_padding(file, written, header.tile_offset);
+
+    std::vector<uint8_t> tile(TEXTURE_TILE_BYTES);
+    for (size_t l = 0; l < levels.size() && ok; ++l) {
+        const TextureLevel& level = levels[l];
+        for (int ty = 0; ty < level.tiles_y && ok; ++ty) {
+            for (int tx = 0; tx < level.tiles_x && ok; ++tx) {
+                // Every texel of the tile plus the border, wrapped into the level
+                for (int y = 0; y < TEXTURE_TILE_STRIDE; ++y) {
+                    int sy = wrap(ty * TEXTURE_TILE + y, level.height);
+                    for (int x = 0; x < TEXTURE_TILE_STRIDE; ++x) {
+                        int sx = wrap(tx * TEXTURE_TILE + x, level.width);
+                        const float* source = &chain[l][3 * (static_cast<size_t>(sy) * level.width + sx)];
+                        uint8_t* target = &tile[3 * (y * TEXTURE_TILE_STRIDE + x)];
+                        for (int c = 0; c < 3; ++c) target[c] = encode_srgb(source[c]);
+                    }
+                }
+                ok = fwrite(tile.data(), 1, tile.size(), file) == tile.size();
+            }
+        }
+    }
+    ok = fclose(file) == 0 && ok;
+    if (!ok) {
+        printf("Texture: failed writing %s\n", path);
+        std::remove(path);
+    }
+    return ok;
+}
+
+double texture_lod(const RayCone& cone, double cos_incidence, double uv_area, double world_area, int width, int height) {
+    if (world_area <= 0.0 || uv_area <= 0.0 || cone.width <= 0.0) return 0.0;
+    double footprint = cone.width / std::max(std::fabs(cos_incidence), 1e-4);
+    double texels_per_unit = std::sqrt(uv_area * width * height / world_area);
+    return std::log2(footprint * texels_per_unit);
+}
+
+TextureCache::TextureCache(size_t budget_bytes)
+    : slot_total(std::max(MIN_SLOTS, budget_bytes / TEXTURE_TILE_BYTES)),
+      miss_clock(0), miss_count(0), eviction_count(0) {
+    slots.reset(new Slot[slot_total]);
+    for (size_t i = 0; i < slot_total; ++i) {
+        slots[i].key.store(0, std::memory_order_relaxed);
+        slots[i].pins.store(0, std::memory_order_relaxed);
+        slots[i].last_used.store(0, std::memory_order_relaxed);
+    }
+    tile_data.resize(slot_total * TEXTURE_TILE_BYTES);
+}
+
+int TextureCache::open(const char* path) {
+    std::unique_ptr<Texture> texture(new Texture());
+    if (!texture->file.open(path)) return -1;
+
+    TextureFileHeader header;
+    if (texture->file.size() < sizeof(header)) {
+        printf("Texture: %s is too small\n", path);
+        return -1;
+    }
+    std::memcpy(&header, texture->file.data(), sizeof(header));
+    if (std::memcmp(header.magic, TEXTURE_MAGIC, sizeof(TEXTURE_MAGIC)) != 0 || header.version != TEXTURE_FILE_VERSION) {
+        printf("Texture: %s is not a version %u tiled texture\n", path, TEXTURE_FILE_VERSION);
+        return -1;
+    }
+    if (header.width == 0 || header.height == 0 || header.width > (1u << 20) || header.height > (1u << 20)) {
+        printf("Texture: %s has invalid size %ux%u\n", path, header.width, header.height);
+        return -1;
+    }
+
+    texture->levels = texture_levels(static_cast<int>(header.width), static_cast<int>(header.height));
+    const TextureLevel& last = texture->levels.back();
+    texture->tile_count = last.first_tile + static_cast<uint32_t>(last.tiles_x * last.tiles_y);
+    texture->tile_offset = header.tile_offset;
+    if (header.level_count != texture->levels.size() ||
+        header.tile_offset + static_cast<uint64_t>(texture->tile_count) * TEXTURE_TILE_BYTES > texture->file.size()) {
+        printf("Texture: %s is truncated\n", path);
+        return -1;
+    }
+
+    texture->tile_slot.reset(new std::atomic<int32_t>[texture->tile_count]);
+    for (uint32_t i = 0; i < texture->tile_count; ++i) texture->tile_slot[i].store(-1, std::memory_order_relaxed);
+    textures.push_back(std::move(texture));
+    return static_cast<int>(textures.size()) - 1;
+}
+
+const uint8_t* TextureCache::acquire(int texture, uint32_t tile, int32_t& slot) {
+    uint64_t key = (static_cast<uint64_t>(texture + 1) << 32) | tile;
+    int32_t s = textures[texture]->tile_slot[tile].load(std::memory_order_acquire);
+    if (s >= 0) {
+        Slot& entry = slots[s];
+        // A refill in progress shows as negative pins; a finished one as a different key
+        if (entry.pins.fetch_add(1, std::memory_order_acquire) >= 0 && entry.key.load(std::memory_order_acquire) == key) {
+            uint64_t now = miss_clock.load(std::memory_order_relaxed);
+            if (entry.last_used.load(std::memory_order_relaxed) != now) entry.last_used.store(now, std::memory_order_relaxed);
+            slot = s;
+            return &tile_data[static_cast<size_t>(s) * TEXTURE_TILE_BYTES];
+        }
+        release(s);
+    }
+    slot = load(texture, tile);
+    return &tile_data[static_cast<size_t>(slot) * TEXTURE_TILE_BYTES];
+}
+
+int32_t TextureCache::load(int texture, uint32_t tile) {
+    std::lock_guard<std::mutex> lock(load_mutex);
+    Texture& source = *textures[texture];
+    uint64_t key = (static_cast<uint64_t>(texture + 1) << 32) | tile;
+
+    // Another thread may have loaded it while this one waited; no refill can
+    // be in progress while the lock is held
+    int32_t s = source.tile_slot[tile].load(std::memory_order_acquire);
+    if (s >= 0 && slots[s].key.load(std::memory_order_relaxed) == key) {
+        slots[s].pins.fetch_add(1, std::memory_order_acquire);
+        return s;
+    }
+
+    miss_count.fetch_add(1, std::memory_order_relaxed);
+    uint64_t now = miss_clock.fetch_add(1, std::memory_order_relaxed) + 1;
+
+    // Empty slots first, then the least recently used one nobody is reading
+    int32_t victim = -1;
+    while (victim < 0) {
+        uint64_t oldest = std::numeric_limits<uint64_t>::max();
+        for (size_t i = 0; i < slot_total; ++i) {
+            if (slots[i].pins.load(std::memory_order_relaxed) != 0) continue;
+            if (slots[i].key.load(std::memory_order_relaxed) == 0) {
+                victim = static_cast<int32_t>(i);
+                break;
+            }
+            uint64_t used = slots[i].last_used.load(std::memory_order_relaxed);
+            if (used < oldest) {
+                oldest = used;
+                victim = static_cast<int32_t>(i);
+            }
+        }
+        int32_t unpinned = 0;
+        if (victim >= 0 && !slots[victim].pins.compare_exchange_strong(unpinned, -REFILL_BIAS, std::memory_order_acquire)) {
+            victim = -1;
+        }
+        // Pins last one bilinear lookup, so waiting is short
+        if (victim < 0) std::this_thread::yield();
+    }
+
+    Slot& entry = slots[victim];
+    uint64_t old_key = entry.key.load(std::memory_order_relaxed);
+    if (old_key != 0) {
+        textures[(old_key >> 32) - 1]->tile_slot[old_key & 0xFFFFFFFFu].store(-1, std::memory_order_relaxed);
+        eviction_count.fetch_add(1, std::memory_order_relaxed);
+    }
+    std::memcpy(&tile_data[static_cast<size_t>(victim) * TEXTURE_TILE_BYTES],
+                source.file.data() + source.tile_offset + static_cast<uint64_t>(tile) * TEXTURE_TILE_BYTES, TEXTURE_TILE_BYTES);
+    entry.key.store(key, std::memory_order_relaxed);
+    entry.last_used.store(now, std::memory_order_relaxed);
+
+    // Reopen the slot with this thread's pin already counted, then publish it
+    entry.pins.fetch_add(REFILL_BIAS + 1, std::memory_order_release);
+    source.tile_slot[tile].store(victim, std::memory_order_release);
+    return victim;
+}
+
+size_t TextureCache::resident_tiles() const {
+    size_t count = 0;
+    for (size_t i = 0; i < slot_total; ++i) {
+        if (slots[i].key.load(std::memory_order_relaxed) != 0) count++;
+    }
+    return count;
+}
+
+color TextureCache::sample_level(int texture, double u, double v, int level) {
+    const TextureLevel& info = textures[texture]->levels[level];
+    double x = (u - std::floor(u)) * info.width - 0.5;
+    double y = (v - std::floor(v)) * info.height - 0.5;
+    double fx_floor = std::floor(x), fy_floor = std::floor(y);
+    double fx = x - fx_floor, fy = y - fy_floor;
+    int x0 = wrap(static_cast<int>(fx_floor), info.width);
+    int y0 = wrap(static_cast<int>(fy_floor), info.height);
+
+    // The right and bottom neighbours live in the tile's border
+    uint32_t tile = info.first_tile + static_cast<uint32_t>((y0 / TEXTURE_TILE) * info.tiles_x + x0 / TEXTURE_TILE);
+    int lx = x0 % TEXTURE_TILE, ly = y0 % TEXTURE_TILE;
+    int32_t slot;
+    const uint8_t* data = acquire(texture, tile, slot);
+    color c00 = texel(data, lx, ly), c10 = texel(data, lx + 1, ly);
+    color c01 = texel(data, lx, ly + 1), c11 = texel(data, lx + 1, ly + 1);
+    release(slot);
+
+    return (1.0 - fy) * ((1.0 - fx) * c00 + fx * c10) + fy * ((1.0 - fx) * c01 + fx * c11);
+}
+
+color TextureCache::sample(int texture, double u, double v, double lod) {
+    int last = level_count(texture) - 1;
+    lod = std::min(std::max(lod, 0.0), static_cast<double>(last));
+    int level = static_cast<int>(lod);
+    double blend = lod - level;
+    color fine = sample_level(texture, u, v, level);
+    if (blend <= 0.0 || level == last) return fine;
+    return (1.0 - blend) * fine + blend * sample_level(texture, u, v, level + 1);
+}
@@ -0,0 +1,110 @@
+#include "core/thread_pool.hpp"
+#include <algorithm>
+
+// Per-thread pool identity; nested jobs run inline instead of deadlocking
+static thread_local int t_thread_index = 0;
+static thread_local bool t_inside_job = false;
+
+ThreadPool::ThreadPool(int num_threads) {
+    if (num_threads <= 0) {
+        num_threads = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    }
+
+    job_function = nullptr;
+    job_context = nullptr;
+    job_count = 0;
+    job_grain = 1;
+    next_index = 0;
+    active_workers = 0;
+    generation = 0;
+    stopping = false;
+
+    // The caller is thread 0, so only num_threads - 1 workers are spawned
+    workers.reserve(num_threads - 1);
+    for (int t = 1; t < num_threads; ++t) {
+        workers.emplace_back(&ThreadPool::worker_loop, this, t);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    work_available.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+int ThreadPool::current_thread_index() {
+    return t_thread_index;
+}
+
+void ThreadPool::run(size_t count, size_t grain, JobFunction function, const void* context) {
+    if (count == 0) return;
+    grain = std::max<size_t>(1, grain);
+
+    // Serial fallback: no workers, a single chunk, or a nested call from inside a job
+    if (workers.empty() || count <= grain || t_inside_job) {
+        for (size_t i = 0; i < count; ++i) {
+            function(context, i, t_thread_index);
+        }
+        return;
+    }
+
+    std::lock_guard<std::mutex> submit_lock(submit_mutex);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        job_function = function;
+        job_context = context;
+        job_count = count;
+        job_grain = grain;
+        next_index = 0;
+        active_workers = static_cast<int>(workers.size());
+        generation++;
+    }
+    work_available.notify_all();
+
+    // The caller works too instead of idling until the workers finish
+    int caller_index = t_thread_index;
+    t_thread_index = 0;
+    t_inside_job = true;
+    execute_job(0);
+    t_inside_job = false;
+    t_thread_index = caller_index;
+
+    std::unique_lock<std::mutex> lock(mutex);
+    work_done.wait(lock, [this]() { return active_workers == 0; });
+}
+
+void ThreadPool::execute_job(int thread_index) {
+    size_t begin;
+    while ((begin = next_index.fetch_add(job_grain)) < job_count) {
+        size_t end = std::min(begin + job_grain, job_count);
+        for (size_t i = begin; i < end; ++i) {
+            job_function(job_context, i, thread_index);
+        }
+    }
+}
+
+void ThreadPool::worker_loop(int thread_index) {
+    t_thread_index = thread_index;
+    t_inside_job = true;
+
+    uint64_t seen_generation = 0;
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        work_available.wait(lock, [&]() { return stopping || generation != seen_generation; });
+        if (stopping) return;
+        seen_generation = generation;
+
+        lock.unlock();
+        execute_job(thread_index);
+        lock.lock();
+
+        if (--active_workers == 0) {
+            work_done.notify_one();
+        }
+    }
+}
@@ -0,0 +1,123 @@
+#include "rendering/tile_scheduler.hpp"
+#include <algorithm>
+
+TileScheduler::TileScheduler() {
+    width = 0;
+    height = 0;
+    target_samples = 1;
+    deadline_hit = false;
+}
+
+void TileScheduler::reset(int new_width, int new_height, int tile_size, int new_target_samples) {
+    width = new_width;
+    height = new_height;
+    target_samples = std::max(1, new_target_samples);
+    tile_size = std::max(1, tile_size);
+
+    tiles.clear();
+    int tile_id = 0;
+    for (int y = 0; y < height; y += tile_size) {
+        for (int x = 0; x < width; x += tile_size) {
+            RenderTile tile;
+            tile.start_x = x;
+            tile.end_x = std::min(x + tile_size, width);
+            tile.start_y = y;
+            tile.end_y = std::min(y + tile_size, height);
+            tile.tile_id = tile_id++;
+            tiles.push_back(tile);
+        }
+    }
+
+    restart();
+}
+
+void TileScheduler::restart() {
+    tile_progress.resize(tiles.size());
+    for (size_t i = 0; i < tiles.size(); ++i) {
+        tile_progress[i].next_row = tiles[i].start_y;
+        tile_progress[i].samples_done = 0;
+        tile_progress[i].converged = false;
+    }
+}
+
+bool TileScheduler::is_complete() const {
+    for (const TileProgress& p : tile_progress) {
+        if (p.samples_done < target_samples && !p.converged) return false;
+    }
+    return true;
+}
+
+size_t TileScheduler::converged_tiles() const {
+    size_t count = 0;
+    for (const TileProgress& p : tile_progress) count += p.converged;
+    return count;
+}
+
+int TileScheduler::get_current_pass() const {
+    int pass = target_samples;
+    for (const TileProgress& p : tile_progress) {
+        if (!p.converged) pass = std::min(pass, p.samples_done);
+    }
+    return pass;
+}
+
+double TileScheduler::progress() const {
+    if (tiles.empty()) return 1.0;
+
+    double done_rows = 0.0;
+    double total_rows = 0.0;
+    for (size_t i = 0; i < tiles.size(); ++i) {
+        int rows = tiles[i].end_y - tiles[i].start_y;
+        int samples = tile_progress[i].converged ? target_samples : std::min(tile_progress[i].samples_done, target_samples);
+        done_rows += static_cast<double>(samples) * rows;
+        if (samples < target_samples) {
+            done_rows += tile_progress[i].next_row - tiles[i].start_y;
+        }
+        total_rows += static_cast<double>(target_samples) * rows;
+    }
+    return done_rows / total_rows;
+}
+
+void TileScheduler::render_tile_slice(size_t index, Clock::time_point deadline, const RowFunction& render_row) {
+    const RenderTile& tile = tiles[index];
+    TileProgress& state = tile_progress[index];
+
+    // Always render at least one row per claimed tile so a tiny budget still makes progress
+    bool first_row = true;
+    for (int row = state.next_row; row < tile.end_y; ++row) {
+        if (!first_row && Clock::now() >= deadline) {
+            deadline_hit = true;
+            state.next_row = row;
+            return;
+        }
+        render_row(tile, row, state.samples_done);
+        first_row = false;
+    }
+
+    state.next_row = tile.start_y;
+    state.samples_done++;
+    if (adaptive.error && state.samples_done >= adaptive.min_samples && state.samples_done < target_samples) {
+        state.converged = adaptive.error(tile, state.samples_done) <= adaptive.threshold;
+    }
+}
+
+bool TileScheduler::run_until(Clock::time_point deadline, ThreadPool* pool, const RowFunction& render_row) {
+    deadline_hit = false;
+
+    while (!is_complete() && !deadline_hit.load()) {
+        int pass = get_current_pass();
+
+        // Each tile is claimed by exactly one worker per pass
+        auto render_pass_tile = [&](size_t index, int) {
+            if (deadline_hit.load(std::memory_order_relaxed)) return;
+            if (tile_progress[index].samples_done != pass || tile_progress[index].converged) return;
+            render_tile_slice(index, deadline, render_row);
+        };
+
+        parallel_for(pool, tiles.size(), render_pass_tile);
+
+        if (Clock::now() >= deadline) break;
+    }
+
+    return is_complete();
+}
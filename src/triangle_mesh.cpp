@@ -0,0 +1,123 @@
+#include "geometry/triangle_mesh.hpp"
+
+uint32_t TriangleMesh::add_vertex(const point3& p) {
+    uint32_t index = static_cast<uint32_t>(vertex_count());
+    positions.push_back(static_cast<float>(p.x()));
+    positions.push_back(static_cast<float>(p.y()));
+    positions.push_back(static_cast<float>(p.z()));
+    return index;
+}
+
+void TriangleMesh::add_triangle(uint32_t a, uint32_t b, uint32_t c) {
+    indices.push_back(a);
+    indices.push_back(b);
+    indices.push_back(c);
+}
+
+void TriangleMesh::append(const TriangleMesh& other) {
+    uint32_t base = static_cast<uint32_t>(vertex_count());
+    positions.insert(positions.end(), other.positions.begin(), other.positions.end());
+    indices.reserve(indices.size() + other.indices.size());
+    for (uint32_t index : other.indices) {
+        indices.push_back(base + index);
+    }
+    // Coordinates are kept only while both sides have them
+    if (other.has_uvs() && (base == 0 || uvs.size() == 2 * static_cast<size_t>(base))) {
+        uvs.insert(uvs.end(), other.uvs.begin(), other.uvs.end());
+    } else {
+        uvs.clear();
+    }
+}
+
+void TriangleMesh::set_uv(uint32_t vertex, double u, double v) {
+    uvs.resize(2 * vertex_count(), 0.0f);
+    uvs[2 * static_cast<size_t>(vertex)] = static_cast<float>(u);
+    uvs[2 * static_cast<size_t>(vertex) + 1] = static_cast<float>(v);
+}
+
+AABB TriangleMesh::triangle_bounds(size_t triangle) const {
+    AABB box;
+    for (int k = 0; k < 3; ++k) {
+        box.expand(vertex(indices[3 * triangle + k]));
+    }
+    return box;
+}
+
+AABB TriangleMesh::bounds() const {
+    AABB box;
+    for (size_t i = 0; i < vertex_count(); ++i) {
+        box.expand(vertex(static_cast<uint32_t>(i)));
+    }
+    return box;
+}
+
+vec3 TriangleMesh::face_normal(size_t triangle) const {
+    point3 p0 = vertex(indices[3 * triangle]);
+    point3 p1 = vertex(indices[3 * triangle + 1]);
+    point3 p2 = vertex(indices[3 * triangle + 2]);
+    return unit_vector(cross(p1 - p0, p2 - p0));
+}
+
+bool TriangleMesh::intersect_triangle(size_t triangle, const Ray& r, double t_min, double t_max,
+                                      double& t, double& u, double& v) const {
+    return intersect_triangle_points(vertex(indices[3 * triangle]), vertex(indices[3 * triangle + 1]),
+                                     vertex(indices[3 * triangle + 2]), r, t_min, t_max, t, u, v);
+}
+
+bool intersect_triangle_points(const point3& p0, const point3& p1, const point3& p2, const Ray& r,
+                               double t_min, double t_max, double& t, double& u, double& v) {
+    vec3 edge1 = p1 - p0;
+    vec3 edge2 = p2 - p0;
+    vec3 pvec = cross(r.direction(), edge2);
+    double det = dot(edge1, pvec);
+
+    // Ray parallel to the triangle plane
+    if (std::fabs(det) < 1e-12) return false;
+    double inv_det = 1.0 / det;
+
+    vec3 tvec = r.origin() - p0;
+    u = dot(tvec, pvec) * inv_det;
+    if (u < 0.0 || u > 1.0) return false;
+
+    vec3 qvec = cross(tvec, edge1);
+    v = dot(r.direction(), qvec) * inv_det;
+    if (v < 0.0 || u + v > 1.0) return false;
+
+    t = dot(edge2, qvec) * inv_det;
+    return t > t_min && t < t_max;
+}
+
+void TriangleMesh::add_quad(const point3& corner, const vec3& edge_u, const vec3& edge_v) {
+    uint32_t a = add_vertex(corner);
+    uint32_t b = add_vertex(corner + edge_u);
+    uint32_t c = add_vertex(corner + edge_u + edge_v);
+    uint32_t d = add_vertex(corner + edge_v);
+    add_triangle(a, b, c);
+    add_triangle(a, c, d);
+}
+
+// UV sphere - rings of latitude by segments of longitude, outward winding
+void TriangleMesh::add_sphere(const point3& center, double radius, int segments, int rings) {
+    const double pi = 3.14159265358979323846;
+    uint32_t base = static_cast<uint32_t>(vertex_count());
+
+    for (int ring = 0; ring <= rings; ++ring) {
+        double theta = pi * ring / rings;
+        for (int seg = 0; seg <= segments; ++seg) {
+            double phi = 2.0 * pi * seg / segments;
+            vec3 dir(std::sin(theta) * std::cos(phi), std::cos(theta), -std::sin(theta) * std::sin(phi));
+            add_vertex(center + radius * dir);
+        }
+    }
+
+    uint32_t stride = static_cast<uint32_t>(segments + 1);
+    for (int ring = 0; ring < rings; ++ring) {
+        for (int seg = 0; seg < segments; ++seg) {
+            uint32_t a = base + ring * stride + seg;
+            uint32_t b = a + stride;
+            // Skip the degenerate triangles at the poles
+            if (ring != 0) add_triangle(a, b, a + 1);
+            if (ring != rings - 1) add_triangle(a + 1, b, b + 1);
+        }
+    }
+}
@@ -0,0 +1,150 @@
+#include "rendering/upscaler.hpp"
+#include <algorithm>
+#include <cmath>
+
+// Largest negative RCAS lobe, as in FSR1
+static const double RCAS_LIMIT = 0.25 - 1.0 / 16.0;
+
+// Luma approximation EASU uses for edge detection
+static inline double easu_luma(const double* p) {
+    return 0.5 * p[0] + p[1] + 0.5 * p[2];
+}
+
+Upscaler::Upscaler() {
+    sharpening = 0.2;
+}
+
+void Upscaler::upscale(const double* src, size_t src_stride, int src_width, int src_height,
+                       double* dst, size_t dst_stride, int dst_width, int dst_height, ThreadPool* pool) {
+    if (src_width <= 0 || src_height <= 0 || dst_width <= 0 || dst_height <= 0) return;
+    scaled.resize(static_cast<size_t>(dst_width) * dst_height * 3);
+    const double scale_x = static_cast<double>(src_width) / dst_width;
+    const double scale_y = static_cast<double>(src_height) / dst_height;
+
+    // Edges repeat the border pixels
+    auto fetch = [&](int x, int y) {
+        x = std::min(std::max(x, 0), src_width - 1);
+        y = std::min(std::max(y, 0), src_height - 1);
+        return src + (static_cast<size_t>(y) * src_width + x) * src_stride;
+    };
+    auto luma = [&](int x, int y) { return easu_luma(fetch(x, y)); };
+
+    // EASU
+    for_each_row(pool, dst_height, [&](int oy, int) {
+        double py = (oy + 0.5) * scale_y - 0.5;
+        int y0 = static_cast<int>(std::floor(py));
+        double fy = py - y0;
+        for (int ox = 0; ox < dst_width; ++ox) {
+            double px = (ox + 0.5) * scale_x - 0.5;
+            int x0 = static_cast<int>(std::floor(px));
+            double fx = px - x0;
+
+            // Gradient direction and edge length, bilinear over the 2x2 quad.
+            // A step counts as an edge when the change over two pixels is as
+            // large as either one-pixel change; a one-pixel spike does not.
+            double dir_x = 0.0, dir_y = 0.0, len = 0.0;
+            for (int qy = 0; qy < 2; ++qy) {
+                for (int qx = 0; qx < 2; ++qx) {
+                    double w = (qx ? fx : 1.0 - fx) * (qy ? fy : 1.0 - fy);
+                    int cx = x0 + qx, cy = y0 + qy;
+                    double c = luma(cx, cy);
+                    double l = luma(cx - 1, cy), r = luma(cx + 1, cy);
+                    double u = luma(cx, cy - 1), d = luma(cx, cy + 1);
+                    double step_x = std::max(std::fabs(r - c), std::fabs(c - l));
+                    double step_y = std::max(std::fabs(d - c), std::fabs(c - u));
+                    double len_x = step_x > 0.0 ? std::min(std::fabs(r - l) / step_x, 1.0) : 0.0;
+                    double len_y = step_y > 0.0 ? std::min(std::fabs(d - u) / step_y, 1.0) : 0.0;
+                    dir_x += (r - l) * w;
+                    dir_y += (d - u) * w;
+                    len += (len_x * len_x + len_y * len_y) * w;
+                }
+            }
+            len *= 0.5;
+            len *= len;
+            double dir_sq = dir_x * dir_x + dir_y * dir_y;
+            if (dir_sq < 1.0 / 32768.0) {
+                dir_x = 1.0;
+                dir_y = 0.0;
+            } else {
+                double inv = 1.0 / std::sqrt(dir_sq);
+                dir_x *= inv;
+                dir_y *= inv;
+            }
+
+            // Kernel narrows across the edge and widens along it as len grows;
+            // diagonal edges stretch further so the footprint stays square
+            double stretch = 1.0 / std::max(std::fabs(dir_x), std::fabs(dir_y));
+            double scale_across = 1.0 + (stretch - 1.0) * len;
+            double scale_along = 1.0 - 0.5 * len;
+            double lobe = 0.5 + ((1.0 / 4.0 - 0.04) - 0.5) * len;
+            double clip = 1.0 / lobe;
+
+            double sum[3] = {0.0, 0.0, 0.0}, sum_w = 0.0;
+            double low[3] = {1e300, 1e300, 1e300}, high[3] = {-1e300, -1e300, -1e300};
+            for (int ty = -1; ty <= 2; ++ty) {
+                for (int tx = -1; tx <= 2; ++tx) {
+                    bool corner = (tx == -1 || tx == 2) && (ty == -1 || ty == 2);
+                    if (corner) continue; // 12 taps, as in EASU
+                    const double* p = fetch(x0 + tx, y0 + ty);
+                    double off_x = x0 + tx - px, off_y = y0 + ty - py;
+                    double across = (off_x * dir_x + off_y * dir_y) * scale_across;
+                    double along = (off_y * dir_x - off_x * dir_y) * scale_along;
+                    double d2 = std::min(across * across + along * along, clip);
+                    // Polynomial approximation of Lanczos 2, windowed by the lobe
+                    double base = 2.0 / 5.0 * d2 - 1.0;
+                    double window = lobe * d2 - 1.0;
+                    double w = (25.0 / 16.0 * base * base - (25.0 / 16.0 - 1.0)) * window * window;
+                    for (int c = 0; c < 3; ++c) sum[c] += w * p[c];
+                    sum_w += w;
+                    if (tx >= 0 && tx <= 1 && ty >= 0 && ty <= 1) {
+                        for (int c = 0; c < 3; ++c) {
+                            low[c] = std::min(low[c], p[c]);
+                            high[c] = std::max(high[c], p[c]);
+                        }
+                    }
+                }
+            }
+
+            double* out = &scaled[(static_cast<size_t>(oy) * dst_width + ox) * 3];
+            for (int c = 0; c < 3; ++c) {
+                double value = sum_w > 0.0 ? sum[c] / sum_w : low[c];
+                out[c] = std::min(std::max(value, low[c]), high[c]);
+            }
+        }
+    });
+
+    // RCAS
+    const double strength = sharpening >= 0.0 ? std::exp2(-sharpening) : 0.0;
+    for_each_row(pool, dst_height, [&](int y, int) {
+        const double* above = &scaled[static_cast<size_t>(std::max(y - 1, 0)) * dst_width * 3];
+        const double* row = &scaled[static_cast<size_t>(y) * dst_width * 3];
+        const double* below = &scaled[static_cast<size_t>(std::min(y + 1, dst_height - 1)) * dst_width * 3];
+        for (int x = 0; x < dst_width; ++x) {
+            int left = std::max(x - 1, 0) * 3, right = std::min(x + 1, dst_width - 1) * 3, centre = x * 3;
+            const double* e = row + centre;
+            double* out = dst + (static_cast<size_t>(y) * dst_width + x) * dst_stride;
+            if (strength == 0.0) {
+                for (int c = 0; c < 3; ++c) out[c] = e[c];
+                continue;
+            }
+
+            // Most negative lobe that keeps every channel within [0, peak]
+            double lobe = -RCAS_LIMIT;
+            for (int c = 0; c < 3; ++c) {
+                double b = above[centre + c], d = row[left + c], f = row[right + c], h = below[centre + c];
+                double low = std::min(std::min(std::min(b, d), std::min(f, h)), e[c]);
+                double high = std::max(std::max(std::max(b, d), std::max(f, h)), e[c]);
+                double peak = std::max(1.0, high); // HDR values are not sharpened past themselves
+                double hit_min = high > 0.0 ? low / (4.0 * high) : 0.0;
+                double hit_max = low < peak ? (peak - high) / (4.0 * low - 4.0 * peak) : 0.0;
+                lobe = std::max(lobe, std::max(-hit_min, hit_max));
+            }
+            lobe = std::min(lobe, 0.0) * strength;
+
+            for (int c = 0; c < 3; ++c) {
+                double ring = above[centre + c] + row[left + c] + row[right + c] + below[centre + c];
+                out[c] = (lobe * ring + e[c]) / (4.0 * lobe + 1.0);
+            }
+        }
+    });
+}
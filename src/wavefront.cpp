@@ -0,0 +1,296 @@
+#include "rendering/wavefront.hpp"
+#include <limits>
+
+// Runs one stage over a queue, in chunks large enough to amortize scheduling
+template<class Function>
+static void run_stage(ThreadPool* pool, size_t count, const Function& fn, size_t grain = 256) {
+    parallel_for(pool, count, [&](size_t i, int) { fn(i); }, grain);
+}
+
+// Spread 4 bits so they interleave with two other axes
+static inline uint32_t spread_bits4(uint32_t v) {
+    v &= 0xF;
+    v = (v | (v << 4)) & 0x0C3;
+    v = (v | (v << 2)) & 0x249;
+    return v;
+}
+
+WavefrontIntegrator::WavefrontIntegrator() {
+    max_depth = 3;
+    sort_rays = true;
+    batch_size = 1 << 16; // Paths in flight; bounds the state memory
+    paged = nullptr;
+    paged_material = 0;
+    extension_rays = 0;
+    shadow_ray_count = 0;
+}
+
+void WavefrontIntegrator::set_paged_geometry(PagedMesh* mesh, const Transform& object_to_world, int material_id) {
+    paged = mesh;
+    paged_to_world = object_to_world;
+    world_to_paged = object_to_world.inverse();
+    paged_material = material_id;
+}
+
+void WavefrontIntegrator::render(const SceneAccel& scene, const Camera& camera, const RenderTile& region, int sample,
+                                 double offset_u, double offset_v, color* output, ThreadPool* pool) {
+    int width = region.end_x - region.start_x;
+    int height = region.end_y - region.start_y;
+    size_t pixel_count = static_cast<size_t>(std::max(0, width)) * std::max(0, height);
+    extension_rays = 0;
+    shadow_ray_count = 0;
+    if (pixel_count == 0) return;
+
+    AABB scene_bounds = scene.tlas.empty() ? AABB() : scene.tlas.nodes[0].bounds;
+    if (paged != nullptr && paged->cluster_count() > 0) scene_bounds.expand(transform_box(paged_to_world, paged->bounds()));
+
+    for (size_t first = 0; first < pixel_count; first += batch_size) {
+        size_t count = std::min(batch_size, pixel_count - first);
+        generate(camera, region, first, count, sample, offset_u, offset_v, pool);
+
+        for (int depth = 0; depth < max_depth && !extend_queue.empty(); ++depth) {
+            if (sort_rays && !scene_bounds.empty()) sort_queue(scene_bounds, pool);
+            extend(scene, pool);
+            shade(scene, depth, pool);
+            trace_shadows(scene, pool);
+        }
+
+        run_stage(pool, count, [&](size_t path) { output[first + path] = radiance[path]; });
+    }
+}
+
+void WavefrontIntegrator::generate(const Camera& camera, const RenderTile& region, size_t first_pixel, size_t count,
+                                   int sample, double offset_u, double offset_v, ThreadPool* pool) {
+    // Grow once; later batches and frames reuse the same storage
+    if (rays.size() < count) {
+        rays.resize(count);
+        throughput.resize(count);
+        radiance.resize(count);
+        rngs.resize(count);
+        hits.resize(count);
+        hit_flags.resize(count);
+        shadow_rays.resize(count);
+        shadow_contribution.resize(count);
+        bounce_pdfs.resize(count);
+        cones.resize(count);
+        continue_flags.resize(count);
+        shadow_flags.resize(count);
+    }
+    extend_queue.resize(count);
+
+    int width = region.end_x - region.start_x;
+    double pixel_spread = camera.pixel_spread_angle();
+    run_stage(pool, count, [&](size_t path) {
+        size_t pixel = first_pixel + path;
+        int x = region.start_x + static_cast<int>(pixel % width);
+        int y = region.start_y + static_cast<int>(pixel / width);
+        rays[path] = camera.get_ray(x, y, offset_u, offset_v);
+        throughput[path] = color(1.0, 1.0, 1.0);
+        radiance[path] = color(0.0, 0.0, 0.0);
+        bounce_pdfs[path] = 0.0;
+        cones[path] = RayCone(0.0, pixel_spread);
+        rngs[path] = Rng(pixel_seed(x, y, sample));
+        extend_queue[path] = static_cast<uint32_t>(path);
+    });
+}
+
+// Stable counting sort on a 15-bit key: direction octant above a 4-bit-per-axis
+// Morton cell of the origin within the scene bounds
+void WavefrontIntegrator::sort_queue(const AABB& scene_bounds, ThreadPool* pool) {
+    size_t n = extend_queue.size();
+    sort_keys.resize(n);
+    sort_keys_scratch.resize(n);
+    sort_scratch.resize(n);
+
+    vec3 extent = scene_bounds.extent();
+    run_stage(pool, n, [&](size_t i) {
+        const Ray& ray = rays[extend_queue[i]];
+        uint32_t cell[3];
+        for (int a = 0; a < 3; ++a) {
+            double t = extent[a] > 0.0 ? (ray.origin()[a] - scene_bounds.min[a]) / extent[a] : 0.0;
+            cell[a] = static_cast<uint32_t>(std::min(15.0, std::max(0.0, t * 16.0)));
+        }
+        uint32_t octant = (ray.direction().x() < 0.0) | ((ray.direction().y() < 0.0) << 1) | ((ray.direction().z() < 0.0) << 2);
+        uint32_t morton = (spread_bits4(cell[0]) << 2) | (spread_bits4(cell[1]) << 1) | spread_bits4(cell[2]);
+        sort_keys[i] = static_cast<uint16_t>((octant << 12) | morton);
+    });
+
+    // Two 8-bit LSD passes; small enough per batch to stay serial
+    histogram.resize(256);
+    for (int shift = 0; shift < 16; shift += 8) {
+        std::fill(histogram.begin(), histogram.end(), 0);
+        for (size_t i = 0; i < n; ++i) histogram[(sort_keys[i] >> shift) & 0xFF]++;
+        uint32_t sum = 0;
+        for (uint32_t& bucket : histogram) {
+            uint32_t count = bucket;
+            bucket = sum;
+            sum += count;
+        }
+        for (size_t i = 0; i < n; ++i) {
+            uint32_t dst = histogram[(sort_keys[i] >> shift) & 0xFF]++;
+            sort_scratch[dst] = extend_queue[i];
+            sort_keys_scratch[dst] = sort_keys[i];
+        }
+        extend_queue.swap(sort_scratch);
+        sort_keys.swap(sort_keys_scratch);
+    }
+}
+
+void WavefrontIntegrator::extend(const SceneAccel& scene, ThreadPool* pool) {
+    const double infinity = std::numeric_limits<double>::infinity();
+    run_stage(pool, extend_queue.size(), [&](size_t i) {
+        uint32_t path = extend_queue[i];
+        hit_flags[path] = scene.intersect(rays[path], RAY_EPSILON, infinity, hits[path]);
+    });
+    if (paged != nullptr) extend_paged(pool);
+    extension_rays += extend_queue.size();
+}
+
+// Paged rays end at the scene hit, so any paged hit is the closer one
+void WavefrontIntegrator::extend_paged(ThreadPool* pool) {
+    const double infinity = std::numeric_limits<double>::infinity();
+    size_t n = extend_queue.size();
+    paged_rays.resize(n);
+    run_stage(pool, n, [&](size_t i) {
+        uint32_t path = extend_queue[i];
+        paged_rays[i] = PagedRay(world_to_paged.apply(rays[path]), RAY_EPSILON, hit_flags[path] ? hits[path].t : infinity);
+    });
+    paged->trace(paged_rays, pool);
+
+    run_stage(pool, n, [&](size_t i) {
+        const PagedRay& paged_ray = paged_rays[i];
+        if (paged_ray.triangle < 0) return;
+        uint32_t path = extend_queue[i];
+        HitRecord& rec = hits[path];
+        rec.t = paged_ray.t_max;
+        rec.p = rays[path].at(rec.t);
+        rec.u = paged_ray.u;
+        rec.v = paged_ray.v;
+        rec.prim_id = paged_ray.triangle;
+        rec.instance_id = -1;
+        rec.material_id = paged_material;
+        rec.set_face_normal(rays[path], unit_vector(world_to_paged.apply_transpose(paged_ray.normal)));
+        hit_flags[path] = 1;
+    });
+}
+
+void WavefrontIntegrator::shade(const SceneAccel& scene, int depth, ThreadPool* pool) {
+    bool last_bounce = depth + 1 >= max_depth;
+    size_t n = extend_queue.size();
+    size_t material_total = scene.materials.size();
+    run_stage(pool, n, [&](size_t i) {
+        uint32_t path = extend_queue[i];
+        continue_flags[i] = 0;
+        shadow_flags[i] = 0;
+        if (!hit_flags[path]) {
+            radiance[path] += throughput[path] * miss_radiance(scene, rays[path], bounce_pdfs[path]);
+        }
+    });
+
+    // Bucket hits by material with a stable counting sort of queue positions
+    material_offsets.assign(material_total + 1, 0);
+    for (size_t i = 0; i < n; ++i) {
+        uint32_t path = extend_queue[i];
+        if (hit_flags[path]) material_offsets[hits[path].material_id + 1]++;
+    }
+    for (size_t m = 0; m < material_total; ++m) material_offsets[m + 1] += material_offsets[m];
+    material_queue.resize(material_offsets[material_total]);
+    material_cursor.assign(material_offsets.begin(), material_offsets.end() - 1);
+    for (size_t i = 0; i < n; ++i) {
+        uint32_t path = extend_queue[i];
+        if (hit_flags[path]) material_queue[material_cursor[hits[path].material_id]++] = static_cast<uint32_t>(i);
+    }
+
+    // One task per ShadingBatch::LANES hits of a single material
+    shading_tasks.clear();
+    for (size_t m = 0; m < material_total; ++m) {
+        for (uint32_t begin = material_offsets[m]; begin < material_offsets[m + 1]; begin += ShadingBatch::LANES) {
+            shading_tasks.push_back(begin);
+        }
+    }
+
+    const EnvironmentMap* environment = scene.environment.get();
+    run_stage(pool, shading_tasks.size(), [&](size_t task) {
+        uint32_t begin = shading_tasks[task];
+        int material_id = hits[extend_queue[material_queue[begin]]].material_id;
+        const Material& material = scene.materials[material_id];
+        uint32_t end = std::min<uint32_t>(material_offsets[material_id + 1], begin + ShadingBatch::LANES);
+
+        ShadingBatch batch;
+        begin_shading_batch(batch, environment);
+        for (uint32_t k = begin; k < end; ++k) {
+            uint32_t path = extend_queue[material_queue[k]];
+            cones[path] = cones[path].at(hits[path].t * rays[path].direction().length());
+            color albedo = surface_albedo(scene, hits[path], rays[path], cones[path]);
+            load_shading_lane(batch, hits[path], rays[path], throughput[path], material, albedo, environment, rngs[path]);
+        }
+        shade_batch(material, batch);
+
+        for (uint32_t k = begin; k < end; ++k) {
+            uint32_t i = material_queue[k];
+            uint32_t path = extend_queue[i];
+            SurfaceScatter scatter;
+            read_shading_lane(batch, k - begin, throughput[path], scatter);
+            rays[path] = scatter.next;
+            bounce_pdfs[path] = scatter.pdf;
+            if (scatter.has_shadow) {
+                shadow_rays[path] = scatter.shadow;
+                shadow_contribution[path] = scatter.direct;
+                shadow_flags[i] = 1;
+            }
+            continue_flags[i] = scatter.has_next && !last_bounce;
+        }
+    }, 1);
+
+    // Order-preserving compaction keeps both queues in sorted order
+    shadow_queue.clear();
+    size_t live = 0;
+    for (size_t i = 0; i < extend_queue.size(); ++i) {
+        uint32_t path = extend_queue[i];
+        if (shadow_flags[i]) shadow_queue.push_back(path);
+        if (continue_flags[i]) extend_queue[live++] = path;
+    }
+    extend_queue.resize(live);
+}
+
+// Shadow rays leave the shade stage in sorted order, so consecutive entries
+// are coherent and go through the any-hit packet traversal together
+void WavefrontIntegrator::trace_shadows(const SceneAccel& scene, ThreadPool* pool) {
+    const double infinity = std::numeric_limits<double>::infinity();
+    const size_t packet = SHADOW_PACKET_SIZE;
+    size_t n = shadow_queue.size();
+    size_t packet_count = (n + packet - 1) / packet;
+    shadow_blocked.resize(n);
+
+    run_stage(pool, packet_count, [&](size_t p) {
+        size_t begin = p * packet;
+        int count = static_cast<int>(std::min(packet, n - begin));
+        Ray packet_rays[SHADOW_PACKET_SIZE];
+        double t_max[SHADOW_PACKET_SIZE] = {};
+        bool blocked[SHADOW_PACKET_SIZE];
+        for (int i = 0; i < count; ++i) {
+            packet_rays[i] = shadow_rays[shadow_queue[begin + i]];
+            t_max[i] = infinity;
+        }
+        scene.occluded_packet(packet_rays, t_max, count, blocked);
+        for (int i = 0; i < count; ++i) shadow_blocked[begin + i] = blocked[i];
+    });
+
+    // Only rays the scene leaves open go through the paged batches
+    if (paged != nullptr) {
+        paged_rays.resize(n);
+        run_stage(pool, n, [&](size_t i) {
+            paged_rays[i] = PagedRay(world_to_paged.apply(shadow_rays[shadow_queue[i]]), RAY_EPSILON, infinity);
+            paged_rays[i].done = shadow_blocked[i] != 0;
+        });
+        paged->trace(paged_rays, pool);
+        run_stage(pool, n, [&](size_t i) {
+            if (paged_rays[i].triangle >= 0) shadow_blocked[i] = 1;
+        });
+    }
+
+    run_stage(pool, n, [&](size_t i) {
+        if (!shadow_blocked[i]) radiance[shadow_queue[i]] += shadow_contribution[shadow_queue[i]];
+    });
+    shadow_ray_count += n;
+}
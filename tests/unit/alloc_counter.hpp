@@ -0,0 +1,12 @@
+#ifndef ALLOC_COUNTER_H
+#define ALLOC_COUNTER_H
+
+#include <cstddef>
+
+// Allocation-counting test hook. alloc_counter.cpp replaces every global
+// operator new (plain, array, aligned and nothrow) for the test runner and
+// counts each heap allocation, so tests can assert that steady-state code
+// paths never reach the heap.
+size_t allocation_count();
+
+#endif
@@ -0,0 +1,114 @@
+#include <gtest/gtest.h>
+#include "../../include/core/arena.hpp"
+#include "alloc_counter.hpp"
+#include <cstdint>
+#include <new>
+
+// Test allocations respect the requested alignment
+TEST(ArenaTest, Alignment) {
+    FrameArena arena(1024);
+    
+    arena.allocate(3, 1);
+    void* aligned = arena.allocate(16, 64);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(aligned) % 64, 0u);
+    EXPECT_GE(arena.bytes_used(), 19u);
+}
+
+// Test reset releases all allocations at once
+TEST(ArenaTest, Reset) {
+    FrameArena arena(1024);
+    
+    int* values = arena.allocate_array<int>(100);
+    for (int i = 0; i < 100; ++i) {
+        EXPECT_EQ(values[i], 0); // Value-initialized
+    }
+    EXPECT_GE(arena.bytes_used(), 400u);
+    
+    arena.reset();
+    EXPECT_EQ(arena.bytes_used(), 0u);
+}
+
+// Test an overflowing frame grows, and reset coalesces into one block
+TEST(ArenaTest, GrowthCoalesces) {
+    FrameArena arena(256);
+    
+    for (int i = 0; i < 20; ++i) {
+        arena.allocate(200);
+    }
+    EXPECT_GT(arena.block_count(), 1u);
+    size_t grown_capacity = arena.capacity();
+    
+    arena.reset();
+    EXPECT_EQ(arena.block_count(), 1u);
+    EXPECT_EQ(arena.capacity(), grown_capacity);
+}
+
+// Test that a repeated frame workload does not touch the heap after warm-up
+TEST(ArenaTest, SteadyStateZeroAllocations) {
+    FrameArena arena(256);
+    
+    auto frame = [&arena]() {
+        for (int i = 0; i < 50; ++i) {
+            arena.allocate_array<double>(64);
+        }
+        arena.reset();
+    };
+    
+    frame(); // Warm-up frame grows the arena
+    
+    size_t before = allocation_count();
+    for (int i = 0; i < 10; ++i) {
+        frame();
+    }
+    EXPECT_EQ(allocation_count(), before);
+}
+
+// Test the counter sees over-aligned and nothrow allocations, which the zero
+// allocation tests would otherwise miss
+TEST(ArenaTest, CounterSeesAlignedAndNothrow) {
+    struct alignas(64) Wide {
+        double values[8];
+    };
+    size_t before = allocation_count();
+    Wide* volatile wide = new Wide;
+    delete wide;
+    Wide* volatile wide_array = new Wide[3];
+    delete[] wide_array;
+    int* volatile plain = new (std::nothrow) int(1);
+    delete plain;
+    EXPECT_EQ(allocation_count(), before + 3);
+}
+
+// Test a rewound scope's memory is handed out again, including overflow blocks
+TEST(ArenaTest, ScopeRewinds) {
+    FrameArena arena(256);
+    arena.allocate(64);
+    size_t used = arena.bytes_used();
+    void* first;
+    {
+        ArenaScope scope(arena);
+        first = arena.allocate(32);
+        arena.allocate(1000); // Overflows into a new block
+    }
+    EXPECT_EQ(arena.bytes_used(), used);
+    size_t blocks = arena.block_count();
+    {
+        ArenaScope scope(arena);
+        EXPECT_EQ(arena.allocate(32), first);
+        arena.allocate(1000);
+    }
+    EXPECT_EQ(arena.block_count(), blocks);
+}
+
+// Test per-thread scratch arenas are independent
+TEST(ArenaTest, ScratchArenas) {
+    ScratchArenas scratch(4, 1024);
+    EXPECT_EQ(scratch.size(), 4);
+    
+    scratch.local(0).allocate(100);
+    EXPECT_GE(scratch.local(0).bytes_used(), 100u);
+    EXPECT_EQ(scratch.local(1).bytes_used(), 0u);
+    
+    scratch.reset_all();
+    EXPECT_EQ(scratch.local(0).bytes_used(), 0u);
+}
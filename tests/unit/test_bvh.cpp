@@ -0,0 +1,124 @@
+#include <gtest/gtest.h>
+#include "../../include/geometry/bvh.hpp"
+#include "../../include/geometry/scene.hpp"
+#include "test_helpers.hpp"
+
+static std::vector<AABB> mesh_bounds(const TriangleMesh& mesh) {
+    std::vector<AABB> bounds;
+    for (size_t i = 0; i < mesh.triangle_count(); ++i) bounds.push_back(mesh.triangle_bounds(i));
+    return bounds;
+}
+
+// Every primitive is referenced exactly once and children nest inside parents
+static void expect_valid(const BVH& bvh, const std::vector<AABB>& bounds) {
+    std::vector<int> seen(bounds.size(), 0);
+    for (const BVHNode& node : bvh.nodes) {
+        if (node.is_leaf()) {
+            for (int i = 0; i < node.prim_count; ++i) {
+                uint32_t prim = bvh.prim_indices[node.left_first + i];
+                seen[prim]++;
+                EXPECT_TRUE(node.bounds.contains(bounds[prim]));
+            }
+        } else {
+            EXPECT_TRUE(node.bounds.contains(bvh.nodes[node.left_first].bounds));
+            EXPECT_TRUE(node.bounds.contains(bvh.nodes[node.left_first + 1].bounds));
+        }
+    }
+    for (int count : seen) EXPECT_EQ(count, 1);
+    EXPECT_LT(bvh.depth(), BVH::MAX_DEPTH);
+}
+
+// Test AABB basics
+TEST(BVHTest, AABB) {
+    AABB box;
+    EXPECT_TRUE(box.empty());
+    
+    box.expand(point3(0, 0, 0));
+    box.expand(point3(1, 2, 3));
+    EXPECT_DOUBLE_EQ(box.surface_area(), 2.0 * (2.0 + 6.0 + 3.0));
+    EXPECT_EQ(box.largest_axis(), 2);
+    
+    Ray ray(point3(0.5, 1.0, -5.0), vec3(0, 0, 1));
+    double t_entry;
+    EXPECT_TRUE(box.hit(ray.origin(), vec3(1.0 / 0.0, 1.0 / 0.0, 1.0), 0.0, 100.0, t_entry));
+    EXPECT_DOUBLE_EQ(t_entry, 5.0);
+}
+
+// Test binned SAH build, serial and parallel
+TEST(BVHTest, BinnedSAH) {
+    TriangleMesh mesh = make_random_mesh(3000, 5.0, 1);
+    std::vector<AABB> bounds = mesh_bounds(mesh);
+    ThreadPool pool(4);
+    
+    BVH serial = build_bvh_binned_sah(bounds, nullptr);
+    BVH parallel = build_bvh_binned_sah(bounds, &pool);
+    expect_valid(serial, bounds);
+    expect_valid(parallel, bounds);
+    expect_matches_brute_force(mesh, parallel);
+}
+
+// Test LBVH build, serial and parallel
+TEST(BVHTest, LBVH) {
+    TriangleMesh mesh = make_random_mesh(3000, 5.0, 2);
+    std::vector<AABB> bounds = mesh_bounds(mesh);
+    ThreadPool pool(4);
+    
+    BVH serial = build_bvh_lbvh(bounds, nullptr);
+    BVH parallel = build_bvh_lbvh(bounds, &pool);
+    expect_valid(serial, bounds);
+    expect_valid(parallel, bounds);
+    EXPECT_EQ(serial.nodes.size(), parallel.nodes.size());
+    expect_matches_brute_force(mesh, parallel);
+}
+
+// Test large inputs go through the data-parallel top-level split path
+TEST(BVHTest, LargeParallelBuilds) {
+    TriangleMesh mesh = make_random_mesh(60000, 5.0, 3);
+    std::vector<AABB> bounds = mesh_bounds(mesh);
+    ThreadPool pool(4);
+    
+    BVH sah = build_bvh_binned_sah(bounds, &pool);
+    BVH lbvh = build_bvh_lbvh(bounds, &pool);
+    expect_valid(sah, bounds);
+    expect_valid(lbvh, bounds);
+    
+    // SAH should never be meaningfully worse than the Morton build
+    EXPECT_LE(sah.sah_cost(), lbvh.sah_cost() * 1.05);
+}
+
+// Test degenerate input: identical centroids and a single primitive
+TEST(BVHTest, DegenerateInput) {
+    std::vector<AABB> same(100, AABB(point3(0, 0, 0), point3(1, 1, 1)));
+    expect_valid(build_bvh_binned_sah(same, nullptr), same);
+    expect_valid(build_bvh_lbvh(same, nullptr), same);
+    
+    std::vector<AABB> single(1, AABB(point3(0, 0, 0), point3(1, 1, 1)));
+    EXPECT_EQ(build_bvh_lbvh(single, nullptr).nodes.size(), 1u);
+    EXPECT_EQ(build_bvh_binned_sah(single, nullptr).nodes.size(), 1u);
+    EXPECT_TRUE(build_bvh_lbvh(std::vector<AABB>(), nullptr).empty());
+}
+
+// Test scene BVH swap and intersection
+TEST(BVHTest, SceneSwap) {
+    Scene scene;
+    add_default_scene(scene);
+    ThreadPool pool(2);
+    
+    EXPECT_EQ(scene.acquire(), nullptr);
+    scene.build_lbvh(&pool);
+    std::shared_ptr<const SceneAccel> lbvh = scene.acquire();
+    ASSERT_NE(lbvh, nullptr);
+    
+    scene.build_sah(&pool);
+    std::shared_ptr<const SceneAccel> sah = scene.acquire();
+    EXPECT_NE(sah, lbvh); // Old snapshot stays valid for its holder
+    
+    // Ray straight down the middle hits the front of the centre sphere
+    Ray ray(point3(0, 0, 0), vec3(0, 0, -1));
+    HitRecord rec_lbvh, rec_sah;
+    ASSERT_TRUE(lbvh->intersect(ray, 0.001, 100.0, rec_lbvh));
+    ASSERT_TRUE(sah->intersect(ray, 0.001, 100.0, rec_sah));
+    EXPECT_NEAR(rec_sah.t, 0.7, 0.01);
+    EXPECT_DOUBLE_EQ(rec_sah.t, rec_lbvh.t);
+    EXPECT_GT(rec_sah.normal.z(), 0.9);
+}
@@ -0,0 +1,156 @@
+#include <gtest/gtest.h>
+#include "../../include/geometry/bvh8.hpp"
+#include "../../include/geometry/triangle_mesh.hpp"
+#include "test_helpers.hpp"
+#include <random>
+#include <limits>
+
+static BVH build_binary(const TriangleMesh& mesh) {
+    std::vector<AABB> bounds;
+    for (size_t i = 0; i < mesh.triangle_count(); ++i) bounds.push_back(mesh.triangle_bounds(i));
+    return build_bvh_binned_sah(bounds, nullptr);
+}
+
+// Every primitive appears once and every decoded child box contains its contents
+static void expect_conservative(const BVH8& wide, const TriangleMesh& mesh) {
+    std::vector<int> seen(mesh.triangle_count(), 0);
+    std::vector<AABB> subtree(wide.nodes.size());
+
+    // Children come after parents, so a reverse sweep yields exact subtree bounds
+    for (size_t n = wide.nodes.size(); n-- > 0;) {
+        const BVH8Node& node = wide.nodes[n];
+        uint32_t prim = node.prim_base;
+        uint32_t child = node.child_base;
+        for (int i = 0; i < 8; ++i) {
+            AABB contents;
+            if ((node.interior_mask >> i) & 1) {
+                contents = subtree[child++];
+            } else {
+                for (int k = 0; k < node.leaf_count[i]; ++k) {
+                    uint32_t tri = wide.prim_indices[prim++];
+                    seen[tri]++;
+                    contents.expand(mesh.triangle_bounds(tri));
+                }
+                if (node.leaf_count[i] == 0) continue;
+            }
+            EXPECT_TRUE(wide.child_bounds(node, i).contains(contents));
+            subtree[n].expand(contents);
+        }
+    }
+    for (int count : seen) EXPECT_EQ(count, 1);
+}
+
+// Test conversion keeps every primitive inside conservative quantized boxes
+TEST(BVH8Test, ConservativeBounds) {
+    TriangleMesh mesh = make_random_mesh(5000, 5.0, 21);
+    BVH binary = build_binary(mesh);
+    BVH8 wide = build_bvh8(binary);
+
+    ASSERT_FALSE(wide.empty());
+    expect_conservative(wide, mesh);
+    EXPECT_TRUE(wide.bounds.contains(mesh.bounds()));
+}
+
+// Test traversal matches brute force, including far from the origin
+TEST(BVH8Test, MatchesBruteForce) {
+    TriangleMesh mesh = make_random_mesh(3000, 5.0, 22);
+    expect_matches_brute_force(mesh, build_bvh8(build_binary(mesh)), 8.0);
+
+    // Large coordinates stress the single-precision grid
+    TriangleMesh offset_mesh;
+    for (size_t v = 0; v < mesh.vertex_count(); ++v) offset_mesh.add_vertex(mesh.vertex(static_cast<uint32_t>(v)) * 0.1 + vec3(1000.0, -2000.0, 500.0));
+    offset_mesh.indices = mesh.indices;
+    BVH8 offset_wide = build_bvh8(build_binary(offset_mesh));
+    expect_conservative(offset_wide, offset_mesh);
+}
+
+// Test the wide layout is much smaller than the binary one
+TEST(BVH8Test, MemoryFootprint) {
+    TriangleMesh mesh = make_random_mesh(20000, 20.0, 23);
+    BVH binary = build_binary(mesh);
+    BVH8 wide = build_bvh8(binary);
+
+    size_t binary_node_bytes = binary.nodes.size() * sizeof(BVHNode);
+    size_t wide_node_bytes = wide.nodes.size() * sizeof(BVH8Node);
+    EXPECT_EQ(sizeof(BVH8Node), 80u);
+    EXPECT_LT(wide_node_bytes * 3, binary_node_bytes);
+    EXPECT_EQ(wide.prim_indices.size(), binary.prim_indices.size());
+}
+
+// Test single-leaf and empty inputs
+TEST(BVH8Test, SmallInputs) {
+    TriangleMesh mesh = make_random_mesh(1, 1.0, 24);
+    BVH8 wide = build_bvh8(build_binary(mesh));
+    ASSERT_EQ(wide.nodes.size(), 1u);
+    EXPECT_EQ(wide.nodes[0].leaf_count[0], 1);
+    expect_matches_brute_force(mesh, wide, 2.0);
+
+    EXPECT_TRUE(build_bvh8(BVH()).empty());
+}
+
+// Test binary leaves over the 255 primitive slot limit are split across
+// slots and extra nodes instead of losing triangles
+TEST(BVH8Test, OversizedLeaves) {
+    TriangleMesh mesh = make_random_mesh(3000, 5.0, 26);
+    std::vector<AABB> bounds;
+    for (size_t i = 0; i < mesh.triangle_count(); ++i) bounds.push_back(mesh.triangle_bounds(i));
+
+    // One leaf of 3000, more than eight full slots; and leaves of up to 400
+    for (int max_leaf : {3000, 400}) {
+        BVH binary = build_bvh_binned_sah(bounds, nullptr, max_leaf);
+        BVH8 wide = build_bvh8(binary);
+        EXPECT_EQ(wide.prim_indices.size(), mesh.triangle_count());
+        expect_conservative(wide, mesh);
+        expect_matches_brute_force(mesh, wide, 8.0, 200);
+    }
+}
+
+// Test any-hit queries agree with closest-hit, singly and in packets
+TEST(BVH8Test, AnyHitMatchesClosestHit) {
+    TriangleMesh mesh = make_random_mesh(3000, 5.0, 25);
+    BVH binary = build_binary(mesh);
+    BVH8 wide = build_bvh8(binary);
+
+    std::mt19937 rng(3);
+    std::uniform_real_distribution<double> unit(-1.0, 1.0);
+    const int count = 16;
+    Ray rays[count];
+    double t_max[count];
+    for (int batch = 0; batch < 40; ++batch) {
+        for (int i = 0; i < count; ++i) {
+            rays[i] = Ray(point3(unit(rng) * 8.0, unit(rng) * 8.0, unit(rng) * 8.0), vec3(unit(rng), unit(rng), unit(rng)));
+            t_max[i] = batch % 2 == 0 ? std::numeric_limits<double>::infinity() : 2.0 + 6.0 * std::abs(unit(rng));
+        }
+
+        uint32_t expected = 0;
+        for (int i = 0; i < count; ++i) {
+            double closest = t_max[i];
+            bool hit = binary.traverse(rays[i], 0.0, closest, [&](uint32_t tri, double& limit) {
+                double t, u, v;
+                if (mesh.intersect_triangle(tri, rays[i], 0.0, limit, t, u, v)) { limit = t; return true; }
+                return false;
+            });
+            auto blocks = [&](uint32_t tri) {
+                double t, u, v;
+                return mesh.intersect_triangle(tri, rays[i], 0.0, t_max[i], t, u, v);
+            };
+            EXPECT_EQ(binary.traverse_any(rays[i], 0.0, t_max[i], blocks), hit);
+            EXPECT_EQ(wide.traverse_any(rays[i], 0.0, t_max[i], blocks), hit);
+            if (hit) expected |= 1u << i;
+        }
+
+        auto packet_blocks = [&](uint32_t tri, uint32_t mask) {
+            uint32_t blocked = 0;
+            for (; mask != 0; mask &= mask - 1) {
+                int i = __builtin_ctz(mask);
+                double t, u, v;
+                if (mesh.intersect_triangle(tri, rays[i], 0.0, t_max[i], t, u, v)) blocked |= 1u << i;
+            }
+            return blocked;
+        };
+        EXPECT_EQ(binary.traverse_any_packet(rays, count, 0.0, t_max, 0xFFFF, packet_blocks), expected);
+        EXPECT_EQ(wide.traverse_any_packet(rays, count, 0.0, t_max, 0xFFFF, packet_blocks), expected);
+        // Inactive rays are never reported
+        EXPECT_EQ(wide.traverse_any_packet(rays, count, 0.0, t_max, 0x00F0, packet_blocks), expected & 0x00F0);
+    }
+}
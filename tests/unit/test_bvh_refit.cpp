@@ -0,0 +1,187 @@
+#include <gtest/gtest.h>
+#include "../../include/geometry/bvh_refit.hpp"
+#include "../../include/geometry/scene.hpp"
+#include "test_helpers.hpp"
+#include <random>
+#include <limits>
+
+// Walk reachable nodes only: partial rebuilds leave unused slots behind.
+// Every primitive is referenced once and every node is exactly the union
+// of its children, i.e. the refit bounds are tight.
+static void expect_tight(const BVH& bvh, const TriangleMesh& mesh) {
+    std::vector<int> seen(mesh.triangle_count(), 0);
+    std::vector<int> stack(1, 0);
+    while (!stack.empty()) {
+        const BVHNode& node = bvh.nodes[stack.back()];
+        stack.pop_back();
+        AABB expected;
+        if (node.is_leaf()) {
+            for (int i = 0; i < node.prim_count; ++i) {
+                uint32_t prim = bvh.prim_indices[node.left_first + i];
+                seen[prim]++;
+                expected.expand(mesh.triangle_bounds(prim));
+            }
+        } else {
+            expected = surrounding_box(bvh.nodes[node.left_first].bounds, bvh.nodes[node.left_first + 1].bounds);
+            stack.push_back(node.left_first);
+            stack.push_back(node.left_first + 1);
+        }
+        for (int axis = 0; axis < 3; ++axis) {
+            EXPECT_EQ(node.bounds.min[axis], expected.min[axis]);
+            EXPECT_EQ(node.bounds.max[axis], expected.max[axis]);
+        }
+    }
+    for (int count : seen) EXPECT_EQ(count, 1);
+}
+
+static void move_triangle(TriangleMesh& mesh, uint32_t tri, const vec3& delta) {
+    for (int k = 0; k < 3; ++k) {
+        float* p = &mesh.positions[3 * static_cast<size_t>(mesh.indices[3 * tri + k])];
+        p[0] += static_cast<float>(delta.x());
+        p[1] += static_cast<float>(delta.y());
+        p[2] += static_cast<float>(delta.z());
+    }
+}
+
+// Test refitting touches only moved leaves and their ancestors
+TEST(BVHRefitTest, RefitIsLocal) {
+    TriangleMesh mesh = make_random_mesh(4000, 5.0, 11);
+    std::vector<AABB> bounds;
+    for (size_t i = 0; i < mesh.triangle_count(); ++i) bounds.push_back(mesh.triangle_bounds(i));
+    ThreadPool pool(4);
+    BVH bvh = build_bvh_binned_sah(bounds, &pool);
+
+    BVHRefitter refitter;
+    refitter.initialize(bvh, mesh.triangle_count());
+    auto bounds_of = [&](uint32_t tri) { return mesh.triangle_bounds(tri); };
+
+    std::vector<uint32_t> moved = {3, 17, 2500};
+    for (uint32_t tri : moved) move_triangle(mesh, tri, vec3(0.2, -0.1, 0.05));
+    refitter.refit(bvh, moved, bounds_of, &pool);
+
+    expect_tight(bvh, mesh);
+    EXPECT_GT(refitter.last_refit_node_count(), 0u);
+    EXPECT_LE(refitter.last_refit_node_count(), moved.size() * static_cast<size_t>(bvh.depth() + 1));
+    EXPECT_TRUE(refitter.degraded_subtrees().empty());
+
+    // Nothing moved, nothing visited
+    refitter.refit(bvh, std::vector<uint32_t>(), bounds_of, &pool);
+    EXPECT_EQ(refitter.last_refit_node_count(), 0u);
+}
+
+// Test large moves are reported as degraded and a partial rebuild restores quality
+TEST(BVHRefitTest, PartialRebuild) {
+    TriangleMesh mesh = make_random_mesh(3000, 5.0, 12);
+    std::vector<AABB> bounds;
+    for (size_t i = 0; i < mesh.triangle_count(); ++i) bounds.push_back(mesh.triangle_bounds(i));
+    BVH bvh = build_bvh_binned_sah(bounds, nullptr);
+
+    BVHRefitter refitter;
+    refitter.initialize(bvh, mesh.triangle_count());
+    auto bounds_of = [&](uint32_t tri) { return mesh.triangle_bounds(tri); };
+
+    // Scatter one subtree's triangles across the scene
+    const BVHNode& left = bvh.nodes[bvh.nodes[0].left_first];
+    int begin = std::numeric_limits<int>::max(), end = 0;
+    std::vector<int> stack(1, bvh.nodes[0].left_first);
+    while (!stack.empty()) {
+        const BVHNode& node = bvh.nodes[stack.back()];
+        stack.pop_back();
+        if (node.is_leaf()) {
+            begin = std::min(begin, node.left_first);
+            end = std::max(end, node.left_first + node.prim_count);
+        } else {
+            stack.push_back(node.left_first);
+            stack.push_back(node.left_first + 1);
+        }
+    }
+    ASSERT_FALSE(left.is_leaf());
+
+    std::mt19937 rng(5);
+    std::uniform_real_distribution<double> jump(-4.0, 4.0);
+    std::vector<uint32_t> moved;
+    for (int i = begin; i < end; i += 3) {
+        uint32_t tri = bvh.prim_indices[i];
+        move_triangle(mesh, tri, vec3(jump(rng), jump(rng), jump(rng)));
+        moved.push_back(tri);
+    }
+    refitter.refit(bvh, moved, bounds_of, nullptr);
+    expect_tight(bvh, mesh);
+    ASSERT_FALSE(refitter.degraded_subtrees().empty());
+
+    double refit_cost = bvh.sah_cost();
+    for (int root : refitter.degraded_subtrees()) rebuild_subtree(bvh, root, bounds_of, nullptr);
+    expect_tight(bvh, mesh);
+    expect_matches_brute_force(mesh, bvh);
+    EXPECT_LT(bvh.sah_cost(), refit_cost);
+
+    // The rebuilt tree can be refitted again
+    refitter.initialize(bvh, mesh.triangle_count());
+    move_triangle(mesh, moved[0], vec3(0.1, 0.1, 0.1));
+    refitter.refit(bvh, std::vector<uint32_t>(1, moved[0]), bounds_of, nullptr);
+    expect_tight(bvh, mesh);
+}
+
+// Test the double-buffered dynamic BLAS and background rebuild adoption
+TEST(BVHRefitTest, DynamicBLAS) {
+    TriangleMesh mesh = make_random_mesh(2000, 5.0, 13);
+    TriangleMesh expected = mesh;
+    DynamicBLAS dynamic(mesh, nullptr);
+
+    std::mt19937 rng(9);
+    std::uniform_int_distribution<uint32_t> pick(0, static_cast<uint32_t>(mesh.vertex_count()) - 1);
+    std::uniform_real_distribution<double> jump(-3.0, 3.0);
+
+    std::vector<std::shared_ptr<const BLAS>> held;
+    for (int frame = 0; frame < 6; ++frame) {
+        std::vector<uint32_t> ids;
+        std::vector<point3> positions;
+        for (int i = 0; i < 200; ++i) {
+            uint32_t vertex = pick(rng);
+            point3 p = expected.vertex(vertex) + vec3(jump(rng), jump(rng), jump(rng));
+            float* dst = &expected.positions[3 * static_cast<size_t>(vertex)];
+            dst[0] = static_cast<float>(p.x());
+            dst[1] = static_cast<float>(p.y());
+            dst[2] = static_cast<float>(p.z());
+            ids.push_back(vertex);
+            positions.push_back(p);
+        }
+        std::shared_ptr<const BLAS> blas = dynamic.update_vertices(ids, positions, nullptr);
+        EXPECT_EQ(blas->mesh->positions, expected.positions);
+        expect_tight(blas->bvh, *blas->mesh);
+
+        // Holding a frame's snapshot forces the next update onto a fresh buffer
+        if (frame == 2) held.push_back(blas);
+        dynamic.wait_for_rebuild();
+    }
+    EXPECT_GT(dynamic.rebuild_count(), 0);
+    expect_matches_brute_force(expected, dynamic.current()->bvh);
+}
+
+// Test scene vertex updates publish a refitted bottom level
+TEST(BVHRefitTest, SceneVertexUpdate) {
+    Scene scene;
+    TriangleMesh quad;
+    quad.add_quad(point3(-1, -1, 0), vec3(2, 0, 0), vec3(0, 2, 0));
+    int mesh_id = scene.add_mesh(quad);
+    scene.add_instance(mesh_id, Transform::translate(vec3(0, 0, -2)));
+    scene.build_sah(nullptr);
+
+    Ray ray(point3(0, 0, 0), vec3(0, 0, -1));
+    HitRecord rec;
+    ASSERT_TRUE(scene.acquire()->intersect(ray, 0.001, 100.0, rec));
+    EXPECT_NEAR(rec.t, 2.0, 1e-9);
+
+    // Push the whole quad one unit further away
+    std::vector<uint32_t> ids = {0, 1, 2, 3};
+    std::vector<point3> positions;
+    for (uint32_t id : ids) positions.push_back(quad.vertex(id) + vec3(0, 0, -1));
+    scene.update_mesh_vertices(mesh_id, ids, positions, nullptr);
+    ASSERT_TRUE(scene.acquire()->intersect(ray, 0.001, 100.0, rec));
+    EXPECT_NEAR(rec.t, 3.0, 1e-6);
+
+    // A later full build keeps the animated mesh
+    scene.build_lbvh(nullptr);
+    ASSERT_TRUE(scene.acquire()->intersect(ray, 0.001, 100.0, rec));
+    EXPECT_NEAR(rec.t, 3.0, 1e-6);
+}
@@ -67,3 +67,53 @@ TEST(CameraTest, DimensionUpdate) {
     EXPECT_DOUBLE_EQ(camera.image_height, 600.0);
     EXPECT_DOUBLE_EQ(camera.aspect_ratio, 800.0/600.0);
 }
+
+// Test jittered ray generation
+TEST(CameraTest, JitteredRay) {
+    Camera camera;
+    
+    // Zero offset matches the pixel center ray
+    Ray center = camera.get_ray(10, 20);
+    Ray jittered_center = camera.get_ray(10, 20, 0.0, 0.0);
+    EXPECT_DOUBLE_EQ(center.direction().x(), jittered_center.direction().x());
+    EXPECT_DOUBLE_EQ(center.direction().y(), jittered_center.direction().y());
+    
+    // A full pixel offset lands on the neighbouring pixel center
+    Ray neighbour = camera.get_ray(11, 21);
+    Ray shifted = camera.get_ray(10, 20, 1.0, 1.0);
+    EXPECT_NEAR(neighbour.direction().x(), shifted.direction().x(), 1e-12);
+    EXPECT_NEAR(neighbour.direction().y(), shifted.direction().y(), 1e-12);
+}
+
+// Test moves translate every ray without turning it
+TEST(CameraTest, Movement) {
+    Camera camera;
+    Ray before = camera.get_ray(100, 200, 0.25, 0.25);
+
+    camera.moveforward(2.0);
+    camera.moveright(0.5);
+    camera.moveup(0.25);
+    Ray after = camera.get_ray(100, 200, 0.25, 0.25);
+    EXPECT_NEAR(after.origin().x(), 0.5, 1e-12);
+    EXPECT_NEAR(after.origin().y(), 0.25, 1e-12);
+    EXPECT_NEAR(after.origin().z(), -2.0, 1e-12);
+    EXPECT_NEAR((after.direction() - before.direction()).length(), 0.0, 1e-12);
+
+    camera.movebackward(2.0);
+    camera.moveleft(0.5);
+    camera.movedown(0.25);
+    EXPECT_NEAR(camera.get_ray(0, 0).origin().length(), 0.0, 1e-12);
+}
+
+// Test projection inverts get_ray, including after a move
+TEST(CameraTest, Projection) {
+    Camera camera;
+    camera.update_dimensions(320.0, 180.0);
+    camera.moveright(0.3);
+    Ray ray = camera.get_ray(40, 150, 0.25, -0.5);
+    double i, j;
+    ASSERT_TRUE(camera.project(ray.at(3.7), i, j));
+    EXPECT_NEAR(i, 40.25, 1e-9);
+    EXPECT_NEAR(j, 149.5, 1e-9);
+    EXPECT_FALSE(camera.project(ray.at(-1.0), i, j));
+}
@@ -0,0 +1,128 @@
+#include <gtest/gtest.h>
+#include "../../include/rendering/denoiser.hpp"
+#include "../../include/rendering/integrator.hpp"
+#include "test_helpers.hpp"
+#include <random>
+#include <cmath>
+
+// Flat guides: a wall facing the camera at depth 2, split into two albedos at column split
+static GuideBuffers flat_guides(int width, int height, int split) {
+    GuideBuffers guides;
+    guides.resize(width, height);
+    for (size_t i = 0; i < guides.depth.size(); ++i) {
+        bool left = static_cast<int>(i % width) < split;
+        for (int c = 0; c < 3; ++c) guides.albedo[c][i] = left ? 0.8f : 0.2f;
+        guides.normal[0][i] = 0.0f;
+        guides.normal[1][i] = 0.0f;
+        guides.normal[2][i] = 1.0f;
+        guides.depth[i] = 2.0f;
+        guides.depth_gradient[0][i] = 0.0f;
+        guides.depth_gradient[1][i] = 0.0f;
+    }
+    return guides;
+}
+
+// Test noise on a lit wall is removed while the albedo edge stays sharp
+TEST(DenoiserTest, SmoothsNoiseKeepsAlbedoEdges) {
+    const int width = 96, height = 64, split = 40;
+    GuideBuffers guides = flat_guides(width, height, split);
+
+    // Irradiance 1 everywhere, so the clean image is the albedo
+    std::vector<double> clean(3 * width * height), noisy(3 * width * height);
+    std::mt19937 rng(3);
+    std::normal_distribution<double> noise(0.0, 0.15);
+    for (int i = 0; i < width * height; ++i) {
+        for (int c = 0; c < 3; ++c) {
+            clean[3 * i + c] = guides.albedo[c][i];
+            noisy[3 * i + c] = guides.albedo[c][i] * (1.0 + noise(rng));
+        }
+    }
+
+    std::vector<double> filtered = noisy;
+    Denoiser denoiser;
+    ThreadPool pool(4);
+    denoiser.denoise(filtered.data(), 3, width, height, guides, &pool);
+    EXPECT_LT(mean_squared_error(filtered, clean) * 20.0, mean_squared_error(noisy, clean));
+
+    // Columns either side of the edge keep their own albedo
+    for (int y = 0; y < height; ++y) {
+        EXPECT_NEAR(filtered[3 * (y * width + split - 1)], 0.8, 0.08);
+        EXPECT_NEAR(filtered[3 * (y * width + split)], 0.2, 0.02);
+    }
+
+    // Threads only split the rows; the serial result is identical
+    std::vector<double> serial = noisy;
+    denoiser.denoise(serial.data(), 3, width, height, guides, nullptr);
+    for (size_t i = 0; i < serial.size(); ++i) ASSERT_EQ(serial[i], filtered[i]);
+}
+
+// Test geometry edges in the guides stop the filter even where albedo matches
+TEST(DenoiserTest, RespectsNormalAndDepthEdges) {
+    const int width = 64, height = 32;
+    GuideBuffers guides = flat_guides(width, height, 0);
+    std::vector<double> image(4 * width * height); // Padded pixels, like Image's
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            size_t i = static_cast<size_t>(y) * width + x;
+            double value = 0.2;
+            if (x >= 20 && x < 40) {
+                // A nearer strip facing sideways, lit brighter
+                guides.normal[0][i] = 1.0f;
+                guides.normal[2][i] = 0.0f;
+                value = 0.2 * 3.0;
+            } else if (x >= 40) {
+                // Same normal as the left, far behind it
+                guides.depth[i] = 20.0f;
+                value = 0.2 * 0.5;
+            }
+            for (int c = 0; c < 3; ++c) image[4 * i + c] = value;
+        }
+    }
+    std::vector<double> filtered = image;
+    Denoiser denoiser;
+    denoiser.denoise(filtered.data(), 4, width, height, guides, nullptr);
+    for (size_t i = 0; i < filtered.size(); i += 4) EXPECT_NEAR(filtered[i], image[i], 1e-4 * image[i]);
+}
+
+// Test guides from the default scene and the denoiser on a real render:
+// denoising 4 samples cuts the error against a 1024 sample reference by more
+// than 3x, still short of 64 raw samples (hard shadows and the metal
+// sphere's reflections are not in the guides)
+TEST(DenoiserTest, RenderedImage) {
+    Scene scene;
+    add_default_scene(scene);
+    scene.build_sah(nullptr);
+    std::shared_ptr<const SceneAccel> accel = scene.acquire();
+    Camera camera;
+    const int width = 64, height = 36;
+    camera.update_dimensions(width, height);
+    ThreadPool pool(8);
+
+    GuideBuffers guides;
+    render_guides(*accel, camera, guides, &pool);
+    ASSERT_EQ(guides.width, width);
+    EXPECT_EQ(guides.depth[0], BACKGROUND_DEPTH);                 // Sky in the top corner
+    EXPECT_NEAR(guides.normal[1][(height - 1) * width], 1.0, 1e-6); // Ground in the bottom corner
+    EXPECT_EQ(guides.albedo[1][(height - 1) * width], static_cast<float>(accel->materials[0].albedo.y()));
+
+    auto render = [&](int sample_begin, int samples) {
+        std::vector<double> image(3 * width * height, 0.0);
+        pool.parallel_for(static_cast<size_t>(height), [&](size_t y, int) {
+            for (int x = 0; x < width; ++x) {
+                for (int s = sample_begin; s < sample_begin + samples; ++s) {
+                    Rng rng(pixel_seed(x, static_cast<int>(y), s));
+                    color c = trace_path(*accel, camera.get_ray(x, static_cast<int>(y)), rng, 3);
+                    for (int k = 0; k < 3; ++k) image[3 * (y * width + x) + k] += c[k] / samples;
+                }
+            }
+        });
+        return image;
+    };
+    std::vector<double> reference = render(10000, 1024);
+    std::vector<double> raw4 = render(0, 4);
+    std::vector<double> denoised4 = raw4;
+    Denoiser denoiser;
+    denoiser.denoise(denoised4.data(), 3, width, height, guides, &pool);
+
+    EXPECT_LT(mean_squared_error(denoised4, reference) * 3.0, mean_squared_error(raw4, reference));
+}
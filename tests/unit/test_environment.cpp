@@ -0,0 +1,241 @@
+#include <gtest/gtest.h>
+#include "../../include/rendering/environment.hpp"
+#include "../../include/rendering/wavefront.hpp"
+#include "test_helpers.hpp"
+#include <random>
+#include <string>
+#include <vector>
+#include <cmath>
+#include <cstdio>
+
+static const double PI = 3.14159265358979323846;
+
+// Dim uniform sky with a small bright patch 45 degrees up, like a sun
+static std::vector<float> make_sky(int width, int height) {
+    std::vector<float> rgb(3 * static_cast<size_t>(width) * height, 0.1f);
+    for (int y = height / 4; y < height / 4 + 2; ++y) {
+        for (int x = 10; x < 14; ++x) {
+            float* p = &rgb[3 * (static_cast<size_t>(y) * width + x)];
+            p[0] = 400.0f;
+            p[1] = 380.0f;
+            p[2] = 300.0f;
+        }
+    }
+    return rgb;
+}
+
+// Test sampled frequencies follow the weights and the leftover number is uniform
+TEST(EnvironmentTest, AliasTable) {
+    std::vector<double> weights = {1.0, 0.0, 3.0, 0.5, 10.0, 0.25, 2.0};
+    AliasTable table;
+    table.build(weights);
+    ASSERT_EQ(table.size(), weights.size());
+
+    const int samples = 200000;
+    std::vector<int> counts(weights.size(), 0);
+    std::mt19937 rng(4);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    double remapped_sum = 0.0;
+    for (int i = 0; i < samples; ++i) {
+        double remapped;
+        counts[table.sample(unit(rng), remapped)]++;
+        ASSERT_GE(remapped, 0.0);
+        ASSERT_LE(remapped, 1.0);
+        remapped_sum += remapped;
+    }
+    double total = 16.75;
+    for (size_t i = 0; i < weights.size(); ++i) {
+        EXPECT_NEAR(table.pmf[i], weights[i] / total, 1e-7);
+        EXPECT_NEAR(counts[i] / static_cast<double>(samples), weights[i] / total, 0.005);
+    }
+    EXPECT_EQ(counts[1], 0);
+    EXPECT_NEAR(remapped_sum / samples, 0.5, 0.005);
+
+    AliasTable flat;
+    flat.build(std::vector<double>(4, 0.0));
+    EXPECT_NEAR(flat.pmf[3], 0.25, 1e-7);
+}
+
+// Test sampled directions, their densities and lookups agree, and the density integrates to one
+TEST(EnvironmentTest, SamplingIsConsistent) {
+    EnvironmentMap map;
+    map.set_image(64, 32, make_sky(64, 32));
+
+    std::mt19937 rng(8);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    int bright = 0;
+    for (int i = 0; i < 20000; ++i) {
+        color value;
+        double pdf;
+        vec3 direction = map.sample(unit(rng), unit(rng), value, pdf);
+        ASSERT_NEAR(direction.length(), 1.0, 1e-9);
+        ASSERT_GT(pdf, 0.0);
+        EXPECT_NEAR(map.pdf(direction), pdf, pdf * 1e-6);
+        color lookup = map.radiance(direction);
+        EXPECT_EQ(lookup.x(), value.x());
+        if (value.x() > 1.0) bright++;
+    }
+    // The patch holds about 95% of the weighted energy
+    EXPECT_GT(bright, 18500);
+
+    // E[pdf / uniform pdf] over uniform directions is 1
+    double sum = 0.0;
+    const int samples = 400000;
+    for (int i = 0; i < samples; ++i) {
+        double z = 1.0 - 2.0 * unit(rng);
+        double r = std::sqrt(std::max(0.0, 1.0 - z * z));
+        double phi = 2.0 * PI * unit(rng);
+        sum += map.pdf(vec3(r * std::cos(phi), z, r * std::sin(phi))) * 4.0 * PI;
+    }
+    EXPECT_NEAR(sum / samples, 1.0, 0.05);
+}
+
+// Radiance RGBE with the given scanlines run-length encoded or flat
+static std::string write_hdr(int width, int height, const std::vector<uint8_t>& rgbe, bool encoded) {
+    std::string path = temp_path("environment_test");
+    FILE* file = fopen(path.c_str(), "wb");
+    fprintf(file, "#?RADIANCE\n# test\nFORMAT=32-bit_rle_rgbe\n\n-Y %d +X %d\n", height, width);
+    for (int y = 0; y < height; ++y) {
+        const uint8_t* row = &rgbe[4 * static_cast<size_t>(y) * width];
+        if (!encoded) {
+            fwrite(row, 1, 4 * width, file);
+            continue;
+        }
+        uint8_t start[4] = {2, 2, static_cast<uint8_t>(width >> 8), static_cast<uint8_t>(width & 0xFF)};
+        fwrite(start, 1, 4, file);
+        for (int c = 0; c < 4; ++c) {
+            // First half as one run of its first byte's value, second half as literals
+            int half = width / 2;
+            bool uniform = true;
+            for (int x = 0; x < half; ++x) uniform = uniform && row[4 * x + c] == row[c];
+            int x = 0;
+            if (uniform) {
+                uint8_t run[2] = {static_cast<uint8_t>(128 + half), row[c]};
+                fwrite(run, 1, 2, file);
+                x = half;
+            }
+            uint8_t count = static_cast<uint8_t>(width - x);
+            fwrite(&count, 1, 1, file);
+            for (; x < width; ++x) fwrite(&row[4 * x + c], 1, 1, file);
+        }
+    }
+    fclose(file);
+    return path;
+}
+
+// Test both scanline encodings decode to the same texels
+TEST(EnvironmentTest, LoadsRadianceHdr) {
+    const int width = 16, height = 4;
+    std::vector<uint8_t> rgbe(4 * width * height);
+    for (int i = 0; i < width * height; ++i) {
+        bool left = (i % width) < width / 2;
+        rgbe[4 * i + 0] = left ? 128 : static_cast<uint8_t>(i);
+        rgbe[4 * i + 1] = left ? 64 : 200;
+        rgbe[4 * i + 2] = left ? 32 : 10;
+        rgbe[4 * i + 3] = (i % 5 == 4 && !left) ? 0 : 129;
+    }
+
+    for (bool encoded : {false, true}) {
+        std::string path = write_hdr(width, height, rgbe, encoded);
+        EnvironmentMap map;
+        ASSERT_TRUE(map.load_hdr(path.c_str())) << encoded;
+        std::remove(path.c_str());
+        EXPECT_EQ(map.get_width(), width);
+        EXPECT_EQ(map.get_height(), height);
+
+        for (int y = 0; y < height; ++y) {
+            for (int x = 0; x < width; ++x) {
+                // Texel centre direction
+                double theta = PI * (y + 0.5) / height, phi = 2.0 * PI * (x + 0.5) / width;
+                color value = map.radiance(vec3(std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi)));
+                const uint8_t* p = &rgbe[4 * (y * width + x)];
+                double scale = p[3] == 0 ? 0.0 : std::ldexp(1.0, p[3] - 136);
+                EXPECT_EQ(value.x(), p[0] * scale);
+                EXPECT_EQ(value.y(), p[1] * scale);
+                EXPECT_EQ(value.z(), p[2] * scale);
+            }
+        }
+    }
+
+    EnvironmentMap map;
+    EXPECT_FALSE(map.load_hdr("/tmp/environment_test_missing.hdr"));
+    EXPECT_TRUE(map.empty());
+}
+
+// Test light sampling converges to the exact answer with far less noise than
+// cosine-weighted bounces alone, in both integrators
+TEST(EnvironmentTest, ImportanceSamplingReducesNoise) {
+    const int width = 64, height = 32;
+    std::shared_ptr<EnvironmentMap> map = std::make_shared<EnvironmentMap>();
+    map->set_image(width, height, make_sky(width, height));
+
+    Scene scene;
+    TriangleMesh ground;
+    ground.add_quad(point3(-50.0, 0.0, 50.0), vec3(100.0, 0.0, 0.0), vec3(0.0, 0.0, -100.0));
+    scene.add_instance(scene.add_mesh(std::move(ground)), Transform());
+    scene.set_environment(map, nullptr);
+    scene.build_sah(nullptr);
+    std::shared_ptr<const SceneAccel> accel = scene.acquire();
+    ASSERT_TRUE(accel->environment);
+
+    // Exact outgoing radiance: albedo / pi times the cosine-weighted integral over the upper rows
+    double irradiance = 0.0;
+    for (int y = 0; y < height / 2; ++y) {
+        double s0 = std::sin(PI * y / height), s1 = std::sin(PI * (y + 1) / height);
+        for (int x = 0; x < width; ++x) {
+            double theta = PI * (y + 0.5) / height, phi = 2.0 * PI * (x + 0.5) / width;
+            color value = map->radiance(vec3(std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi)));
+            irradiance += value.y() * (2.0 * PI / width) * 0.5 * (s1 * s1 - s0 * s0);
+        }
+    }
+    double expected = 0.6 / PI * irradiance;
+
+    // Light samples at the hit plus the MIS-weighted bounce (depth 2)
+    const int samples = 4000;
+    Ray down(point3(0.0, 1.0, 0.0), vec3(0.0, -1.0, 0.0));
+    double sum = 0.0, sum_sq = 0.0;
+    for (int i = 0; i < samples; ++i) {
+        Rng rng(pixel_seed(0, 0, i));
+        double value = trace_path(*accel, down, rng, 2).y();
+        sum += value;
+        sum_sq += value * value;
+    }
+    double mean = sum / samples;
+    double variance = sum_sq / samples - mean * mean;
+    EXPECT_NEAR(mean, expected, 0.03 * expected);
+
+    // Cosine-weighted bounces alone: albedo * L per sample
+    double cosine_sum = 0.0, cosine_sq = 0.0;
+    Rng rng(99);
+    const int cosine_samples = 200000;
+    for (int i = 0; i < cosine_samples; ++i) {
+        double u1 = rng.next_double(), u2 = rng.next_double();
+        double r = std::sqrt(u1), phi = 2.0 * PI * u2;
+        double value = 0.6 * map->radiance(vec3(r * std::cos(phi), std::sqrt(1.0 - u1), r * std::sin(phi))).y();
+        cosine_sum += value;
+        cosine_sq += value * value;
+    }
+    double cosine_mean = cosine_sum / cosine_samples;
+    double cosine_variance = cosine_sq / cosine_samples - cosine_mean * cosine_mean;
+    EXPECT_NEAR(cosine_mean, expected, 0.05 * expected);
+    EXPECT_LT(variance * 20.0, cosine_variance);
+
+    // The wavefront integrator draws the same samples
+    Camera camera;
+    camera.update_dimensions(32.0, 18.0);
+    scene.set_environment(map, nullptr);
+    add_default_scene(scene);
+    scene.build_sah(nullptr);
+    accel = scene.acquire();
+    RenderTile region = make_tile(0, 0, 32, 18);
+    std::vector<color> output(32 * 18);
+    WavefrontIntegrator wavefront;
+    wavefront.render(*accel, camera, region, 1, 0.5, 0.5, output.data(), nullptr);
+    for (int y = 0; y < 18; ++y) {
+        for (int x = 0; x < 32; ++x) {
+            Rng path_rng(pixel_seed(x, y, 1));
+            color reference = trace_path(*accel, camera.get_ray(x, y, 0.5, 0.5), path_rng, 3);
+            EXPECT_NEAR(output[y * 32 + x].y(), reference.y(), 1e-12);
+        }
+    }
+}
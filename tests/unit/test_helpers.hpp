@@ -0,0 +1,97 @@
+#ifndef TEST_HELPERS_H
+#define TEST_HELPERS_H
+
+#include <gtest/gtest.h>
+#include "../../include/geometry/triangle_mesh.hpp"
+#include "../../include/geometry/scene.hpp"
+#include "../../include/rendering/tile_scheduler.hpp"
+#include <random>
+#include <limits>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+// Fixtures shared between the unit tests. Each test file still builds its
+// own scenes; only helpers that several files need live here.
+
+// Ground and three spheres under SAH BVHs, as the renderer shows by default
+inline std::shared_ptr<const SceneAccel> default_accel(Scene& scene) {
+    add_default_scene(scene);
+    scene.build_sah(nullptr);
+    return scene.acquire();
+}
+
+// Tile covering [start_x, end_x) x [start_y, end_y)
+inline RenderTile make_tile(int start_x, int start_y, int end_x, int end_y) {
+    RenderTile tile;
+    tile.start_x = start_x;
+    tile.start_y = start_y;
+    tile.end_x = end_x;
+    tile.end_y = end_y;
+    tile.tile_id = 0;
+    return tile;
+}
+
+// Fresh empty file under /tmp; the caller removes it
+inline std::string temp_path(const char* prefix) {
+    std::string name = std::string("/tmp/") + prefix + "XXXXXX";
+    int fd = mkstemp(&name[0]);
+    if (fd >= 0) close(fd);
+    return name;
+}
+
+inline double mean_squared_error(const std::vector<double>& a, const std::vector<double>& b) {
+    double sum = 0.0;
+    for (size_t i = 0; i < a.size(); ++i) sum += (a[i] - b[i]) * (a[i] - b[i]);
+    return sum / a.size();
+}
+
+// Random triangle soup: centres uniform in a box of the given half size,
+// corners up to `corner_offset` from the centre on each axis
+inline TriangleMesh make_random_mesh(int triangles, double half_size, unsigned seed, double corner_offset = 0.3) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> position(-half_size, half_size);
+    std::uniform_real_distribution<double> offset(-corner_offset, corner_offset);
+
+    TriangleMesh mesh;
+    for (int i = 0; i < triangles; ++i) {
+        point3 center(position(rng), position(rng), position(rng));
+        uint32_t a = mesh.add_vertex(center + vec3(offset(rng), offset(rng), offset(rng)));
+        uint32_t b = mesh.add_vertex(center + vec3(offset(rng), offset(rng), offset(rng)));
+        uint32_t c = mesh.add_vertex(center + vec3(offset(rng), offset(rng), offset(rng)));
+        mesh.add_triangle(a, b, c);
+    }
+    return mesh;
+}
+
+// Closest hit through any hierarchy with traverse(ray, t_min, t_max, fn)
+// must match testing every triangle. Origins are spread over a cube of the
+// given half size; every tenth ray is axis-aligned, to exercise the guards
+// for zero direction components.
+template<class Hierarchy>
+void expect_matches_brute_force(const TriangleMesh& mesh, const Hierarchy& hierarchy, double spread = 8.0, int rays = 500) {
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<double> unit(-1.0, 1.0);
+    const double infinity = std::numeric_limits<double>::infinity();
+
+    for (int r = 0; r < rays; ++r) {
+        Ray ray(point3(unit(rng) * spread, unit(rng) * spread, unit(rng) * spread), vec3(unit(rng), unit(rng), unit(rng)));
+        if (r % 10 == 0) ray = Ray(ray.origin(), vec3(0, 0, r % 20 == 0 ? 1 : -1));
+
+        double brute_t = infinity;
+        for (size_t tri = 0; tri < mesh.triangle_count(); ++tri) {
+            double t, u, v;
+            if (mesh.intersect_triangle(tri, ray, 0.0, brute_t, t, u, v)) brute_t = t;
+        }
+
+        double hierarchy_t = infinity;
+        hierarchy.traverse(ray, 0.0, hierarchy_t, [&](uint32_t tri, double& closest) {
+            double t, u, v;
+            if (mesh.intersect_triangle(tri, ray, 0.0, closest, t, u, v)) { closest = t; return true; }
+            return false;
+        });
+        EXPECT_DOUBLE_EQ(hierarchy_t, brute_t);
+    }
+}
+
+#endif
@@ -0,0 +1,140 @@
+#include <gtest/gtest.h>
+#include "../../include/math/transform.hpp"
+#include "../../include/geometry/scene.hpp"
+#include <random>
+
+// Test transform composition and inverse
+TEST(InstancingTest, TransformInverse) {
+    Transform xform = Transform::translate(vec3(1, 2, 3)) * Transform::rotate_y(0.7) * Transform::scale(vec3(2, 3, 4));
+    Transform inverse = xform.inverse();
+    
+    point3 p(0.3, -1.2, 5.0);
+    point3 round_trip = inverse.apply_point(xform.apply_point(p));
+    EXPECT_NEAR(round_trip.x(), p.x(), 1e-12);
+    EXPECT_NEAR(round_trip.y(), p.y(), 1e-12);
+    EXPECT_NEAR(round_trip.z(), p.z(), 1e-12);
+    
+    // Composition order: scale first, then translate
+    point3 moved = (Transform::translate(vec3(1, 0, 0)) * Transform::scale(2.0)).apply_point(point3(1, 1, 1));
+    EXPECT_DOUBLE_EQ(moved.x(), 3.0);
+    EXPECT_DOUBLE_EQ(moved.y(), 2.0);
+}
+
+// Test instanced hits match hits on the geometry baked into world space
+TEST(InstancingTest, MatchesFlattenedGeometry) {
+    TriangleMesh sphere;
+    sphere.add_sphere(point3(0, 0, 0), 1.0, 24, 12);
+    
+    Scene scene;
+    int mesh_id = scene.add_mesh(sphere);
+    std::vector<Transform> placements = {
+        Transform::translate(vec3(-3, 0, 0)),
+        Transform::translate(vec3(3, 0, 0)) * Transform::scale(vec3(1, 2, 1)),
+        Transform::translate(vec3(0, 0, -4)) * Transform::rotate_y(1.0) * Transform::scale(0.5),
+    };
+    TriangleMesh flattened;
+    for (const Transform& xform : placements) {
+        scene.add_instance(mesh_id, xform);
+        TriangleMesh copy;
+        for (size_t v = 0; v < sphere.vertex_count(); ++v) {
+            copy.add_vertex(xform.apply_point(sphere.vertex(static_cast<uint32_t>(v))));
+        }
+        copy.indices = sphere.indices;
+        flattened.append(copy);
+    }
+    
+    ThreadPool pool(2);
+    scene.build_sah(&pool);
+    std::shared_ptr<const SceneAccel> accel = scene.acquire();
+    EXPECT_EQ(scene.unique_triangle_count() * 3, scene.instanced_triangle_count());
+    
+    std::mt19937 rng(11);
+    std::uniform_real_distribution<double> unit(-1.0, 1.0);
+    for (int r = 0; r < 300; ++r) {
+        Ray ray(point3(unit(rng) * 2.0, unit(rng) * 2.0, 6.0), vec3(unit(rng) * 0.6, unit(rng) * 0.3, -1.0));
+        
+        double expected = 1e30;
+        for (size_t tri = 0; tri < flattened.triangle_count(); ++tri) {
+            double t, u, v;
+            if (flattened.intersect_triangle(tri, ray, 0.001, expected, t, u, v)) expected = t;
+        }
+        
+        HitRecord rec;
+        bool hit = accel->intersect(ray, 0.001, 1e30, rec);
+        EXPECT_EQ(hit, expected < 1e30);
+        if (hit) {
+            EXPECT_NEAR(rec.t, expected, 1e-6);
+            EXPECT_LT(dot(rec.normal, ray.direction()), 0.0);
+        }
+    }
+}
+
+// Test moving an instance only rebuilds the top level
+TEST(InstancingTest, MoveInstance) {
+    Scene scene;
+    TriangleMesh quad;
+    quad.add_quad(point3(-1, -1, 0), vec3(2, 0, 0), vec3(0, 2, 0));
+    int mesh_id = scene.add_mesh(quad);
+    int instance = scene.add_instance(mesh_id, Transform::translate(vec3(0, 0, -5)));
+    
+    ThreadPool pool(2);
+    scene.build_lbvh(&pool);
+    std::shared_ptr<const SceneAccel> before = scene.acquire();
+    
+    scene.set_instance_transform(instance, Transform::translate(vec3(0, 0, -2)), &pool);
+    std::shared_ptr<const SceneAccel> after = scene.acquire();
+    
+    // Bottom level is shared, not copied
+    EXPECT_EQ(before->blas[mesh_id], after->blas[mesh_id]);
+    
+    Ray ray(point3(0, 0, 0), vec3(0, 0, -1));
+    HitRecord rec;
+    ASSERT_TRUE(before->intersect(ray, 0.001, 100.0, rec));
+    EXPECT_NEAR(rec.t, 5.0, 1e-9);
+    ASSERT_TRUE(after->intersect(ray, 0.001, 100.0, rec));
+    EXPECT_NEAR(rec.t, 2.0, 1e-9);
+    EXPECT_EQ(rec.instance_id, instance);
+}
+
+// Test an unbuilt scene has no instances in the top level
+TEST(InstancingTest, UnbuiltMeshIsSkipped) {
+    Scene scene;
+    TriangleMesh quad;
+    quad.add_quad(point3(-1, -1, 0), vec3(2, 0, 0), vec3(0, 2, 0));
+    int instance = scene.add_instance(scene.add_mesh(quad), Transform());
+    
+    scene.set_instance_transform(instance, Transform::translate(vec3(0, 0, -1)), nullptr);
+    HitRecord rec;
+    EXPECT_FALSE(scene.acquire()->intersect(Ray(point3(0, 0, 0), vec3(0, 0, -1)), 0.001, 100.0, rec));
+}
+
+// Test scene occlusion queries, single and packet, against closest hits
+TEST(InstancingTest, Occlusion) {
+    Scene scene;
+    add_default_scene(scene);
+    scene.build_sah(nullptr);
+    std::shared_ptr<const SceneAccel> accel = scene.acquire();
+
+    std::mt19937 rng(4);
+    std::uniform_real_distribution<double> unit(-1.0, 1.0);
+    const int count = SceneAccel::MAX_PACKET;
+    Ray rays[count];
+    double t_max[count];
+    bool blocked[count];
+    for (int i = 0; i < count; ++i) {
+        rays[i] = Ray(point3(unit(rng) * 2.0, 0.2 + unit(rng) * 0.5, -1.3 + unit(rng)), vec3(unit(rng), unit(rng), unit(rng)));
+        t_max[i] = i % 3 == 0 ? 0.5 : std::numeric_limits<double>::infinity();
+    }
+    accel->occluded_packet(rays, t_max, count, blocked);
+
+    int occluded_count = 0;
+    for (int i = 0; i < count; ++i) {
+        HitRecord rec;
+        bool hit = accel->intersect(rays[i], RAY_EPSILON, t_max[i], rec);
+        EXPECT_EQ(accel->occluded(rays[i], t_max[i]), hit);
+        EXPECT_EQ(blocked[i], hit);
+        occluded_count += hit;
+    }
+    EXPECT_GT(occluded_count, 0);
+    EXPECT_LT(occluded_count, count);
+}
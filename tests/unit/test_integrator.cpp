@@ -0,0 +1,127 @@
+#include <gtest/gtest.h>
+#include "../../include/rendering/integrator.hpp"
+#include "test_helpers.hpp"
+
+// Test the table holds one distinct specialization per feature set
+TEST(IntegratorTest, DispatchTable) {
+    for (unsigned features = 0; features < INTEGRATOR_FEATURE_COMBINATIONS; ++features) {
+        const IntegratorKernels& kernels = select_integrator(features);
+        EXPECT_EQ(kernels.features, features);
+        for (unsigned other = 0; other < features; ++other) {
+            EXPECT_NE(kernels.trace, select_integrator(other).trace);
+            EXPECT_NE(kernels.render_row, select_integrator(other).render_row);
+        }
+    }
+    EXPECT_EQ(select_integrator(0).trace, &trace_path_features<0>);
+    EXPECT_EQ(&select_integrator(INTEGRATOR_FEATURE_COMBINATIONS | FEATURE_CLAMP_INDIRECT), &select_integrator(FEATURE_CLAMP_INDIRECT));
+    EXPECT_STREQ(integrator_name(FEATURE_RUSSIAN_ROULETTE | FEATURE_CLAMP_INDIRECT), "roulette+clamp");
+}
+
+// Test row kernels give the same pixels as tracing each path on its own
+TEST(IntegratorTest, RowKernelMatchesPaths) {
+    Scene scene;
+    std::shared_ptr<const SceneAccel> accel = default_accel(scene);
+    Camera camera;
+    camera.update_dimensions(80.0, 45.0);
+
+    for (unsigned features = 0; features < INTEGRATOR_FEATURE_COMBINATIONS; ++features) {
+        const IntegratorKernels& kernels = select_integrator(features);
+        color row[50];
+        kernels.render_row(*accel, camera, 30, 10, 60, 2, 0.25, -0.25, 4, row);
+        for (int x = 10; x < 60; ++x) {
+            Rng rng(pixel_seed(x, 30, 2));
+            color expected = kernels.trace(*accel, camera.get_ray(x, 30, 0.25, -0.25), rng, 4, camera.pixel_spread_angle());
+            EXPECT_EQ(row[x - 10].x(), expected.x());
+            EXPECT_EQ(row[x - 10].y(), expected.y());
+            EXPECT_EQ(row[x - 10].z(), expected.z());
+        }
+    }
+
+    // Without features the row kernel is the plain path the wavefront traces
+    color row[8];
+    select_integrator(0).render_row(*accel, camera, 20, 0, 8, 0, 0.0, 0.0, 3, row);
+    for (int x = 0; x < 8; ++x) {
+        Rng rng(pixel_seed(x, 20, 0));
+        EXPECT_EQ(row[x].y(), trace_path(*accel, camera.get_ray(x, 20, 0.0, 0.0), rng, 3).y());
+    }
+}
+
+// Test Russian roulette leaves the pixel mean unchanged, and the clamp only
+// takes away light that arrives after a bounce
+TEST(IntegratorTest, FeaturesBehave) {
+    Scene scene;
+    std::shared_ptr<const SceneAccel> accel = default_accel(scene);
+    Camera camera;
+    camera.update_dimensions(80.0, 45.0);
+    Ray ground_ray = camera.get_ray(40, 40);
+
+    const int samples = 20000;
+    double plain = 0.0, roulette = 0.0;
+    PathKernel plain_trace = select_integrator(0).trace;
+    PathKernel roulette_trace = select_integrator(FEATURE_RUSSIAN_ROULETTE).trace;
+    for (int i = 0; i < samples; ++i) {
+        Rng a(pixel_seed(40, 40, i)), b(pixel_seed(40, 40, i));
+        plain += plain_trace(*accel, ground_ray, a, 6, 0.0).y();
+        roulette += roulette_trace(*accel, ground_ray, b, 6, 0.0).y();
+    }
+    EXPECT_NEAR(roulette / samples, plain / samples, 0.03 * plain / samples);
+
+    // A sky far brighter than the clamp: only the camera's direct view of it keeps its value
+    std::shared_ptr<EnvironmentMap> bright = std::make_shared<EnvironmentMap>();
+    bright->set_image(4, 2, std::vector<float>(3 * 8, 1000.0f));
+    scene.set_environment(bright, nullptr);
+    accel = scene.acquire();
+    PathKernel clamp_trace = select_integrator(FEATURE_CLAMP_INDIRECT).trace;
+    Rng sky_rng(1);
+    EXPECT_EQ(clamp_trace(*accel, Ray(point3(0.0, 0.0, 0.0), vec3(0.0, 1.0, 0.0)), sky_rng, 3, 0.0).x(), 1000.0);
+    // Same random numbers, so clamping can only take light away
+    int clamped = 0;
+    for (int i = 0; i < 200; ++i) {
+        Rng rng(pixel_seed(40, 40, i)), plain_rng(pixel_seed(40, 40, i));
+        double value = clamp_trace(*accel, ground_ray, rng, 3, 0.0).x();
+        double unclamped = plain_trace(*accel, ground_ray, plain_rng, 3, 0.0).x();
+        EXPECT_LE(value, unclamped + 1e-9);
+        clamped += value < unclamped - 1e-9;
+    }
+    EXPECT_GT(clamped, 100);
+}
+
+// Test each preview mode's output on known hits and misses
+TEST(IntegratorTest, PreviewModes) {
+    Scene scene;
+    std::shared_ptr<const SceneAccel> accel = default_accel(scene);
+    EXPECT_EQ(select_integrator(FEATURE_CLAMP_INDIRECT, PREVIEW_OFF).features, static_cast<unsigned>(FEATURE_CLAMP_INDIRECT));
+    EXPECT_EQ(select_integrator(0, PREVIEW_AO).preview, PREVIEW_AO);
+    EXPECT_STREQ(preview_name(PREVIEW_DEPTH), "depth");
+
+    // Open ground 2 units below the camera, the centre sphere's top, and the sky
+    Ray ground(point3(0.0, 1.5, 5.0), vec3(0.0, -1.0, 0.0));
+    Ray sphere_top(point3(0.0, 1.5, -1.2), vec3(0.0, -1.0, 0.0));
+    Ray sky(point3(0.0, 0.0, 0.0), vec3(0.0, 1.0, 0.0));
+    auto trace = [&](PreviewMode mode, const Ray& ray) {
+        Rng rng(7);
+        return select_integrator(0, mode).trace(*accel, ray, rng, 3, 0.0);
+    };
+
+    color normal = trace(PREVIEW_NORMALS, ground);
+    EXPECT_NEAR(normal.x(), 0.5, 1e-9);
+    EXPECT_NEAR(normal.y(), 1.0, 1e-9);
+    EXPECT_NEAR(normal.z(), 0.5, 1e-9);
+
+    EXPECT_NEAR(trace(PREVIEW_DEPTH, ground).x(), 1.0 / 3.0, 1e-9);
+    EXPECT_GT(trace(PREVIEW_DEPTH, sphere_top).x(), trace(PREVIEW_DEPTH, ground).x());
+
+    const color& ground_albedo = accel->materials[0].albedo;
+    EXPECT_EQ(trace(PREVIEW_ALBEDO, ground).y(), ground_albedo.y());
+    EXPECT_EQ(trace(PREVIEW_ALBEDO, sky).y(), sky_radiance(sky.direction()).y());
+
+    // Open ground sees no occluders; the ground where the sphere meets it sees mostly sphere
+    EXPECT_EQ(trace(PREVIEW_AO, ground).x(), 1.0);
+    EXPECT_EQ(trace(PREVIEW_AO, sky).x(), 1.0);
+    double contact = 0.0;
+    for (int i = 0; i < 50; ++i) {
+        Rng rng(pixel_seed(i, 0, 0));
+        contact += select_integrator(0, PREVIEW_AO).trace(*accel, Ray(point3(0.3, -0.45, -1.2), vec3(0.0, -1.0, 0.0)), rng, 3, 0.0).x();
+    }
+    EXPECT_LT(contact / 50.0, 0.8);
+}
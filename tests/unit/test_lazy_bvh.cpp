@@ -0,0 +1,113 @@
+#include <gtest/gtest.h>
+#include "../../include/geometry/scene.hpp"
+#include <random>
+#include <limits>
+#include <algorithm>
+
+// Clusters of small triangles spread along x, one cluster per unit of x
+static TriangleMesh make_clusters(int clusters, int triangles_per_cluster, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> offset(-0.3, 0.3);
+    TriangleMesh mesh;
+    for (int c = 0; c < clusters; ++c) {
+        for (int i = 0; i < triangles_per_cluster; ++i) {
+            point3 center(4.0 * c + offset(rng), offset(rng), offset(rng));
+            uint32_t a = mesh.add_vertex(center + vec3(offset(rng), offset(rng), offset(rng)) * 0.3);
+            uint32_t b = mesh.add_vertex(center + vec3(offset(rng), offset(rng), offset(rng)) * 0.3);
+            uint32_t d = mesh.add_vertex(center + vec3(offset(rng), offset(rng), offset(rng)) * 0.3);
+            mesh.add_triangle(a, b, d);
+        }
+    }
+    return mesh;
+}
+
+// Test lazy traversal matches an eagerly built BLAS
+TEST(LazyBVHTest, MatchesEagerBuild) {
+    auto mesh = std::make_shared<const TriangleMesh>(make_clusters(16, 500, 41));
+    std::shared_ptr<const BLAS> eager = build_blas(mesh, nullptr, true);
+    std::shared_ptr<const BLAS> lazy = build_blas_lazy(mesh, nullptr, 256);
+    ASSERT_TRUE(lazy->lazy);
+    EXPECT_GE(lazy->lazy->subtree_total(), 16u);
+    EXPECT_EQ(lazy->lazy->subtrees_built(), 0u);
+    EXPECT_TRUE(lazy->bounds().contains(mesh->bounds()));
+
+    std::mt19937 rng(3);
+    std::uniform_real_distribution<double> unit(-1.0, 1.0);
+    for (int r = 0; r < 400; ++r) {
+        Ray ray(point3(unit(rng) * 35.0 + 30.0, unit(rng), 3.0), vec3(unit(rng) * 0.2, unit(rng) * 0.2, -1.0));
+        HitRecord expected, actual;
+        bool hit = eager->intersect(ray, 0.001, 100.0, expected);
+        ASSERT_EQ(lazy->intersect(ray, 0.001, 100.0, actual), hit);
+        if (hit) {
+            EXPECT_EQ(actual.t, expected.t);
+            EXPECT_EQ(actual.prim_id, expected.prim_id);
+        }
+        EXPECT_EQ(lazy->occluded(ray, 0.001, 100.0), hit);
+    }
+
+    // Packets through the lazy and the SoA paths agree with single rays
+    Ray rays[32];
+    double t_max[32];
+    for (int i = 0; i < 32; ++i) {
+        rays[i] = Ray(point3(unit(rng) * 35.0 + 30.0, unit(rng), 3.0), vec3(unit(rng) * 0.2, unit(rng) * 0.2, -1.0));
+        t_max[i] = i % 4 == 0 ? 2.5 : 100.0;
+    }
+    uint32_t expected = 0;
+    for (int i = 0; i < 32; ++i) expected |= uint32_t(eager->occluded(rays[i], 0.001, t_max[i])) << i;
+    EXPECT_NE(expected, 0u);
+    EXPECT_EQ(lazy->occluded_packet(rays, 32, 0.001, t_max, 0xFFFFFFFFu), expected);
+    EXPECT_EQ(eager->occluded_packet(rays, 32, 0.001, t_max, 0xFFFFFFFFu), expected);
+    EXPECT_EQ(eager->occluded_packet(rays, 32, 0.001, t_max, 0x0000FF00u), expected & 0x0000FF00u);
+}
+
+// Test only the subtrees rays reach are built, once each, under concurrency
+TEST(LazyBVHTest, BuildsOnlyWhatIsVisited) {
+    auto mesh = std::make_shared<const TriangleMesh>(make_clusters(32, 200, 42));
+    std::shared_ptr<const BLAS> blas = build_blas_lazy(mesh, nullptr, 200);
+    const LazyBVH& lazy = *blas->lazy;
+    size_t total = lazy.subtree_total();
+    ASSERT_GE(total, 32u);
+
+    // Many threads hammer the first cluster at the same time
+    ThreadPool pool(8);
+    std::vector<uint8_t> hits(4096);
+    pool.parallel_for(hits.size(), [&](size_t i, int) {
+        double jitter = (i % 64) / 64.0 * 0.2 - 0.1;
+        HitRecord rec;
+        hits[i] = blas->intersect(Ray(point3(jitter, jitter, 3.0), vec3(0, 0, -1)), 0.001, 100.0, rec);
+    }, 16);
+    size_t built = lazy.subtrees_built();
+    EXPECT_GT(built, 0u);
+    EXPECT_LT(built, total / 4);
+    EXPECT_GT(std::count(hits.begin(), hits.end(), 1), 0);
+
+    // Rays that hit nothing build nothing more
+    HitRecord rec;
+    EXPECT_FALSE(blas->intersect(Ray(point3(0, 10, 3), vec3(0, 0, -1)), 0.001, 100.0, rec));
+    EXPECT_EQ(lazy.subtrees_built(), built);
+
+    lazy.build_all(&pool);
+    EXPECT_EQ(lazy.subtrees_built(), total);
+}
+
+// Test a lazily built scene renders the same hits as an eager one
+TEST(LazyBVHTest, SceneBuild) {
+    Scene eager_scene, lazy_scene;
+    add_default_scene(eager_scene);
+    add_default_scene(lazy_scene);
+    ThreadPool pool(2);
+    eager_scene.build_sah(&pool);
+    lazy_scene.build_lazy(&pool);
+
+    std::mt19937 rng(5);
+    std::uniform_real_distribution<double> unit(-1.0, 1.0);
+    for (int r = 0; r < 200; ++r) {
+        Ray ray(point3(0, 0, 1), vec3(unit(rng), unit(rng) * 0.5, -1.0));
+        HitRecord expected, actual;
+        bool hit = eager_scene.acquire()->intersect(ray, 0.001, 1e30, expected);
+        ASSERT_EQ(lazy_scene.acquire()->intersect(ray, 0.001, 1e30, actual), hit);
+        if (hit) {
+            EXPECT_EQ(actual.prim_id, expected.prim_id);
+        }
+    }
+}
@@ -0,0 +1,166 @@
+#include <gtest/gtest.h>
+#include "../../include/rendering/wavefront.hpp"
+#include "test_helpers.hpp"
+#include <cmath>
+
+// Test instances pick their material and hits report it
+TEST(MaterialTest, InstancesCarryMaterials) {
+    Scene scene;
+    EXPECT_EQ(scene.material_count(), static_cast<size_t>(Scene::DEFAULT_PALETTE));
+    int red = scene.add_material(Material::diffuse(color(0.9, 0.1, 0.1)));
+    EXPECT_EQ(red, Scene::DEFAULT_PALETTE);
+
+    TriangleMesh quad;
+    quad.add_quad(point3(-1.0, -1.0, 0.0), vec3(2.0, 0.0, 0.0), vec3(0.0, 2.0, 0.0));
+    int mesh = scene.add_mesh(quad);
+    scene.add_instance(mesh, Transform::translate(vec3(0.0, 0.0, -1.0)));
+    scene.add_instance(mesh, Transform::translate(vec3(0.0, 0.0, -2.0)));
+    scene.add_instance(mesh, Transform::translate(vec3(5.0, 0.0, -1.0)), red);
+    scene.add_instance(mesh, Transform::translate(vec3(-5.0, 0.0, -1.0)), 99); // Falls back to the palette
+    scene.build_sah(nullptr);
+    std::shared_ptr<const SceneAccel> accel = scene.acquire();
+    ASSERT_EQ(accel->materials.size(), static_cast<size_t>(Scene::DEFAULT_PALETTE + 1));
+
+    HitRecord rec;
+    ASSERT_TRUE(accel->intersect(Ray(point3(0.0, 0.0, 0.0), vec3(0.0, 0.0, -1.0)), 0.001, 100.0, rec));
+    EXPECT_EQ(rec.material_id, 0);
+    ASSERT_TRUE(accel->intersect(Ray(point3(5.0, 0.0, 0.0), vec3(0.0, 0.0, -1.0)), 0.001, 100.0, rec));
+    EXPECT_EQ(rec.material_id, red);
+    ASSERT_TRUE(accel->intersect(Ray(point3(-5.0, 0.0, 0.0), vec3(0.0, 0.0, -1.0)), 0.001, 100.0, rec));
+    EXPECT_EQ(rec.material_id, 3);
+}
+
+// Random hits on a unit sphere around the origin, seen from outside
+static HitRecord random_hit(Rng& rng, Ray& ray) {
+    double z = 1.0 - 2.0 * rng.next_double(), phi = 6.283185307179586 * rng.next_double();
+    double r = std::sqrt(1.0 - z * z);
+    HitRecord rec;
+    rec.normal = vec3(r * std::cos(phi), r * std::sin(phi), z);
+    rec.p = rec.normal;
+    ray = Ray(rec.p + 2.0 * rec.normal + vec3(0.3, -0.2, 0.1), vec3(-0.3, 0.2, -0.1) - 2.0 * rec.normal);
+    return rec;
+}
+
+// Test a full batch gives every lane the result it gets alone, for both
+// kernels and both kinds of light
+TEST(MaterialTest, BatchesMatchSingleLanes) {
+    std::shared_ptr<EnvironmentMap> map = std::make_shared<EnvironmentMap>();
+    std::vector<float> texels(3 * 16 * 8);
+    for (size_t i = 0; i < texels.size(); ++i) texels[i] = 0.1f + 0.05f * static_cast<float>(i % 7);
+    map->set_image(16, 8, texels);
+
+    for (const Material& material : {Material::diffuse(color(0.7, 0.5, 0.3)), Material::metal(color(0.9, 0.8, 0.7), 0.3)}) {
+        for (const EnvironmentMap* environment : {static_cast<const EnvironmentMap*>(nullptr), static_cast<const EnvironmentMap*>(map.get())}) {
+            const size_t lanes = ShadingBatch::LANES;
+            std::vector<HitRecord> hits(lanes);
+            std::vector<Ray> rays(lanes);
+            Rng scene_rng(5);
+            for (size_t i = 0; i < lanes; ++i) hits[i] = random_hit(scene_rng, rays[i]);
+
+            ShadingBatch full;
+            begin_shading_batch(full, environment);
+            for (size_t i = 0; i < lanes; ++i) {
+                Rng rng(pixel_seed(static_cast<int>(i), 0, 0));
+                load_shading_lane(full, hits[i], rays[i], color(1.0, 0.5, 0.25), material, material.albedo, environment, rng);
+            }
+            shade_batch(material, full);
+            ASSERT_EQ(full.count, lanes);
+
+            size_t continued = 0, shadowed = 0;
+            for (size_t i = 0; i < lanes; ++i) {
+                ShadingBatch single;
+                begin_shading_batch(single, environment);
+                Rng rng(pixel_seed(static_cast<int>(i), 0, 0));
+                load_shading_lane(single, hits[i], rays[i], color(1.0, 0.5, 0.25), material, material.albedo, environment, rng);
+                shade_batch(material, single);
+
+                color full_throughput, single_throughput;
+                SurfaceScatter a, b;
+                read_shading_lane(full, i, full_throughput, a);
+                read_shading_lane(single, 0, single_throughput, b);
+                ASSERT_EQ(a.has_next, b.has_next);
+                ASSERT_EQ(a.has_shadow, b.has_shadow);
+                EXPECT_NEAR((a.next.direction() - b.next.direction()).length(), 0.0, 1e-12);
+                EXPECT_NEAR(a.pdf, b.pdf, 1e-12);
+                EXPECT_NEAR((full_throughput - single_throughput).length(), 0.0, 1e-12);
+                if (a.has_shadow) {
+                    EXPECT_NEAR((a.direct - b.direct).length(), 0.0, 1e-12);
+                }
+                continued += a.has_next;
+                shadowed += a.has_shadow;
+
+                // Continuations leave the surface
+                if (a.has_next) {
+                    EXPECT_GT(dot(a.next.direction(), hits[i].normal), 0.0);
+                }
+            }
+            EXPECT_GT(continued, lanes / 2);
+            if (material.type == MATERIAL_DIFFUSE) {
+                EXPECT_GT(shadowed, 0u);
+            } else {
+                EXPECT_EQ(shadowed, 0u);
+            }
+        }
+    }
+}
+
+// Test a smooth metal is a perfect mirror
+TEST(MaterialTest, MirrorReflection) {
+    Material mirror = Material::metal(color(0.9, 0.9, 0.9), 0.0);
+    HitRecord rec;
+    rec.p = point3(0.0, 0.0, 0.0);
+    rec.normal = vec3(0.0, 1.0, 0.0);
+    Ray incoming(point3(-1.0, 1.0, 0.0), vec3(2.0, -2.0, 0.0));
+
+    ShadingBatch batch;
+    begin_shading_batch(batch, nullptr);
+    Rng rng(3);
+    load_shading_lane(batch, rec, incoming, color(1.0, 1.0, 1.0), mirror, mirror.albedo, nullptr, rng);
+    shade_batch(mirror, batch);
+    color throughput;
+    SurfaceScatter scatter;
+    read_shading_lane(batch, 0, throughput, scatter);
+    ASSERT_TRUE(scatter.has_next);
+    EXPECT_FALSE(scatter.has_shadow);
+    vec3 expected = unit_vector(vec3(1.0, 1.0, 0.0));
+    EXPECT_NEAR((scatter.next.direction() - expected).length(), 0.0, 1e-12);
+    EXPECT_NEAR(throughput.x(), 0.9, 1e-12);
+}
+
+// Test many interleaved materials: the wavefront's bucketed shading gives
+// exactly the megakernel's image
+TEST(MaterialTest, BucketedShadingMatchesMegakernel) {
+    Scene scene;
+    add_default_scene(scene);
+    TriangleMesh sphere;
+    sphere.add_sphere(point3(0.0, 0.0, 0.0), 1.0, 24, 12);
+    int mesh = scene.add_mesh(std::move(sphere));
+    for (int i = 0; i < 12; ++i) {
+        double shade = 0.2 + 0.06 * i;
+        int material = scene.add_material(i % 3 == 0 ? Material::metal(color(shade, shade, 0.8), 0.05 * i)
+                                                     : Material::diffuse(color(shade, 0.5, 1.0 - shade)));
+        scene.add_instance(mesh, Transform::translate(vec3(-2.2 + 0.4 * i, -0.35, -0.6 - 0.1 * (i % 4))) * Transform::scale(0.15), material);
+    }
+    scene.build_sah(nullptr);
+    std::shared_ptr<const SceneAccel> accel = scene.acquire();
+
+    Camera camera;
+    camera.update_dimensions(120.0, 68.0);
+    RenderTile region = make_tile(0, 0, 120, 68);
+    std::vector<color> output(120 * 68);
+    ThreadPool pool(4);
+    WavefrontIntegrator wavefront;
+    wavefront.set_max_depth(4);
+    wavefront.render(*accel, camera, region, 2, 0.5, 0.5, output.data(), &pool);
+
+    for (int y = 0; y < 68; ++y) {
+        for (int x = 0; x < 120; ++x) {
+            Rng rng(pixel_seed(x, y, 2));
+            color expected = trace_path(*accel, camera.get_ray(x, y, 0.5, 0.5), rng, 4);
+            const color& actual = output[y * 120 + x];
+            EXPECT_NEAR(actual.x(), expected.x(), 1e-12);
+            EXPECT_NEAR(actual.y(), expected.y(), 1e-12);
+            EXPECT_NEAR(actual.z(), expected.z(), 1e-12);
+        }
+    }
+}
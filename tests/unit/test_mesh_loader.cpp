@@ -0,0 +1,229 @@
+#include <gtest/gtest.h>
+#include "../../include/geometry/mesh_loader.hpp"
+#include <random>
+#include <string>
+#include <cstring>
+#include <cstdlib>
+#include <cmath>
+#include <cstdio>
+#include <unistd.h>
+
+static void expect_same_mesh(const TriangleMesh& a, const TriangleMesh& b) {
+    EXPECT_EQ(a.positions, b.positions);
+    EXPECT_EQ(a.indices, b.indices);
+}
+
+// Quad and triangle over five vertices, the reference for every format
+static TriangleMesh expected_mesh() {
+    TriangleMesh mesh;
+    mesh.add_vertex(point3(0, 0, 0));
+    mesh.add_vertex(point3(1, 0, 0));
+    mesh.add_vertex(point3(1, 1, 0));
+    mesh.add_vertex(point3(0, 1, 0));
+    mesh.add_vertex(point3(0.5, 0.5, -2.25));
+    mesh.add_triangle(0, 1, 2);
+    mesh.add_triangle(0, 2, 3);
+    mesh.add_triangle(1, 2, 4);
+    return mesh;
+}
+
+// Test the float parser against strtof
+TEST(MeshLoaderTest, ParseFloat) {
+    const char* cases[] = {"0", "-0.0", "1", "+2.5", "3.14159265358979", "-1e-7", "6.02214076e23", "1E+10",
+                           ".5", "5.", "1.17549435e-38", "123456789012345678901234", "0.000000000000000000000123"};
+    for (const char* text : cases) {
+        float value;
+        const char* end = text + std::strlen(text);
+        ASSERT_EQ(parse_float(text, end, value), end) << text;
+        EXPECT_FLOAT_EQ(value, std::strtof(text, nullptr)) << text;
+    }
+
+    std::mt19937 rng(12);
+    std::uniform_real_distribution<double> mantissa(-10.0, 10.0);
+    std::uniform_int_distribution<int> exponent(-30, 30);
+    for (int i = 0; i < 2000; ++i) {
+        char text[64];
+        snprintf(text, sizeof(text), "%.9ge%d", mantissa(rng), exponent(rng));
+        float value;
+        ASSERT_NE(parse_float(text, text + std::strlen(text), value), nullptr);
+        float expected = std::strtof(text, nullptr);
+        EXPECT_LE(std::fabs(value - expected), std::fabs(expected) * 1.2e-7f) << text;
+    }
+
+    float value;
+    const char* bad = "-x";
+    EXPECT_EQ(parse_float(bad, bad + 2, value), nullptr);
+    // An exponent marker without digits is not part of the number
+    const char* partial = "2e";
+    EXPECT_EQ(parse_float(partial, partial + 2, value), partial + 1);
+}
+
+// Test OBJ features and that any chunking gives the same mesh
+TEST(MeshLoaderTest, ObjChunkedParsing) {
+    std::string obj =
+        "# comment\r\n"
+        "o quad\n"
+        "v 0 0 0\n"
+        "v 1 0 0\r\n"
+        "vn 0 0 1\n"
+        "vt 0.5 0.5\n"
+        "  v 1 1 0 1.0\n"
+        "v 0 1 0\n"
+        "f 1/1/1 2/1/1 3//1 4\n"
+        "v 0.5 0.5 -2.25\n"
+        "g rest\n"
+        "f -4 -3 -1\n";
+    TriangleMesh expected = expected_mesh();
+
+    ThreadPool pool(4);
+    for (size_t chunk : {size_t(1), size_t(7), size_t(32), size_t(1) << 20}) {
+        TriangleMesh mesh;
+        ASSERT_TRUE(parse_obj(obj.data(), obj.size(), mesh, &pool, chunk));
+        expect_same_mesh(mesh, expected);
+    }
+
+    TriangleMesh mesh;
+    std::string bad = "v 0 0 0\nv 1 0 0\nf 1 2 3\n";
+    EXPECT_FALSE(parse_obj(bad.data(), bad.size(), mesh, nullptr));
+    EXPECT_TRUE(mesh.empty());
+}
+
+// Test ASCII and both binary PLY encodings, with extra properties and elements
+TEST(MeshLoaderTest, PlyFormats) {
+    TriangleMesh expected = expected_mesh();
+    const char* properties =
+        "element vertex 5\n"
+        "property float x\nproperty float y\nproperty double z\nproperty uchar red\n"
+        "element face 2\n"
+        "property uchar flags\nproperty list uchar int vertex_indices\n"
+        "element edge 1\n"
+        "property list uchar int vertex_pair\n"
+        "end_header\n";
+
+    std::string ascii = std::string("ply\nformat ascii 1.0\ncomment test\n") + properties +
+        "0 0 0 255\n1 0 0 0\n1 1 0 0\n0 1 0 0\n0.5 0.5 -2.25 7\n"
+        "1 4 0 1 2 3\n0 3 1 2 4\n"
+        "2 0 1\n";
+
+    ThreadPool pool(3);
+    for (size_t chunk : {size_t(1), size_t(9), size_t(1) << 20}) {
+        TriangleMesh mesh;
+        ASSERT_TRUE(parse_ply(ascii.data(), ascii.size(), mesh, &pool, chunk));
+        expect_same_mesh(mesh, expected);
+    }
+
+    for (bool big_endian : {false, true}) {
+        std::string binary = std::string("ply\nformat ") + (big_endian ? "binary_big_endian" : "binary_little_endian") +
+                             " 1.0\n" + properties;
+        auto put = [&](const void* bytes, size_t size) {
+            std::string value(static_cast<const char*>(bytes), size);
+            if (big_endian) value.assign(value.rbegin(), value.rend());
+            binary += value;
+        };
+        for (size_t v = 0; v < expected.vertex_count(); ++v) {
+            float x = expected.positions[3 * v], y = expected.positions[3 * v + 1];
+            double z = expected.positions[3 * v + 2];
+            uint8_t red = 3;
+            put(&x, 4);
+            put(&y, 4);
+            put(&z, 8);
+            put(&red, 1);
+        }
+        int32_t faces[2][5] = {{0, 1, 2, 3, -1}, {1, 2, 4, -1, -1}};
+        for (int f = 0; f < 2; ++f) {
+            uint8_t flags = 0, count = f == 0 ? 4 : 3;
+            put(&flags, 1);
+            put(&count, 1);
+            for (int k = 0; k < count; ++k) put(&faces[f][k], 4);
+        }
+        uint8_t pair = 2;
+        int32_t ends[2] = {0, 1};
+        put(&pair, 1);
+        put(&ends[0], 4);
+        put(&ends[1], 4);
+
+        TriangleMesh mesh;
+        ASSERT_TRUE(parse_ply(binary.data(), binary.size(), mesh, &pool));
+        expect_same_mesh(mesh, expected);
+
+        // Truncated data is an error, not a crash
+        EXPECT_FALSE(parse_ply(binary.data(), binary.size() - 12, mesh, &pool));
+    }
+}
+
+// Test OBJ vt and PLY u/v become per-vertex uvs with v flipped
+TEST(MeshLoaderTest, TextureCoordinates) {
+    std::string obj =
+        "v 0 0 0\nv 1 0 0\nv 1 1 0\n"
+        "vt 0 0\nvt 1 0.25\n"
+        "v 0 1 0\n"
+        "vt 1 1\nvt 0.5\n"
+        "f 1/1 2/2/1 3/-2 4/4\n"
+        "v 0.5 0.5 -2.25\n"
+        "f 2 3 5\n";
+    const float expected[10] = {0.0f, 1.0f, 1.0f, 0.75f, 1.0f, 0.0f, 0.5f, 1.0f, 0.0f, 0.0f};
+    ThreadPool pool(4);
+    for (size_t chunk : {size_t(1), size_t(16), size_t(1) << 20}) {
+        TriangleMesh mesh;
+        ASSERT_TRUE(parse_obj(obj.data(), obj.size(), mesh, &pool, chunk));
+        expect_same_mesh(mesh, expected_mesh());
+        ASSERT_TRUE(mesh.has_uvs());
+        for (int i = 0; i < 10; ++i) EXPECT_EQ(mesh.uvs[i], expected[i]);
+    }
+
+    TriangleMesh mesh;
+    std::string bad = "v 0 0 0\nv 1 0 0\nv 1 1 0\nvt 0 0\nf 1/1 2/2 3/1\n";
+    EXPECT_FALSE(parse_obj(bad.data(), bad.size(), mesh, nullptr));
+    std::string plain = "v 0 0 0\nv 1 0 0\nv 1 1 0\nf 1 2 3\n";
+    ASSERT_TRUE(parse_obj(plain.data(), plain.size(), mesh, nullptr));
+    EXPECT_FALSE(mesh.has_uvs());
+
+    std::string header = "ply\nformat ascii 1.0\nelement vertex 3\n"
+                         "property float x\nproperty float y\nproperty float z\nproperty float s\nproperty float t\n"
+                         "element face 1\nproperty list uchar int vertex_indices\nend_header\n";
+    std::string ascii = header + "0 0 0 0 0\n1 0 0 1 0.25\n1 1 0 1 1\n3 0 1 2\n";
+    ASSERT_TRUE(parse_ply(ascii.data(), ascii.size(), mesh, &pool));
+    ASSERT_TRUE(mesh.has_uvs());
+    for (int i = 0; i < 6; ++i) EXPECT_EQ(mesh.uvs[i], expected[i]);
+
+    std::string binary = "ply\nformat binary_little_endian 1.0\nelement vertex 3\n"
+                         "property float u\nproperty double x\nproperty float y\nproperty float z\nproperty float v\n"
+                         "element face 1\nproperty list uchar int vertex_indices\nend_header\n";
+    float texcoords[3][2] = {{0.0f, 0.0f}, {1.0f, 0.25f}, {1.0f, 1.0f}};
+    float corners[3][3] = {{0, 0, 0}, {1, 0, 0}, {1, 1, 0}};
+    for (int v = 0; v < 3; ++v) {
+        double x = corners[v][0];
+        binary.append(reinterpret_cast<const char*>(&texcoords[v][0]), 4);
+        binary.append(reinterpret_cast<const char*>(&x), 8);
+        binary.append(reinterpret_cast<const char*>(&corners[v][1]), 8);
+        binary.append(reinterpret_cast<const char*>(&texcoords[v][1]), 4);
+    }
+    uint8_t count = 3;
+    int32_t face[3] = {0, 1, 2};
+    binary.append(reinterpret_cast<const char*>(&count), 1);
+    binary.append(reinterpret_cast<const char*>(face), 12);
+    ASSERT_TRUE(parse_ply(binary.data(), binary.size(), mesh, &pool));
+    EXPECT_EQ(mesh.positions[3], 1.0f);
+    ASSERT_TRUE(mesh.has_uvs());
+    for (int i = 0; i < 6; ++i) EXPECT_EQ(mesh.uvs[i], expected[i]);
+}
+
+// Test loading through a memory-mapped file
+TEST(MeshLoaderTest, LoadFromFile) {
+    char path[] = "/tmp/mesh_loader_testXXXXXX";
+    int fd = mkstemp(path);
+    ASSERT_GE(fd, 0);
+    std::string obj = "v 0 0 0\nv 1 0 0\nv 1 1 0\nv 0 1 0\nv 0.5 0.5 -2.25\nf 1 2 3 4\nf 2 3 5\n";
+    ASSERT_EQ(write(fd, obj.data(), obj.size()), static_cast<ssize_t>(obj.size()));
+    close(fd);
+
+    std::string obj_path = std::string(path) + ".OBJ";
+    ASSERT_EQ(std::rename(path, obj_path.c_str()), 0);
+    TriangleMesh mesh;
+    EXPECT_TRUE(load_mesh(obj_path.c_str(), mesh, nullptr));
+    expect_same_mesh(mesh, expected_mesh());
+    std::remove(obj_path.c_str());
+
+    EXPECT_FALSE(load_mesh(obj_path.c_str(), mesh, nullptr));
+    EXPECT_FALSE(load_mesh("/tmp/mesh.unknown", mesh, nullptr));
+}
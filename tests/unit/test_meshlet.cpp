@@ -0,0 +1,139 @@
+#include <gtest/gtest.h>
+#include "../../include/geometry/scene.hpp"
+#include <random>
+#include <cmath>
+#include <algorithm>
+
+// Sphere tessellations share vertices between neighbouring triangles
+static TriangleMesh make_spheres(int count) {
+    TriangleMesh mesh;
+    for (int i = 0; i < count; ++i) {
+        mesh.add_sphere(point3(2.5 * i, 0.1 * i, -0.3 * i), 1.0 + 0.1 * i, 64, 32);
+    }
+    return mesh;
+}
+
+// Test every decoded vertex is within half a grid step of its source
+TEST(MeshletTest, DecodesWithinQuantizationError) {
+    TriangleMesh mesh = make_spheres(3);
+    MeshletMesh meshlets;
+    std::vector<uint32_t> order;
+    ThreadPool pool(4);
+    meshlets.build(mesh, &pool, &order);
+
+    ASSERT_EQ(meshlets.triangle_count(), mesh.triangle_count());
+    std::vector<uint32_t> ids = meshlets.triangle_ids();
+    ASSERT_EQ(ids.size(), order.size());
+    for (const Meshlet& meshlet : meshlets.meshlets) {
+        EXPECT_LE(meshlet.triangle_count, MeshletMesh::MESHLET_TRIANGLES);
+        EXPECT_GT(meshlet.triangle_count, 0);
+    }
+
+    double tolerance = 0.5 * meshlets.step * (1.0 + 1e-6) + 1e-6;
+    for (size_t i = 0; i < ids.size(); ++i) {
+        point3 decoded[3];
+        meshlets.triangle(ids[i], decoded[0], decoded[1], decoded[2]);
+        for (int k = 0; k < 3; ++k) {
+            point3 source = mesh.vertex(mesh.indices[3 * static_cast<size_t>(order[i]) + k]);
+            for (int axis = 0; axis < 3; ++axis) {
+                ASSERT_LE(std::fabs(decoded[k][axis] - source[axis]), tolerance);
+            }
+        }
+    }
+}
+
+// Test a vertex shared across meshlets decodes to the same point in each
+TEST(MeshletTest, SharedVerticesAreWatertight) {
+    TriangleMesh mesh = make_spheres(1);
+    MeshletMesh meshlets;
+    std::vector<uint32_t> order;
+    meshlets.build(mesh, nullptr, &order);
+    ASSERT_GT(meshlets.meshlet_count(), 10u);
+
+    std::vector<uint32_t> ids = meshlets.triangle_ids();
+    std::vector<point3> decoded(mesh.vertex_count());
+    std::vector<uint32_t> seen_in(mesh.vertex_count(), UINT32_MAX);
+    size_t shared = 0;
+    for (size_t i = 0; i < ids.size(); ++i) {
+        point3 p[3];
+        meshlets.triangle(ids[i], p[0], p[1], p[2]);
+        for (int k = 0; k < 3; ++k) {
+            uint32_t vertex = mesh.indices[3 * static_cast<size_t>(order[i]) + k];
+            if (seen_in[vertex] == UINT32_MAX) {
+                seen_in[vertex] = ids[i] >> 8;
+                decoded[vertex] = p[k];
+                continue;
+            }
+            if (seen_in[vertex] != ids[i] >> 8) shared++;
+            EXPECT_EQ(p[k].x(), decoded[vertex].x());
+            EXPECT_EQ(p[k].y(), decoded[vertex].y());
+            EXPECT_EQ(p[k].z(), decoded[vertex].z());
+        }
+    }
+    EXPECT_GT(shared, 0u);
+
+    // Rays through meshlet borders never slip between triangles
+    std::shared_ptr<const BLAS> blas = build_blas_compressed(mesh, nullptr);
+    std::mt19937 rng(5);
+    std::uniform_real_distribution<double> unit(-0.95, 0.95);
+    for (int r = 0; r < 2000; ++r) {
+        Ray ray(point3(unit(rng), unit(rng), 5.0), vec3(0.0, 0.0, -1.0));
+        double radius = std::sqrt(ray.origin().x() * ray.origin().x() + ray.origin().y() * ray.origin().y());
+        if (radius > 0.9) continue;
+        EXPECT_TRUE(blas->occluded(ray, 0.001, 100.0));
+    }
+}
+
+// Test compressed hits match the uncompressed mesh and memory shrinks
+TEST(MeshletTest, CompressedBLASMatchesMesh) {
+    auto mesh = std::make_shared<const TriangleMesh>(make_spheres(4));
+    ThreadPool pool(4);
+    std::shared_ptr<const BLAS> reference = build_blas(mesh, &pool, true);
+    std::shared_ptr<const BLAS> compressed = build_blas_compressed(*mesh, &pool);
+    ASSERT_TRUE(compressed->meshlets);
+    EXPECT_FALSE(compressed->mesh);
+    EXPECT_EQ(compressed->triangle_count(), mesh->triangle_count());
+
+    size_t compressed_bytes = compressed->meshlets->memory_bytes();
+    size_t packed_bytes = mesh->positions.size() * sizeof(float) + mesh->indices.size() * sizeof(uint32_t);
+    size_t vec3_bytes = mesh->vertex_count() * sizeof(vec3) + mesh->indices.size() * sizeof(uint32_t);
+    EXPECT_LT(compressed_bytes * 2, packed_bytes);
+    EXPECT_LT(compressed_bytes * 4, vec3_bytes);
+
+    double tolerance = 4.0 * compressed->meshlets->step;
+    std::mt19937 rng(9);
+    std::uniform_real_distribution<double> unit(-1.0, 1.0);
+    int hits = 0, flipped = 0;
+    for (int r = 0; r < 1000; ++r) {
+        Ray ray(point3(unit(rng) * 5.0 + 3.5, unit(rng) * 1.5, 6.0), vec3(unit(rng) * 0.1, unit(rng) * 0.1, -1.0));
+        HitRecord expected, actual;
+        bool hit = reference->intersect(ray, 0.001, 100.0, expected);
+        bool compressed_hit = compressed->intersect(ray, 0.001, 100.0, actual);
+        EXPECT_EQ(compressed->occluded(ray, 0.001, 100.0), compressed_hit);
+        // Rays grazing a silhouette may flip; everything else agrees
+        if (hit != compressed_hit) {
+            flipped++;
+            continue;
+        }
+        if (!hit) continue;
+        hits++;
+        vec3 n_expected = reference->face_normal(expected.prim_id);
+        vec3 n_actual = compressed->face_normal(actual.prim_id);
+        // Vertex error moves the surface along its normal; t moves more at grazing angles
+        double cosine = std::fabs(dot(n_expected, unit_vector(ray.direction())));
+        EXPECT_NEAR(actual.t, expected.t, tolerance / std::max(cosine, 0.05));
+        EXPECT_GT(dot(n_expected, n_actual), 0.9);
+    }
+    EXPECT_GT(hits, 300);
+    EXPECT_LT(flipped, 5);
+
+    // Compressed meshes work as prebuilt scene meshes
+    Scene scene;
+    int id = scene.add_built_mesh(compressed);
+    scene.add_instance(id, Transform::translate(vec3(0.0, 0.0, -2.0)));
+    scene.build_lbvh(nullptr);
+    EXPECT_EQ(scene.unique_triangle_count(), mesh->triangle_count());
+    HitRecord rec;
+    EXPECT_TRUE(scene.acquire()->intersect(Ray(point3(0.0, 0.0, 5.0), vec3(0.0, 0.0, -1.0)), 0.001, 100.0, rec));
+    EXPECT_NEAR(rec.t, 6.0, 0.01);
+}
@@ -0,0 +1,156 @@
+#include <gtest/gtest.h>
+#include "../../include/geometry/paged_mesh.hpp"
+#include "../../include/rendering/wavefront.hpp"
+#include "test_helpers.hpp"
+#include <random>
+#include <cstdio>
+
+// Grid of small quads over a wide area, so rays touch few clusters each
+static TriangleMesh make_terrain(int size, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> height(-0.2, 0.2);
+    TriangleMesh mesh;
+    for (int z = 0; z <= size; ++z) {
+        for (int x = 0; x <= size; ++x) mesh.add_vertex(point3(x * 0.1, height(rng), -z * 0.1));
+    }
+    for (int z = 0; z < size; ++z) {
+        for (int x = 0; x < size; ++x) {
+            uint32_t a = z * (size + 1) + x;
+            mesh.add_triangle(a, a + 1, a + size + 2);
+            mesh.add_triangle(a, a + size + 2, a + size + 1);
+        }
+    }
+    return mesh;
+}
+
+// Test paged tracing under a tight budget matches in-memory tracing
+TEST(PagedMeshTest, MatchesInMemoryUnderBudget) {
+    TriangleMesh terrain = make_terrain(120, 51);
+    std::string path = temp_path("paged_mesh_test");
+    std::vector<uint32_t> order;
+    ThreadPool pool(4);
+    ASSERT_TRUE(write_paged_mesh(path.c_str(), terrain, 512, &pool, &order));
+    ASSERT_EQ(order.size(), terrain.triangle_count());
+
+    PagedMesh paged;
+    ASSERT_TRUE(paged.open(path.c_str(), 0));
+    ASSERT_GT(paged.cluster_count(), 40u);
+    EXPECT_EQ(paged.resident_clusters(), 0u);
+    size_t budget = 4 * paged.cluster_bytes(0);
+    paged.set_budget(budget);
+
+    std::shared_ptr<const BLAS> reference = build_blas(std::make_shared<const TriangleMesh>(terrain), &pool, true);
+    std::mt19937 rng(2);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    std::vector<PagedRay> rays;
+    for (int i = 0; i < 2000; ++i) {
+        point3 origin(unit(rng) * 12.0, 2.0, -unit(rng) * 12.0);
+        rays.push_back(PagedRay(Ray(origin, vec3(unit(rng) - 0.5, -1.0, unit(rng) - 0.5)), 0.001, 1e30));
+    }
+    paged.trace(rays, &pool);
+
+    for (const PagedRay& ray : rays) {
+        ASSERT_TRUE(ray.done);
+        HitRecord rec;
+        bool hit = reference->intersect(ray.ray, 0.001, 1e30, rec);
+        ASSERT_EQ(ray.triangle >= 0, hit);
+        if (hit) {
+            EXPECT_EQ(ray.t_max, rec.t);
+            EXPECT_EQ(order[ray.triangle], static_cast<uint32_t>(rec.prim_id));
+        }
+    }
+    EXPECT_LE(paged.resident_bytes(), budget);
+    EXPECT_GT(paged.evictions(), 0u);
+    EXPECT_GT(paged.passes(), 1u);
+    std::remove(path.c_str());
+}
+
+// Test a budget smaller than one cluster still finishes, one cluster at a time
+TEST(PagedMeshTest, TinyBudget) {
+    TriangleMesh terrain = make_terrain(40, 52);
+    std::string path = temp_path("paged_mesh_test");
+    ASSERT_TRUE(write_paged_mesh(path.c_str(), terrain, 256, nullptr));
+
+    PagedMesh paged;
+    ASSERT_TRUE(paged.open(path.c_str(), 1));
+    std::vector<PagedRay> rays;
+    for (int i = 0; i < 50; ++i) rays.push_back(PagedRay(Ray(point3(0.05 + i * 0.07, 1.0, -0.1 - i * 0.07), vec3(0.3, -1.0, -0.2)), 0.001, 1e30));
+    paged.trace(rays, nullptr);
+    for (const PagedRay& ray : rays) {
+        EXPECT_TRUE(ray.done);
+        EXPECT_GE(ray.triangle, 0);
+    }
+    EXPECT_EQ(paged.resident_clusters(), 1u);
+
+    // A corrupt header is rejected
+    FILE* f = fopen(path.c_str(), "r+b");
+    fputc('X', f);
+    fclose(f);
+    PagedMesh corrupt;
+    EXPECT_FALSE(corrupt.open(path.c_str(), 1 << 20));
+    std::remove(path.c_str());
+}
+
+// Test the wavefront integrator renders paged geometry under a tight budget
+// as if the mesh were an ordinary instance of the scene
+TEST(PagedMeshTest, WavefrontMatchesInMemoryInstance) {
+    TriangleMesh terrain = make_terrain(40, 7);
+    std::string path = temp_path("paged_mesh_test");
+    ASSERT_TRUE(write_paged_mesh(path.c_str(), terrain, 64, nullptr));
+    PagedMesh paged;
+    ASSERT_TRUE(paged.open(path.c_str(), 0));
+    size_t budget = 4 * paged.cluster_bytes(0);
+    paged.set_budget(budget);
+
+    Transform placement = Transform::translate(vec3(-2.0, -0.45, -0.3)) * Transform::rotate_y(0.3);
+    Scene reference, scene;
+    add_default_scene(reference);
+    add_default_scene(scene);
+    reference.add_instance(reference.add_mesh(std::move(terrain)), placement, 1);
+    reference.build_sah(nullptr);
+    scene.build_sah(nullptr);
+
+    Camera camera;
+    camera.update_dimensions(80.0, 45.0);
+    RenderTile region = make_tile(0, 0, 80, 45);
+    std::vector<color> expected(80 * 45), without(80 * 45), actual(80 * 45);
+    ThreadPool pool(4);
+
+    WavefrontIntegrator wavefront;
+    wavefront.render(*reference.acquire(), camera, region, 1, 0.0, 0.0, expected.data(), &pool);
+    wavefront.render(*scene.acquire(), camera, region, 1, 0.0, 0.0, without.data(), &pool);
+    wavefront.set_paged_geometry(&paged, placement, 1);
+    wavefront.render(*scene.acquire(), camera, region, 1, 0.0, 0.0, actual.data(), &pool);
+
+    size_t covered = 0, matching = 0;
+    for (size_t i = 0; i < actual.size(); ++i) {
+        covered += (expected[i] - without[i]).length() > 1e-6;
+        matching += (expected[i] - actual[i]).length() < 1e-9;
+    }
+    EXPECT_GT(covered, actual.size() / 10);
+    // Ties on shared edges may pick the other triangle of a quad
+    EXPECT_GE(matching, actual.size() * 99 / 100);
+    EXPECT_LE(paged.resident_bytes(), budget);
+    EXPECT_GT(paged.evictions(), 0u);
+    std::remove(path.c_str());
+}
+
+// Test converting a mesh file gives the clusters of the parsed mesh
+TEST(PagedMeshTest, ConvertsMeshFile) {
+    std::string source = temp_path("paged_source") + ".obj";
+    FILE* f = fopen(source.c_str(), "wb");
+    ASSERT_NE(f, nullptr);
+    fputs("v 0 0 0\nv 1 0 0\nv 1 1 0\nv 0 1 0\nv 0 0 -3\nv 1 0 -3\nf 1 2 3 4\nf 1 5 6\n", f);
+    fclose(f);
+
+    std::string path = source + ".paged";
+    EXPECT_FALSE(page_mesh_file((source + ".missing").c_str(), path.c_str(), 2, nullptr));
+    ASSERT_TRUE(page_mesh_file(source.c_str(), path.c_str(), 2, nullptr));
+    PagedMesh paged;
+    ASSERT_TRUE(paged.open(path.c_str(), 0));
+    EXPECT_EQ(paged.cluster_count(), 2u);
+    EXPECT_EQ(paged.bounds().min.z(), -3.0);
+    EXPECT_EQ(paged.bounds().max.y(), 1.0);
+    std::remove(path.c_str());
+    std::remove(source.c_str());
+}
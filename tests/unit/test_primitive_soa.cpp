@@ -0,0 +1,112 @@
+#include <gtest/gtest.h>
+#include "../../include/geometry/primitive_soa.hpp"
+#include "../../include/geometry/instance.hpp"
+#include "test_helpers.hpp"
+#include <random>
+#include <numeric>
+#include <limits>
+
+// Test the candidate mask never misses a double-precision hit, for every
+// run length and alignment
+TEST(PrimitiveSoATest, TriangleCandidatesCoverScalarHits) {
+    TriangleMesh mesh = make_random_mesh(64, 1.0, 31, 0.5);
+    std::vector<uint32_t> order(mesh.triangle_count());
+    std::iota(order.begin(), order.end(), 0u);
+    TriangleSoA tris;
+    tris.build(mesh, order);
+    ASSERT_EQ(tris.count, mesh.triangle_count());
+
+    std::mt19937 rng(5);
+    std::uniform_real_distribution<double> unit(-1.0, 1.0);
+    int total_hits = 0, total_candidates = 0;
+    for (int r = 0; r < 400; ++r) {
+        Ray ray(point3(unit(rng) * 3.0, unit(rng) * 3.0, 4.0), vec3(unit(rng) * 0.5, unit(rng) * 0.5, -1.0));
+        double t_max = r % 2 == 0 ? std::numeric_limits<double>::infinity() : 4.0;
+        uint32_t first = static_cast<uint32_t>(r % 40);
+        uint32_t count = 1 + static_cast<uint32_t>(r % 24);
+
+        uint32_t mask = triangle_candidates_soa(tris, first, count, RayF(ray), 0.001, t_max);
+        EXPECT_EQ(mask >> count, 0u);
+        for (uint32_t i = 0; i < count; ++i) {
+            double t, u, v;
+            if (mesh.intersect_triangle(first + i, ray, 0.001, t_max, t, u, v)) {
+                EXPECT_TRUE((mask >> i) & 1);
+                total_hits++;
+            }
+        }
+        total_candidates += __builtin_popcount(mask);
+    }
+    // Tolerance only admits a few near misses
+    EXPECT_GT(total_hits, 0);
+    EXPECT_LE(total_candidates, total_hits + total_hits / 10 + 2);
+}
+
+// Test the sphere kernel against the analytic closest hit, from outside and inside
+TEST(PrimitiveSoATest, SpheresMatchScalar) {
+    std::mt19937 rng(6);
+    std::uniform_real_distribution<double> unit(-1.0, 1.0);
+    SphereSoA spheres;
+    std::vector<point3> centers;
+    std::vector<double> radii;
+    for (int i = 0; i < 21; ++i) {
+        centers.push_back(point3(unit(rng) * 4.0, unit(rng) * 4.0, unit(rng) * 4.0));
+        radii.push_back(0.3 + 0.7 * std::abs(unit(rng)));
+        spheres.add(centers.back(), radii.back());
+    }
+
+    for (int r = 0; r < 300; ++r) {
+        Ray ray(point3(unit(rng) * 4.0, unit(rng) * 4.0, unit(rng) * 4.0), vec3(unit(rng), unit(rng), unit(rng)));
+        if (r % 10 == 0) ray = Ray(centers[r % centers.size()], ray.direction());
+
+        int expected = -1;
+        double expected_t = 1e30;
+        for (size_t s = 0; s < centers.size(); ++s) {
+            vec3 oc = ray.origin() - centers[s];
+            double a = ray.direction().length_squared();
+            double half_b = dot(oc, ray.direction());
+            double disc = half_b * half_b - a * (oc.length_squared() - radii[s] * radii[s]);
+            if (disc < 0.0) continue;
+            double t = (-half_b - std::sqrt(disc)) / a;
+            if (t <= 0.001) t = (-half_b + std::sqrt(disc)) / a;
+            if (t > 0.001 && t < expected_t) {
+                expected_t = t;
+                expected = static_cast<int>(s);
+            }
+        }
+
+        float t_max = 1e30f;
+        int hit = intersect_spheres_soa(spheres, 0, static_cast<uint32_t>(spheres.count), RayF(ray), 0.001f, t_max);
+        EXPECT_EQ(hit, expected);
+        if (hit >= 0) {
+            EXPECT_NEAR(t_max, expected_t, 1e-4 * (1.0 + expected_t));
+        }
+    }
+}
+
+// Test SIMD leaf runs give the same hits as per-primitive scalar tests
+TEST(PrimitiveSoATest, BLASMatchesScalarTraversal) {
+    auto mesh = std::make_shared<TriangleMesh>(make_random_mesh(4000, 5.0, 32, 0.5));
+    std::shared_ptr<const BLAS> blas = build_blas(mesh, nullptr, true);
+    ASSERT_EQ(blas->triangles.count, mesh->triangle_count());
+
+    std::mt19937 rng(8);
+    std::uniform_real_distribution<double> unit(-1.0, 1.0);
+    for (int r = 0; r < 500; ++r) {
+        Ray ray(point3(unit(rng) * 8.0, unit(rng) * 8.0, unit(rng) * 8.0), vec3(unit(rng), unit(rng), unit(rng)));
+        double t_max = r % 3 == 0 ? 3.0 : 1e30;
+
+        double expected = t_max;
+        bool scalar_hit = blas->wide.traverse(ray, 0.001, expected, [&](uint32_t tri, double& closest) {
+            double t, u, v;
+            if (mesh->intersect_triangle(tri, ray, 0.001, closest, t, u, v)) { closest = t; return true; }
+            return false;
+        });
+
+        HitRecord rec;
+        ASSERT_EQ(blas->intersect(ray, 0.001, t_max, rec), scalar_hit);
+        if (scalar_hit) {
+            EXPECT_DOUBLE_EQ(rec.t, expected);
+        }
+        EXPECT_EQ(blas->occluded(ray, 0.001, t_max), scalar_hit);
+    }
+}
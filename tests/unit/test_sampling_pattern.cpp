@@ -0,0 +1,78 @@
+#include <gtest/gtest.h>
+#include "../../include/rendering/sampling_pattern.hpp"
+#include "test_helpers.hpp"
+#include <vector>
+
+// Test two checkerboard frames trace every pixel once, and reconstruction
+// keeps history that fits the neighbours but clamps history that does not
+TEST(SamplingPatternTest, Checkerboard) {
+    const int width = 16, height = 10;
+    SamplingPattern even, odd;
+    even.mode = odd.mode = SAMPLING_CHECKERBOARD;
+    odd.parity = 1;
+    EXPECT_EQ(even.traced_count(width, height), static_cast<size_t>(width * height / 2));
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) EXPECT_NE(even.traces(x, y), odd.traces(x, y));
+    }
+
+    // A horizontal ramp traced on the even pixels; odd pixels hold last frame's values
+    std::vector<double> image(3 * width * height);
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            double value = even.traces(x, y) ? 0.1 * x : 0.1 * x + 0.05;
+            if (x == 7 && y == 4) value = 5.0; // Stale history from before a camera move
+            for (int c = 0; c < 3; ++c) image[3 * (y * width + x) + c] = value;
+        }
+    }
+    reconstruct_tile(even, make_tile(0, 0, width, height), image.data(), 3, width, height);
+    EXPECT_NEAR(image[3 * (3 * width + 8)], 0.85, 1e-12); // Within its neighbours' range
+    EXPECT_NEAR(image[3 * (4 * width + 7)], 0.8, 1e-12);  // Clamped to the right neighbour
+    EXPECT_NEAR(image[3 * (4 * width + 4)], 0.4, 1e-12);  // Traced pixels are untouched
+}
+
+// Test foveated strides fall off with distance, cost well under half of the
+// frame at 4K, and reconstruction fills every block from its traced corner
+TEST(SamplingPatternTest, Foveated) {
+    SamplingPattern pattern;
+    pattern.mode = SAMPLING_FOVEATED;
+    pattern.focus_x = 1920.0;
+    pattern.focus_y = 1080.0;
+    pattern.fovea_radius = 360.0;
+    EXPECT_EQ(pattern.stride(1920, 1080), 1);
+    EXPECT_EQ(pattern.stride(1920 + 500, 1080), 2);
+    EXPECT_EQ(pattern.stride(1920 + 900, 1080), 4);
+    EXPECT_EQ(pattern.stride(0, 0), FOVEATED_CELL);
+    EXPECT_LT(pattern.traced_count(3840, 2160), static_cast<size_t>(3840 * 2160 / 5));
+
+    // Every pixel of a cell shares its stride
+    for (int y = 0; y < 2160; y += 37) {
+        for (int x = 0; x < 3840; x += 41) {
+            EXPECT_EQ(pattern.stride(x, y), pattern.stride(x - x % FOVEATED_CELL, y - y % FOVEATED_CELL));
+        }
+    }
+
+    const int width = 96, height = 64;
+    pattern.focus_x = 10.0;
+    pattern.focus_y = 10.0;
+    pattern.fovea_radius = 16.0;
+    std::vector<double> image(4 * width * height, -1.0); // Padded pixels, like Image's
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            if (pattern.traces(x, y)) image[4 * (y * width + x)] = y * width + x;
+        }
+    }
+    RenderTile right_half = make_tile(0, 0, width, height);
+    right_half.start_x = width / 2;
+    reconstruct_tile(pattern, right_half, image.data(), 4, width, height);
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            int step = pattern.stride(x, y);
+            double expected = (y - y % step) * width + (x - x % step);
+            if (x >= width / 2 || pattern.traces(x, y)) {
+                EXPECT_EQ(image[4 * (y * width + x)], expected);
+            } else {
+                EXPECT_EQ(image[4 * (y * width + x)], -1.0); // Outside the tile
+            }
+        }
+    }
+}
@@ -0,0 +1,233 @@
+#include <gtest/gtest.h>
+#include "../../include/geometry/scene_cache.hpp"
+#include "../../include/geometry/scene.hpp"
+#include "../../include/rendering/denoiser.hpp"
+#include "test_helpers.hpp"
+#include <cstring>
+#include <cstdio>
+#include <string>
+#include <random>
+
+// Temporary file path that is removed, with its cache, at scope exit
+struct TempPath {
+    std::string path;
+    explicit TempPath(const char* suffix) {
+        std::string name = temp_path("scene_cache_test");
+        std::remove(name.c_str());
+        path = name + suffix;
+    }
+    ~TempPath() {
+        std::remove(path.c_str());
+        std::remove((path + ".rtcache").c_str());
+    }
+};
+
+// Test the hash depends on content and size but not on the thread count
+TEST(SceneCacheTest, ContentHash) {
+    std::vector<char> data(3 * 1024 * 1024 + 17);
+    std::mt19937 rng(9);
+    for (char& c : data) c = static_cast<char>(rng());
+
+    ThreadPool pool(4);
+    uint64_t serial = content_hash(data.data(), data.size(), nullptr);
+    EXPECT_EQ(content_hash(data.data(), data.size(), &pool), serial);
+    EXPECT_NE(content_hash(data.data(), data.size() - 1, nullptr), serial);
+    data[2 * 1024 * 1024] ^= 1;
+    EXPECT_NE(content_hash(data.data(), data.size(), &pool), serial);
+}
+
+// Test a cached BLAS round-trips exactly and rejects other content
+TEST(SceneCacheTest, RoundTrip) {
+    TriangleMesh sphere;
+    sphere.add_sphere(point3(0.2, -0.1, 0.3), 1.0, 32, 16);
+    for (uint32_t v = 0; v < sphere.vertex_count(); ++v) sphere.set_uv(v, v * 0.01, 1.0 - v * 0.02);
+    std::shared_ptr<const BLAS> built = build_blas(std::make_shared<const TriangleMesh>(sphere), nullptr, true);
+
+    TempPath file(".rtcache");
+    ASSERT_TRUE(write_scene_cache(file.path.c_str(), *built, 1234));
+    EXPECT_EQ(read_scene_cache(file.path.c_str(), 1235), nullptr);
+
+    std::shared_ptr<const BLAS> cached = read_scene_cache(file.path.c_str(), 1234);
+    ASSERT_NE(cached, nullptr);
+    EXPECT_EQ(cached->mesh->positions, built->mesh->positions);
+    EXPECT_EQ(cached->mesh->indices, built->mesh->indices);
+    EXPECT_EQ(cached->mesh->uvs, built->mesh->uvs);
+    EXPECT_EQ(cached->wide.prim_indices, built->wide.prim_indices);
+    ASSERT_EQ(cached->wide.nodes.size(), built->wide.nodes.size());
+    EXPECT_EQ(std::memcmp(cached->wide.nodes.data(), built->wide.nodes.data(), built->wide.nodes.size() * sizeof(BVH8Node)), 0);
+    // SoA leaves come from the file rather than being rebuilt
+    EXPECT_EQ(cached->triangles.count, built->triangles.count);
+    EXPECT_EQ(cached->triangles.v0x, built->triangles.v0x);
+    EXPECT_EQ(cached->triangles.e1y, built->triangles.e1y);
+    EXPECT_EQ(cached->triangles.e2z, built->triangles.e2z);
+    for (int a = 0; a < 3; ++a) {
+        EXPECT_EQ(cached->bounds().min[a], built->bounds().min[a]);
+        EXPECT_EQ(cached->bounds().max[a], built->bounds().max[a]);
+    }
+
+    HitRecord expected, actual;
+    Ray ray(point3(0, 0, 5), vec3(0.05, -0.02, -1));
+    ASSERT_TRUE(built->intersect(ray, 0.001, 100.0, expected));
+    ASSERT_TRUE(cached->intersect(ray, 0.001, 100.0, actual));
+    EXPECT_EQ(actual.t, expected.t);
+    EXPECT_EQ(actual.prim_id, expected.prim_id);
+
+    // Truncation and a bumped version are both stale
+    ASSERT_EQ(truncate(file.path.c_str(), 200), 0);
+    EXPECT_EQ(read_scene_cache(file.path.c_str(), 1234), nullptr);
+    ASSERT_TRUE(write_scene_cache(file.path.c_str(), *built, 1234));
+    FILE* f = fopen(file.path.c_str(), "r+b");
+    uint32_t version = SCENE_CACHE_VERSION + 1;
+    fseek(f, offsetof(SceneCacheHeader, version), SEEK_SET);
+    fwrite(&version, sizeof(version), 1, f);
+    fclose(f);
+    EXPECT_EQ(read_scene_cache(file.path.c_str(), 1234), nullptr);
+}
+
+// Test the first load writes the cache, the next reads it, and edits invalidate it
+TEST(SceneCacheTest, LoadThroughCache) {
+    TempPath file(".obj");
+    auto write_obj = [&](const char* text) {
+        FILE* f = fopen(file.path.c_str(), "wb");
+        fputs(text, f);
+        fclose(f);
+    };
+    write_obj("v 0 0 0\nv 1 0 0\nv 1 1 0\nv 0 1 0\nf 1 2 3 4\n");
+
+    ThreadPool pool(2);
+    bool hit = true;
+    std::shared_ptr<const BLAS> first = load_mesh_cached(file.path.c_str(), &pool, &hit);
+    ASSERT_NE(first, nullptr);
+    EXPECT_FALSE(hit);
+    std::shared_ptr<const BLAS> second = load_mesh_cached(file.path.c_str(), &pool, &hit);
+    ASSERT_NE(second, nullptr);
+    EXPECT_TRUE(hit);
+    EXPECT_EQ(second->mesh->triangle_count(), 2u);
+
+    write_obj("v 0 0 0\nv 1 0 0\nv 1 1 0\nf 1 2 3\n");
+    std::shared_ptr<const BLAS> edited = load_mesh_cached(file.path.c_str(), &pool, &hit);
+    ASSERT_NE(edited, nullptr);
+    EXPECT_FALSE(hit);
+    EXPECT_EQ(edited->mesh->triangle_count(), 1u);
+
+    // Prebuilt bottom levels survive scene builds untouched
+    Scene scene;
+    int mesh_id = scene.add_built_mesh(second);
+    scene.add_instance(mesh_id, Transform::translate(vec3(0, 0, -2)));
+    scene.build_lbvh(&pool);
+    EXPECT_EQ(scene.acquire()->blas[mesh_id], second);
+    HitRecord rec;
+    EXPECT_TRUE(scene.acquire()->intersect(Ray(point3(0.5, 0.5, 0), vec3(0, 0, -1)), 0.001, 10.0, rec));
+}
+
+// Flat grid of size x size quads over [-50, 50] in x and z, as OBJ text
+static void write_grid_obj(const std::string& path, int size) {
+    FILE* f = fopen(path.c_str(), "wb");
+    for (int z = 0; z <= size; ++z) {
+        for (int x = 0; x <= size; ++x) fprintf(f, "v %g 0 %g\n", -50.0 + 100.0 * x / size, -50.0 + 100.0 * z / size);
+    }
+    for (int z = 0; z < size; ++z) {
+        for (int x = 0; x < size; ++x) {
+            int a = z * (size + 1) + x + 1;
+            fprintf(f, "f %d %d %d %d\n", a, a + size + 1, a + size + 2, a + 1);
+        }
+    }
+    fclose(f);
+}
+
+static bool file_exists(const std::string& path) {
+    FILE* f = fopen(path.c_str(), "rb");
+    if (f != nullptr) fclose(f);
+    return f != nullptr;
+}
+
+// Test a large mesh without a cache is loaded as the renderer does: it starts
+// lazy, the first frame builds only the subtrees it sees, and the cache is
+// written from the later SAH build
+TEST(SceneCacheTest, MissStartsLazyAndCachesSah) {
+    TempPath file(".obj");
+    write_grid_obj(file.path, 160);
+    ThreadPool pool(4);
+
+    CachedMesh loaded;
+    ASSERT_TRUE(open_mesh_cached(file.path.c_str(), SIZE_MAX, &pool, loaded));
+    EXPECT_FALSE(loaded.cache_hit);
+    ASSERT_TRUE(loaded.mesh);
+    EXPECT_FALSE(loaded.built);
+    EXPECT_EQ(loaded.triangle_count, 2u * 160 * 160);
+    EXPECT_FALSE(file_exists(loaded.cache_path));
+
+    Scene scene;
+    int mesh_id = add_cached_mesh(scene, loaded);
+    scene.add_instance(mesh_id, Transform::translate(vec3(0.0, -0.5, 0.0)));
+    ASSERT_TRUE(scene.build_quick(&pool, 20000));
+
+    // One frame of primary rays; the half of the grid behind the camera stays unbuilt
+    std::shared_ptr<const SceneAccel> first = scene.acquire();
+    const LazyBVH* lazy = first->blas[mesh_id]->lazy.get();
+    ASSERT_NE(lazy, nullptr);
+    Camera camera;
+    camera.update_dimensions(64.0, 36.0);
+    GuideBuffers guides;
+    render_guides(*first, camera, guides, &pool);
+    EXPECT_GT(lazy->subtrees_built(), 0u);
+    EXPECT_LT(lazy->subtrees_built(), lazy->subtree_total());
+
+    scene.build_sah(&pool);
+    std::shared_ptr<const BLAS> sah = scene.acquire()->blas[mesh_id];
+    ASSERT_FALSE(sah->wide.empty());
+    ASSERT_TRUE(store_mesh_cache(loaded, *sah));
+
+    CachedMesh reopened;
+    ASSERT_TRUE(open_mesh_cached(file.path.c_str(), SIZE_MAX, &pool, reopened));
+    EXPECT_TRUE(reopened.cache_hit);
+    ASSERT_TRUE(reopened.built);
+    EXPECT_EQ(reopened.built->wide.prim_indices, sah->wide.prim_indices);
+    EXPECT_EQ(reopened.triangle_count, loaded.triangle_count);
+}
+
+// Test a mesh over the compression threshold is compressed before any BVH
+// is built, and its cache holds the meshlets rather than the mesh
+TEST(SceneCacheTest, CompressedMeshesCacheMeshlets) {
+    TempPath file(".obj");
+    write_grid_obj(file.path, 40);
+    ThreadPool pool(2);
+
+    CachedMesh loaded;
+    ASSERT_TRUE(open_mesh_cached(file.path.c_str(), 1000, &pool, loaded));
+    ASSERT_TRUE(loaded.meshlets);
+    EXPECT_FALSE(loaded.mesh);
+    EXPECT_EQ(loaded.meshlets->triangle_count(), 2u * 40 * 40);
+
+    Scene scene;
+    int mesh_id = add_cached_mesh(scene, loaded);
+    scene.add_instance(mesh_id, Transform());
+    EXPECT_FALSE(scene.build_quick(&pool, SIZE_MAX));
+    EXPECT_EQ(scene.unique_triangle_count(), loaded.triangle_count);
+    Ray ray(point3(3.3, 2.0, -7.1), vec3(0.1, -1.0, 0.05));
+    HitRecord quick;
+    ASSERT_TRUE(scene.acquire()->intersect(ray, 0.001, 100.0, quick));
+
+    scene.build_sah(&pool);
+    std::shared_ptr<const BLAS> sah = scene.acquire()->blas[mesh_id];
+    EXPECT_EQ(sah->meshlets, loaded.meshlets);
+    ASSERT_TRUE(store_mesh_cache(loaded, *sah));
+
+    CachedMesh reopened;
+    ASSERT_TRUE(open_mesh_cached(file.path.c_str(), 1000, &pool, reopened));
+    ASSERT_TRUE(reopened.cache_hit);
+    ASSERT_TRUE(reopened.built->meshlets);
+    EXPECT_FALSE(reopened.built->mesh);
+    EXPECT_EQ(reopened.built->meshlets->quantized, loaded.meshlets->quantized);
+    EXPECT_EQ(reopened.built->meshlets->local_indices, loaded.meshlets->local_indices);
+    EXPECT_EQ(reopened.built->meshlets->step, loaded.meshlets->step);
+
+    Scene cached_scene;
+    cached_scene.add_instance(add_cached_mesh(cached_scene, reopened), Transform());
+    cached_scene.build_quick(&pool, SIZE_MAX);
+    EXPECT_EQ(cached_scene.acquire()->blas[0], reopened.built);
+    HitRecord cached;
+    ASSERT_TRUE(cached_scene.acquire()->intersect(ray, 0.001, 100.0, cached));
+    EXPECT_EQ(cached.t, quick.t);
+    EXPECT_EQ(cached.prim_id, quick.prim_id);
+}
@@ -0,0 +1,119 @@
+#include <gtest/gtest.h>
+#include "../../include/rendering/temporal.hpp"
+#include "../../include/rendering/path_tracer.hpp"
+#include "test_helpers.hpp"
+#include <cmath>
+
+// Albedo planes as an interleaved image, so history has a known colour per surface
+static std::vector<double> albedo_image(const GuideBuffers& guides) {
+    std::vector<double> image(3 * guides.depth.size());
+    for (size_t i = 0; i < guides.depth.size(); ++i) {
+        for (int c = 0; c < 3; ++c) image[3 * i + c] = guides.albedo[c][i];
+    }
+    return image;
+}
+
+// Test an unmoved camera gets its history back exactly, blended by weight
+TEST(TemporalTest, StaticCameraKeepsHistory) {
+    Scene scene;
+    std::shared_ptr<const SceneAccel> accel = default_accel(scene);
+    Camera camera;
+    camera.update_dimensions(64.0, 36.0);
+    GuideBuffers guides;
+    render_guides(*accel, camera, guides, nullptr);
+
+    TemporalReprojector temporal;
+    EXPECT_FALSE(temporal.has_history());
+    std::vector<double> history = albedo_image(guides);
+    temporal.store(history.data(), 3, guides, camera, nullptr);
+    ASSERT_TRUE(temporal.has_history());
+    EXPECT_EQ(temporal.reproject(camera, guides, nullptr), guides.depth.size());
+
+    std::vector<double> current(history.size(), 1.0);
+    temporal.resolve(current.data(), 3, 0.25, nullptr);
+    for (size_t i = 0; i < current.size(); ++i) EXPECT_NEAR(current[i], 0.75 * history[i] + 0.25, 1e-6);
+
+    temporal.clear_history();
+    EXPECT_EQ(temporal.reproject(camera, guides, nullptr), 0u);
+}
+
+// Test a sideways move: most pixels find the surface they saw before, and
+// surfaces the old view did not show are rejected
+TEST(TemporalTest, MovedCameraRejectsDisocclusions) {
+    Scene scene;
+    std::shared_ptr<const SceneAccel> accel = default_accel(scene);
+    Camera before;
+    before.update_dimensions(160.0, 90.0);
+    Camera after = before;
+    after.moveright(0.15);
+    after.moveforward(0.1);
+    ThreadPool pool(4);
+
+    GuideBuffers old_guides, new_guides;
+    render_guides(*accel, before, old_guides, &pool);
+    render_guides(*accel, after, new_guides, &pool);
+    std::vector<double> history = albedo_image(old_guides);
+    TemporalReprojector temporal;
+    temporal.store(history.data(), 3, old_guides, before, &pool);
+    size_t reused = temporal.reproject(after, new_guides, &pool);
+    size_t pixels = new_guides.depth.size();
+    EXPECT_GT(reused, pixels * 9 / 10);
+    EXPECT_LT(reused, pixels);
+
+    // Reused pixels show the albedo of the surface now seen there
+    std::vector<double> current(history.size(), -1.0);
+    temporal.resolve(current.data(), 3, 0.0, &pool);
+    std::vector<double> truth = albedo_image(new_guides);
+    size_t matching = 0, rejected_geometry = 0;
+    for (int y = 0; y < new_guides.height; ++y) {
+        for (int x = 0; x < new_guides.width; ++x) {
+            size_t i = static_cast<size_t>(y) * new_guides.width + x;
+            if (!temporal.is_valid(x, y)) {
+                EXPECT_EQ(current[3 * i], -1.0);
+                rejected_geometry += new_guides.depth[i] != BACKGROUND_DEPTH;
+                continue;
+            }
+            matching += std::fabs(current[3 * i + 1] - truth[3 * i + 1]) < 0.02;
+        }
+    }
+    EXPECT_GT(matching, reused * 97 / 100);
+    EXPECT_GT(rejected_geometry, 0u); // Ground entering at the image edge and beside the spheres
+}
+
+// Test splatting the history depth forward stands in for the new view's
+// guides: nearly as many pixels are reused, and they show the right surface
+TEST(TemporalTest, SplattedDepthMatchesGuides) {
+    Scene scene;
+    std::shared_ptr<const SceneAccel> accel = default_accel(scene);
+    Camera before;
+    before.update_dimensions(160.0, 90.0);
+    Camera after = before;
+    after.moveright(0.15);
+    after.moveforward(0.1);
+    ThreadPool pool(4);
+
+    GuideBuffers old_guides, new_guides;
+    render_guides(*accel, before, old_guides, &pool);
+    render_guides(*accel, after, new_guides, &pool);
+    std::vector<double> history = albedo_image(old_guides);
+    TemporalReprojector temporal;
+    temporal.store(history.data(), 3, old_guides, before, &pool);
+    size_t guided = temporal.reproject(after, new_guides, &pool);
+    size_t splatted = temporal.reproject_splatted(after, &pool);
+    EXPECT_GT(splatted, guided * 95 / 100);
+    EXPECT_LE(splatted, new_guides.depth.size());
+
+    std::vector<double> current(history.size(), -1.0);
+    temporal.resolve(current.data(), 3, 0.0, &pool);
+    std::vector<double> truth = albedo_image(new_guides);
+    size_t matching = 0;
+    for (size_t i = 0; i < new_guides.depth.size(); ++i) {
+        if (current[3 * i] >= 0.0) matching += std::fabs(current[3 * i + 1] - truth[3 * i + 1]) < 0.02;
+    }
+    EXPECT_GT(matching, splatted * 97 / 100);
+
+    // Serial splatting keeps the same surfaces
+    TemporalReprojector serial;
+    serial.store(history.data(), 3, old_guides, before, nullptr);
+    EXPECT_EQ(serial.reproject_splatted(after, nullptr), splatted);
+}
@@ -0,0 +1,218 @@
+#include <gtest/gtest.h>
+#include "../../include/rendering/texture_cache.hpp"
+#include "../../include/core/thread_pool.hpp"
+#include "../../include/rendering/integrator.hpp"
+#include "test_helpers.hpp"
+#include <random>
+#include <string>
+#include <vector>
+#include <cmath>
+#include <cstdio>
+
+// Smooth colour ramps, so bilinear results can be predicted from the source
+static std::vector<float> make_image(int width, int height) {
+    std::vector<float> rgb(3 * static_cast<size_t>(width) * height);
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            float* p = &rgb[3 * (static_cast<size_t>(y) * width + x)];
+            p[0] = static_cast<float>(x) / width;
+            p[1] = static_cast<float>(y) / height;
+            p[2] = 0.25f + 0.5f * static_cast<float>((x / 8 + y / 8) & 1);
+        }
+    }
+    return rgb;
+}
+
+// Test texel centres and bilinear lookups across tile borders and the wrap
+TEST(TextureCacheTest, SamplesMatchSource) {
+    const int width = 200, height = 130;
+    std::vector<float> rgb = make_image(width, height);
+    std::string path = temp_path("texture_cache_test");
+    ASSERT_TRUE(write_tiled_texture(path.c_str(), width, height, rgb.data()));
+
+    TextureCache cache(1 << 20);
+    int texture = cache.open(path.c_str());
+    ASSERT_EQ(texture, 0);
+    EXPECT_EQ(cache.width(texture), width);
+    EXPECT_EQ(cache.height(texture), height);
+    EXPECT_EQ(cache.level_count(texture), 8); // 200, 100, 50, 25, 12, 6, 3, 1
+
+    // 8-bit sRGB keeps bright values to within about 1%
+    auto source = [&](int x, int y, int c) {
+        x = (x % width + width) % width;
+        y = (y % height + height) % height;
+        return rgb[3 * (static_cast<size_t>(y) * width + x) + c];
+    };
+    for (int y : {0, 5, 63, 64, 65, 127, 129}) {
+        for (int x : {0, 1, 63, 64, 127, 128, 199}) {
+            color c = cache.sample_level(texture, (x + 0.5) / width, (y + 0.5) / height, 0);
+            for (int k = 0; k < 3; ++k) EXPECT_NEAR(c[k], source(x, y, k), 0.01 + 0.01 * source(x, y, k));
+        }
+    }
+
+    // Halfway between columns 63 and 64 (two tiles), and between the last column and the first
+    for (int x : {63, 199}) {
+        color c = cache.sample_level(texture, (x + 1.0) / width, 10.5 / height, 0);
+        EXPECT_NEAR(c[0], 0.5 * (source(x, 10, 0) + source(x + 1, 10, 0)), 0.01);
+    }
+
+    // The 1x1 level is close to the image average (odd sizes fold unevenly);
+    // blue alternates between 0.25 and 0.75
+    color average = cache.sample_level(texture, 0.3, 0.7, cache.level_count(texture) - 1);
+    EXPECT_NEAR(average[0], 0.5, 0.03);
+    EXPECT_NEAR(average[1], 0.5, 0.03);
+    EXPECT_NEAR(average[2], 0.5, 0.03);
+
+    // Trilinear lookups blend neighbouring levels
+    color fine = cache.sample(texture, 0.4, 0.4, 2.0);
+    color coarse = cache.sample(texture, 0.4, 0.4, 3.0);
+    color blended = cache.sample(texture, 0.4, 0.4, 2.25);
+    for (int k = 0; k < 3; ++k) EXPECT_NEAR(blended[k], 0.75 * fine[k] + 0.25 * coarse[k], 1e-9);
+    std::remove(path.c_str());
+
+    EXPECT_EQ(cache.open(path.c_str()), -1);
+}
+
+// Test residency stays within budget and eviction follows recency
+TEST(TextureCacheTest, EvictsLeastRecentlyUsed) {
+    const int size = 1024;
+    std::vector<float> rgb = make_image(size, size);
+    std::string path = temp_path("texture_cache_test");
+    ASSERT_TRUE(write_tiled_texture(path.c_str(), size, size, rgb.data()));
+
+    TextureCache cache(0);
+    ASSERT_EQ(cache.slot_count(), TextureCache::MIN_SLOTS);
+    int texture = cache.open(path.c_str());
+    ASSERT_GE(texture, 0);
+    const int tiles = size / TEXTURE_TILE; // Per side at level 0
+
+    // One pass over every level-0 tile
+    auto touch = [&](int tile) {
+        int tx = tile % tiles, ty = tile / tiles;
+        cache.sample_level(texture, (tx * TEXTURE_TILE + 10.5) / size, (ty * TEXTURE_TILE + 10.5) / size, 0);
+    };
+    for (int tile = 0; tile < tiles * tiles; ++tile) touch(tile);
+    size_t touched = static_cast<size_t>(tiles * tiles);
+    EXPECT_EQ(cache.misses(), touched);
+    EXPECT_EQ(cache.evictions(), touched - TextureCache::MIN_SLOTS);
+    EXPECT_EQ(cache.resident_tiles(), TextureCache::MIN_SLOTS);
+    EXPECT_LE(cache.resident_bytes(), TextureCache::MIN_SLOTS * TEXTURE_TILE_BYTES);
+
+    // The most recent tiles hit; the one before them was evicted
+    touch(tiles * tiles - 1);
+    touch(tiles * tiles - static_cast<int>(TextureCache::MIN_SLOTS));
+    EXPECT_EQ(cache.misses(), touched);
+    touch(tiles * tiles - static_cast<int>(TextureCache::MIN_SLOTS) - 1);
+    EXPECT_EQ(cache.misses(), touched + 1);
+
+    // The refreshed tile survives the next eviction; the oldest untouched one does not
+    touch(0);
+    touch(tiles * tiles - static_cast<int>(TextureCache::MIN_SLOTS));
+    EXPECT_EQ(cache.misses(), touched + 2);
+    touch(tiles * tiles - static_cast<int>(TextureCache::MIN_SLOTS) + 1);
+    EXPECT_EQ(cache.misses(), touched + 3);
+    std::remove(path.c_str());
+}
+
+// Test concurrent sampling through a thrashing cache returns exact results
+TEST(TextureCacheTest, ConcurrentSampling) {
+    const int size = 512;
+    std::vector<float> rgb = make_image(size, size);
+    std::string path = temp_path("texture_cache_test");
+    ASSERT_TRUE(write_tiled_texture(path.c_str(), size, size, rgb.data()));
+
+    TextureCache reference(64 << 20);
+    TextureCache small(0);
+    ASSERT_EQ(reference.open(path.c_str()), 0);
+    ASSERT_EQ(small.open(path.c_str()), 0);
+    std::remove(path.c_str());
+
+    const size_t count = 20000;
+    std::vector<double> u(count), v(count), lod(count);
+    std::mt19937 rng(17);
+    std::uniform_real_distribution<double> unit(-2.0, 2.0);
+    for (size_t i = 0; i < count; ++i) {
+        u[i] = unit(rng);
+        v[i] = unit(rng);
+        lod[i] = std::fabs(unit(rng)) * 2.0;
+    }
+    std::vector<color> expected(count), actual(count);
+    for (size_t i = 0; i < count; ++i) expected[i] = reference.sample(0, u[i], v[i], lod[i]);
+
+    ThreadPool pool(8);
+    pool.parallel_for(count, [&](size_t i, int) { actual[i] = small.sample(0, u[i], v[i], lod[i]); }, 16);
+    for (size_t i = 0; i < count; ++i) {
+        ASSERT_EQ(actual[i].x(), expected[i].x());
+        ASSERT_EQ(actual[i].y(), expected[i].y());
+        ASSERT_EQ(actual[i].z(), expected[i].z());
+    }
+    EXPECT_GT(small.evictions(), 0u);
+    EXPECT_LE(small.resident_tiles(), small.slot_count());
+}
+
+// Test level selection from ray cones
+TEST(TextureCacheTest, RayConeLevels) {
+    // A unit square mapped to the whole 256x256 texture: 256 texels per unit
+    double spread = 1.0 / 256.0;
+    RayCone cone = RayCone(0.0, spread).at(1.0);
+    EXPECT_NEAR(cone.width, 1.0 / 256.0, 1e-12);
+    EXPECT_NEAR(texture_lod(cone, 1.0, 0.5, 0.5, 256, 256), 0.0, 1e-9);
+    EXPECT_NEAR(texture_lod(RayCone(0.0, spread).at(4.0), 1.0, 0.5, 0.5, 256, 256), 2.0, 1e-9);
+    // Grazing views and smaller texel density both push towards coarser levels
+    EXPECT_NEAR(texture_lod(cone, 0.5, 0.5, 0.5, 256, 256), 1.0, 1e-9);
+    EXPECT_NEAR(texture_lod(cone, 1.0, 0.5, 2.0, 256, 256), -1.0, 1e-9);
+    EXPECT_EQ(texture_lod(RayCone(), 1.0, 0.5, 0.5, 256, 256), 0.0);
+}
+
+// Albedo preview of a camera-facing quad whose texture repeats `repeat` times
+static std::vector<color> render_textured_quad(std::shared_ptr<TextureCache> cache, int texture, double repeat) {
+    TriangleMesh quad;
+    quad.add_quad(point3(-5.0, -3.0, -2.0), vec3(10.0, 0.0, 0.0), vec3(0.0, 6.0, 0.0));
+    quad.set_uv(0, 0.0, 0.0);
+    quad.set_uv(1, repeat, 0.0);
+    quad.set_uv(2, repeat, repeat);
+    quad.set_uv(3, 0.0, repeat);
+    Scene scene;
+    scene.add_instance(scene.add_mesh(std::move(quad)), Transform(), scene.add_material(Material::textured(texture)));
+    scene.set_textures(cache, nullptr);
+    scene.build_sah(nullptr);
+
+    Camera camera;
+    camera.update_dimensions(64.0, 36.0);
+    std::vector<color> image(64 * 36);
+    const IntegratorKernels& kernels = select_integrator(0, PREVIEW_ALBEDO);
+    for (int y = 0; y < 36; ++y) kernels.render_row(*scene.acquire(), camera, y, 0, 64, 0, 0.0, 0.0, 1, &image[y * 64]);
+    return image;
+}
+
+// Test textured materials filter by the camera's ray cone: a minified
+// checkerboard averages out from coarse levels, which are all that gets
+// paged in, and a magnified one keeps its contrast
+TEST(TextureCacheTest, TexturedMaterialFiltersByRayCone) {
+    const int size = 256;
+    std::vector<float> checker(3 * size * size);
+    for (int y = 0; y < size; ++y) {
+        for (int x = 0; x < size; ++x) {
+            for (int c = 0; c < 3; ++c) checker[3 * (y * size + x) + c] = (x + y) & 1 ? 0.8f : 0.2f;
+        }
+    }
+    std::string path = temp_path("texture_cache_test");
+    ASSERT_TRUE(write_tiled_texture(path.c_str(), size, size, checker.data()));
+    std::shared_ptr<TextureCache> cache = std::make_shared<TextureCache>(1 << 20);
+    int texture = cache->open(path.c_str());
+    std::remove(path.c_str());
+    ASSERT_EQ(texture, 0);
+
+    for (const color& albedo : render_textured_quad(cache, texture, 64.0)) {
+        for (int c = 0; c < 3; ++c) EXPECT_NEAR(albedo[c], 0.5, 0.02);
+    }
+    EXPECT_LE(cache->resident_tiles(), 2u); // The finest level alone has 16
+
+    double low = 1.0, high = 0.0;
+    for (const color& albedo : render_textured_quad(cache, texture, 1.0 / 16.0)) {
+        low = std::min(low, albedo.y());
+        high = std::max(high, albedo.y());
+    }
+    EXPECT_LT(low, 0.3);
+    EXPECT_GT(high, 0.7);
+}
@@ -0,0 +1,137 @@
+#include <gtest/gtest.h>
+#include "../../include/core/thread_pool.hpp"
+#include "../../include/core/arena.hpp"
+#include "../../include/rendering/tile_scheduler.hpp"
+#include "../../include/rendering/integrator.hpp"
+#include "../../include/rendering/temporal.hpp"
+#include "alloc_counter.hpp"
+#include "test_helpers.hpp"
+#include <vector>
+#include <atomic>
+
+// Test every index is visited exactly once
+TEST(ThreadPoolTest, ParallelForCoversRange) {
+    ThreadPool pool(4);
+    EXPECT_EQ(pool.size(), 4);
+    
+    std::vector<std::atomic<int>> visits(1000);
+    pool.parallel_for(visits.size(), [&](size_t index, int thread_index) {
+        EXPECT_GE(thread_index, 0);
+        EXPECT_LT(thread_index, 4);
+        visits[index]++;
+    }, 7);
+    
+    for (auto& count : visits) {
+        EXPECT_EQ(count.load(), 1);
+    }
+}
+
+// Test nested calls run inline instead of deadlocking
+TEST(ThreadPoolTest, NestedParallelFor) {
+    ThreadPool pool(4);
+    std::atomic<int> total(0);
+    
+    pool.parallel_for(8, [&](size_t, int) {
+        pool.parallel_for(8, [&](size_t, int) { total++; });
+    });
+    
+    EXPECT_EQ(total.load(), 64);
+}
+
+// Test dispatching jobs does not allocate, unlike std::async futures
+TEST(ThreadPoolTest, SteadyStateZeroAllocations) {
+    ThreadPool pool(4);
+    std::atomic<int> total(0);
+    auto job = [&total](size_t, int) { total++; };
+    
+    pool.parallel_for(64, job); // Warm-up
+    
+    size_t before = allocation_count();
+    for (int i = 0; i < 20; ++i) {
+        pool.parallel_for(64, job);
+    }
+    EXPECT_EQ(allocation_count(), before);
+    EXPECT_EQ(total.load(), 21 * 64);
+}
+
+// Test steady-state time-sliced frames render without heap allocations
+TEST(ThreadPoolTest, SchedulerSteadyStateZeroAllocations) {
+    ThreadPool pool(4);
+    TileScheduler scheduler;
+    std::atomic<int> rows(0);
+    TileScheduler::RowFunction render_row = [&rows](const RenderTile&, int, int) { rows++; };
+    auto forever = TileScheduler::Clock::now() + std::chrono::hours(1);
+    
+    scheduler.reset(256, 128, 32, 2);
+    scheduler.run_until(forever, &pool, render_row); // Warm-up frame
+    
+    size_t before = allocation_count();
+    for (int i = 0; i < 5; ++i) {
+        scheduler.reset(256, 128, 32, 2);
+        scheduler.run_until(forever, &pool, render_row);
+    }
+    EXPECT_EQ(allocation_count(), before);
+    EXPECT_EQ(rows.load(), 6 * 2 * 128 * 8);
+}
+
+// Test warmed-up path-traced frames allocate nothing: row colours come from
+// the per-thread scratch arenas, rewound after each row
+TEST(ThreadPoolTest, RenderFrameSteadyStateZeroAllocations) {
+    Scene scene;
+    std::shared_ptr<const SceneAccel> accel = default_accel(scene);
+    Camera camera;
+    camera.update_dimensions(96.0, 54.0);
+    ThreadPool pool(4);
+    ScratchArenas scratch(pool.size());
+    TileScheduler scheduler;
+    const IntegratorKernels& kernels = select_integrator(FEATURE_RUSSIAN_ROULETTE);
+    std::atomic<int> rows(0);
+    TileScheduler::RowFunction render_row = [&](const RenderTile& tile, int row, int sample) {
+        FrameArena& arena = scratch.local(ThreadPool::current_thread_index());
+        ArenaScope scope(arena);
+        color* out = arena.allocate_array<color>(tile.end_x - tile.start_x);
+        kernels.render_row(*accel, camera, row, tile.start_x, tile.end_x, sample, 0.0, 0.0, 4, out);
+        rows++;
+    };
+    auto forever = TileScheduler::Clock::now() + std::chrono::hours(1);
+
+    scheduler.reset(96, 54, 16, 1);
+    scheduler.run_until(forever, &pool, render_row); // Warm-up frame
+
+    size_t before = allocation_count();
+    for (int i = 0; i < 3; ++i) {
+        scheduler.reset(96, 54, 16, 1);
+        scheduler.run_until(forever, &pool, render_row);
+    }
+    EXPECT_EQ(allocation_count(), before);
+    EXPECT_EQ(rows.load(), 4 * 54 * 6);
+}
+
+// Test the denoiser and temporal reprojection reuse their buffers after the
+// first frame
+TEST(ThreadPoolTest, PostProcessSteadyStateZeroAllocations) {
+    Scene scene;
+    std::shared_ptr<const SceneAccel> accel = default_accel(scene);
+    Camera camera;
+    camera.update_dimensions(64.0, 36.0);
+    Camera moved = camera;
+    moved.moveright(0.1);
+    ThreadPool pool(4);
+    GuideBuffers guides;
+    render_guides(*accel, camera, guides, &pool);
+    std::vector<double> rgb(3 * guides.depth.size(), 0.5);
+    Denoiser denoiser;
+    TemporalReprojector temporal;
+
+    auto frame = [&]() {
+        denoiser.denoise(rgb.data(), 3, 64, 36, guides, &pool);
+        temporal.store(rgb.data(), 3, guides, camera, &pool);
+        temporal.reproject_splatted(moved, &pool);
+        temporal.resolve(rgb.data(), 3, 0.2, &pool);
+    };
+    frame(); // Warm-up
+
+    size_t before = allocation_count();
+    for (int i = 0; i < 3; ++i) frame();
+    EXPECT_EQ(allocation_count(), before);
+}
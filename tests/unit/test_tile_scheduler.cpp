@@ -0,0 +1,146 @@
+#include <gtest/gtest.h>
+#include "../../include/rendering/tile_scheduler.hpp"
+#include <vector>
+#include <mutex>
+#include <cmath>
+
+// Test tile layout covers the whole image
+TEST(TileSchedulerTest, TileLayout) {
+    TileScheduler scheduler;
+    scheduler.reset(100, 70, 32, 1);
+    
+    // 4 columns x 3 rows of tiles, edge tiles clipped to the image
+    EXPECT_EQ(scheduler.get_tiles().size(), 12u);
+    EXPECT_EQ(scheduler.get_tiles().back().end_x, 100);
+    EXPECT_EQ(scheduler.get_tiles().back().end_y, 70);
+    EXPECT_FALSE(scheduler.is_complete());
+    EXPECT_DOUBLE_EQ(scheduler.progress(), 0.0);
+}
+
+// Test that an unlimited budget renders every row of every sample exactly once
+TEST(TileSchedulerTest, RunToCompletion) {
+    TileScheduler scheduler;
+    scheduler.reset(64, 48, 16, 3);
+    
+    std::mutex mutex;
+    std::vector<int> row_counts(48, 0);
+    auto deadline = TileScheduler::Clock::now() + std::chrono::hours(1);
+    
+    ThreadPool pool(4);
+    bool done = scheduler.run_until(deadline, &pool, [&](const RenderTile& tile, int row, int) {
+        std::lock_guard<std::mutex> lock(mutex);
+        row_counts[row] += tile.end_x - tile.start_x;
+    });
+    
+    EXPECT_TRUE(done);
+    EXPECT_TRUE(scheduler.is_complete());
+    EXPECT_DOUBLE_EQ(scheduler.progress(), 1.0);
+    for (int count : row_counts) {
+        EXPECT_EQ(count, 64 * 3);
+    }
+}
+
+// Test that an expired deadline stops early and resumes where it left off
+TEST(TileSchedulerTest, ResumeAfterDeadline) {
+    TileScheduler scheduler;
+    scheduler.reset(32, 32, 16, 2);
+    
+    int rows_rendered = 0;
+    auto counting_row = [&](const RenderTile&, int, int) { rows_rendered++; };
+    
+    // Deadline already passed: only one row of the first claimed tile is rendered
+    bool done = scheduler.run_until(TileScheduler::Clock::now(), nullptr, counting_row);
+    EXPECT_FALSE(done);
+    EXPECT_EQ(rows_rendered, 1);
+    EXPECT_EQ(scheduler.get_tile_progress(0).next_row, 1);
+    
+    // Finish the rest - total work is 2 samples x 32 rows x 2 tile columns
+    done = scheduler.run_until(TileScheduler::Clock::now() + std::chrono::hours(1), nullptr, counting_row);
+    EXPECT_TRUE(done);
+    EXPECT_EQ(rows_rendered, 2 * 32 * 2);
+}
+
+// Test that passes are sample-major
+TEST(TileSchedulerTest, SampleMajorOrder) {
+    TileScheduler scheduler;
+    scheduler.reset(32, 32, 16, 2);
+    
+    int last_sample = 0;
+    bool ordered = true;
+    scheduler.run_until(TileScheduler::Clock::now() + std::chrono::hours(1), nullptr,
+        [&](const RenderTile&, int, int sample) {
+            if (sample < last_sample) ordered = false;
+            last_sample = sample;
+        });
+    
+    EXPECT_TRUE(ordered);
+    EXPECT_EQ(scheduler.get_current_pass(), 2);
+}
+
+// Test the running variance helpers against a direct computation
+TEST(TileSchedulerTest, PixelError) {
+    double mean = 0.0, m2 = 0.0;
+    const double values[4] = {1.0, 2.0, 3.0, 4.0};
+    for (int n = 0; n < 4; ++n) {
+        double new_mean = mean + (values[n] - mean) / (n + 1);
+        m2 = update_luminance_m2(m2, mean, new_mean, values[n]);
+        mean = new_mean;
+    }
+    EXPECT_NEAR(m2, 5.0, 1e-12);
+    EXPECT_NEAR(pixel_relative_error(mean, m2, 4), std::sqrt(5.0 / 3.0 / 4.0) / 2.5, 1e-12);
+    EXPECT_TRUE(std::isinf(pixel_relative_error(1.0, 0.0, 1)));
+    EXPECT_EQ(pixel_relative_error(0.0, 0.0, 8), 0.0);
+}
+
+// Test flat tiles converge at the minimum sample count while noisy tiles run
+// to the target, and the pass still counts as complete
+TEST(TileSchedulerTest, AdaptiveConvergence) {
+    const int size = 64, min_samples = 4, target = 32;
+    TileScheduler scheduler;
+    scheduler.reset(size, size, 16, target);
+
+    // Per-pixel running mean and m2; the left half is flat, the right half noisy
+    std::vector<double> mean(size * size, 0.0), m2(size * size, 0.0);
+    std::vector<unsigned> state(size * size);
+    for (int i = 0; i < size * size; ++i) state[i] = 1234567u + 7919u * i;
+    AdaptiveSampling adaptive;
+    adaptive.min_samples = min_samples;
+    adaptive.threshold = 0.05;
+    adaptive.error = [&](const RenderTile& tile, int samples) {
+        double sum_sq = 0.0;
+        for (int y = tile.start_y; y < tile.end_y; ++y) {
+            for (int x = tile.start_x; x < tile.end_x; ++x) {
+                double e = pixel_relative_error(mean[y * size + x], m2[y * size + x], samples);
+                sum_sq += e * e;
+            }
+        }
+        return std::sqrt(sum_sq / ((tile.end_x - tile.start_x) * (tile.end_y - tile.start_y)));
+    };
+    scheduler.set_adaptive(adaptive);
+
+    std::atomic<size_t> pixels_traced(0);
+    ThreadPool pool(4);
+    bool done = scheduler.run_until(TileScheduler::Clock::now() + std::chrono::hours(1), &pool,
+        [&](const RenderTile& tile, int row, int sample) {
+            for (int x = tile.start_x; x < tile.end_x; ++x) {
+                int i = row * size + x;
+                state[i] = state[i] * 1664525u + 1013904223u;
+                double noise = (state[i] >> 8) / 16777216.0 - 0.5;
+                double value = x < size / 2 ? 0.5 : 0.5 + noise;
+                double new_mean = mean[i] + (value - mean[i]) / (sample + 1);
+                m2[i] = sample == 0 ? 0.0 : update_luminance_m2(m2[i], mean[i], new_mean, value);
+                mean[i] = new_mean;
+            }
+            pixels_traced += tile.end_x - tile.start_x;
+        });
+
+    EXPECT_TRUE(done);
+    EXPECT_DOUBLE_EQ(scheduler.progress(), 1.0);
+    EXPECT_EQ(scheduler.converged_tiles(), 8u);
+    for (size_t i = 0; i < scheduler.get_tiles().size(); ++i) {
+        bool flat = scheduler.get_tiles()[i].start_x < size / 2;
+        EXPECT_EQ(scheduler.get_tile_progress(i).converged, flat);
+        EXPECT_EQ(scheduler.get_tile_progress(i).samples_done, flat ? min_samples : target);
+    }
+    EXPECT_EQ(pixels_traced.load(), static_cast<size_t>(size * size / 2) * (min_samples + target));
+}
@@ -0,0 +1,103 @@
+#include <gtest/gtest.h>
+#include "../../include/rendering/upscaler.hpp"
+#include "test_helpers.hpp"
+#include <cmath>
+
+// Disc over a diagonal split, box filtered over each pixel of a width x height
+// image of the unit square
+static std::vector<double> render_shapes(int width, int height) {
+    const int grid = 8;
+    std::vector<double> image(3 * width * height);
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            double sum = 0.0;
+            for (int sy = 0; sy < grid; ++sy) {
+                for (int sx = 0; sx < grid; ++sx) {
+                    double u = (x + (sx + 0.5) / grid) / width;
+                    double v = (y + (sy + 0.5) / grid) / height;
+                    bool disc = (u - 0.5) * (u - 0.5) + (v - 0.45) * (v - 0.45) < 0.09;
+                    sum += disc ? 0.9 : (u + 0.4 * v < 0.6 ? 0.3 : 0.05);
+                }
+            }
+            for (int c = 0; c < 3; ++c) image[3 * (y * width + x) + c] = sum / (grid * grid) * (1.0 - 0.2 * c);
+        }
+    }
+    return image;
+}
+
+static std::vector<double> bilinear(const std::vector<double>& src, int src_width, int src_height, int width, int height) {
+    std::vector<double> out(3 * width * height);
+    for (int y = 0; y < height; ++y) {
+        double py = std::min(std::max((y + 0.5) * src_height / height - 0.5, 0.0), src_height - 1.0);
+        int y0 = std::min(static_cast<int>(py), src_height - 2);
+        double fy = py - y0;
+        for (int x = 0; x < width; ++x) {
+            double px = std::min(std::max((x + 0.5) * src_width / width - 0.5, 0.0), src_width - 1.0);
+            int x0 = std::min(static_cast<int>(px), src_width - 2);
+            double fx = px - x0;
+            for (int c = 0; c < 3; ++c) {
+                auto at = [&](int sx, int sy) { return src[3 * (sy * src_width + sx) + c]; };
+                double top = at(x0, y0) + fx * (at(x0 + 1, y0) - at(x0, y0));
+                double bottom = at(x0, y0 + 1) + fx * (at(x0 + 1, y0 + 1) - at(x0, y0 + 1));
+                out[3 * (y * width + x) + c] = top + fy * (bottom - top);
+            }
+        }
+    }
+    return out;
+}
+
+// Test flat colour passes through unchanged, padded layouts work, and the
+// pool only splits rows
+TEST(UpscalerTest, FlatAndThreaded) {
+    std::vector<double> flat(4 * 20 * 12);
+    for (size_t i = 0; i < flat.size(); i += 4) {
+        flat[i] = 0.25;
+        flat[i + 1] = 0.5;
+        flat[i + 2] = 2.0;
+    }
+    std::vector<double> out(4 * 33 * 20, -1.0);
+    Upscaler upscaler;
+    upscaler.upscale(flat.data(), 4, 20, 12, out.data(), 4, 33, 20, nullptr);
+    for (size_t i = 0; i < out.size(); i += 4) {
+        EXPECT_NEAR(out[i], 0.25, 1e-12);
+        EXPECT_NEAR(out[i + 1], 0.5, 1e-12);
+        EXPECT_NEAR(out[i + 2], 2.0, 1e-12);
+        EXPECT_EQ(out[i + 3], -1.0);
+    }
+
+    std::vector<double> shapes = render_shapes(60, 36);
+    std::vector<double> serial(3 * 100 * 60), threaded(3 * 100 * 60);
+    ThreadPool pool(4);
+    upscaler.upscale(shapes.data(), 3, 60, 36, serial.data(), 3, 100, 60, nullptr);
+    upscaler.upscale(shapes.data(), 3, 60, 36, threaded.data(), 3, 100, 60, &pool);
+    for (size_t i = 0; i < serial.size(); ++i) ASSERT_EQ(serial[i], threaded[i]);
+}
+
+// Test a 60% render scaled to full size lands closer to the full resolution
+// render than bilinear filtering does
+TEST(UpscalerTest, SharperThanBilinear) {
+    const int width = 160, height = 96, low_width = 96, low_height = 58;
+    std::vector<double> low = render_shapes(low_width, low_height);
+    std::vector<double> reference = render_shapes(width, height);
+
+    std::vector<double> upscaled(3 * width * height);
+    Upscaler upscaler;
+    upscaler.upscale(low.data(), 3, low_width, low_height, upscaled.data(), 3, width, height, nullptr);
+    double error = mean_squared_error(upscaled, reference);
+    double error_bilinear = mean_squared_error(bilinear(low, low_width, low_height, width, height), reference);
+    EXPECT_LT(error, error_bilinear * 0.7);
+    // Sharpening stays within [0, 1]
+    for (double value : upscaled) {
+        EXPECT_GE(value, 0.0);
+        EXPECT_LE(value, 1.0);
+    }
+
+    // EASU on its own already beats bilinear, and cannot ring past its inputs
+    upscaler.set_sharpening(-1.0);
+    upscaler.upscale(low.data(), 3, low_width, low_height, upscaled.data(), 3, width, height, nullptr);
+    EXPECT_LT(mean_squared_error(upscaled, reference), error_bilinear);
+    for (size_t i = 0; i < upscaled.size(); ++i) {
+        EXPECT_GE(upscaled[i], 0.05 * (1.0 - 0.2 * (i % 3)) - 1e-9);
+        EXPECT_LE(upscaled[i], 0.9 * (1.0 - 0.2 * (i % 3)) + 1e-9);
+    }
+}
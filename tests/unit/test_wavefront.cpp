@@ -0,0 +1,68 @@
+#include <gtest/gtest.h>
+#include "../../include/rendering/wavefront.hpp"
+#include "test_helpers.hpp"
+
+// Test the wavefront stages reproduce the megakernel path tracer
+TEST(WavefrontTest, MatchesMegakernel) {
+    Scene scene;
+    std::shared_ptr<const SceneAccel> accel = default_accel(scene);
+    Camera camera;
+    camera.update_dimensions(160.0, 90.0);
+    ThreadPool pool(4);
+
+    RenderTile region = make_tile(20, 30, 140, 80);
+    int width = region.end_x - region.start_x;
+    std::vector<color> output(static_cast<size_t>(width) * (region.end_y - region.start_y));
+
+    WavefrontIntegrator wavefront;
+    wavefront.set_batch_size(1000); // Several batches
+    wavefront.render(*accel, camera, region, 3, 0.25, -0.125, output.data(), &pool);
+    EXPECT_GE(wavefront.rays_traced(), output.size());
+    EXPECT_GT(wavefront.shadow_rays_traced(), 0u);
+
+    for (int y = region.start_y; y < region.end_y; ++y) {
+        for (int x = region.start_x; x < region.end_x; ++x) {
+            Rng rng(pixel_seed(x, y, 3));
+            color expected = trace_path(*accel, camera.get_ray(x, y, 0.25, -0.125), rng, 3);
+            const color& actual = output[(y - region.start_y) * width + (x - region.start_x)];
+            EXPECT_NEAR(actual.x(), expected.x(), 1e-12);
+            EXPECT_NEAR(actual.y(), expected.y(), 1e-12);
+            EXPECT_NEAR(actual.z(), expected.z(), 1e-12);
+        }
+    }
+}
+
+// Test ray sorting changes the processing order but not the image
+TEST(WavefrontTest, SortingPreservesResult) {
+    Scene scene;
+    std::shared_ptr<const SceneAccel> accel = default_accel(scene);
+    Camera camera;
+    camera.update_dimensions(96.0, 54.0);
+
+    RenderTile region = make_tile(0, 0, 96, 54);
+    std::vector<color> sorted(96 * 54), unsorted(96 * 54);
+
+    WavefrontIntegrator wavefront;
+    wavefront.render(*accel, camera, region, 0, 0.0, 0.0, sorted.data(), nullptr);
+    wavefront.set_ray_sorting(false);
+    wavefront.render(*accel, camera, region, 0, 0.0, 0.0, unsorted.data(), nullptr);
+
+    for (size_t i = 0; i < sorted.size(); ++i) {
+        EXPECT_EQ(sorted[i].x(), unsorted[i].x());
+        EXPECT_EQ(sorted[i].y(), unsorted[i].y());
+        EXPECT_EQ(sorted[i].z(), unsorted[i].z());
+    }
+}
+
+// Test shadow rays: with one bounce only direct sunlight reaches the camera,
+// and the ground point touching the centre sphere is fully shadowed
+TEST(WavefrontTest, ShadowRays) {
+    Scene scene;
+    std::shared_ptr<const SceneAccel> accel = default_accel(scene);
+
+    Rng open_rng(1), shadowed_rng(2);
+    color open = trace_path(*accel, Ray(point3(0.0, 1.0, 3.0), vec3(0, -1, 0)), open_rng, 1);
+    color shadowed = trace_path(*accel, Ray(point3(0.0, -0.49, -1.2), vec3(0, -1, 0)), shadowed_rng, 1);
+    EXPECT_GT(open.y(), 0.1);
+    EXPECT_EQ(shadowed.y(), 0.0);
+}